@@ -7,18 +7,37 @@ bool Engine::Initialize(HINSTANCE hInstance, std::string window_title, std::stri
 
 	if (!gfx.Initialize(this->render_window.GetHWND(), width, height))
 		return false;
+	XMStoreFloat3(&cameraPosition, gfx.camera.GetPosition());
+	previousCameraPosition = cameraPosition;
+	gfx.StartRenderThread();
 
 	return true;
 }
 
 bool Engine::ProcessMessages()
 {
+	if (!NeedsFrames())
+	{
+		this->render_window.WaitForMessages();
+		// The time asleep isn't part of any frame.
+		frameClock.Tick();
+		settleFrames = 3;
+	}
 	return this->render_window.ProcessMessages();
 }
 
+bool Engine::NeedsFrames()
+{
+	if (settleFrames > 0)
+		return true;
+	return cameraMoving || mouse.IsRightDown() || this->gfx.NeedsContinuousFrames();
+}
+
 void Engine::Update()
 {
-	float dt = 1.0f;
+	frameSeconds = static_cast<float>(frameClock.Tick());
+	if (settleFrames > 0)
+		--settleFrames;
 	while (!keyboard.CharBufferIsEmpty())
 	{
 		unsigned char ch = keyboard.ReadChar();
@@ -42,37 +61,50 @@ void Engine::Update()
 		}
 	}
 
+	XMVECTOR velocity = XMVectorZero();
 	if (keyboard.KeyIsPressed('W'))
 	{
-		this->gfx.camera.AdjustPosition(this->gfx.camera.GetForwardVector() * dt * 0.02f);
+		velocity += this->gfx.camera.GetForwardVector();
 	}
 	if (keyboard.KeyIsPressed('S'))
 	{
-		this->gfx.camera.AdjustPosition(this->gfx.camera.GetBackwardVector() * dt * 0.02f);
+		velocity += this->gfx.camera.GetBackwardVector();
 	}
 	if (keyboard.KeyIsPressed('A'))
 	{
-		this->gfx.camera.AdjustPosition(this->gfx.camera.GetLeftVector() * dt * 0.02f);
+		velocity += this->gfx.camera.GetLeftVector();
 	}
 	if (keyboard.KeyIsPressed('D'))
 	{
-		this->gfx.camera.AdjustPosition(this->gfx.camera.GetRightVector() * dt * 0.02f);
+		velocity += this->gfx.camera.GetRightVector();
 	}
 	if (keyboard.KeyIsPressed(VK_SPACE))
 	{
-		this->gfx.camera.AdjustPosition({ 0.0f, dt * 0.02f, 0.0f });
+		velocity += XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
 	}
 	if (keyboard.KeyIsPressed('Z'))
 	{
-		this->gfx.camera.AdjustPosition({ 0.0f, -dt * 0.02f, 0.0f });
+		velocity += XMVectorSet(0.0f, -1.0f, 0.0f, 0.0f);
 	}
+	velocity *= cameraSpeed * static_cast<float>(cameraStep.Step());
 
+	const int steps = cameraStep.Advance(frameSeconds);
+	for (int i = 0; i < steps; ++i)
+	{
+		previousCameraPosition = cameraPosition;
+		XMStoreFloat3(&cameraPosition, XMLoadFloat3(&cameraPosition) + velocity);
+	}
+	// Still moving while the interpolation catches up with the last step.
+	cameraMoving = XMVector3NotEqual(velocity, XMVectorZero()) ||
+		XMVector3NotEqual(XMLoadFloat3(&previousCameraPosition), XMLoadFloat3(&cameraPosition));
 
-
+	XMFLOAT3 shown;
+	XMStoreFloat3(&shown, XMVectorLerp(XMLoadFloat3(&previousCameraPosition), XMLoadFloat3(&cameraPosition), cameraStep.Alpha()));
+	this->gfx.camera.SetPosition(shown.x, shown.y, shown.z);
 }
 
-void Engine::RenderFrame()
+void Engine::PublishFrame()
 {
-	this->gfx.RenderFrame();
+	this->gfx.PublishFrame(frameSeconds);
 }
 
@@ -1,10 +1,30 @@
 #pragma once
 #include "WindowContainer.h"
+#include "Timing/FrameClock.h"
 class Engine : WindowContainer
 {
 public:
 	bool Initialize(HINSTANCE hInstance, std::string window_title, std::string window_class, int width, int height);
 	bool ProcessMessages();
 	void Update();
-	void RenderFrame();
+	void PublishFrame();
+
+private:
+	// False when nothing will change until the next message arrives.
+	bool NeedsFrames();
+
+	FrameClock frameClock;
+	float frameSeconds = 0.0f;
+
+	// The camera moves in fixed steps so its speed doesn't depend on the
+	// frame rate; what is drawn is interpolated between the last two steps.
+	FixedStep cameraStep{ 1.0 / 120.0 };
+	XMFLOAT3 cameraPosition = { 0.0f, 0.0f, 0.0f };
+	XMFLOAT3 previousCameraPosition = { 0.0f, 0.0f, 0.0f };
+	// Units per second; 0.02 per frame at 60 Hz, as before.
+	const float cameraSpeed = 1.2f;
+	bool cameraMoving = false;
+	// Frames still to run after waking up, so the UI can catch up with the
+	// input, e.g. hover highlights after the mouse moved.
+	int settleFrames = 3;
 };
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "ErrorLogger.h"
+#ifdef _WIN32
 #include <comdef.h>
+#else
+#include <iostream>
+#endif
 
+#ifdef _WIN32
 void ErrorLogger::Log(std::string message)
 {
 	std::string error_message = "Error: " + message;
@@ -20,3 +25,23 @@ void ErrorLogger::Log(HRESULT hr, std::wstring message)
 	std::wstring error_message = L"Error: " + message + L"\n" + error.ErrorMessage();
 	MessageBoxW(NULL, error_message.c_str(), L"Error", MB_ICONERROR);
 }
+#else
+// No message boxes off Windows; errors go to stderr.
+void ErrorLogger::Log(std::string message)
+{
+	std::cerr << "Error: " << message << std::endl;
+}
+
+void ErrorLogger::Log(HRESULT hr, std::string message)
+{
+	std::cerr << "Error: " << message << " (HRESULT 0x" << std::hex << static_cast<std::uint32_t>(hr) << std::dec << ")" << std::endl;
+}
+
+void ErrorLogger::Log(HRESULT hr, std::wstring message)
+{
+	std::string narrow;
+	for (wchar_t c : message)
+		narrow += c < 128 ? static_cast<char>(c) : '?';
+	Log(hr, narrow);
+}
+#endif
@@ -0,0 +1,364 @@
+#include "AdaptiveGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const double pi = 3.14159265358979;
+	const int minExponent = -3;
+	const int maxExponent = 5;
+	// Levels drawn at once, finest first.
+	const int numLevels = 3;
+	// Alphas are rebuilt when the fade moves by this much.
+	const float fadeSteps = 64.0f;
+	const int minRingSegments = 8;
+	const int maxRingSegments = 512;
+
+	enum LineKind : unsigned char { LINE, AXIS };
+
+	int PlaneIndex(GridPlane plane)
+	{
+		return plane == GridPlane::XY ? 0 : 1;
+	}
+
+	// Plane coordinates of a point and its height above the plane.
+	void ToPlane(GridPlane plane, const DirectX::XMFLOAT3& p, double& u, double& v, double& h)
+	{
+		u = p.x;
+		v = plane == GridPlane::XY ? p.y : p.z;
+		h = plane == GridPlane::XY ? p.z : p.y;
+	}
+
+	DirectX::XMFLOAT3 FromPlane(GridPlane plane, double u, double v)
+	{
+		if (plane == GridPlane::XY)
+			return DirectX::XMFLOAT3(static_cast<float>(u), static_cast<float>(v), 0.0f);
+		return DirectX::XMFLOAT3(static_cast<float>(u), 0.0f, static_cast<float>(v));
+	}
+
+	double Spacing(int exponent)
+	{
+		return std::pow(10.0, exponent);
+	}
+
+	// Square a level covers. Lines fade out towards its edge.
+	struct Window
+	{
+		double centerU;
+		double centerV;
+		double halfSize;
+
+		double Weight(double u, double v) const
+		{
+			const double d = (std::max)(std::abs(u - centerU), std::abs(v - centerV));
+			return (std::max)(0.0, 1.0 - d / halfSize);
+		}
+	};
+
+	// Adds the segment from (u0, v0) to (u1, v1) in `pieces` parts, leaving
+	// out the parts that are entirely outside the window.
+	template<class Lines>
+	void AddLine(Lines& lines, const Window& window, double u0, double v0, double u1, double v1, int pieces, LineKind kind)
+	{
+		double u = u0;
+		double v = v0;
+		double weight = window.Weight(u, v);
+		for (int i = 1; i <= pieces; ++i)
+		{
+			const double t = static_cast<double>(i) / pieces;
+			const double nu = u0 + (u1 - u0) * t;
+			const double nv = v0 + (v1 - v0) * t;
+			const double nweight = window.Weight(nu, nv);
+			if (weight > 0.0 || nweight > 0.0)
+			{
+				lines.points.push_back(FromPlane(lines.key.plane, u, v));
+				lines.points.push_back(FromPlane(lines.key.plane, nu, nv));
+				lines.weights.push_back(static_cast<float>(weight));
+				lines.weights.push_back(static_cast<float>(nweight));
+				lines.kinds.push_back(kind);
+			}
+			u = nu;
+			v = nv;
+			weight = nweight;
+		}
+	}
+
+	bool SameStyle(const GridStyle& a, const GridStyle& b)
+	{
+		return a.kind == b.kind && a.minSpacing == b.minSpacing && a.halfLines == b.halfLines &&
+			a.radialDegrees == b.radialDegrees &&
+			a.color.x == b.color.x && a.color.y == b.color.y && a.color.z == b.color.z &&
+			a.axisColor.x == b.axisColor.x && a.axisColor.y == b.axisColor.y && a.axisColor.z == b.axisColor.z &&
+			a.minorAlpha == b.minorAlpha && a.majorAlpha == b.majorAlpha;
+	}
+}
+
+bool AdaptiveGrid::LevelKey::operator==(const LevelKey& rhs) const
+{
+	return plane == rhs.plane && kind == rhs.kind && exponent == rhs.exponent &&
+		cellU == rhs.cellU && cellV == rhs.cellV && halfLines == rhs.halfLines &&
+		radialDegrees == rhs.radialDegrees && top == rhs.top;
+}
+
+GridLevel AdaptiveGrid::ChooseLevel(const GridView& view, GridPlane plane, float minSpacing)
+{
+	double eyeU, eyeV, eyeH;
+	double forwardU, forwardV, forwardH;
+	ToPlane(plane, view.eye, eyeU, eyeV, eyeH);
+	ToPlane(plane, view.forward, forwardU, forwardV, forwardH);
+
+	// Where the view ray meets the plane. Close to grazing, or looking
+	// away, the point is taken at most a few heights out along the ray.
+	const double height = (std::max)(std::abs(eyeH), 1e-4);
+	const double maxDistance = 8.0 * height;
+	double distance = height;
+	double lookU = eyeU;
+	double lookV = eyeV;
+	if (eyeH * forwardH < 0.0)
+	{
+		distance = (std::min)(-eyeH / forwardH, maxDistance);
+		lookU = eyeU + forwardU * distance;
+		lookV = eyeV + forwardV * distance;
+	}
+
+	GridLevel level;
+	level.centerU = static_cast<float>(lookU);
+	level.centerV = static_cast<float>(lookV);
+
+	const double tanHalfFov = (std::max)(static_cast<double>(view.tanHalfFov), 1e-4);
+	const double pixelsPerUnit = view.viewportHeight / (2.0 * distance * tanHalfFov);
+	const double decade = std::log10((std::max)(static_cast<double>(minSpacing), 1e-3) / pixelsPerUnit);
+	if (!(decade > minExponent))
+	{
+		level.exponent = minExponent;
+		level.fade = 1.0f;
+	}
+	else if (!(decade <= maxExponent))
+	{
+		level.exponent = maxExponent;
+		level.fade = 0.0f;
+	}
+	else
+	{
+		level.exponent = static_cast<int>(std::ceil(decade));
+		level.fade = static_cast<float>((std::min)(level.exponent - decade, 1.0));
+	}
+	return level;
+}
+
+bool AdaptiveGrid::Update(const GridView& view, const GridStyle& style, bool xy, bool xz)
+{
+	const bool planes[2] = { xy, xz };
+	LevelKey keys[2];
+	int fades[2] = {};
+	for (int p = 0; p < 2; ++p)
+	{
+		if (!planes[p])
+			continue;
+		const GridPlane plane = p == 0 ? GridPlane::XY : GridPlane::XZ;
+		levels[p] = ChooseLevel(view, plane, style.minSpacing);
+		const double cell = 10.0 * Spacing(levels[p].exponent);
+		keys[p].plane = plane;
+		keys[p].kind = style.kind;
+		keys[p].exponent = levels[p].exponent;
+		keys[p].cellU = std::llround(levels[p].centerU / cell);
+		keys[p].cellV = std::llround(levels[p].centerV / cell);
+		keys[p].halfLines = style.halfLines;
+		keys[p].radialDegrees = style.radialDegrees;
+		fades[p] = static_cast<int>(levels[p].fade * fadeSteps);
+	}
+
+	bool changed = !built || !SameStyle(style, builtStyle);
+	for (int p = 0; p < 2 && !changed; ++p)
+		changed = planes[p] != builtPlanes[p] || (planes[p] && (!(keys[p] == builtKeys[p]) || fades[p] != builtFade[p]));
+	if (!changed)
+		return false;
+
+	built = true;
+	builtStyle = style;
+	vertices.clear();
+	for (int p = 0; p < 2; ++p)
+	{
+		builtPlanes[p] = planes[p];
+		builtKeys[p] = keys[p];
+		builtFade[p] = fades[p];
+		if (planes[p])
+			AppendPlane(keys[p].plane, levels[p], style);
+	}
+	return true;
+}
+
+void AdaptiveGrid::AppendPlane(GridPlane plane, const GridLevel& level, const GridStyle& style)
+{
+	for (int i = 0; i < numLevels; ++i)
+	{
+		// Each line keeps its alpha as the levels shift by a decade: the
+		// finest level fades in from nothing to the minor alpha, the next
+		// one grows to the major alpha, and the coarsest stays there. A
+		// coarser level's lines lie on every tenth line of the finer ones,
+		// which is why those leave them out.
+		float alpha = style.majorAlpha;
+		if (i == 0)
+			alpha = level.fade * style.minorAlpha;
+		else if (i == 1)
+			alpha = style.minorAlpha + (style.majorAlpha - style.minorAlpha) * level.fade;
+		const bool top = i == numLevels - 1;
+		if (alpha <= 0.0f && !top)
+			continue;
+
+		LevelKey key;
+		key.plane = plane;
+		key.kind = style.kind;
+		key.exponent = level.exponent + i;
+		const double cell = 10.0 * Spacing(key.exponent);
+		key.cellU = std::llround(level.centerU / cell);
+		key.cellV = std::llround(level.centerV / cell);
+		key.halfLines = style.halfLines;
+		key.radialDegrees = style.radialDegrees;
+		key.top = top;
+
+		const LevelLines& lines = Lines(key);
+		for (size_t s = 0; s < lines.kinds.size(); ++s)
+		{
+			const bool axis = lines.kinds[s] == AXIS;
+			const DirectX::XMFLOAT3& color = axis ? style.axisColor : style.color;
+			const float a = axis ? 1.0f : alpha;
+			for (size_t e = 2 * s; e < 2 * s + 2; ++e)
+			{
+				const DirectX::XMFLOAT3& p = lines.points[e];
+				vertices.emplace_back(p.x, p.y, p.z, color.x, color.y, color.z, a * lines.weights[e]);
+			}
+		}
+	}
+}
+
+const AdaptiveGrid::LevelLines& AdaptiveGrid::Lines(const LevelKey& key)
+{
+	for (auto it = cache.begin(); it != cache.end(); ++it)
+	{
+		if (it->key == key)
+		{
+			cache.splice(cache.begin(), cache, it);
+			return cache.front();
+		}
+	}
+
+	cache.emplace_front();
+	LevelLines& lines = cache.front();
+	lines.key = key;
+	if (key.kind == GridKind::POLAR)
+		BuildPolar(lines);
+	else
+		BuildCartesian(lines);
+	while (cache.size() > (std::max)(cacheCapacity, static_cast<size_t>(1)))
+		cache.pop_back();
+	return lines;
+}
+
+void AdaptiveGrid::BuildCartesian(LevelLines& lines)
+{
+	const LevelKey& key = lines.key;
+	const double spacing = Spacing(key.exponent);
+	const int n = (std::max)(key.halfLines, 1);
+	const Window window = { key.cellU * 10.0 * spacing, key.cellV * 10.0 * spacing, n * spacing };
+
+	for (int direction = 0; direction < 2; ++direction)
+	{
+		const long long first = (direction == 0 ? key.cellU : key.cellV) * 10;
+		for (int i = -n + 1; i < n; ++i)
+		{
+			const long long index = first + i;
+			if (index % 10 == 0 && !key.top)
+				continue;
+			const LineKind kind = index == 0 ? AXIS : LINE;
+			// Split at the center, where the weight is highest.
+			const double c = index * spacing;
+			if (direction == 0)
+				AddLine(lines, window, c, window.centerV - window.halfSize, c, window.centerV + window.halfSize, 2, kind);
+			else
+				AddLine(lines, window, window.centerU - window.halfSize, c, window.centerU + window.halfSize, c, 2, kind);
+		}
+	}
+}
+
+void AdaptiveGrid::BuildPolar(LevelLines& lines)
+{
+	const LevelKey& key = lines.key;
+	const double spacing = Spacing(key.exponent);
+	const int n = (std::max)(key.halfLines, 1);
+	const Window window = { key.cellU * 10.0 * spacing, key.cellV * 10.0 * spacing, n * spacing };
+
+	// Rings that pass through the window, over the angles it covers.
+	const double reach = window.halfSize * std::sqrt(2.0);
+	const double centerDistance = std::sqrt(window.centerU * window.centerU + window.centerV * window.centerV);
+	const double centerAngle = std::atan2(window.centerV, window.centerU);
+	double halfAngle = pi;
+	if (centerDistance > reach)
+		halfAngle = std::asin(reach / centerDistance);
+	const long long firstRing = (std::max)(1LL, static_cast<long long>(std::ceil((centerDistance - reach) / spacing)));
+	const long long lastRing = static_cast<long long>(std::floor((centerDistance + reach) / spacing));
+	for (long long k = firstRing; k <= lastRing; ++k)
+	{
+		if (k % 10 == 0 && !key.top)
+			continue;
+		const double radius = k * spacing;
+		// Chords of 1 / sqrt(k) radians stray at most an eighth of the
+		// spacing from the ring.
+		const int segments = static_cast<int>((std::min)((std::max)(std::ceil(2.0 * halfAngle * std::sqrt(static_cast<double>(k))), static_cast<double>(minRingSegments)),
+			static_cast<double>(maxRingSegments)));
+		const double step = 2.0 * halfAngle / segments;
+		double angle = centerAngle - halfAngle;
+		double u = radius * std::cos(angle);
+		double v = radius * std::sin(angle);
+		for (int s = 0; s < segments; ++s)
+		{
+			angle += step;
+			const double nu = radius * std::cos(angle);
+			const double nv = radius * std::sin(angle);
+			AddLine(lines, window, u, v, nu, nv, 1, LINE);
+			u = nu;
+			v = nv;
+		}
+	}
+
+	if (!key.top)
+		return;
+
+	// Radial lines, in pieces of a cell so their weight follows the window.
+	const double rMin = (std::max)(0.0, centerDistance - reach);
+	const double rMax = centerDistance + reach;
+	const int pieces = (std::max)(1, static_cast<int>(std::ceil((rMax - rMin) / (10.0 * spacing))));
+	const int numRadials = key.radialDegrees > 0.0f ? static_cast<int>(std::floor(360.0 / key.radialDegrees + 0.5)) : 0;
+	for (int r = 0; r < numRadials; ++r)
+	{
+		const double degrees = r * static_cast<double>(key.radialDegrees);
+		// The axes are drawn below.
+		const double quadrant = std::fmod(degrees, 90.0);
+		if (quadrant < 1e-6 || 90.0 - quadrant < 1e-6)
+			continue;
+		const double angle = degrees * pi / 180.0;
+		const double cu = std::cos(angle);
+		const double cv = std::sin(angle);
+		AddLine(lines, window, rMin * cu, rMin * cv, rMax * cu, rMax * cv, pieces, LINE);
+	}
+
+	if (std::abs(window.centerV) < window.halfSize)
+		AddLine(lines, window, window.centerU - window.halfSize, 0.0, window.centerU + window.halfSize, 0.0, 2, AXIS);
+	if (std::abs(window.centerU) < window.halfSize)
+		AddLine(lines, window, 0.0, window.centerV - window.halfSize, 0.0, window.centerV + window.halfSize, 2, AXIS);
+}
+
+const std::vector<VertexCommon>& AdaptiveGrid::Vertices() const
+{
+	return vertices;
+}
+
+const GridLevel& AdaptiveGrid::Level(GridPlane plane) const
+{
+	return levels[PlaneIndex(plane)];
+}
+
+size_t AdaptiveGrid::CachedLevels() const
+{
+	return cache.size();
+}
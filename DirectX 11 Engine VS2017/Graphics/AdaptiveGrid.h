@@ -0,0 +1,114 @@
+#pragma once
+#include "Vertex.h"
+#include <cstddef>
+#include <list>
+#include <vector>
+
+enum class GridPlane { XY, XZ };
+enum class GridKind { CARTESIAN, POLAR };
+
+// Where the grid is seen from, in world units.
+struct GridView
+{
+	DirectX::XMFLOAT3 eye = { 0.0f, 0.0f, 0.0f };
+	// Normalized.
+	DirectX::XMFLOAT3 forward = { 0.0f, 0.0f, 1.0f };
+	// tan of half the vertical field of view.
+	float tanHalfFov = 0.57735f;
+	// Pixels.
+	float viewportHeight = 600.0f;
+};
+
+struct GridStyle
+{
+	GridKind kind = GridKind::CARTESIAN;
+	// The finest lines drawn are at least this many pixels apart where the
+	// camera looks at the plane.
+	float minSpacing = 8.0f;
+	// Lines of each level on either side of its center.
+	int halfLines = 40;
+	// Angle between radial lines of the polar grid.
+	float radialDegrees = 15.0f;
+	DirectX::XMFLOAT3 color = { 0.6f, 0.6f, 0.6f };
+	DirectX::XMFLOAT3 axisColor = { 0.9f, 0.9f, 0.9f };
+	float minorAlpha = 0.25f;
+	float majorAlpha = 0.6f;
+};
+
+// Spacing 10^exponent. fade runs from 0, when the lines are just at
+// minSpacing and about to disappear, to 1 when they are ten times as far
+// apart and about to become the next level's major lines.
+struct GridLevel
+{
+	int exponent = 0;
+	float fade = 1.0f;
+	float centerU = 0.0f;
+	float centerV = 0.0f;
+};
+
+// Grid lines on the X-Y and X-Z planes whose spacing follows the camera.
+// Three decades of spacing are drawn at once and the finest one fades in
+// and out with the distance, so lines neither vanish nor clutter as the
+// view zooms. Each level's lines are kept per plane, spacing and center,
+// so moving within a cell or coming back to a zoom reuses them; only the
+// alphas are redone, and only when the fade has changed noticeably.
+class AdaptiveGrid
+{
+public:
+	// Returns true when Vertices changed.
+	bool Update(const GridView& view, const GridStyle& style, bool xy, bool xz);
+
+	// Line list, one color per vertex with the alpha to blend with.
+	const std::vector<VertexCommon>& Vertices() const;
+	// Where the camera looks at the plane, of the last Update.
+	const GridLevel& Level(GridPlane plane) const;
+	size_t CachedLevels() const;
+
+	static GridLevel ChooseLevel(const GridView& view, GridPlane plane, float minSpacing);
+
+	size_t cacheCapacity = 24;
+
+private:
+	struct LevelKey
+	{
+		GridPlane plane = GridPlane::XY;
+		GridKind kind = GridKind::CARTESIAN;
+		int exponent = 0;
+		// Cell of the center, in units of ten times the spacing.
+		long long cellU = 0;
+		long long cellV = 0;
+		int halfLines = 0;
+		float radialDegrees = 0.0f;
+		// Whether the level is the coarsest drawn: it alone has the axes,
+		// the major lines and the radials.
+		bool top = false;
+
+		bool operator==(const LevelKey& rhs) const;
+	};
+
+	// Line segments of a level, without colors. weight scales the alpha
+	// down to 0 at the edge of the level's extent; kind is a LineKind.
+	struct LevelLines
+	{
+		LevelKey key;
+		std::vector<DirectX::XMFLOAT3> points;
+		std::vector<float> weights;
+		std::vector<unsigned char> kinds;
+	};
+
+	const LevelLines& Lines(const LevelKey& key);
+	static void BuildCartesian(LevelLines& lines);
+	static void BuildPolar(LevelLines& lines);
+	void AppendPlane(GridPlane plane, const GridLevel& level, const GridStyle& style);
+
+	std::list<LevelLines> cache;
+	std::vector<VertexCommon> vertices;
+	GridLevel levels[2];
+
+	// What the last vertices were built from.
+	bool built = false;
+	GridStyle builtStyle;
+	bool builtPlanes[2] = {};
+	LevelKey builtKeys[2];
+	int builtFade[2] = {};
+};
@@ -0,0 +1,254 @@
+#include "AnimatedCurve.h"
+#include "../Jobs/ParallelFor.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+bool AnimatedCurve::Initialize(RenderTaskQueue* tasks, RenderDevice* device, UploadRing* uploads, DeviceVertexShader* vs, DeviceInputLayout* inputLayout, DevicePixelShader* ps)
+{
+	this->tasks = tasks;
+	this->device = device;
+	this->uploads = uploads;
+	for (Model& model : models)
+	{
+		model.vs = vs;
+		model.inputLayout = inputLayout;
+		model.ps = ps;
+		model.topology = PrimitiveTopology::LINE_STRIP;
+		model.transformatin = XMMatrixIdentity();
+
+		HRESULT hr = model.cb.Initialize(device);
+		if (FAILED(hr))
+		{
+			ErrorLogger::Log(hr, "Failed to create constant buffer for animated curve.");
+			return false;
+		}
+	}
+	return true;
+}
+
+void AnimatedCurve::Resize(UINT numVertices)
+{
+	hasFront = false;
+	generating = false;
+	capacity = numVertices;
+
+	tasks->Push([this, numVertices]()
+	{
+		drawable = false;
+		bufferCapacity = 0;
+
+		std::vector<DWORD> indices(numVertices);
+		std::iota(indices.begin(), indices.end(), 0);
+
+		for (Model& model : models)
+		{
+			HRESULT hr = model.vertices.Initialize(device, nullptr, numVertices, false);
+			if (SUCCEEDED(hr))
+				hr = model.indices.Initialize(device, indices.data(), numVertices);
+			if (FAILED(hr))
+			{
+				ErrorLogger::Log(hr, "Failed to create buffers for animated curve.");
+				return;
+			}
+		}
+		bufferCapacity = numVertices;
+	});
+}
+
+void AnimatedCurve::Play(const CurveParams& base, const XMFLOAT4& color)
+{
+	const UINT numVertices = CurveVertexCount(base);
+	if (numVertices < 2)
+		return;
+
+	if (numVertices != capacity || base.type != this->base.type)
+	{
+		Resize(numVertices);
+		time = 0.0f;
+	}
+	this->base = base;
+	this->color = color;
+	playing = true;
+}
+
+void AnimatedCurve::Pause()
+{
+	playing = false;
+}
+
+void AnimatedCurve::Stop()
+{
+	playing = false;
+	generating = false;
+	hasFront = false;
+	time = 0.0f;
+	tasks->Push([this]() { drawable = false; });
+}
+
+CurveParams AnimatedCurve::ParamsAt(float time) const
+{
+	CurveParams params = base;
+	if (animateA && !aTrack.IsEmpty())
+		params.a = aTrack.Evaluate(time);
+	if (animateTMax && !tMaxTrack.IsEmpty())
+		params.t_max = tMaxTrack.Evaluate(time);
+	return params;
+}
+
+void AnimatedCurve::BeginGeneration(const CurveParams& params)
+{
+	pending = params;
+	cursor = 0;
+	generating = true;
+	pendingChunks = MakeCurveChunks(capacity, chunkSize);
+}
+
+AnimatedCurve::Slice AnimatedCurve::NewSlice()
+{
+	Slice slice;
+	if (!uploadedSlices.TryPop(slice))
+		slice = std::make_shared<std::vector<VertexCommon>>();
+	return slice;
+}
+
+void AnimatedCurve::Update(float dt, float budgetMs)
+{
+	streamedLastFrame = 0;
+	if (capacity == 0)
+		return;
+
+	rateTime += dt;
+	if (rateTime >= 1.0f)
+	{
+		updatesPerSecond = rateUpdates / rateTime;
+		rateTime = 0.0f;
+		rateUpdates = 0;
+	}
+
+	if (playing)
+		time += dt;
+
+	if (!generating && playing)
+	{
+		const CurveParams target = ParamsAt(time);
+		if (!hasFront || target.a != displayed.a || target.t_max != displayed.t_max)
+			BeginGeneration(target);
+	}
+	if (!generating)
+		return;
+
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point start = Clock::now();
+	const int back = 1 - front;
+	const UINT expected = capacity;
+	do
+	{
+		const UINT first = cursor;
+		const UINT count = std::min(sliceSize, capacity - cursor);
+		Slice slice = NewSlice();
+		slice->resize(count);
+		VertexCommon* vertices = slice->data();
+		ParallelFor(count, 4096, [&](size_t begin, size_t end)
+		{
+			GenerateCurveRange(pending, color, first + static_cast<UINT>(begin), static_cast<UINT>(end - begin), vertices + begin);
+		});
+		ExpandCurveChunks(pendingChunks, vertices, first, count, chunkSize);
+
+		// Slices for buffers that failed to be created are dropped.
+		tasks->Push([this, slice, back, first, expected]()
+		{
+			if (bufferCapacity == expected)
+			{
+				HRESULT hr = models[back].vertices.UploadRange(*uploads, slice->data(), first, static_cast<UINT>(slice->size()));
+				if (FAILED(hr))
+				{
+					ErrorLogger::Log(hr, "Failed to stream animated curve vertices.");
+					drawable = false;
+					bufferCapacity = 0;
+				}
+			}
+			uploadedSlices.Push(slice);
+		});
+		cursor += count;
+		streamedLastFrame += count;
+
+		if (cursor == capacity)
+		{
+			std::shared_ptr<std::vector<CurveChunk>> chunks = std::make_shared<std::vector<CurveChunk>>(std::move(pendingChunks));
+			tasks->Push([this, chunks, back, expected]()
+			{
+				if (bufferCapacity != expected)
+					return;
+				models[back].chunks = std::move(*chunks);
+				drawnFront = back;
+				drawable = true;
+			});
+			front = back;
+			hasFront = true;
+			displayed = pending;
+			generating = false;
+			++rateUpdates;
+			break;
+		}
+	} while (std::chrono::duration<float, std::milli>(Clock::now() - start).count() < budgetMs);
+}
+
+void AnimatedCurve::Draw(DrawCommandBuffer& commands, const XMMATRIX& viewProjection, bool enableSpherical, UINT layer)
+{
+	if (!drawable)
+		return;
+	Model& model = models[drawnFront];
+	model.cb.data.enableSpherical = enableSpherical;
+	model.draw(commands, viewProjection, layer);
+}
+
+bool AnimatedCurve::IsPlaying() const
+{
+	return playing;
+}
+
+bool AnimatedCurve::IsStreaming() const
+{
+	return generating;
+}
+
+bool AnimatedCurve::IsActive() const
+{
+	return hasFront;
+}
+
+CurveType AnimatedCurve::Type() const
+{
+	return base.type;
+}
+
+float AnimatedCurve::Time() const
+{
+	return time;
+}
+
+const CurveParams& AnimatedCurve::DisplayedParams() const
+{
+	return displayed;
+}
+
+const XMFLOAT4& AnimatedCurve::Color() const
+{
+	return color;
+}
+
+unsigned long long AnimatedCurve::ResidentBytes() const
+{
+	return 2ull * capacity * (sizeof(VertexCommon) + sizeof(DWORD));
+}
+
+UINT AnimatedCurve::StreamedLastFrame() const
+{
+	return streamedLastFrame;
+}
+
+float AnimatedCurve::UpdatesPerSecond() const
+{
+	return updatesPerSecond;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "Model.h"
+#include "Curves.h"
+#include "ParameterAnimation.h"
+#include "RenderTaskQueue.h"
+#include <memory>
+#include <vector>
+
+// Curve whose `a` and `t_max` follow keyframed tracks over time.
+// Vertices for the next parameter values are streamed into a back buffer a
+// few slices per frame, within a time budget, and the buffers flip once the
+// back one is complete, so a frame never waits for a full regeneration.
+// Both buffers stay in GPU memory; slices reach them through an UploadRing.
+//
+// Playback and generation run on the update thread, which posts every
+// slice as a render task. The buffers and Draw belong to the render thread.
+class AnimatedCurve
+{
+public:
+	// Vertices are streamed through `uploads` into static buffers.
+	bool Initialize(RenderTaskQueue* tasks, RenderDevice* device, UploadRing* uploads, DeviceVertexShader* vs, DeviceInputLayout* inputLayout, DevicePixelShader* ps);
+
+	void Play(const CurveParams& base, const DirectX::XMFLOAT4& color);
+	void Pause();
+	void Stop();
+
+	// Advances playback by dt seconds and streams pending vertices for at
+	// most budgetMs. At least one slice is streamed per call.
+	void Update(float dt, float budgetMs);
+	// Render thread.
+	void Draw(DrawCommandBuffer& commands, const DirectX::XMMATRIX& viewProjection, bool enableSpherical, UINT layer = 0);
+
+	bool IsPlaying() const;
+	// True while a curve is being streamed, even when paused.
+	bool IsStreaming() const;
+	// True once a complete curve is available for drawing.
+	bool IsActive() const;
+	CurveType Type() const;
+	float Time() const;
+	const CurveParams& DisplayedParams() const;
+	const DirectX::XMFLOAT4& Color() const;
+	UINT StreamedLastFrame() const;
+	// GPU memory the two buffers take, or will once created.
+	unsigned long long ResidentBytes() const;
+	float UpdatesPerSecond() const;
+
+	ParameterTrack aTrack;
+	ParameterTrack tMaxTrack;
+	bool animateA = true;
+	bool animateTMax = false;
+
+private:
+	typedef std::shared_ptr<std::vector<VertexCommon>> Slice;
+
+	void Resize(UINT numVertices);
+	CurveParams ParamsAt(float time) const;
+	void BeginGeneration(const CurveParams& params);
+	Slice NewSlice();
+
+	static const UINT sliceSize = 1 << 16;
+	static const UINT chunkSize = 4096;
+
+	RenderTaskQueue* tasks = nullptr;
+	int front = 0;
+	bool hasFront = false;
+	UINT capacity = 0;
+
+	CurveParams base;
+	DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+	bool playing = false;
+	float time = 0.0f;
+
+	bool generating = false;
+	CurveParams pending;
+	CurveParams displayed;
+	UINT cursor = 0;
+	std::vector<CurveChunk> pendingChunks;
+	// Slices come back once the render thread has uploaded them.
+	SpscQueue<Slice> uploadedSlices;
+
+	UINT streamedLastFrame = 0;
+	float rateTime = 0.0f;
+	UINT rateUpdates = 0;
+	float updatesPerSecond = 0.0f;
+
+	// Render thread.
+	RenderDevice* device = nullptr;
+	UploadRing* uploads = nullptr;
+	Model models[2];
+	int drawnFront = 0;
+	bool drawable = false;
+	UINT bufferCapacity = 0;
+};
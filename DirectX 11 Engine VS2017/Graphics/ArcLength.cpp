@@ -0,0 +1,121 @@
+#include "ArcLength.h"
+#include "CurveChunks.h"
+#include "../Jobs/ParallelFor.h"
+#include <algorithm>
+#include <vector>
+using namespace DirectX;
+
+static const size_t scanBlockSize = 1 << 16;
+
+void ParallelInclusiveScan(double* values, size_t count)
+{
+	const size_t numBlocks = (count + scanBlockSize - 1) / scanBlockSize;
+	std::vector<double> blockOffsets(numBlocks, 0.0);
+
+	// Scan every block on its own, then offset each block by the total of
+	// the blocks before it.
+	ParallelFor(count, scanBlockSize, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin + 1; i < end; ++i)
+			values[i] += values[i - 1];
+		blockOffsets[begin / scanBlockSize] = values[end - 1];
+	});
+
+	double total = 0.0;
+	for (double& offset : blockOffsets)
+	{
+		const double blockTotal = offset;
+		offset = total;
+		total += blockTotal;
+	}
+
+	ParallelFor(count, scanBlockSize, [&](size_t begin, size_t end)
+	{
+		const double offset = blockOffsets[begin / scanBlockSize];
+		if (offset == 0.0)
+			return;
+		for (size_t i = begin; i < end; ++i)
+			values[i] += offset;
+	});
+}
+
+static XMFLOAT3& Position(VertexCommon& vertex)
+{
+	return vertex.pos;
+}
+
+static const XMFLOAT3& Position(const VertexCommon& vertex)
+{
+	return vertex.pos;
+}
+
+static XMFLOAT3& Position(XMFLOAT3& point)
+{
+	return point;
+}
+
+static const XMFLOAT3& Position(const XMFLOAT3& point)
+{
+	return point;
+}
+
+// Everything but the position is taken from the earlier of the two
+// points the sample falls between.
+template<class Point>
+static float Resample(const Point* dense, unsigned int numDense, Point* out, unsigned int numOut)
+{
+	if (numOut == 0)
+		return 0.0f;
+	if (numDense < 2)
+	{
+		std::fill(out, out + numOut, numDense > 0 ? dense[0] : Point());
+		return 0.0f;
+	}
+
+	// cumulative[i] is the arc length from vertex 0 to vertex i.
+	std::vector<double> cumulative(numDense);
+	cumulative[0] = 0.0;
+	ParallelFor(numDense - 1, scanBlockSize, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+			cumulative[i + 1] = SegmentLength(Position(dense[i]), Position(dense[i + 1]));
+	});
+	ParallelInclusiveScan(cumulative.data(), cumulative.size());
+
+	const double total = cumulative.back();
+	const double step = numOut > 1 ? total / (numOut - 1) : 0.0;
+
+	ParallelFor(numOut, 4096, [&](size_t begin, size_t end)
+	{
+		// Targets grow monotonically, so search once per block and walk on.
+		size_t segment = std::upper_bound(cumulative.begin(), cumulative.end(), begin * step) - cumulative.begin();
+		segment = segment > 0 ? segment - 1 : 0;
+		for (size_t k = begin; k < end; ++k)
+		{
+			const double target = k * step;
+			while (segment + 2 < numDense && cumulative[segment + 1] <= target)
+				++segment;
+
+			const XMFLOAT3& p0 = Position(dense[segment]);
+			const XMFLOAT3& p1 = Position(dense[segment + 1]);
+			const double length = cumulative[segment + 1] - cumulative[segment];
+			const float f = length > 0.0 ? static_cast<float>(std::min(1.0, (target - cumulative[segment]) / length)) : 0.0f;
+
+			Point point = dense[segment];
+			Position(point) = XMFLOAT3(p0.x + f * (p1.x - p0.x), p0.y + f * (p1.y - p0.y), p0.z + f * (p1.z - p0.z));
+			out[k] = point;
+		}
+	});
+
+	return static_cast<float>(total);
+}
+
+float ResampleByArcLength(const VertexCommon* dense, unsigned int numDense, VertexCommon* out, unsigned int numOut)
+{
+	return Resample(dense, numDense, out, numOut);
+}
+
+float ResampleByArcLength(const XMFLOAT3* dense, unsigned int numDense, XMFLOAT3* out, unsigned int numOut)
+{
+	return Resample(dense, numDense, out, numOut);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Vertex.h"
+#include <cstddef>
+
+enum class CurveSampling { UNIFORM_PHI, ARC_LENGTH };
+
+// In-place inclusive prefix sum, computed block-wise on all hardware threads.
+void ParallelInclusiveScan(double* values, size_t count);
+
+// Resamples the line strip `dense` at numOut points spaced equally along its
+// arc length and returns the total arc length. Segments touching a
+// non-finite vertex count as zero length.
+float ResampleByArcLength(const VertexCommon* dense, unsigned int numDense, VertexCommon* out, unsigned int numOut);
+// The same for bare positions.
+float ResampleByArcLength(const DirectX::XMFLOAT3* dense, unsigned int numDense, DirectX::XMFLOAT3* out, unsigned int numOut);
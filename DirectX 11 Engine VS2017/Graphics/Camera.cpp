@@ -1,30 +1,22 @@
 #include "Camera.h"
 Camera::Camera()
 {
-	this->pos.m128_f32[0] = 0;
-	this->pos.m128_f32[1] = 0;
-	this->pos.m128_f32[2] = 0;
-	this->pos.m128_f32[3] = 0;
+	this->pos = XMVectorZero();
 	this->rot.x = 0;
 	this->rot.y = 0;
 	this->rot.z = 0;
-	UpdateViewMatrix();
 }
 
 void Camera::SetPosition(float x, float y, float z)
 {
-	this->pos.m128_f32[0] = x;
-	this->pos.m128_f32[1] = y;
-	this->pos.m128_f32[2] = z;
-	this->pos.m128_f32[3] = 0;
-	UpdateViewMatrix();
+	this->pos = XMVectorSet(x, y, z, 0.0f);
+	this->viewDirty = true;
 }
 
 void Camera::AdjustPosition(XMVECTOR posOffset)
 {
-	this->pos += posOffset;
-	this->pos.m128_f32[3] = 0;
-	UpdateViewMatrix();
+	this->pos = XMVectorSetW(XMVectorAdd(this->pos, posOffset), 0.0f);
+	this->viewDirty = true;
 }
 
 void Camera::SetRotation(float xRot, float yRot, float zRot)
@@ -32,7 +24,7 @@ void Camera::SetRotation(float xRot, float yRot, float zRot)
 	this->rot.x = xRot / 180 * 3.14159;
 	this->rot.y = yRot / 180 * 3.14159;
 	this->rot.z = zRot / 180 * 3.14159;
-	UpdateViewMatrix();
+	this->viewDirty = true;
 }
 
 void Camera::AdjustRotation(float xRotOffset, float yRotOffset, float zRotOffset)
@@ -52,7 +44,7 @@ void Camera::AdjustRotation(float xRotOffset, float yRotOffset, float zRotOffset
 		this->rot.y += XM_2PI;
 	else if (this->rot.y > XM_2PI)
 		this->rot.y -= XM_2PI;
-	UpdateViewMatrix();
+	this->viewDirty = true;
 }
 
 XMVECTOR Camera::GetPosition()
@@ -67,40 +59,66 @@ XMFLOAT3 Camera::GetRotation()
 
 const XMMATRIX Camera::GetViewMatrix()
 {
+	if (this->viewDirty)
+		UpdateViewMatrix();
 	return this->viewMatrix;
 }
 
 const XMMATRIX Camera::GetProjectionMatrix()
 {
+	if (this->projectionDirty)
+		UpdateProjectionMatrix();
 	return this->projectionMatrix;
 }
 
+const XMMATRIX Camera::GetViewProjectionMatrix()
+{
+	if (this->viewDirty)
+		UpdateViewMatrix();
+	if (this->projectionDirty)
+		UpdateProjectionMatrix();
+	if (this->viewProjectionDirty)
+	{
+		this->viewProjectionMatrix = XMMatrixMultiply(this->viewMatrix, this->projectionMatrix);
+		this->viewProjectionDirty = false;
+	}
+	return this->viewProjectionMatrix;
+}
+
 void Camera::SetProjectionValues(float FOV, float width, float height, float nearZ, float farZ)
 {
-	this->projectionMatrix = XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(FOV) , (float)width / height, nearZ, farZ);
+	this->fovRadians = DirectX::XMConvertToRadians(FOV);
+	this->aspectRatio = (float)width / height;
+	this->nearZ = nearZ;
+	this->farZ = farZ;
+	this->projectionDirty = true;
 }
 
 const XMVECTOR & Camera::GetForwardVector()
 {
-	this->vec_forward.m128_f32[1] = 0; //set y part of vector to 0
+	if (this->viewDirty)
+		UpdateViewMatrix();
 	return this->vec_forward;
 }
 
 const XMVECTOR & Camera::GetRightVector()
 {
-	this->vec_right.m128_f32[1] = 0; //set y part of vector to 0
+	if (this->viewDirty)
+		UpdateViewMatrix();
 	return this->vec_right;
 }
 
 const XMVECTOR & Camera::GetBackwardVector()
 {
-	this->vec_backward.m128_f32[1] = 0; //set y part of vector to 0
+	if (this->viewDirty)
+		UpdateViewMatrix();
 	return this->vec_backward;
 }
 
 const XMVECTOR & Camera::GetLeftVector()
 {
-	this->vec_left.m128_f32[1] = 0; //set y part of vector to 0
+	if (this->viewDirty)
+		UpdateViewMatrix();
 	return this->vec_left;
 }
 
@@ -112,15 +130,26 @@ void Camera::UpdateViewMatrix() //Updates view matrix and also updates the movem
 	XMVECTOR camTarget = XMVector3TransformCoord(this->DEFAULT_FORWARD_VECTOR, camRotationMatrix);
 	camTarget = XMVector3Normalize(camTarget);
 	//Adjust cam target to be offset by the camera's current position
-	camTarget += this->pos;
+	camTarget = XMVectorAdd(camTarget, this->pos);
 	//Calculate up direction based on current rotation
 	XMVECTOR upDir = XMVector3TransformCoord(this->DEFAULT_UP_VECTOR, camRotationMatrix);
 
 	this->viewMatrix = XMMatrixLookAtLH(this->pos, camTarget, upDir);
 
+	//Movement stays in the horizontal plane: y of the vectors is set to 0
 	XMMATRIX camRotationMatrix2 = XMMatrixRotationRollPitchYaw(0, this->rot.y, this->rot.z);
-	this->vec_forward = XMVector3TransformCoord(this->DEFAULT_FORWARD_VECTOR, camRotationMatrix2);
-	this->vec_backward = XMVector3TransformCoord(this->DEFAULT_BACKWARD_VECTOR, camRotationMatrix2);
-	this->vec_left = XMVector3TransformCoord(this->DEFAULT_LEFT_VECTOR, camRotationMatrix2);
-	this->vec_right = XMVector3TransformCoord(this->DEFAULT_RIGHT_VECTOR, camRotationMatrix2);
+	this->vec_forward = XMVectorSetY(XMVector3TransformCoord(this->DEFAULT_FORWARD_VECTOR, camRotationMatrix2), 0.0f);
+	this->vec_backward = XMVectorSetY(XMVector3TransformCoord(this->DEFAULT_BACKWARD_VECTOR, camRotationMatrix2), 0.0f);
+	this->vec_left = XMVectorSetY(XMVector3TransformCoord(this->DEFAULT_LEFT_VECTOR, camRotationMatrix2), 0.0f);
+	this->vec_right = XMVectorSetY(XMVector3TransformCoord(this->DEFAULT_RIGHT_VECTOR, camRotationMatrix2), 0.0f);
+
+	this->viewDirty = false;
+	this->viewProjectionDirty = true;
+}
+
+void Camera::UpdateProjectionMatrix()
+{
+	this->projectionMatrix = XMMatrixPerspectiveFovLH(this->fovRadians, this->aspectRatio, this->nearZ, this->farZ);
+	this->projectionDirty = false;
+	this->viewProjectionDirty = true;
 }
@@ -3,7 +3,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 #ifndef _CAMERA_H_
 #define _CAMERA_H_
-#include <DirectXMath.h>
+#include "../Math/VectorMath.h"
 using namespace DirectX;
 
 class Camera
@@ -22,17 +22,32 @@ public:
 
 	const XMMATRIX GetViewMatrix();
 	const XMMATRIX GetProjectionMatrix();
+	// GetViewMatrix() * GetProjectionMatrix().
+	const XMMATRIX GetViewProjectionMatrix();
 	void SetProjectionValues(float FOV, float width, float height, float nearZ, float farZ);
 	const XMVECTOR & GetForwardVector();
 	const XMVECTOR & GetRightVector();
 	const XMVECTOR & GetBackwardVector();
 	const XMVECTOR & GetLeftVector();
 private:
+	// The setters only mark what changed; matrices and movement vectors are
+	// rebuilt the first time they are asked for afterwards, so a burst of
+	// mouse moves in one frame costs a single rebuild.
 	void UpdateViewMatrix();
+	void UpdateProjectionMatrix();
 	XMVECTOR pos;
 	XMFLOAT3 rot;
 	XMMATRIX viewMatrix;
 	XMMATRIX projectionMatrix;
+	XMMATRIX viewProjectionMatrix;
+	bool viewDirty = true;
+	bool projectionDirty = true;
+	bool viewProjectionDirty = true;
+
+	float fovRadians = XM_PIDIV2;
+	float aspectRatio = 1.0f;
+	float nearZ = 0.1f;
+	float farZ = 1000.0f;
 
 	const XMVECTOR DEFAULT_FORWARD_VECTOR = { 0, 0, 1 };
 	const XMVECTOR DEFAULT_BACKWARD_VECTOR = { 0, 0, -1 };
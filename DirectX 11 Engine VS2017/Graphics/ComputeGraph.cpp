@@ -0,0 +1,226 @@
+#include "ComputeGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	const ContentHash prime1 = 0x9E3779B185EBCA87ull;
+	const ContentHash prime2 = 0xC2B2AE3D27D4EB4Full;
+
+	ContentHash Round(ContentHash acc, ContentHash input)
+	{
+		acc += input * prime2;
+		acc = (acc << 31) | (acc >> 33);
+		return acc * prime1;
+	}
+
+	// Spreads every bit of x over the whole result.
+	ContentHash Mix(ContentHash x)
+	{
+		x ^= x >> 33;
+		x *= 0xFF51AFD7ED558CCDull;
+		x ^= x >> 33;
+		x *= 0xC4CEB9FE1A85EC53ull;
+		x ^= x >> 33;
+		return x;
+	}
+
+	ContentHash ReadWord(const unsigned char* bytes)
+	{
+		ContentHash word;
+		memcpy(&word, bytes, sizeof(word));
+		return word;
+	}
+}
+
+ContentHash HashBytes(const void* data, size_t size)
+{
+	// Four lanes, so the multiplies of one word don't wait for the last.
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	ContentHash lanes[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		for (int lane = 0; lane < 4; ++lane)
+			lanes[lane] = Round(lanes[lane], ReadWord(bytes + i + 8 * lane));
+	}
+	ContentHash hash = static_cast<ContentHash>(size) * prime1;
+	for (int lane = 0; lane < 4; ++lane)
+		hash = Round(hash, lanes[lane]);
+	for (; i + 8 <= size; i += 8)
+		hash = Round(hash, ReadWord(bytes + i));
+	if (i < size)
+	{
+		ContentHash tail = 0;
+		memcpy(&tail, bytes + i, size - i);
+		hash = Round(hash, tail);
+	}
+	return Mix(hash);
+}
+
+ContentHash CombineHashes(ContentHash seed, ContentHash value)
+{
+	return Mix(Round(seed, value));
+}
+
+const char* NodeStatusName(NodeStatus status)
+{
+	switch (status)
+	{
+	case NodeStatus::IDLE: return "Idle";
+	case NodeStatus::REUSED: return "Reused";
+	case NodeStatus::MEMO_HIT: return "Memo hit";
+	case NodeStatus::COMPUTED: return "Computed";
+	default: return "";
+	}
+}
+
+ComputeGraph::ComputeGraph(size_t memoCapacity) : memoCapacity((std::max)(memoCapacity, size_t(1)))
+{
+}
+
+unsigned int ComputeGraph::Add(Node node)
+{
+	this->nodes.push_back(std::move(node));
+	return static_cast<unsigned int>(this->nodes.size() - 1);
+}
+
+void ComputeGraph::SetValue(unsigned int index, std::shared_ptr<const void> value, ContentHash hash)
+{
+	Node& node = this->nodes[index];
+	node.value = std::move(value);
+	node.hash = hash;
+	++node.computes;
+	Mark(node, NodeStatus::COMPUTED);
+	++this->revision;
+}
+
+void ComputeGraph::Update(unsigned int index)
+{
+	Node& node = this->nodes[index];
+	if (node.verified == this->revision)
+		return;
+	node.verified = this->revision;
+	if (!node.compute)
+	{
+		Mark(node, NodeStatus::REUSED);
+		return;
+	}
+
+	// Inputs first; what this node needs from them is their hashes.
+	ContentHash key = prime2;
+	std::vector<std::shared_ptr<const void>> values(node.inputs.size());
+	std::vector<ContentHash> hashes(node.inputs.size());
+	for (size_t i = 0; i < node.inputs.size(); ++i)
+	{
+		this->Update(node.inputs[i]);
+		const Node& input = this->nodes[node.inputs[i]];
+		key = CombineHashes(key, input.hash);
+		values[i] = input.value;
+		hashes[i] = input.hash;
+	}
+	if (node.value && key == node.key)
+	{
+		Mark(node, NodeStatus::REUSED);
+		return;
+	}
+
+	for (size_t i = 0; i < node.memo.size(); ++i)
+	{
+		if (node.memo[i].key != key)
+			continue;
+		std::rotate(node.memo.begin(), node.memo.begin() + i, node.memo.begin() + i + 1);
+		node.value = node.memo.front().value;
+		node.hash = node.memo.front().hash;
+		node.key = key;
+		++node.memoHits;
+		Mark(node, NodeStatus::MEMO_HIT);
+		return;
+	}
+
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point start = Clock::now();
+	node.value = node.compute(values.data(), hashes.data(), node.hash);
+	node.lastMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	node.key = key;
+	++node.computes;
+	Mark(node, NodeStatus::COMPUTED);
+	this->Remember(node);
+}
+
+void ComputeGraph::Remember(Node& node)
+{
+	Memo memo;
+	memo.key = node.key;
+	memo.hash = node.hash;
+	memo.value = node.value;
+	node.memo.insert(node.memo.begin(), std::move(memo));
+	if (node.memo.size() > this->memoCapacity)
+		node.memo.resize(this->memoCapacity);
+}
+
+void ComputeGraph::Mark(Node& node, NodeStatus status)
+{
+	if (static_cast<int>(status) > static_cast<int>(node.status))
+		node.status = status;
+}
+
+void ComputeGraph::BeginPass()
+{
+	for (Node& node : this->nodes)
+		node.status = NodeStatus::IDLE;
+}
+
+void ComputeGraph::Report(std::vector<NodeReport>& out) const
+{
+	out.resize(this->nodes.size());
+	for (size_t i = 0; i < this->nodes.size(); ++i)
+	{
+		const Node& node = this->nodes[i];
+		NodeReport& report = out[i];
+		report.name = node.name;
+		report.input = !node.compute;
+		report.status = node.status;
+		report.lastMs = node.lastMs;
+		report.computes = node.computes;
+		report.memoHits = node.memoHits;
+		report.hash = node.hash;
+	}
+}
+
+size_t ComputeGraph::NodeCount() const
+{
+	return this->nodes.size();
+}
+
+void ComputeGraphHistory::BeginFrame()
+{
+	for (Row& row : this->rows)
+	{
+		row.computed <<= 1;
+		row.memoHits <<= 1;
+	}
+}
+
+void ComputeGraphHistory::Record(const std::vector<NodeReport>& nodes)
+{
+	if (this->rows.size() < nodes.size())
+		this->rows.resize(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		Row& row = this->rows[i];
+		row.name = nodes[i].name;
+		row.input = nodes[i].input;
+		row.last = nodes[i];
+		if (nodes[i].status == NodeStatus::COMPUTED)
+			row.computed |= 1;
+		else if (nodes[i].status == NodeStatus::MEMO_HIT)
+			row.memoHits |= 1;
+	}
+}
+
+const std::vector<ComputeGraphHistory::Row>& ComputeGraphHistory::Rows() const
+{
+	return this->rows;
+}
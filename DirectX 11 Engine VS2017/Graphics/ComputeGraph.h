@@ -0,0 +1,247 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+typedef std::uint64_t ContentHash;
+
+ContentHash HashBytes(const void* data, size_t size);
+ContentHash CombineHashes(ContentHash seed, ContentHash value);
+
+// Hashes the bytes of the value, so types with padding between their
+// members need an overload of their own.
+template<class T>
+ContentHash HashContent(const T& value)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "hash the members of this type instead");
+	return HashBytes(&value, sizeof(T));
+}
+
+template<class T>
+ContentHash HashContent(const std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "hash the members of this type instead");
+	return HashBytes(values.data(), values.size() * sizeof(T));
+}
+
+enum class NodeStatus
+{
+	// Not asked for since BeginPass.
+	IDLE,
+	// Its inputs hadn't changed, or for inputs, the value set was the same.
+	REUSED,
+	// Its inputs had changed to values it had already been computed from.
+	MEMO_HIT,
+	// Computed, or for inputs, set to a new value.
+	COMPUTED,
+	COUNT
+};
+
+const char* NodeStatusName(NodeStatus status);
+
+struct NodeReport
+{
+	std::string name;
+	bool input = false;
+	// What happened to the node in the last pass.
+	NodeStatus status = NodeStatus::IDLE;
+	float lastMs = 0.0f;
+	unsigned int computes = 0;
+	unsigned int memoHits = 0;
+	ContentHash hash = 0;
+};
+
+// Typed name of a node in a ComputeGraph.
+template<class T>
+struct GraphNode
+{
+	unsigned int index = 0;
+};
+
+// Values derived from each other, each a node with declared inputs.
+// Evaluation is lazy: Get brings a node, and only the nodes it depends
+// on, up to date, and a node is only computed again when the content of
+// one of its inputs has changed since. Every value is hashed when it is
+// set or computed; a node whose result hashes the same as before leaves
+// the nodes downstream of it alone. Each node also keeps its last few
+// values by the hashes of the inputs they were computed from, so going
+// back to earlier inputs costs a lookup.
+//
+// Values are shared and never changed once made; what Get returns stays
+// valid after the graph has moved on. The graph itself isn't thread-safe.
+class ComputeGraph
+{
+public:
+	// Values each node keeps, the current one included.
+	explicit ComputeGraph(size_t memoCapacity = 2);
+
+	template<class T>
+	GraphNode<T> AddInput(const std::string& name, const T& value)
+	{
+		Node node;
+		node.name = name;
+		node.value = std::make_shared<const T>(value);
+		node.hash = HashContent(value);
+		GraphNode<T> handle;
+		handle.index = this->Add(std::move(node));
+		return handle;
+	}
+
+	// compute(const Inputs&...) returns the node's value.
+	template<class T, class Func, class... Inputs>
+	GraphNode<T> AddNode(const std::string& name, Func compute, GraphNode<Inputs>... inputs)
+	{
+		Node node;
+		node.name = name;
+		node.inputs = { inputs.index... };
+		node.compute = [compute](const std::shared_ptr<const void>* values, const ContentHash*, ContentHash& hash) -> std::shared_ptr<const void>
+		{
+			std::shared_ptr<const T> value = std::make_shared<const T>(Call<Inputs...>(compute, values, std::index_sequence_for<Inputs...>()));
+			hash = HashContent(*value);
+			return value;
+		};
+		GraphNode<T> handle;
+		handle.index = this->Add(std::move(node));
+		return handle;
+	}
+
+	// compute(const std::shared_ptr<const Inputs>&...) returns the node's
+	// value as a std::shared_ptr<const T>, which may be one of its inputs:
+	// a node that passes an input on shares it, and its hash, instead of
+	// copying and hashing it again.
+	template<class T, class Func, class... Inputs>
+	GraphNode<T> AddSharedNode(const std::string& name, Func compute, GraphNode<Inputs>... inputs)
+	{
+		Node node;
+		node.name = name;
+		node.inputs = { inputs.index... };
+		node.compute = [compute](const std::shared_ptr<const void>* values, const ContentHash* hashes, ContentHash& hash) -> std::shared_ptr<const void>
+		{
+			std::shared_ptr<const T> value = CallShared<Inputs...>(compute, values, std::index_sequence_for<Inputs...>());
+			for (size_t i = 0; i < sizeof...(Inputs); ++i)
+			{
+				if (values[i].get() == value.get())
+				{
+					hash = hashes[i];
+					return value;
+				}
+			}
+			hash = HashContent(*value);
+			return value;
+		};
+		GraphNode<T> handle;
+		handle.index = this->Add(std::move(node));
+		return handle;
+	}
+
+	template<class T>
+	void Set(GraphNode<T> input, const T& value)
+	{
+		const ContentHash hash = HashContent(value);
+		if (hash != this->nodes[input.index].hash)
+			this->SetValue(input.index, std::make_shared<const T>(value), hash);
+		else
+			this->Mark(this->nodes[input.index], NodeStatus::REUSED);
+	}
+
+	template<class T>
+	std::shared_ptr<const T> Get(GraphNode<T> node)
+	{
+		this->Update(node.index);
+		return std::static_pointer_cast<const T>(this->nodes[node.index].value);
+	}
+
+	// Starts a new pass: every node's status goes back to IDLE.
+	void BeginPass();
+	// Every node in the order they were added.
+	void Report(std::vector<NodeReport>& out) const;
+	size_t NodeCount() const;
+
+private:
+	typedef std::function<std::shared_ptr<const void>(const std::shared_ptr<const void>* values, const ContentHash* hashes, ContentHash& hash)> Compute;
+
+	struct Memo
+	{
+		// Combined hashes of the inputs the value was computed from.
+		ContentHash key = 0;
+		ContentHash hash = 0;
+		std::shared_ptr<const void> value;
+	};
+
+	struct Node
+	{
+		std::string name;
+		std::vector<unsigned int> inputs;
+		// Null for inputs.
+		Compute compute;
+
+		std::shared_ptr<const void> value;
+		ContentHash hash = 0;
+		ContentHash key = 0;
+		// The revision the node was last brought up to date in.
+		unsigned long long verified = 0;
+		// Most recently used first.
+		std::vector<Memo> memo;
+
+		NodeStatus status = NodeStatus::IDLE;
+		float lastMs = 0.0f;
+		unsigned int computes = 0;
+		unsigned int memoHits = 0;
+	};
+
+	template<class... Inputs, class Func, size_t... I>
+	static auto Call(const Func& compute, const std::shared_ptr<const void>* values, std::index_sequence<I...>)
+	{
+		return compute(*static_cast<const Inputs*>(values[I].get())...);
+	}
+
+	template<class... Inputs, class Func, size_t... I>
+	static auto CallShared(const Func& compute, const std::shared_ptr<const void>* values, std::index_sequence<I...>)
+	{
+		return compute(std::static_pointer_cast<const Inputs>(values[I])...);
+	}
+
+	unsigned int Add(Node node);
+	void SetValue(unsigned int index, std::shared_ptr<const void> value, ContentHash hash);
+	void Update(unsigned int index);
+	void Remember(Node& node);
+	static void Mark(Node& node, NodeStatus status);
+
+	ComputeGraph(const ComputeGraph& rhs);
+	ComputeGraph& operator=(const ComputeGraph& rhs);
+
+	std::vector<Node> nodes;
+	size_t memoCapacity;
+	// Counts up whenever an input changes.
+	unsigned long long revision = 1;
+};
+
+// What the nodes of one or more graphs with the same nodes did in each of
+// the last 64 frames, for showing which of them recompute when.
+class ComputeGraphHistory
+{
+public:
+	struct Row
+	{
+		std::string name;
+		bool input = false;
+		// Bit 0 is the current frame, bit 1 the one before and so on.
+		std::uint64_t computed = 0;
+		std::uint64_t memoHits = 0;
+		// The node in the last pass recorded.
+		NodeReport last;
+	};
+
+	void BeginFrame();
+	// Reports of a pass, e.g. ComputeGraph::Report after it.
+	void Record(const std::vector<NodeReport>& nodes);
+	const std::vector<Row>& Rows() const;
+
+private:
+	std::vector<Row> rows;
+};
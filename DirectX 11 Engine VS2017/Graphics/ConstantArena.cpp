@@ -0,0 +1,135 @@
+#include "ConstantArena.h"
+#include "../ErrorLogger.h"
+#include <algorithm>
+#include <cstring>
+
+void LinearAllocator::Reset(UINT capacity)
+{
+	this->capacity = capacity;
+	this->used = 0;
+}
+
+void LinearAllocator::Reset()
+{
+	this->used = 0;
+}
+
+UINT LinearAllocator::Allocate(UINT size, UINT alignment)
+{
+	const UINT offset = (this->used + alignment - 1) & ~(alignment - 1);
+	if (offset < this->used || offset > this->capacity || size > this->capacity - offset)
+		return invalidOffset;
+	this->used = offset + size;
+	return offset;
+}
+
+UINT LinearAllocator::Used() const
+{
+	return this->used;
+}
+
+UINT LinearAllocator::Capacity() const
+{
+	return this->capacity;
+}
+
+ConstantArena::~ConstantArena()
+{
+	Close();
+	if (device)
+		device->ReleaseBuffer(buffer);
+}
+
+HRESULT ConstantArena::CreateBuffer(UINT byteWidth)
+{
+	Close();
+	if (device)
+		device->ReleaseBuffer(buffer);
+	buffer = nullptr;
+	allocator.Reset(0);
+
+	BufferDesc desc;
+	desc.type = BufferType::CONSTANT;
+	desc.byteWidth = byteWidth;
+	desc.dynamic = true;
+
+	HRESULT hr = device->CreateBuffer(desc, nullptr, &buffer);
+	if (SUCCEEDED(hr))
+		allocator.Reset(byteWidth);
+	return hr;
+}
+
+HRESULT ConstantArena::Initialize(RenderDevice* device, UINT byteWidth)
+{
+	this->device = device;
+	this->requestedBytes = 0;
+	return CreateBuffer((byteWidth + blockAlignment - 1) / blockAlignment * blockAlignment);
+}
+
+void ConstantArena::BeginFrame()
+{
+	Close();
+	lastFrameBytes = allocator.Used();
+
+	if (device && requestedBytes > allocator.Capacity() && allocator.Capacity() < maxByteWidth)
+	{
+		UINT byteWidth = (std::max)(allocator.Capacity(), blockAlignment);
+		while (byteWidth < requestedBytes && byteWidth < maxByteWidth)
+			byteWidth *= 2;
+		HRESULT hr = CreateBuffer(byteWidth);
+		if (FAILED(hr))
+			ErrorLogger::Log(hr, "Failed to grow constant arena.");
+	}
+
+	allocator.Reset();
+	requestedBytes = 0;
+}
+
+bool ConstantArena::Write(const void* data, UINT size, ConstantRange& range)
+{
+	if (!buffer || !device->SupportsConstantBufferOffsets())
+		return false;
+
+	const UINT blockSize = (size + blockAlignment - 1) / blockAlignment * blockAlignment;
+	requestedBytes += blockSize;
+	const UINT offset = allocator.Allocate(blockSize, blockAlignment);
+	if (offset == LinearAllocator::invalidOffset)
+		return false;
+
+	if (!mapped)
+	{
+		void* memory = nullptr;
+		HRESULT hr = device->Map(buffer, MapMode::WRITE_DISCARD, &memory);
+		if (FAILED(hr))
+		{
+			ErrorLogger::Log(hr, "Failed to map constant arena.");
+			allocator.Reset();
+			return false;
+		}
+		mapped = static_cast<std::uint8_t*>(memory);
+	}
+
+	memcpy(mapped + offset, data, size);
+	range.buffer = buffer;
+	range.firstConstant = offset / 16;
+	range.numConstants = blockSize / 16;
+	return true;
+}
+
+void ConstantArena::Close()
+{
+	if (!mapped)
+		return;
+	device->Unmap(buffer, allocator.Used());
+	mapped = nullptr;
+}
+
+UINT ConstantArena::LastFrameBytes() const
+{
+	return lastFrameBytes;
+}
+
+UINT ConstantArena::CapacityBytes() const
+{
+	return allocator.Capacity();
+}
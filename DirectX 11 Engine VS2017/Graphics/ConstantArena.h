@@ -0,0 +1,76 @@
+#pragma once
+#include "RenderDevice.h"
+#include <cstdint>
+
+// Hands out aligned ranges of a fixed capacity front to back. Reset frees
+// all of them at once.
+class LinearAllocator
+{
+public:
+	static const UINT invalidOffset = 0xFFFFFFFF;
+
+	void Reset(UINT capacity);
+	void Reset();
+	// alignment must be a power of two. Returns invalidOffset when the
+	// range doesn't fit.
+	UINT Allocate(UINT size, UINT alignment);
+
+	UINT Used() const;
+	UINT Capacity() const;
+
+private:
+	UINT capacity = 0;
+	UINT used = 0;
+};
+
+// Constants of one draw inside the arena, in 16-byte shader constants as
+// taken by RenderDevice::SetVSConstantBufferRange.
+struct ConstantRange
+{
+	DeviceBuffer* buffer = nullptr;
+	UINT firstConstant = 0;
+	UINT numConstants = 0;
+};
+
+// One dynamic constant buffer shared by all draws of a frame. The first
+// Write of a frame maps it with WRITE_DISCARD, later writes go behind the
+// previous ones and Close unmaps it once before the draws are submitted,
+// so a frame costs one map however many draws it has.
+//
+// When a frame asks for more than the buffer holds, the writes that don't
+// fit fail and the buffer grows at the next BeginFrame. Writes also fail on
+// devices without constant buffer offsets; callers then fall back to a
+// constant buffer of their own.
+class ConstantArena
+{
+public:
+	// Offsets and sizes of bound ranges are multiples of 16 constants.
+	static const UINT blockAlignment = 256;
+	static const UINT maxByteWidth = 16 * 1024 * 1024;
+
+	ConstantArena() {}
+	~ConstantArena();
+
+	HRESULT Initialize(RenderDevice* device, UINT byteWidth);
+	void BeginFrame();
+	bool Write(const void* data, UINT size, ConstantRange& range);
+	void Close();
+
+	// Bytes written during the frame before the current one.
+	UINT LastFrameBytes() const;
+	UINT CapacityBytes() const;
+
+private:
+	ConstantArena(const ConstantArena& rhs);
+	ConstantArena& operator=(const ConstantArena& rhs);
+
+	HRESULT CreateBuffer(UINT byteWidth);
+
+	RenderDevice* device = nullptr;
+	DeviceBuffer* buffer = nullptr;
+	LinearAllocator allocator;
+	std::uint8_t* mapped = nullptr;
+	// Everything asked for this frame, including writes that didn't fit.
+	UINT requestedBytes = 0;
+	UINT lastFrameBytes = 0;
+};
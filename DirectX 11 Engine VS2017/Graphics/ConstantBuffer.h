@@ -1,66 +1,70 @@
 #ifndef ConstantBuffer_h__
 #define ConstantBuffer_h__
-#include <d3d11.h>
+#include "RenderDevice.h"
 #include "ConstantBufferTypes.h"
-#include <wrl/client.h>
-#include "..\\ErrorLogger.h"
+#include "../ErrorLogger.h"
+#include <cstring>
 
 template<class T>
 class ConstantBuffer
 {
 private:
 	ConstantBuffer(const ConstantBuffer<T>& rhs);
+	ConstantBuffer& operator=(const ConstantBuffer<T>& rhs);
 
 private:
-
-	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
-	ID3D11DeviceContext * deviceContext = nullptr;
+	RenderDevice* device = nullptr;
+	DeviceBuffer* buffer = nullptr;
 
 public:
 	ConstantBuffer() {}
 
-	T data;
+	~ConstantBuffer()
+	{
+		Release();
+	}
 
-	ID3D11Buffer* Get()const
+	void Release()
 	{
-		return buffer.Get();
+		if (device)
+			device->ReleaseBuffer(buffer);
+		buffer = nullptr;
 	}
 
-	ID3D11Buffer* const* GetAddressOf()const
+	T data;
+
+	DeviceBuffer* Get()const
 	{
-		return buffer.GetAddressOf();
+		return buffer;
 	}
 
-	HRESULT Initialize(ID3D11Device *device, ID3D11DeviceContext * deviceContext)
+	HRESULT Initialize(RenderDevice* device)
 	{
-		buffer.Reset();
-		this->deviceContext = deviceContext;
+		Release();
+		this->device = device;
 
-		D3D11_BUFFER_DESC desc;
-		desc.Usage = D3D11_USAGE_DYNAMIC;
-		desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		desc.MiscFlags = 0;
-		desc.ByteWidth = static_cast<UINT>(sizeof(T) + (16 - (sizeof(T) % 16)));
-		desc.StructureByteStride = 0;
+		BufferDesc desc;
+		desc.type = BufferType::CONSTANT;
+		desc.byteWidth = static_cast<UINT>(sizeof(T) + (16 - (sizeof(T) % 16)));
+		desc.dynamic = true;
 
-		HRESULT hr = device->CreateBuffer(&desc, 0, buffer.GetAddressOf());
+		HRESULT hr = device->CreateBuffer(desc, nullptr, &this->buffer);
 		return hr;
 	}
 
 	bool ApplyChanges()
 	{
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		HRESULT hr = this->deviceContext->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		void* mapped = nullptr;
+		HRESULT hr = device->Map(buffer, MapMode::WRITE_DISCARD, &mapped);
 		if (FAILED(hr))
 		{
 			ErrorLogger::Log(hr, "Failed to map constant buffer.");
 			return false;
 		}
-		CopyMemory(mappedResource.pData, &data, sizeof(T));
-		this->deviceContext->Unmap(buffer.Get(), 0);
+		memcpy(mapped, &data, sizeof(T));
+		device->Unmap(buffer, sizeof(T));
 		return true;
 	}
 };
 
-#endif // ConstantBuffer_h__
\ No newline at end of file
+#endif // ConstantBuffer_h__
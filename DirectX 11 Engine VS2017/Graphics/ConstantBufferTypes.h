@@ -1,8 +1,9 @@
 #pragma once
-#include <DirectXMath.h>
+#include "../Math/VectorMath.h"
+#include <cstdint>
 
 struct CB_VS_vertexshader
 {
 	DirectX::XMMATRIX wvp;
 	std::uint32_t enableSpherical = 0;
-};
\ No newline at end of file
+};
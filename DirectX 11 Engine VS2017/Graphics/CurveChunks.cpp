@@ -0,0 +1,75 @@
+#include "CurveChunks.h"
+#include <algorithm>
+#include <cmath>
+
+std::vector<CurveChunk> BuildCurveChunks(const DirectX::XMFLOAT3* points, unsigned int numPoints, unsigned int chunkSize)
+{
+	std::vector<CurveChunk> chunks = MakeCurveChunks(numPoints, chunkSize);
+	for (CurveChunk& chunk : chunks)
+	{
+		const DirectX::XMFLOAT3* first = points + chunk.firstIndex;
+		double length = 0.0;
+		chunk.bounds.Expand(first[0]);
+		for (unsigned int i = 1; i < chunk.indexCount; ++i)
+		{
+			chunk.bounds.Expand(first[i]);
+			length += SegmentLength(first[i - 1], first[i]);
+		}
+		chunk.length = static_cast<float>(length);
+	}
+	return chunks;
+}
+
+float SegmentLength(const DirectX::XMFLOAT3& p0, const DirectX::XMFLOAT3& p1)
+{
+	const float dx = p1.x - p0.x;
+	const float dy = p1.y - p0.y;
+	const float dz = p1.z - p0.z;
+	const float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+	return std::isfinite(length) ? length : 0.0f;
+}
+
+float ChunkedCurveLength(const std::vector<CurveChunk>& chunks)
+{
+	double length = 0.0;
+	for (const CurveChunk& chunk : chunks)
+		length += chunk.length;
+	return static_cast<float>(length);
+}
+
+std::vector<CurveChunk> MakeCurveChunks(unsigned int numVertices, unsigned int chunkSize)
+{
+	std::vector<CurveChunk> chunks;
+	if (numVertices < 2 || chunkSize == 0)
+		return chunks;
+
+	const unsigned int numSegments = numVertices - 1;
+	chunks.reserve((numSegments + chunkSize - 1) / chunkSize);
+
+	for (unsigned int first = 0; first < numSegments; first += chunkSize)
+	{
+		CurveChunk chunk;
+		chunk.firstIndex = first;
+		chunk.indexCount = std::min(chunkSize, numSegments - first) + 1;
+		chunks.push_back(chunk);
+	}
+	return chunks;
+}
+
+void ExpandCurveChunks(std::vector<CurveChunk>& chunks, const VertexCommon* vertices, unsigned int first, unsigned int count, unsigned int chunkSize)
+{
+	if (chunks.empty() || chunkSize == 0)
+		return;
+
+	const unsigned int numChunks = static_cast<unsigned int>(chunks.size());
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const unsigned int index = first + i;
+		const unsigned int chunk = index / chunkSize;
+		if (chunk < numChunks)
+			chunks[chunk].bounds.Expand(vertices[i].pos);
+		// Boundary vertex is also the last one of the previous chunk.
+		if (index % chunkSize == 0 && chunk > 0)
+			chunks[chunk - 1].bounds.Expand(vertices[i].pos);
+	}
+}
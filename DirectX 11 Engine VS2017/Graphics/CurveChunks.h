@@ -0,0 +1,34 @@
+#pragma once
+#include "Frustum.h"
+#include "Vertex.h"
+#include <vector>
+
+// Fixed-size slice of a curve's index range with its precomputed bounds.
+struct CurveChunk
+{
+	unsigned int firstIndex = 0;
+	unsigned int indexCount = 0;
+	AABB bounds;
+	// Arc length of the chunk's segments. Left at 0 by ExpandCurveChunks.
+	float length = 0.0f;
+};
+
+// Length of a segment, or 0 if either end is not finite (e.g. the
+// lemniscate where cos(2*phi) < 0).
+float SegmentLength(const DirectX::XMFLOAT3& p0, const DirectX::XMFLOAT3& p1);
+
+// Sum of the chunk lengths, i.e. the arc length of the chunked curve.
+float ChunkedCurveLength(const std::vector<CurveChunk>& chunks);
+
+// Splits a line strip of numPoints into chunks of chunkSize segments.
+// Consecutive chunks share their boundary vertex so no segment is lost
+// when only some of them are drawn.
+std::vector<CurveChunk> BuildCurveChunks(const DirectX::XMFLOAT3* points, unsigned int numPoints, unsigned int chunkSize);
+
+// Same ranges as BuildCurveChunks but with empty bounds, for curves whose
+// vertices arrive piece by piece through ExpandCurveChunks.
+std::vector<CurveChunk> MakeCurveChunks(unsigned int numVertices, unsigned int chunkSize);
+
+// Grows the bounds of every chunk touched by vertices [first, first + count).
+// `vertices` points at vertex `first`, not at the start of the curve.
+void ExpandCurveChunks(std::vector<CurveChunk>& chunks, const VertexCommon* vertices, unsigned int first, unsigned int count, unsigned int chunkSize);
@@ -0,0 +1,78 @@
+#include "CurveFamily.h"
+#include "../Jobs/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+using namespace DirectX;
+
+XMFLOAT4 SamplePalette(Palette palette, float t)
+{
+	static const XMFLOAT4 rainbow[] = { { 0.5f, 0.0f, 1.0f, 1.0f }, { 0.0f, 0.3f, 1.0f, 1.0f }, { 0.0f, 1.0f, 0.5f, 1.0f }, { 1.0f, 1.0f, 0.0f, 1.0f }, { 1.0f, 0.2f, 0.0f, 1.0f } };
+	static const XMFLOAT4 heat[] = { { 0.2f, 0.0f, 0.0f, 1.0f }, { 0.9f, 0.1f, 0.0f, 1.0f }, { 1.0f, 0.8f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+	static const XMFLOAT4 grayscale[] = { { 0.2f, 0.2f, 0.2f, 1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+
+	const XMFLOAT4* colors = rainbow;
+	size_t numColors = sizeof(rainbow) / sizeof(rainbow[0]);
+	switch (palette)
+	{
+	case Palette::HEAT: colors = heat; numColors = sizeof(heat) / sizeof(heat[0]); break;
+	case Palette::GRAYSCALE: colors = grayscale; numColors = sizeof(grayscale) / sizeof(grayscale[0]); break;
+	default: break;
+	}
+
+	t = std::min(std::max(t, 0.0f), 1.0f) * (numColors - 1);
+	const size_t i = std::min(static_cast<size_t>(t), numColors - 2);
+	const float f = t - i;
+	const XMFLOAT4& c0 = colors[i];
+	const XMFLOAT4& c1 = colors[i + 1];
+	return XMFLOAT4(c0.x + f * (c1.x - c0.x), c0.y + f * (c1.y - c0.y), c0.z + f * (c1.z - c0.z), c0.w + f * (c1.w - c0.w));
+}
+
+unsigned int CurveFamilyMemberCount(const CurveFamilyDesc& desc)
+{
+	if (desc.aStep <= 0.0f || desc.aMax < desc.aMin)
+		return 0;
+	return static_cast<unsigned int>(std::floor((desc.aMax - desc.aMin) / desc.aStep + 1e-4f)) + 1;
+}
+
+void GenerateCurveFamily(const CurveFamilyDesc& desc, const std::function<void(const CurveFamilyBatch&)>& onBatch)
+{
+	const unsigned int numMembers = CurveFamilyMemberCount(desc);
+	CurveParams base = desc.base;
+	base.t_num = std::min(base.t_num, desc.maxBatchVertices);
+	const unsigned int verticesPerMember = CurveVertexCount(base);
+	if (numMembers == 0 || verticesPerMember == 0)
+		return;
+
+	const unsigned int membersPerBatch = std::max(1u, desc.maxBatchVertices / verticesPerMember);
+	const float paletteScale = numMembers > 1 ? 1.0f / (numMembers - 1) : 0.0f;
+
+	CurveFamilyBatch batch;
+	batch.verticesPerMember = verticesPerMember;
+	for (unsigned int firstMember = 0; firstMember < numMembers; firstMember += membersPerBatch)
+	{
+		batch.firstMember = firstMember;
+		batch.memberCount = std::min(membersPerBatch, numMembers - firstMember);
+		batch.vertices.resize(static_cast<size_t>(batch.memberCount) * verticesPerMember);
+
+		// Blocks run across member boundaries so few large members still
+		// spread over every thread.
+		ParallelFor(batch.vertices.size(), 1 << 14, [&](size_t begin, size_t end)
+		{
+			while (begin < end)
+			{
+				const unsigned int local = static_cast<unsigned int>(begin / verticesPerMember);
+				const unsigned int member = firstMember + local;
+				const unsigned int first = static_cast<unsigned int>(begin - static_cast<size_t>(local) * verticesPerMember);
+				const unsigned int count = static_cast<unsigned int>(std::min<size_t>(end - begin, verticesPerMember - first));
+
+				CurveParams params = base;
+				params.a = desc.aMin + member * desc.aStep;
+				const XMFLOAT4 color = SamplePalette(desc.palette, member * paletteScale);
+				GenerateCurveRange(params, color, first, count, &batch.vertices[begin]);
+				begin += count;
+			}
+		});
+
+		onBatch(batch);
+	}
+}
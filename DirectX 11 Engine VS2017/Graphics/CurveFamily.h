@@ -0,0 +1,38 @@
+#pragma once
+#include "Curves.h"
+#include <functional>
+#include <vector>
+
+enum class Palette { RAINBOW, HEAT, GRAYSCALE };
+
+// Color at t in [0, 1] of a piecewise linear palette.
+DirectX::XMFLOAT4 SamplePalette(Palette palette, float t);
+
+// Family of curves sharing `base` with `a` swept over [aMin, aMax].
+struct CurveFamilyDesc
+{
+	CurveParams base;
+	float aMin = 0.1f;
+	float aMax = 3.0f;
+	float aStep = 0.01f;
+	Palette palette = Palette::RAINBOW;
+	// Upper bound of vertices per batch, keeps each vertex buffer under the
+	// 128 MB every D3D11 device has to support.
+	unsigned int maxBatchVertices = (128u << 20) / sizeof(VertexCommon);
+};
+
+// Members packed back to back into one vertex array. Member i occupies
+// [i * verticesPerMember, (i + 1) * verticesPerMember).
+struct CurveFamilyBatch
+{
+	std::vector<VertexCommon> vertices;
+	unsigned int firstMember = 0;
+	unsigned int memberCount = 0;
+	unsigned int verticesPerMember = 0;
+};
+
+unsigned int CurveFamilyMemberCount(const CurveFamilyDesc& desc);
+
+// Generates every member of the family in parallel, one batch at a time.
+// The same batch storage is reused for each call of onBatch.
+void GenerateCurveFamily(const CurveFamilyDesc& desc, const std::function<void(const CurveFamilyBatch&)>& onBatch);
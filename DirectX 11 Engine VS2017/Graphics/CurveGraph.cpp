@@ -0,0 +1,175 @@
+#include "CurveGraph.h"
+#include "../Jobs/ParallelFor.h"
+#include <cmath>
+#include <utility>
+using namespace DirectX;
+
+namespace
+{
+	const size_t lengthGrain = 1 << 16;
+
+	bool IsFinite(const XMFLOAT3& p)
+	{
+		return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+	}
+
+	// Squared distance from p to the segment from a to b.
+	float DistanceSquared(const XMFLOAT3& p, const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		const float abx = b.x - a.x, aby = b.y - a.y, abz = b.z - a.z;
+		const float apx = p.x - a.x, apy = p.y - a.y, apz = p.z - a.z;
+		const float lengthSquared = abx * abx + aby * aby + abz * abz;
+		float t = lengthSquared > 0.0f ? (apx * abx + apy * aby + apz * abz) / lengthSquared : 0.0f;
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		const float dx = apx - t * abx, dy = apy - t * aby, dz = apz - t * abz;
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	std::vector<XMFLOAT3> DensePoints(const CurveParams& params)
+	{
+		std::vector<XMFLOAT3> points(CurveVertexCount(params));
+		GenerateCurvePoints(params, std::span<XMFLOAT3>(points.data(), points.size()));
+		return points;
+	}
+
+	typedef std::shared_ptr<const std::vector<XMFLOAT3>> SharedPoints;
+
+	// The dense points themselves unless the curve is resampled.
+	SharedPoints SampledPoints(const SharedPoints& dense, const std::shared_ptr<const CurveSamplingDesc>& sampling)
+	{
+		if (sampling->sampling != CurveSampling::ARC_LENGTH)
+			return dense;
+		std::shared_ptr<std::vector<XMFLOAT3>> points = std::make_shared<std::vector<XMFLOAT3>>((std::min)(static_cast<size_t>(sampling->vertices), dense->size()));
+		ResampleByArcLength(dense->data(), static_cast<unsigned int>(dense->size()), points->data(), static_cast<unsigned int>(points->size()));
+		return points;
+	}
+
+	// The points themselves when there is nothing to drop.
+	SharedPoints Simplified(const SharedPoints& points, const std::shared_ptr<const float>& tolerance)
+	{
+		if (*tolerance <= 0.0f || points->size() < 3)
+			return points;
+		return std::make_shared<const std::vector<XMFLOAT3>>(SimplifyPolyline(*points, *tolerance));
+	}
+
+	float ArcLength(const std::vector<XMFLOAT3>& points)
+	{
+		if (points.size() < 2)
+			return 0.0f;
+		std::vector<double> blocks((points.size() - 1 + lengthGrain - 1) / lengthGrain);
+		ParallelFor(points.size() - 1, lengthGrain, [&](size_t begin, size_t end)
+		{
+			double length = 0.0;
+			for (size_t i = begin; i < end; ++i)
+				length += SegmentLength(points[i], points[i + 1]);
+			blocks[begin / lengthGrain] = length;
+		});
+		double length = 0.0;
+		for (double block : blocks)
+			length += block;
+		return static_cast<float>(length);
+	}
+
+	AABB Bounds(const std::vector<CurveChunk>& chunks)
+	{
+		AABB bounds;
+		for (const CurveChunk& chunk : chunks)
+		{
+			if (chunk.bounds.IsEmpty())
+				continue;
+			bounds.Expand(chunk.bounds.min);
+			bounds.Expand(chunk.bounds.max);
+		}
+		return bounds;
+	}
+}
+
+std::vector<XMFLOAT3> SimplifyPolyline(const std::vector<XMFLOAT3>& points, float tolerance)
+{
+	if (tolerance <= 0.0f || points.size() < 3)
+		return points;
+
+	const float toleranceSquared = tolerance * tolerance;
+	std::vector<unsigned char> keep(points.size(), 0);
+	std::vector<std::pair<size_t, size_t>> spans;
+	size_t first = 0;
+	while (first < points.size())
+	{
+		if (!IsFinite(points[first]))
+		{
+			keep[first++] = 1;
+			continue;
+		}
+		// Every run of finite points on its own, ends included.
+		size_t last = first;
+		while (last + 1 < points.size() && IsFinite(points[last + 1]))
+			++last;
+		keep[first] = keep[last] = 1;
+		spans.emplace_back(first, last);
+		while (!spans.empty())
+		{
+			const std::pair<size_t, size_t> span = spans.back();
+			spans.pop_back();
+			float farthest = 0.0f;
+			size_t at = span.first;
+			for (size_t i = span.first + 1; i < span.second; ++i)
+			{
+				const float distance = DistanceSquared(points[i], points[span.first], points[span.second]);
+				if (distance > farthest)
+				{
+					farthest = distance;
+					at = i;
+				}
+			}
+			if (farthest <= toleranceSquared)
+				continue;
+			keep[at] = 1;
+			spans.emplace_back(span.first, at);
+			spans.emplace_back(at, span.second);
+		}
+		first = last + 1;
+	}
+
+	std::vector<XMFLOAT3> kept;
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		if (keep[i])
+			kept.push_back(points[i]);
+	}
+	return kept;
+}
+
+CurveGraph::CurveGraph()
+{
+	const CurveInputs defaults;
+	this->params = this->graph.AddInput("params", defaults.params);
+	this->sampling = this->graph.AddInput("sampling", defaults.sampling);
+	this->chunkSize = this->graph.AddInput("chunk size", defaults.chunkSize);
+	this->simplifyTolerance = this->graph.AddInput("simplify tolerance", defaults.simplifyTolerance);
+
+	this->densePoints = this->graph.AddNode<std::vector<XMFLOAT3>>("dense points", DensePoints, this->params);
+	this->sampledPoints = this->graph.AddSharedNode<std::vector<XMFLOAT3>>("sampled points", SampledPoints, this->densePoints, this->sampling);
+	this->arcLength = this->graph.AddNode<float>("arc length", ArcLength, this->densePoints);
+	this->chunks = this->graph.AddNode<std::vector<CurveChunk>>("chunks", [](const std::vector<XMFLOAT3>& points, const unsigned int& chunkSize)
+	{
+		return BuildCurveChunks(points.data(), static_cast<unsigned int>(points.size()), chunkSize);
+	}, this->sampledPoints, this->chunkSize);
+	this->bounds = this->graph.AddNode<AABB>("bounds", Bounds, this->chunks);
+	this->simplified = this->graph.AddSharedNode<std::vector<XMFLOAT3>>("simplified", Simplified, this->sampledPoints, this->simplifyTolerance);
+}
+
+void CurveGraph::Evaluate(const CurveInputs& inputs, CurveProducts& out)
+{
+	this->graph.BeginPass();
+	this->graph.Set(this->params, inputs.params);
+	this->graph.Set(this->sampling, inputs.sampling);
+	this->graph.Set(this->chunkSize, inputs.chunkSize);
+	this->graph.Set(this->simplifyTolerance, inputs.simplifyTolerance);
+
+	out.points = this->graph.Get(this->sampledPoints);
+	out.chunks = this->graph.Get(this->chunks);
+	out.simplified = this->graph.Get(this->simplified);
+	out.arcLength = *this->graph.Get(this->arcLength);
+	out.bounds = *this->graph.Get(this->bounds);
+	this->graph.Report(out.nodes);
+}
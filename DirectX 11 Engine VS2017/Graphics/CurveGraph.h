@@ -0,0 +1,82 @@
+#pragma once
+#include "ComputeGraph.h"
+#include "ArcLength.h"
+#include "CurveChunks.h"
+#include "Curves.h"
+#include <memory>
+#include <vector>
+
+struct CurveSamplingDesc
+{
+	CurveSampling sampling = CurveSampling::UNIFORM_PHI;
+	// Vertices of an ARC_LENGTH curve.
+	unsigned int vertices = 0;
+};
+
+// Everything a curve model's vertices and the data derived from them are
+// made from.
+struct CurveInputs
+{
+	CurveParams params;
+	DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+	CurveSamplingDesc sampling;
+	unsigned int chunkSize = 4096;
+	// How far, in world units, the simplified polyline may stray from the
+	// curve. 0 keeps every point.
+	float simplifyTolerance = 0.0f;
+};
+
+// Shared with the graph, which never changes them.
+struct CurveProducts
+{
+	// Positions of the vertices; they take the color when they are packed
+	// into the model's buffer.
+	std::shared_ptr<const std::vector<DirectX::XMFLOAT3>> points;
+	std::shared_ptr<const std::vector<CurveChunk>> chunks;
+	std::shared_ptr<const std::vector<DirectX::XMFLOAT3>> simplified;
+	// Of the uniform-phi curve, whatever the sampling.
+	float arcLength = 0.0f;
+	AABB bounds;
+	// What the evaluation did to each node of the graph.
+	std::vector<NodeReport> nodes;
+};
+
+// Drops the points of a polyline that lie within `tolerance` of the line
+// through the points kept either side of them (Douglas-Peucker). Points
+// that aren't finite are kept and break the line, the way the stroker
+// treats them.
+std::vector<DirectX::XMFLOAT3> SimplifyPolyline(const std::vector<DirectX::XMFLOAT3>& points, float tolerance);
+
+// A curve model's derived data as a ComputeGraph:
+//     dense points    <- params
+//     sampled points  <- dense points, sampling
+//     arc length      <- dense points
+//     chunks          <- sampled points, chunk size
+//     bounds          <- chunks
+//     simplified      <- sampled points, tolerance
+// so a new sampling leaves the dense points and the arc length alone.
+// Uniform-phi sampled points are the dense points themselves, and without
+// a tolerance the simplified ones are the sampled ones, shared rather than
+// copied. The color isn't part of it: the render thread packs the sampled
+// points with it straight into the mapped vertex buffer.
+class CurveGraph
+{
+public:
+	CurveGraph();
+	// Not thread-safe, and may wait for jobs: callers run one evaluation
+	// of a graph at a time and hold no lock across it.
+	void Evaluate(const CurveInputs& inputs, CurveProducts& out);
+
+private:
+	ComputeGraph graph;
+	GraphNode<CurveParams> params;
+	GraphNode<CurveSamplingDesc> sampling;
+	GraphNode<unsigned int> chunkSize;
+	GraphNode<float> simplifyTolerance;
+	GraphNode<std::vector<DirectX::XMFLOAT3>> densePoints;
+	GraphNode<std::vector<DirectX::XMFLOAT3>> sampledPoints;
+	GraphNode<float> arcLength;
+	GraphNode<std::vector<CurveChunk>> chunks;
+	GraphNode<AABB> bounds;
+	GraphNode<std::vector<DirectX::XMFLOAT3>> simplified;
+};
@@ -0,0 +1,222 @@
+#include "Curves.h"
+#include "../Jobs/ParallelFor.h"
+#include "../Math/MathKernels.h"
+#include <cmath>
+using namespace DirectX;
+
+static float lerp(float a, float b, float f)
+{
+	return a + f * (b - a);
+}
+
+unsigned int CurveVertexCount(const CurveParams& params)
+{
+	switch (params.type)
+	{
+	case CurveType::FERMAT:
+		// Both branches use t_num/2 samples.
+		return (params.t_num / 2) * 2;
+	default:
+		return params.t_num;
+	}
+}
+
+// Vertices are computed this many at a time, so sin, cos and sqrt run
+// over arrays.
+static const unsigned int curveBatch = 256;
+
+static_assert(sizeof(VertexCommon) == 9 * sizeof(float), "packVertices writes VertexCommon as nine floats");
+
+namespace
+{
+	// One batch of positions as separate arrays, the way the kernels take them.
+	// z is the same for every vertex and filled once.
+	struct CurveBatch
+	{
+		float x[curveBatch];
+		float y[curveBatch];
+		float z[curveBatch];
+
+		explicit CurveBatch(float zValue)
+		{
+			for (unsigned int i = 0; i < curveBatch; ++i)
+				this->z[i] = zValue;
+		}
+
+		XMFLOAT3 Position(unsigned int i) const
+		{
+			return XMFLOAT3(this->x[i], this->y[i], this->z[i]);
+		}
+
+		void Pack(unsigned int count, const XMFLOAT4& color, VertexCommon* out) const
+		{
+			SoaPoints3 points;
+			points.x = this->x;
+			points.y = this->y;
+			points.z = this->z;
+			Kernels().packVertices(points, count, &color.x, reinterpret_cast<float*>(out));
+		}
+	};
+}
+
+// x and y of vertices [first, first + count), count <= curveBatch.
+static void EvaluateCurveBatch(const CurveParams& params, unsigned int first, unsigned int count, float* x, float* y)
+{
+	float phi[curveBatch];
+	float r[curveBatch];
+	float sinPhi[curveBatch];
+	float cosPhi[curveBatch];
+	switch (params.type)
+	{
+	case CurveType::ARHIMEDES:
+		// r = a*phi
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			phi[i] = lerp(params.t_min, params.t_max, (first + i) / static_cast<float>(params.t_num));
+			r[i] = params.a * phi[i];
+		}
+		break;
+	case CurveType::FERMAT:
+	{
+		// r = +-a*sqrt(phi): the - branch is walked backwards so the strip
+		// passes through the origin into the + branch.
+		const unsigned int half = params.t_num / 2;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const unsigned int index = first + i;
+			const unsigned int j = index < half ? half - 1 - index : index - half;
+			phi[i] = lerp(params.t_min, params.t_max, j / static_cast<float>(half));
+		}
+		VectorSqrt(phi, r, count, params.accuracy);
+		for (unsigned int i = 0; i < count; ++i)
+			r[i] = params.a * (first + i < half ? -r[i] : +r[i]);
+		break;
+	}
+	case CurveType::BERNOULLI:
+	{
+		// r^2 = a^2 * cos(phi_scale*phi)
+		const float a2 = params.a * params.a;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			phi[i] = lerp(params.t_min, params.t_max, (first + i) / static_cast<float>(params.t_num));
+			r[i] = phi[i] * params.phi_scale;
+		}
+		VectorCos(r, r, count, params.accuracy);
+		for (unsigned int i = 0; i < count; ++i)
+			r[i] *= a2;
+		VectorSqrt(r, r, count, params.accuracy);
+		break;
+	}
+	default:
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			x[i] = 0.0f;
+			y[i] = 0.0f;
+		}
+		return;
+	}
+
+	VectorSinCos(phi, sinPhi, cosPhi, count, params.accuracy);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		x[i] = r[i] * cosPhi[i];
+		y[i] = r[i] * sinPhi[i];
+	}
+}
+
+XMFLOAT3 EvaluateCurve(const CurveParams& params, unsigned int index)
+{
+	float x, y;
+	EvaluateCurveBatch(params, index, 1, &x, &y);
+	return XMFLOAT3(x, y, params.z);
+}
+
+void GenerateCurveRange(const CurveParams& params, const XMFLOAT4& color, unsigned int first, unsigned int count, VertexCommon* out)
+{
+	CurveBatch batch(params.z);
+	for (unsigned int done = 0; done < count; done += curveBatch)
+	{
+		const unsigned int n = count - done < curveBatch ? count - done : curveBatch;
+		EvaluateCurveBatch(params, first + done, n, batch.x, batch.y);
+		batch.Pack(n, color, out + done);
+	}
+}
+
+unsigned int GenerateCurvePoints(const CurveParams& params, std::span<XMFLOAT3> out)
+{
+	const unsigned int count = CurveVertexCount(params);
+	if (out.size() < count)
+		return 0;
+
+	ParallelFor(count, 4096, [&](size_t begin, size_t end)
+	{
+		CurveBatch batch(params.z);
+		for (size_t first = begin; first < end; first += curveBatch)
+		{
+			const unsigned int n = static_cast<unsigned int>(end - first < curveBatch ? end - first : curveBatch);
+			EvaluateCurveBatch(params, static_cast<unsigned int>(first), n, batch.x, batch.y);
+			for (unsigned int j = 0; j < n; ++j)
+				out[first + j] = batch.Position(j);
+		}
+	});
+	return count;
+}
+
+unsigned int GenerateCurve(const CurveParams& params, const XMFLOAT4& color, std::span<VertexCommon> out,
+	std::vector<CurveChunk>* chunks, unsigned int chunkSize)
+{
+	const unsigned int count = CurveVertexCount(params);
+	if (out.size() < count)
+		return 0;
+
+	if (chunks)
+		*chunks = MakeCurveChunks(count, chunkSize);
+	const bool trackBounds = chunks && !chunks->empty();
+
+	// Blocks line up with chunks so each one owns exactly one chunk's bounds.
+	ParallelFor(count, trackBounds ? chunkSize : 4096, [&](size_t begin, size_t end)
+	{
+		AABB bounds;
+		double length = 0.0;
+		XMFLOAT3 prev;
+		CurveBatch batch(params.z);
+		for (size_t first = begin; first < end; first += curveBatch)
+		{
+			const unsigned int n = static_cast<unsigned int>(end - first < curveBatch ? end - first : curveBatch);
+			EvaluateCurveBatch(params, static_cast<unsigned int>(first), n, batch.x, batch.y);
+			batch.Pack(n, color, &out[first]);
+			for (unsigned int j = 0; j < n; ++j)
+			{
+				const XMFLOAT3 p = batch.Position(j);
+				bounds.Expand(p);
+				if (first + j > begin)
+					length += SegmentLength(prev, p);
+				prev = p;
+			}
+		}
+
+		if (!trackBounds || begin / chunkSize >= chunks->size())
+			return;
+		// The chunk also ends on the first vertex of the next block.
+		if (end < count)
+		{
+			const XMFLOAT3 next = EvaluateCurve(params, static_cast<unsigned int>(end));
+			bounds.Expand(next);
+			length += SegmentLength(prev, next);
+		}
+		CurveChunk& chunk = (*chunks)[begin / chunkSize];
+		chunk.bounds = bounds;
+		chunk.length = static_cast<float>(length);
+	});
+	return count;
+}
+
+void PackCurveVertices(const XMFLOAT3* points, unsigned int count, const XMFLOAT4& color, VertexCommon* out)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		out[i].pos = points[i];
+		out[i].color = color;
+		out[i].texCoord = XMFLOAT2(0.0f, 0.0f);
+	}
+}
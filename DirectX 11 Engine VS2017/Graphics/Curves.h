@@ -0,0 +1,48 @@
+#pragma once
+#include "Vertex.h"
+#include "CurveChunks.h"
+#include "../Math/Transcendental.h"
+#include <span>
+#include <vector>
+
+enum class CurveType { ARHIMEDES, FERMAT, BERNOULLI };
+
+struct CurveParams
+{
+	CurveType type = CurveType::ARHIMEDES;
+	float a = 1.0f;
+	float t_min = 0.0f;
+	float t_max = 1.0f;
+	float phi_scale = 2.0f; // Lemniscate only: r^2 = a^2 * cos(phi_scale * phi)
+	float z = 0.0f;
+	unsigned int t_num = 100000;
+	// Tier of the sin, cos and sqrt the samples are computed with.
+	MathAccuracy accuracy = MathAccuracy::PRECISE;
+};
+
+// Number of vertices GenerateCurve writes for the given parameters.
+unsigned int CurveVertexCount(const CurveParams& params);
+
+// Position of vertex `index` of the curve's line strip.
+DirectX::XMFLOAT3 EvaluateCurve(const CurveParams& params, unsigned int index);
+
+// Writes vertices [first, first + count) of the curve into out.
+void GenerateCurveRange(const CurveParams& params, const DirectX::XMFLOAT4& color, unsigned int first, unsigned int count, VertexCommon* out);
+
+// Positions of all CurveVertexCount(params) vertices, computed in
+// parallel; returns how many were written (0 if `out` is too small).
+unsigned int GenerateCurvePoints(const CurveParams& params, std::span<DirectX::XMFLOAT3> out);
+
+// Writes all CurveVertexCount(params) vertices of the curve into `out`, in
+// parallel, and returns how many were written (0 if `out` is too small).
+// `out` is never read, so it can point straight at mapped, write-combined
+// buffer memory. When `chunks` is given it receives the chunk ranges,
+// bounds and lengths of the curve, taken from the positions as they are
+// generated.
+unsigned int GenerateCurve(const CurveParams& params, const DirectX::XMFLOAT4& color, std::span<VertexCommon> out,
+	std::vector<CurveChunk>* chunks = nullptr, unsigned int chunkSize = 4096);
+
+// Writes points[i] with `color` into out[i]. Like GenerateCurve it never
+// reads `out`, so it can fill mapped buffer memory straight from points
+// computed earlier.
+void PackCurveVertices(const DirectX::XMFLOAT3* points, unsigned int count, const DirectX::XMFLOAT4& color, VertexCommon* out);
@@ -0,0 +1,168 @@
+#include "D3D11RenderDevice.h"
+#include "../ErrorLogger.h"
+
+namespace
+{
+	ID3D11Buffer* ToD3D(DeviceBuffer* buffer)
+	{
+		return reinterpret_cast<ID3D11Buffer*>(buffer);
+	}
+}
+
+D3D11RenderDevice::D3D11RenderDevice(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+	: device(device)
+	, deviceContext(deviceContext)
+{
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	ZeroMemory(&options, sizeof(options));
+	if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))
+		&& options.ConstantBufferOffsetting
+		&& SUCCEEDED(this->deviceContext.As(&this->deviceContext1)))
+	{
+		constantBufferOffsets = true;
+	}
+
+	D3D11_BLEND_DESC blendDesc;
+	ZeroMemory(&blendDesc, sizeof(blendDesc));
+	D3D11_RENDER_TARGET_BLEND_DESC& target = blendDesc.RenderTarget[0];
+	target.BlendEnable = TRUE;
+	target.SrcBlend = D3D11_BLEND_SRC_ALPHA;
+	target.DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+	target.BlendOp = D3D11_BLEND_OP_ADD;
+	target.SrcBlendAlpha = D3D11_BLEND_ONE;
+	target.DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+	target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+	target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	HRESULT hr = device->CreateBlendState(&blendDesc, this->alphaBlend.GetAddressOf());
+	if (FAILED(hr))
+		ErrorLogger::Log(hr, "Failed to create alpha blend state.");
+}
+
+HRESULT D3D11RenderDevice::DoCreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+	bufferDesc.ByteWidth = desc.byteWidth;
+	bufferDesc.Usage = desc.dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+	bufferDesc.CPUAccessFlags = desc.dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+	switch (desc.type)
+	{
+	case BufferType::VERTEX: bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER; break;
+	case BufferType::INDEX: bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER; break;
+	case BufferType::CONSTANT: bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER; break;
+	}
+
+	D3D11_SUBRESOURCE_DATA data;
+	ZeroMemory(&data, sizeof(data));
+	data.pSysMem = initialData;
+
+	// Without data the contents are undefined until the first Map.
+	ID3D11Buffer* created = nullptr;
+	HRESULT hr = device->CreateBuffer(&bufferDesc, initialData ? &data : NULL, &created);
+	if (FAILED(hr))
+		return hr;
+	*buffer = ToHandle(created);
+	return S_OK;
+}
+
+void D3D11RenderDevice::DoReleaseBuffer(DeviceBuffer* buffer)
+{
+	ToD3D(buffer)->Release();
+}
+
+HRESULT D3D11RenderDevice::DoMap(DeviceBuffer* buffer, MapMode mode, void** data)
+{
+	const D3D11_MAP mapType = mode == MapMode::WRITE_DISCARD ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+	D3D11_MAPPED_SUBRESOURCE resource;
+	HRESULT hr = deviceContext->Map(ToD3D(buffer), 0, mapType, 0, &resource);
+	if (FAILED(hr))
+		return hr;
+	*data = resource.pData;
+	return S_OK;
+}
+
+void D3D11RenderDevice::DoUnmap(DeviceBuffer* buffer)
+{
+	deviceContext->Unmap(ToD3D(buffer), 0);
+}
+
+void D3D11RenderDevice::DoUpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size)
+{
+	D3D11_BOX box = { offset, 0, 0, offset + size, 1, 1 };
+	deviceContext->UpdateSubresource(ToD3D(buffer), 0, &box, data, 0, 0);
+}
+
+void D3D11RenderDevice::DoCopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size)
+{
+	D3D11_BOX box = { srcOffset, 0, 0, srcOffset + size, 1, 1 };
+	deviceContext->CopySubresourceRegion(ToD3D(destination), 0, dstOffset, 0, 0, ToD3D(source), 0, &box);
+}
+
+void D3D11RenderDevice::DoSetPrimitiveTopology(PrimitiveTopology topology)
+{
+	D3D11_PRIMITIVE_TOPOLOGY d3dTopology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	switch (topology)
+	{
+	case PrimitiveTopology::POINT_LIST: d3dTopology = D3D11_PRIMITIVE_TOPOLOGY_POINTLIST; break;
+	case PrimitiveTopology::LINE_LIST: d3dTopology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST; break;
+	case PrimitiveTopology::LINE_STRIP: d3dTopology = D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP; break;
+	case PrimitiveTopology::TRIANGLE_LIST: d3dTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST; break;
+	case PrimitiveTopology::TRIANGLE_STRIP: d3dTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP; break;
+	}
+	deviceContext->IASetPrimitiveTopology(d3dTopology);
+}
+
+void D3D11RenderDevice::DoSetInputLayout(DeviceInputLayout* layout)
+{
+	deviceContext->IASetInputLayout(reinterpret_cast<ID3D11InputLayout*>(layout));
+}
+
+void D3D11RenderDevice::DoSetVertexShader(DeviceVertexShader* shader)
+{
+	deviceContext->VSSetShader(reinterpret_cast<ID3D11VertexShader*>(shader), NULL, 0);
+}
+
+void D3D11RenderDevice::DoSetPixelShader(DevicePixelShader* shader)
+{
+	deviceContext->PSSetShader(reinterpret_cast<ID3D11PixelShader*>(shader), NULL, 0);
+}
+
+void D3D11RenderDevice::DoSetBlendMode(BlendMode mode)
+{
+	// Without the state, blended draws come out opaque rather than not at all.
+	ID3D11BlendState* state = mode == BlendMode::ALPHA ? this->alphaBlend.Get() : NULL;
+	deviceContext->OMSetBlendState(state, NULL, 0xffffffff);
+}
+
+void D3D11RenderDevice::DoSetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset)
+{
+	ID3D11Buffer* d3dBuffer = ToD3D(buffer);
+	deviceContext->IASetVertexBuffers(0, 1, &d3dBuffer, &stride, &offset);
+}
+
+void D3D11RenderDevice::DoSetIndexBuffer(DeviceBuffer* buffer)
+{
+	deviceContext->IASetIndexBuffer(ToD3D(buffer), DXGI_FORMAT_R32_UINT, 0);
+}
+
+void D3D11RenderDevice::DoSetVSConstantBuffer(UINT slot, DeviceBuffer* buffer)
+{
+	ID3D11Buffer* d3dBuffer = ToD3D(buffer);
+	deviceContext->VSSetConstantBuffers(slot, 1, &d3dBuffer);
+}
+
+void D3D11RenderDevice::DoSetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	ID3D11Buffer* d3dBuffer = ToD3D(buffer);
+	deviceContext1->VSSetConstantBuffers1(slot, 1, &d3dBuffer, &firstConstant, &numConstants);
+}
+
+void D3D11RenderDevice::DoDraw(UINT vertexCount, UINT startVertex)
+{
+	deviceContext->Draw(vertexCount, startVertex);
+}
+
+void D3D11RenderDevice::DoDrawIndexed(UINT indexCount, UINT startIndex, int baseVertex)
+{
+	deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "RenderDevice.h"
+#include <d3d11_1.h>
+#include <wrl/client.h>
+
+// RenderDevice forwarding to an immediate D3D11 context. Handles are the
+// D3D11 interface pointers themselves.
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+	D3D11RenderDevice(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+
+	static DeviceBuffer* ToHandle(ID3D11Buffer* buffer) { return reinterpret_cast<DeviceBuffer*>(buffer); }
+	static DeviceVertexShader* ToHandle(ID3D11VertexShader* shader) { return reinterpret_cast<DeviceVertexShader*>(shader); }
+	static DevicePixelShader* ToHandle(ID3D11PixelShader* shader) { return reinterpret_cast<DevicePixelShader*>(shader); }
+	static DeviceInputLayout* ToHandle(ID3D11InputLayout* layout) { return reinterpret_cast<DeviceInputLayout*>(layout); }
+
+protected:
+	HRESULT DoCreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer) override;
+	void DoReleaseBuffer(DeviceBuffer* buffer) override;
+	HRESULT DoMap(DeviceBuffer* buffer, MapMode mode, void** data) override;
+	void DoUnmap(DeviceBuffer* buffer) override;
+	void DoUpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size) override;
+	void DoCopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size) override;
+	void DoSetPrimitiveTopology(PrimitiveTopology topology) override;
+	void DoSetInputLayout(DeviceInputLayout* layout) override;
+	void DoSetVertexShader(DeviceVertexShader* shader) override;
+	void DoSetPixelShader(DevicePixelShader* shader) override;
+	void DoSetBlendMode(BlendMode mode) override;
+	void DoSetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset) override;
+	void DoSetIndexBuffer(DeviceBuffer* buffer) override;
+	void DoSetVSConstantBuffer(UINT slot, DeviceBuffer* buffer) override;
+	void DoSetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants) override;
+	void DoDraw(UINT vertexCount, UINT startVertex) override;
+	void DoDrawIndexed(UINT indexCount, UINT startIndex, int baseVertex) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> deviceContext;
+	// Null unless the D3D11.1 runtime and driver support constant buffer
+	// offsets.
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> deviceContext1;
+	Microsoft::WRL::ComPtr<ID3D11BlendState> alphaBlend;
+};
@@ -0,0 +1,151 @@
+#include "DrawCommandBuffer.h"
+#include <algorithm>
+
+namespace
+{
+	const int layerBits = 4;
+	const int pipelineBits = 10;
+	const int vertexBufferBits = 18;
+	const int indexBits = 32;
+
+	// Ids that don't fit share the last value: the order gets worse, the
+	// result doesn't change since Submit compares the real bindings.
+	std::uint64_t Field(UINT value, int bits)
+	{
+		const std::uint64_t max = (std::uint64_t(1) << bits) - 1;
+		return (std::min)(static_cast<std::uint64_t>(value), max);
+	}
+}
+
+void DrawCommandBuffer::SetConstantArena(ConstantArena* arena)
+{
+	this->arena = arena;
+}
+
+void DrawCommandBuffer::Clear()
+{
+	if (arena)
+		arena->BeginFrame();
+	commands.clear();
+	keys.clear();
+	pipelines.clear();
+	vertexBuffers.clear();
+}
+
+UINT DrawCommandBuffer::PipelineId(const DrawCommand& command)
+{
+	// A frame only uses a handful of pipelines, a linear search is enough.
+	for (size_t i = 0; i < pipelines.size(); ++i)
+	{
+		const DrawCommand& p = pipelines[i];
+		if (p.topology == command.topology && p.inputLayout == command.inputLayout && p.vs == command.vs && p.ps == command.ps
+			&& p.blend == command.blend)
+			return static_cast<UINT>(i);
+	}
+	pipelines.push_back(command);
+	return static_cast<UINT>(pipelines.size() - 1);
+}
+
+UINT DrawCommandBuffer::VertexBufferId(DeviceBuffer* buffer)
+{
+	auto inserted = vertexBuffers.insert(std::make_pair(buffer, static_cast<UINT>(vertexBuffers.size())));
+	return inserted.first->second;
+}
+
+void DrawCommandBuffer::Add(const DrawCommand& command)
+{
+	if (command.count == 0)
+		return;
+
+	std::uint64_t key = Field(command.layer, layerBits);
+	key = (key << pipelineBits) | Field(PipelineId(command), pipelineBits);
+	key = (key << vertexBufferBits) | Field(VertexBufferId(command.vertexBuffer), vertexBufferBits);
+	key = (key << indexBits) | static_cast<std::uint32_t>(commands.size());
+	keys.push_back(key);
+	commands.push_back(command);
+}
+
+void DrawCommandBuffer::Submit(RenderDevice& device)
+{
+	// The arena can't stay mapped while the GPU reads from it.
+	if (arena)
+		arena->Close();
+
+	// The command index in the low bits keeps recording order among draws
+	// with equal state.
+	std::sort(keys.begin(), keys.end());
+
+	skippedBindings = 0;
+	// Nothing is assumed about the state before the first draw, and the
+	// index buffer is only known once an indexed draw has set it.
+	DrawCommand bound;
+	bool anyBound = false;
+	bool indexBound = false;
+	for (std::uint64_t key : keys)
+	{
+		const DrawCommand& command = commands[static_cast<std::uint32_t>(key)];
+
+		if (!anyBound || bound.topology != command.topology)
+			device.SetPrimitiveTopology(command.topology);
+		else
+			++skippedBindings;
+		if (!anyBound || bound.inputLayout != command.inputLayout)
+			device.SetInputLayout(command.inputLayout);
+		else
+			++skippedBindings;
+		if (!anyBound || bound.vs != command.vs)
+			device.SetVertexShader(command.vs);
+		else
+			++skippedBindings;
+		if (!anyBound || bound.ps != command.ps)
+			device.SetPixelShader(command.ps);
+		else
+			++skippedBindings;
+		if (!anyBound || bound.blend != command.blend)
+			device.SetBlendMode(command.blend);
+		else
+			++skippedBindings;
+		if (!anyBound || bound.vertexBuffer != command.vertexBuffer || bound.vertexStride != command.vertexStride)
+			device.SetVertexBuffer(command.vertexBuffer, command.vertexStride, 0);
+		else
+			++skippedBindings;
+		if (!anyBound || bound.constantBuffer != command.constantBuffer
+			|| bound.firstConstant != command.firstConstant || bound.numConstants != command.numConstants)
+		{
+			if (command.numConstants > 0)
+				device.SetVSConstantBufferRange(0, command.constantBuffer, command.firstConstant, command.numConstants);
+			else
+				device.SetVSConstantBuffer(0, command.constantBuffer);
+		}
+		else
+			++skippedBindings;
+
+		if (command.indexBuffer)
+		{
+			if (!indexBound || bound.indexBuffer != command.indexBuffer)
+				device.SetIndexBuffer(command.indexBuffer);
+			else
+				++skippedBindings;
+			device.DrawIndexed(command.count, command.start, command.baseVertex);
+		}
+		else
+			device.Draw(command.count, command.start);
+
+		// A non-indexed draw leaves the previous index buffer bound.
+		DeviceBuffer* indexBuffer = command.indexBuffer ? command.indexBuffer : bound.indexBuffer;
+		indexBound = indexBound || command.indexBuffer != nullptr;
+		bound = command;
+		bound.indexBuffer = indexBuffer;
+		anyBound = true;
+	}
+}
+
+size_t DrawCommandBuffer::Size() const
+{
+	return commands.size();
+}
+
+UINT DrawCommandBuffer::SkippedBindings() const
+{
+	return skippedBindings;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "RenderDevice.h"
+#include "ConstantArena.h"
+#include "ConstantBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Everything the device needs for one draw call.
+struct DrawCommand
+{
+	// Draws of a lower layer are always submitted first, so e.g. curves
+	// keep winning depth ties against the grid they are drawn over.
+	UINT layer = 0;
+	PrimitiveTopology topology = PrimitiveTopology::POINT_LIST;
+	DeviceInputLayout* inputLayout = nullptr;
+	DeviceVertexShader* vs = nullptr;
+	DevicePixelShader* ps = nullptr;
+	BlendMode blend = BlendMode::NONE;
+	DeviceBuffer* vertexBuffer = nullptr;
+	UINT vertexStride = 0;
+	// nullptr for non-indexed draws.
+	DeviceBuffer* indexBuffer = nullptr;
+	DeviceBuffer* constantBuffer = nullptr;
+	// Range of constantBuffer bound to slot 0; numConstants is 0 to bind
+	// the whole buffer.
+	UINT firstConstant = 0;
+	UINT numConstants = 0;
+	UINT count = 0;
+	UINT start = 0;
+	// Added to every index of an indexed draw.
+	int baseVertex = 0;
+};
+
+// Draws recorded during a frame and submitted in one go. Submission is
+// ordered by layer, pipeline and vertex buffer so draws sharing state end
+// up next to each other, and only bindings that differ from the previous
+// draw reach the device.
+class DrawCommandBuffer
+{
+public:
+	// Per-draw constants go to the arena when one is set.
+	void SetConstantArena(ConstantArena* arena);
+	// Starts recording a new frame.
+	void Clear();
+	void Add(const DrawCommand& command);
+	// Closes the arena and issues the recorded draws.
+	void Submit(RenderDevice& device);
+
+	// Points the command at a copy of constants.data in the arena, or
+	// uploads constants and binds it whole if the arena can't take it.
+	// Fails when neither works, e.g. for an uninitialized buffer while the
+	// arena is full; the arena grows by the next frame.
+	template<class T>
+	bool BindConstants(DrawCommand& command, ConstantBuffer<T>& constants)
+	{
+		ConstantRange range;
+		if (arena && arena->Write(&constants.data, sizeof(T), range))
+		{
+			command.constantBuffer = range.buffer;
+			command.firstConstant = range.firstConstant;
+			command.numConstants = range.numConstants;
+			return true;
+		}
+		if (!constants.Get() || !constants.ApplyChanges())
+			return false;
+		command.constantBuffer = constants.Get();
+		command.firstConstant = 0;
+		command.numConstants = 0;
+		return true;
+	}
+
+	size_t Size() const;
+	// Bindings the last Submit didn't have to issue.
+	UINT SkippedBindings() const;
+
+private:
+	UINT PipelineId(const DrawCommand& command);
+	UINT VertexBufferId(DeviceBuffer* buffer);
+
+	ConstantArena* arena = nullptr;
+	std::vector<DrawCommand> commands;
+	// layer | pipeline | vertex buffer | command index, sorted instead of
+	// the commands themselves.
+	std::vector<std::uint64_t> keys;
+	std::vector<DrawCommand> pipelines;
+	std::unordered_map<const DeviceBuffer*, UINT> vertexBuffers;
+	UINT skippedBindings = 0;
+};
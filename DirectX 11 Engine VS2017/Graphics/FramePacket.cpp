@@ -0,0 +1,53 @@
+#include "FramePacket.h"
+#include <cstring>
+
+namespace
+{
+	// ImVector's assignment frees before it copies; resizing keeps the
+	// memory of the last frame.
+	template<class T>
+	void CopyVector(ImVector<T>& to, const ImVector<T>& from)
+	{
+		to.resize(from.Size);
+		if (from.Size > 0)
+			memcpy(to.Data, from.Data, static_cast<size_t>(from.Size) * sizeof(T));
+	}
+}
+
+UiDrawData::~UiDrawData()
+{
+	for (ImDrawList* list : lists)
+		IM_DELETE(list);
+}
+
+void UiDrawData::CopyFrom(const ImDrawData* source)
+{
+	data.Clear();
+	if (!source || !source->Valid)
+		return;
+
+	while (lists.size() < static_cast<size_t>(source->CmdListsCount))
+		lists.push_back(IM_NEW(ImDrawList)(nullptr));
+	for (int i = 0; i < source->CmdListsCount; ++i)
+	{
+		const ImDrawList* from = source->CmdLists[i];
+		ImDrawList* to = lists[i];
+		CopyVector(to->CmdBuffer, from->CmdBuffer);
+		CopyVector(to->IdxBuffer, from->IdxBuffer);
+		CopyVector(to->VtxBuffer, from->VtxBuffer);
+		to->Flags = from->Flags;
+	}
+
+	data.Valid = true;
+	data.CmdLists = lists.data();
+	data.CmdListsCount = source->CmdListsCount;
+	data.TotalIdxCount = source->TotalIdxCount;
+	data.TotalVtxCount = source->TotalVtxCount;
+	data.DisplayPos = source->DisplayPos;
+	data.DisplaySize = source->DisplaySize;
+}
+
+const ImDrawData& UiDrawData::Data() const
+{
+	return data;
+}
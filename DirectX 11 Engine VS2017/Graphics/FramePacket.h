@@ -0,0 +1,86 @@
+#pragma once
+#include "RenderDevice.h"
+#include "Curves.h"
+#include "imgui.h"
+#include "../Math/VectorMath.h"
+#include <vector>
+
+// Copy of the UI's draw lists that stays valid while ImGui builds its next
+// frame. Lists and their memory are reused from one copy to the next.
+class UiDrawData
+{
+public:
+	UiDrawData() {}
+	~UiDrawData();
+
+	// Same thread as ImGui: the lists are allocated through its allocator.
+	void CopyFrom(const ImDrawData* source);
+	// Invalid (Valid is false) when nothing was copied.
+	const ImDrawData& Data() const;
+
+private:
+	UiDrawData(const UiDrawData& rhs);
+	UiDrawData& operator=(const UiDrawData& rhs);
+
+	std::vector<ImDrawList*> lists;
+	ImDrawData data;
+};
+
+// A curve to draw in a frame.
+struct CurveDraw
+{
+	CurveType type = CurveType::ARHIMEDES;
+	// The animated curve instead of the function's own model.
+	bool animated = false;
+	bool enableSpherical = false;
+	// The stroke mesh instead of the model's line strip.
+	bool stroked = false;
+};
+
+// Everything the render thread needs to draw a frame, as the update thread
+// saw it when it published the packet. Geometry isn't copied: the render
+// thread owns the buffers and gets their contents through render tasks
+// posted before the packet.
+struct FramePacket
+{
+	unsigned long long sequence = 0;
+	DirectX::XMMATRIX viewProjection = DirectX::XMMatrixIdentity();
+	bool drawGrid = true;
+	// Draw the packet again at every present until the next one arrives.
+	// Otherwise the render thread sleeps once it has shown the packet.
+	bool continuous = true;
+	std::vector<CurveDraw> curves;
+	UiDrawData ui;
+};
+
+// What the render thread reports back about the last frame it drew, for
+// the UI.
+struct RenderFeedback
+{
+	unsigned long long framesRendered = 0;
+	unsigned long long lastPacket = 0;
+	// Time between the last two presents.
+	float presentIntervalMs = 0.0f;
+	RenderStats stats;
+	UINT drawCommands = 0;
+	UINT skippedBindings = 0;
+	UINT arenaBytes = 0;
+	UINT arenaCapacity = 0;
+	UINT ringUsed = 0;
+	UINT ringCapacity = 0;
+	UINT ringFallbacks = 0;
+	// Geometry heap, in vertices.
+	UINT heapUsed = 0;
+	UINT heapCapacity = 0;
+	UINT heapFreeBlocks = 0;
+	float heapFragmentation = 0.0f;
+	UINT heapMovedBytes = 0;
+	// Buffers the render thread sizes itself, for the residency manager.
+	UINT heapBytes = 0;
+	UINT strokeBytes = 0;
+	UINT gridBytes = 0;
+	UINT familyBatches = 0;
+	// Of the first curve in the packet.
+	UINT visibleChunks = 0;
+	UINT totalChunks = 0;
+};
@@ -0,0 +1,194 @@
+#include "FreeListAllocator.h"
+#include <iterator>
+
+void FreeListAllocator::Reset(UINT capacity)
+{
+	this->capacity = 0;
+	this->used = 0;
+	this->entries.clear();
+	this->unusedEntries.clear();
+	this->freeBlocks.clear();
+	this->freeBySize.clear();
+	this->allocations.clear();
+	Grow(capacity);
+}
+
+void FreeListAllocator::Grow(UINT capacity)
+{
+	if (capacity <= this->capacity)
+		return;
+	const UINT oldCapacity = this->capacity;
+	this->capacity = capacity;
+	InsertFree(oldCapacity, capacity - oldCapacity);
+}
+
+void FreeListAllocator::InsertFree(UINT offset, UINT size)
+{
+	// Merge with the blocks on either side.
+	std::map<UINT, UINT>::iterator next = freeBlocks.lower_bound(offset);
+	if (next != freeBlocks.begin())
+	{
+		std::map<UINT, UINT>::iterator previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			offset = previous->first;
+			size += previous->second;
+			EraseFree(previous);
+		}
+	}
+	if (next != freeBlocks.end() && offset + size == next->first)
+	{
+		size += next->second;
+		EraseFree(next);
+	}
+
+	freeBlocks[offset] = size;
+	freeBySize.insert(std::make_pair(size, offset));
+}
+
+void FreeListAllocator::EraseFree(std::map<UINT, UINT>::iterator block)
+{
+	auto range = freeBySize.equal_range(block->second);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == block->first)
+		{
+			freeBySize.erase(it);
+			break;
+		}
+	}
+	freeBlocks.erase(block);
+}
+
+HeapHandle FreeListAllocator::Allocate(UINT size)
+{
+	HeapHandle handle;
+	if (size == 0)
+		return handle;
+
+	std::multimap<UINT, UINT>::iterator fit = freeBySize.lower_bound(size);
+	if (fit == freeBySize.end())
+		return handle;
+
+	const UINT offset = fit->second;
+	const UINT blockSize = fit->first;
+	EraseFree(freeBlocks.find(offset));
+	if (blockSize > size)
+		InsertFree(offset + size, blockSize - size);
+
+	if (unusedEntries.empty())
+	{
+		unusedEntries.push_back(static_cast<UINT>(entries.size()));
+		entries.push_back(Entry());
+	}
+	handle.index = unusedEntries.back();
+	unusedEntries.pop_back();
+
+	Entry& entry = entries[handle.index];
+	entry.offset = offset;
+	entry.size = size;
+	entry.live = true;
+	handle.generation = entry.generation;
+
+	allocations[offset] = handle.index;
+	used += size;
+	return handle;
+}
+
+const FreeListAllocator::Entry* FreeListAllocator::Find(HeapHandle handle) const
+{
+	if (handle.index >= entries.size())
+		return nullptr;
+	const Entry& entry = entries[handle.index];
+	if (!entry.live || entry.generation != handle.generation)
+		return nullptr;
+	return &entry;
+}
+
+void FreeListAllocator::Free(HeapHandle handle)
+{
+	if (!Find(handle))
+		return;
+
+	Entry& entry = entries[handle.index];
+	allocations.erase(entry.offset);
+	InsertFree(entry.offset, entry.size);
+	used -= entry.size;
+
+	// A new generation makes stale copies of the handle invalid.
+	entry.live = false;
+	++entry.generation;
+	unusedEntries.push_back(handle.index);
+}
+
+bool FreeListAllocator::IsLive(HeapHandle handle) const
+{
+	return Find(handle) != nullptr;
+}
+
+UINT FreeListAllocator::Offset(HeapHandle handle) const
+{
+	const Entry* entry = Find(handle);
+	return entry ? entry->offset : 0;
+}
+
+UINT FreeListAllocator::Size(HeapHandle handle) const
+{
+	const Entry* entry = Find(handle);
+	return entry ? entry->size : 0;
+}
+
+bool FreeListAllocator::CompactStep(Move& move)
+{
+	if (freeBlocks.empty())
+		return false;
+
+	const std::map<UINT, UINT>::iterator gap = freeBlocks.begin();
+	const std::map<UINT, UINT>::iterator next = allocations.find(gap->first + gap->second);
+	if (next == allocations.end())
+		return false;
+
+	Entry& entry = entries[next->second];
+	move.handle.index = next->second;
+	move.handle.generation = entry.generation;
+	move.from = entry.offset;
+	move.to = gap->first;
+	move.size = entry.size;
+
+	// The gap moves behind the allocation and merges with what follows.
+	const UINT gapSize = gap->second;
+	EraseFree(gap);
+	allocations.erase(next);
+	entry.offset = move.to;
+	allocations[entry.offset] = move.handle.index;
+	InsertFree(move.to + move.size, gapSize);
+	return true;
+}
+
+UINT FreeListAllocator::Capacity() const
+{
+	return capacity;
+}
+
+UINT FreeListAllocator::UsedSize() const
+{
+	return used;
+}
+
+UINT FreeListAllocator::LargestFreeBlock() const
+{
+	return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+UINT FreeListAllocator::FreeBlockCount() const
+{
+	return static_cast<UINT>(freeBlocks.size());
+}
+
+float FreeListAllocator::Fragmentation() const
+{
+	const UINT free = capacity - used;
+	if (free == 0)
+		return 0.0f;
+	return 1.0f - static_cast<float>(LargestFreeBlock()) / free;
+}
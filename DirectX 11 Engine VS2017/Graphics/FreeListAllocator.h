@@ -0,0 +1,74 @@
+#pragma once
+#include "../Platform.h"
+#include <map>
+#include <vector>
+
+// Names an allocation of a FreeListAllocator. The offset behind it may
+// change when the allocator compacts, the handle stays the same.
+struct HeapHandle
+{
+	UINT index = 0xFFFFFFFF;
+	UINT generation = 0;
+
+	bool IsValid() const { return index != 0xFFFFFFFF; }
+};
+
+// Best-fit allocator over a range of `capacity` units, with free blocks
+// kept sorted by offset so neighbours coalesce on Free. CompactStep slides
+// allocations down one at a time; the caller copies the data it reports.
+class FreeListAllocator
+{
+public:
+	struct Move
+	{
+		HeapHandle handle;
+		UINT from = 0;
+		UINT to = 0;
+		UINT size = 0;
+	};
+
+	void Reset(UINT capacity);
+	// Adds free space at the end.
+	void Grow(UINT capacity);
+
+	// Returns an invalid handle when no free block is large enough.
+	HeapHandle Allocate(UINT size);
+	void Free(HeapHandle handle);
+	bool IsLive(HeapHandle handle) const;
+	UINT Offset(HeapHandle handle) const;
+	UINT Size(HeapHandle handle) const;
+
+	// Moves the allocation right after the lowest free block to the start
+	// of that block. Returns false when there is no gap left to close.
+	bool CompactStep(Move& move);
+
+	UINT Capacity() const;
+	UINT UsedSize() const;
+	UINT LargestFreeBlock() const;
+	UINT FreeBlockCount() const;
+	// 0 when all free space is one block, close to 1 when it is scattered.
+	float Fragmentation() const;
+
+private:
+	struct Entry
+	{
+		UINT offset = 0;
+		UINT size = 0;
+		UINT generation = 0;
+		bool live = false;
+	};
+
+	void InsertFree(UINT offset, UINT size);
+	void EraseFree(std::map<UINT, UINT>::iterator block);
+	const Entry* Find(HeapHandle handle) const;
+
+	UINT capacity = 0;
+	UINT used = 0;
+	std::vector<Entry> entries;
+	std::vector<UINT> unusedEntries;
+	// offset -> size, and size -> offset for the best-fit search.
+	std::map<UINT, UINT> freeBlocks;
+	std::multimap<UINT, UINT> freeBySize;
+	// offset -> entry index of every live allocation.
+	std::map<UINT, UINT> allocations;
+};
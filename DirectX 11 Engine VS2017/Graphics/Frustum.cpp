@@ -0,0 +1,50 @@
+#include "Frustum.h"
+using namespace DirectX;
+
+void AABB::Expand(const XMFLOAT3& p)
+{
+	if (p.x < min.x) min.x = p.x;
+	if (p.y < min.y) min.y = p.y;
+	if (p.z < min.z) min.z = p.z;
+	if (p.x > max.x) max.x = p.x;
+	if (p.y > max.y) max.y = p.y;
+	if (p.z > max.z) max.z = p.z;
+}
+
+bool AABB::IsEmpty() const
+{
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+Frustum::Frustum(const XMMATRIX& viewProjection)
+{
+	// Row-vector convention (v * M): clip = dot(v, column_j), so the planes
+	// are sums/differences of the matrix columns, i.e. rows of the transpose.
+	const XMMATRIX m = XMMatrixTranspose(viewProjection);
+
+	XMStoreFloat4(&planes[LEFT], XMPlaneNormalize(m.r[3] + m.r[0]));
+	XMStoreFloat4(&planes[RIGHT], XMPlaneNormalize(m.r[3] - m.r[0]));
+	XMStoreFloat4(&planes[BOTTOM], XMPlaneNormalize(m.r[3] + m.r[1]));
+	XMStoreFloat4(&planes[TOP], XMPlaneNormalize(m.r[3] - m.r[1]));
+	// D3D clip space depth is [0, w].
+	XMStoreFloat4(&planes[NEAR_PLANE], XMPlaneNormalize(m.r[2]));
+	XMStoreFloat4(&planes[FAR_PLANE], XMPlaneNormalize(m.r[3] - m.r[2]));
+}
+
+bool Frustum::Intersects(const AABB& box) const
+{
+	if (box.IsEmpty())
+		return false;
+
+	for (int i = 0; i < PLANE_COUNT; ++i)
+	{
+		const XMFLOAT4& p = planes[i];
+		// Corner furthest along the plane normal.
+		const float x = p.x >= 0 ? box.max.x : box.min.x;
+		const float y = p.y >= 0 ? box.max.y : box.min.y;
+		const float z = p.z >= 0 ? box.max.z : box.min.z;
+		if (p.x * x + p.y * y + p.z * z + p.w < 0)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "../Math/VectorMath.h"
+#include <cfloat>
+
+struct AABB
+{
+	DirectX::XMFLOAT3 min = { +FLT_MAX, +FLT_MAX, +FLT_MAX };
+	DirectX::XMFLOAT3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	void Expand(const DirectX::XMFLOAT3& p);
+	bool IsEmpty() const;
+};
+
+class Frustum
+{
+public:
+	Frustum() = default;
+	// Extracts the six clip planes from a (world *) view * projection matrix.
+	// Planes end up in the space the matrix transforms from, so passing
+	// world * view * projection lets boxes be tested in object space.
+	explicit Frustum(const DirectX::XMMATRIX& viewProjection);
+
+	bool Intersects(const AABB& box) const;
+
+private:
+	enum { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+	DirectX::XMFLOAT4 planes[PLANE_COUNT];
+};
@@ -0,0 +1,179 @@
+#include "GeometryHeap.h"
+#include "../ErrorLogger.h"
+#include <algorithm>
+
+namespace
+{
+	// Moves go over in pieces of this size.
+	const UINT scratchBytes = 64 * 1024;
+}
+
+GeometryHeap::~GeometryHeap()
+{
+	if (device)
+	{
+		device->ReleaseBuffer(vertexBuffer);
+		device->ReleaseBuffer(indexBuffer);
+		device->ReleaseBuffer(scratchBuffer);
+	}
+}
+
+HRESULT GeometryHeap::Initialize(RenderDevice* device, UploadRing* uploads, UINT vertexCapacity, UINT indexCapacity)
+{
+	this->device = device;
+	this->uploads = uploads;
+	vertexAllocator.Reset(0);
+	indexAllocator.Reset(0);
+
+	BufferDesc desc;
+	desc.type = BufferType::VERTEX;
+	desc.byteWidth = scratchBytes;
+	desc.dynamic = false;
+	HRESULT hr = device->CreateBuffer(desc, nullptr, &scratchBuffer);
+	if (FAILED(hr))
+		return hr;
+	hr = Grow(vertexBuffer, vertexAllocator, BufferType::VERTEX, sizeof(VertexCommon), vertexCapacity);
+	if (FAILED(hr))
+		return hr;
+	return Grow(indexBuffer, indexAllocator, BufferType::INDEX, sizeof(DWORD), indexCapacity);
+}
+
+HRESULT GeometryHeap::Grow(DeviceBuffer*& buffer, FreeListAllocator& allocator, BufferType type, UINT elementSize, UINT capacity)
+{
+	BufferDesc desc;
+	desc.type = type;
+	desc.byteWidth = elementSize * capacity;
+	desc.dynamic = false;
+
+	DeviceBuffer* grown = nullptr;
+	HRESULT hr = device->CreateBuffer(desc, nullptr, &grown);
+	if (FAILED(hr))
+		return hr;
+
+	// Offsets don't change, so handles stay valid across the copy.
+	if (buffer && allocator.Capacity() > 0)
+		device->CopyBuffer(grown, 0, buffer, 0, elementSize * allocator.Capacity());
+	device->ReleaseBuffer(buffer);
+	buffer = grown;
+	allocator.Grow(capacity);
+	return S_OK;
+}
+
+HeapHandle GeometryHeap::AllocateOrGrow(DeviceBuffer*& buffer, FreeListAllocator& allocator, BufferType type, UINT elementSize, UINT count)
+{
+	HeapHandle handle = allocator.Allocate(count);
+	if (handle.IsValid())
+		return handle;
+
+	// Double, or more if a single curve needs it; the new space joins the
+	// free block at the end, if there is one.
+	const UINT capacity = (std::max)(allocator.Capacity() * 2, allocator.Capacity() + count);
+	HRESULT hr = Grow(buffer, allocator, type, elementSize, capacity);
+	if (FAILED(hr))
+	{
+		ErrorLogger::Log(hr, "Failed to grow geometry heap.");
+		return handle;
+	}
+	return allocator.Allocate(count);
+}
+
+HRESULT GeometryHeap::Add(const VertexCommon* vertices, UINT numVertices, const DWORD* indices, UINT numIndices, GeometryHandle& handle)
+{
+	Remove(handle);
+	if (numVertices == 0 || numIndices == 0)
+		return E_INVALIDARG;
+
+	handle.vertices = AllocateOrGrow(vertexBuffer, vertexAllocator, BufferType::VERTEX, sizeof(VertexCommon), numVertices);
+	handle.indices = AllocateOrGrow(indexBuffer, indexAllocator, BufferType::INDEX, sizeof(DWORD), numIndices);
+	if (!handle.vertices.IsValid() || !handle.indices.IsValid())
+	{
+		Remove(handle);
+		return E_OUTOFMEMORY;
+	}
+
+	HRESULT hr = uploads->Upload(vertexBuffer, sizeof(VertexCommon) * vertexAllocator.Offset(handle.vertices), vertices, sizeof(VertexCommon) * numVertices);
+	if (SUCCEEDED(hr))
+		hr = uploads->Upload(indexBuffer, sizeof(DWORD) * indexAllocator.Offset(handle.indices), indices, sizeof(DWORD) * numIndices);
+	if (FAILED(hr))
+		Remove(handle);
+	return hr;
+}
+
+void GeometryHeap::Remove(GeometryHandle& handle)
+{
+	vertexAllocator.Free(handle.vertices);
+	indexAllocator.Free(handle.indices);
+	handle = GeometryHandle();
+}
+
+void GeometryHeap::MoveRange(DeviceBuffer* buffer, UINT elementSize, const FreeListAllocator::Move& move)
+{
+	// Out to the scratch buffer and back, a piece at a time. Ranges only
+	// move towards the start, so going front first never overwrites a piece
+	// before it has been read.
+	const UINT size = elementSize * move.size;
+	const UINT from = elementSize * move.from;
+	const UINT to = elementSize * move.to;
+	for (UINT done = 0; done < size; done += scratchBytes)
+	{
+		const UINT piece = (std::min)(scratchBytes, size - done);
+		device->CopyBuffer(scratchBuffer, 0, buffer, from + done, piece);
+		device->CopyBuffer(buffer, to + done, scratchBuffer, 0, piece);
+	}
+	movedBytes += size;
+}
+
+void GeometryHeap::Defragment(UINT budgetBytes)
+{
+	movedBytes = 0;
+	FreeListAllocator::Move move;
+	while (movedBytes < budgetBytes && vertexAllocator.Fragmentation() > 0.0f && vertexAllocator.CompactStep(move))
+		MoveRange(vertexBuffer, sizeof(VertexCommon), move);
+	while (movedBytes < budgetBytes && indexAllocator.Fragmentation() > 0.0f && indexAllocator.CompactStep(move))
+		MoveRange(indexBuffer, sizeof(DWORD), move);
+}
+
+DeviceBuffer* GeometryHeap::VertexBuffer() const
+{
+	return vertexBuffer;
+}
+
+DeviceBuffer* GeometryHeap::IndexBuffer() const
+{
+	return indexBuffer;
+}
+
+UINT GeometryHeap::VertexStride() const
+{
+	return sizeof(VertexCommon);
+}
+
+int GeometryHeap::BaseVertex(const GeometryHandle& handle) const
+{
+	return static_cast<int>(vertexAllocator.Offset(handle.vertices));
+}
+
+UINT GeometryHeap::FirstIndex(const GeometryHandle& handle) const
+{
+	return indexAllocator.Offset(handle.indices);
+}
+
+UINT GeometryHeap::IndexCount(const GeometryHandle& handle) const
+{
+	return indexAllocator.Size(handle.indices);
+}
+
+const FreeListAllocator& GeometryHeap::Vertices() const
+{
+	return vertexAllocator;
+}
+
+const FreeListAllocator& GeometryHeap::Indices() const
+{
+	return indexAllocator;
+}
+
+UINT GeometryHeap::MovedBytesLastFrame() const
+{
+	return movedBytes;
+}
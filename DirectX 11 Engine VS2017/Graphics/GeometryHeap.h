@@ -0,0 +1,64 @@
+#pragma once
+#include "RenderDevice.h"
+#include "FreeListAllocator.h"
+#include "UploadRing.h"
+#include "Vertex.h"
+
+// Vertex and index ranges of one piece of geometry in a GeometryHeap.
+struct GeometryHandle
+{
+	HeapHandle vertices;
+	HeapHandle indices;
+};
+
+// One static vertex buffer and one static index buffer shared by many
+// curves. Geometry is added and removed without creating buffers; indices
+// stay relative to the geometry's first vertex and are drawn with its base
+// vertex. Defragment slides geometry towards the start of the buffers a
+// little every frame, and handles keep working while it does. D3D11 drops
+// copies within one buffer, so moved geometry goes through a small scratch
+// buffer.
+class GeometryHeap
+{
+public:
+	GeometryHeap() {}
+	~GeometryHeap();
+
+	HRESULT Initialize(RenderDevice* device, UploadRing* uploads, UINT vertexCapacity, UINT indexCapacity);
+
+	// Grows the buffers when the geometry doesn't fit.
+	HRESULT Add(const VertexCommon* vertices, UINT numVertices, const DWORD* indices, UINT numIndices, GeometryHandle& handle);
+	void Remove(GeometryHandle& handle);
+
+	// Moves geometry until about budgetBytes have been copied. Call before
+	// recording draws, the offsets of moved geometry change.
+	void Defragment(UINT budgetBytes);
+
+	DeviceBuffer* VertexBuffer() const;
+	DeviceBuffer* IndexBuffer() const;
+	UINT VertexStride() const;
+	int BaseVertex(const GeometryHandle& handle) const;
+	UINT FirstIndex(const GeometryHandle& handle) const;
+	UINT IndexCount(const GeometryHandle& handle) const;
+
+	const FreeListAllocator& Vertices() const;
+	const FreeListAllocator& Indices() const;
+	UINT MovedBytesLastFrame() const;
+
+private:
+	GeometryHeap(const GeometryHeap& rhs);
+	GeometryHeap& operator=(const GeometryHeap& rhs);
+
+	HRESULT Grow(DeviceBuffer*& buffer, FreeListAllocator& allocator, BufferType type, UINT elementSize, UINT capacity);
+	void MoveRange(DeviceBuffer* buffer, UINT elementSize, const FreeListAllocator::Move& move);
+	HeapHandle AllocateOrGrow(DeviceBuffer*& buffer, FreeListAllocator& allocator, BufferType type, UINT elementSize, UINT count);
+
+	RenderDevice* device = nullptr;
+	UploadRing* uploads = nullptr;
+	DeviceBuffer* vertexBuffer = nullptr;
+	DeviceBuffer* indexBuffer = nullptr;
+	DeviceBuffer* scratchBuffer = nullptr;
+	FreeListAllocator vertexAllocator;
+	FreeListAllocator indexAllocator;
+	UINT movedBytes = 0;
+};
@@ -1,13 +1,99 @@
 #include "Graphics.h"
+#include "ImageWriter.h"
+#include "../Math/MathKernels.h"
+#include "../Jobs/JobSystem.h"
 #include <sstream>
 #include <iomanip>
+#include <cfloat>
 #include <cmath>
 #include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
 
-auto lerp = [](float a, float b, float f) -> float
+namespace
 {
-	return a + f * (b - a);
-};
+	// The uniform-phi curve serves as the dense reference polyline. `dense`
+	// is scratch and keeps its capacity from one call to the next.
+	float ResampleCurve(const CurveParams& params, const XMFLOAT4& color, UINT numVertices, std::vector<VertexCommon>& dense, std::vector<VertexCommon>& out)
+	{
+		dense.resize(CurveVertexCount(params));
+		GenerateCurve(params, color, std::span<VertexCommon>(dense.data(), dense.size()));
+		out.resize(std::min<size_t>(numVertices, dense.size()));
+		return ResampleByArcLength(dense.data(), dense.size(), out.data(), out.size());
+	}
+
+	// Counts a pipeline from its start until its coroutine returns or is
+	// destroyed.
+	class PipelineCount
+	{
+	public:
+		explicit PipelineCount(std::atomic<unsigned int>& count) : count(count)
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		~PipelineCount()
+		{
+			count.fetch_sub(1, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<unsigned int>& count;
+	};
+
+	// Runs `release` once on the update thread: right there when Release is
+	// called on it, or posted to it when the lease is destroyed first, as
+	// it is with a cancelled pipeline, on whichever thread that happens.
+	class UpdateLease
+	{
+	public:
+		UpdateLease(TaskQueue& updateTasks, std::function<void()> release) : updateTasks(updateTasks), release(std::move(release)) {}
+
+		~UpdateLease()
+		{
+			if (release)
+				updateTasks.Push(std::move(release));
+		}
+
+		void Release()
+		{
+			std::function<void()> run = std::move(release);
+			release = nullptr;
+			if (run)
+				run();
+		}
+
+	private:
+		UpdateLease(const UpdateLease& rhs);
+		UpdateLease& operator=(const UpdateLease& rhs);
+
+		TaskQueue& updateTasks;
+		std::function<void()> release;
+	};
+}
+
+Graphics::~Graphics()
+{
+	// Regenerations in flight are cancelled and freed the next time they
+	// would move on, so the queues they wait in have to keep moving. Once
+	// the render thread is gone this thread runs its tasks. Curves waiting
+	// for their graph never start.
+	for (Model* model : { &arhimedesModel, &fermatModel, &lemniscateOfBernoulliModel })
+	{
+		model->curvePending = false;
+		model->regeneration.Cancel();
+	}
+	StopRenderThread();
+	while (curvePipelines.load(std::memory_order_acquire) > 0)
+	{
+		updateTasks.Run();
+		RunRenderTasks();
+		std::this_thread::yield();
+	}
+}
 
 bool Graphics::Initialize(HWND hwnd, int width, int height)
 {
@@ -25,6 +111,33 @@ bool Graphics::Initialize(HWND hwnd, int width, int height)
 	return true;
 }
 
+void Graphics::StartRenderThread()
+{
+	if (renderThread.joinable())
+		return;
+	rendering.store(true, std::memory_order_release);
+	renderThread = std::thread([this]() { RenderLoop(); });
+}
+
+void Graphics::StopRenderThread()
+{
+	if (!renderThread.joinable())
+		return;
+	rendering.store(false, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(renderWakeMutex);
+	}
+	renderWake.notify_one();
+	renderThread.join();
+}
+
+bool Graphics::NeedsContinuousFrames() const
+{
+	// Regenerations in flight move on a frame at a time.
+	return !renderOnDemand || animatedCurve.IsPlaying() || animatedCurve.IsStreaming() ||
+		curvePipelines.load(std::memory_order_relaxed) > 0;
+}
+
 void Graphics::RenderFunctionsImGui()
 {
 	ImGui_ImplDX11_NewFrame();
@@ -36,6 +149,26 @@ void Graphics::RenderFunctionsImGui()
 
 	ImGui::Checkbox("Render X-Y Axis", &renderXYaxis);
 	ImGui::Checkbox("Render X-Z Axis", &renderXZaxis);
+	ImGui::Checkbox("Render on demand", &renderOnDemand);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Sleep while the camera, the parameters and the UI don't change");
+	const RenderStats& stats = feedback.stats;
+	ImGui::Text("Last frame: %u draws, %u state changes, %u maps, %.1f KB uploaded",
+		stats.draws, stats.stateChanges, stats.maps, stats.uploadedBytes / 1024.0);
+	ImGui::Text("Draw commands: %u, redundant bindings skipped: %u", feedback.drawCommands, feedback.skippedBindings);
+	if (renderDevice->SupportsConstantBufferOffsets())
+		ImGui::Text("Constant arena: %.1f / %.1f KB", feedback.arenaBytes / 1024.0, feedback.arenaCapacity / 1024.0);
+	else
+		ImGui::Text("Constant arena: unsupported, one buffer per model");
+	ImGui::Text("Upload ring: %.1f / %.1f MB in flight, %u uploads around it",
+		feedback.ringUsed / (1024.0 * 1024.0), feedback.ringCapacity / (1024.0 * 1024.0), feedback.ringFallbacks);
+	RenderGridImGui();
+	RenderStrokeImGui();
+	RenderMemoryImGui();
+	RenderMathImGui();
+	RenderJobsImGui();
+	RenderCurveGraphImGui();
+	RenderExportImGui();
 	ImGui::NewLine();
 
 	if (ImGui::BeginMenuBar())
@@ -71,8 +204,12 @@ void Graphics::RenderFunctionsImGui()
 		ImGui::SliderFloat("Z", &zCoord, -15.0f, +15.0f);
 		static bool enableSpherical = 0;
 		ImGui::Checkbox("Enable spherical coordinates", &enableSpherical);
-		arhimedesModel.cb.data.enableSpherical = enableSpherical;
+		sphericalCoordinates[ARHIMEDES] = enableSpherical;
+		RenderSamplingImGui();
+		RenderAccuracyImGui(CurveType::ARHIMEDES);
 		if (ImGui::Button("Apply changes")) UpdateArhimedesModel(param[A], param[MIN], param[MAX], color);
+		RenderFamilyImGui(MakeCurveParams(CurveType::ARHIMEDES, param[A], param[MIN], param[MAX]));
+		RenderAnimationImGui(MakeCurveParams(CurveType::ARHIMEDES, param[A], param[MIN], param[MAX]), color);
 	}
 	break;
 
@@ -93,8 +230,12 @@ void Graphics::RenderFunctionsImGui()
 		ImGui::SliderFloat("Z", &zCoord, -15.0f, +15.0f);
 		static bool enableSpherical = 0;
 		ImGui::Checkbox("Enable spherical coordinates", &enableSpherical);
-		fermatModel.cb.data.enableSpherical = enableSpherical;
+		sphericalCoordinates[FERMAT] = enableSpherical;
+		RenderSamplingImGui();
+		RenderAccuracyImGui(CurveType::FERMAT);
 		if (ImGui::Button("Apply changes")) UpdateFermatModel(param[A], param[MIN], param[MAX], color);
+		RenderFamilyImGui(MakeCurveParams(CurveType::FERMAT, param[A], param[MIN], param[MAX]));
+		RenderAnimationImGui(MakeCurveParams(CurveType::FERMAT, param[A], param[MIN], param[MAX]), color);
 	}
 	break;
 
@@ -116,8 +257,12 @@ void Graphics::RenderFunctionsImGui()
 		ImGui::SliderFloat("Z", &zCoord, -15.0f, +15.0f);
 		static bool enableSpherical = 0;
 		ImGui::Checkbox("Enable spherical coordinates", &enableSpherical);
-		lemniscateOfBernoulliModel.cb.data.enableSpherical = enableSpherical;
+		sphericalCoordinates[BERNOULLI] = enableSpherical;
+		RenderSamplingImGui();
+		RenderAccuracyImGui(CurveType::BERNOULLI);
 		if (ImGui::Button("Apply changes")) UpdateLemniscateOfBernoulliModel(param[A], param[MIN], param[MAX], scale, color);
+		RenderFamilyImGui(MakeCurveParams(CurveType::BERNOULLI, param[A], param[MIN], param[MAX], scale));
+		RenderAnimationImGui(MakeCurveParams(CurveType::BERNOULLI, param[A], param[MIN], param[MAX], scale), color);
 	}
 	break;
 
@@ -126,321 +271,1199 @@ void Graphics::RenderFunctionsImGui()
 	default:
 		break;
 	}
+	if (const Model* model = GetFunctionModel())
+	{
+		ImGui::Text("Arc length: %f;    vertices: %u", model->arcLength, model->curveVertices);
+		ImGui::Text("Regenerations in flight: %u", curvePipelines.load(std::memory_order_relaxed));
+		if (!model->curveBounds.IsEmpty())
+			ImGui::Text("Bounds: x %.3f .. %.3f;    y %.3f .. %.3f", model->curveBounds.min.x, model->curveBounds.max.x,
+				model->curveBounds.min.y, model->curveBounds.max.y);
+		ImGui::Text("Visible chunks: %u / %u", feedback.visibleChunks, feedback.totalChunks);
+	}
 	ImGui::NewLine();
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	ImGui::Text("Render thread: %.3f ms between presents, %llu frames", feedback.presentIntervalMs, feedback.framesRendered);
+	RenderTimingImGui();
 	ImGui::NewLine();
 	ImGui::Text("Camera control: [WASD] [Space] [Z] [Hold right mouse button]");
 	ImGui::End();
 
 	ImGui::Render();
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 }
 
-void Graphics::InitArhimedeslModel()
+CurveParams Graphics::MakeCurveParams(CurveType type, float a, float t_min, float t_max, float phi_scale) const
+{
+	CurveParams params;
+	params.type = type;
+	params.a = a;
+	params.t_min = t_min;
+	params.t_max = t_max;
+	params.phi_scale = phi_scale;
+	params.z = zCoord;
+	params.t_num = static_cast<unsigned int>(t_num);
+	params.accuracy = curveAccuracy[static_cast<int>(type)];
+	return params;
+}
+
+void Graphics::InitCurveModel(Model& model, const CurveParams& params, const std::string& name)
 {
-	Model& model = arhimedesModel;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
+	Model* target = &model;
+	model.residency = residency.Register(ResidencyCategory::CURVES, name, [this, target]() { EvictCurveModel(*target); });
+	model.vs = commonVS.Handle();
+	model.inputLayout = commonVS.LayoutHandle();
+	model.ps = coloredPS.Handle();
+	model.topology = PrimitiveTopology::LINE_STRIP;
 	model.transformatin = XMMatrixIdentity();
 
-	const float a = 0.33f;
-	float t_min = 0;
-	float t_max = 3.14f * 10.0;
+	const UINT numVertices = CurveVertexCount(params);
+	model.curveCapacity = numVertices;
+	model.derived = std::make_unique<CurveGraph>();
+	residency.SetBytes(model.residency, static_cast<unsigned long long>(numVertices) * (sizeof(VertexCommon) + sizeof(DWORD)));
+	HRESULT hr = model.vertices.Initialize(this->renderDevice.get(), nullptr, numVertices);
+	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create vertex buffer for " + name + ".");
+	else UpdateCurveModel(model, params, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), CurveSampling::UNIFORM_PHI);
+
+	std::vector<DWORD> indices(numVertices);
+	std::iota(indices.begin(), indices.end(), 0);
 
-	std::vector<VertexCommon> vertices;
-	for (int i = 0; i < t_num; ++i)
+	hr = model.indices.Initialize(this->renderDevice.get(), indices.data(), indices.size());
+	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create indices buffer for " + name + ".");
+
+	hr = model.cb.Initialize(this->renderDevice.get());
+	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create constant buffer for " + name + ".");
+}
+
+void Graphics::UpdateCurveModel(Model& model, const CurveParams& params, const XMFLOAT4& color, CurveSampling sampling)
+{
+	if (!residency.IsResident(model.residency))
+		RestoreCurveModel(model);
+
+	model.curve = params;
+	model.curveColor = color;
+	model.curveSampling = sampling;
+
+	CurveInputs inputs;
+	inputs.params = params;
+	inputs.color = color;
+	inputs.sampling.sampling = sampling;
+	inputs.sampling.vertices = sampling == CurveSampling::ARC_LENGTH ? arcLengthVertices : 0;
+	inputs.chunkSize = curveChunkSize;
+	inputs.simplifyTolerance = simplifyTolerance;
+
+	// A newer curve makes the one in flight worthless. If it is still
+	// evaluating the graph, the new one waits for it to finish rather than
+	// evaluate the same graph alongside; only the newest curve waits.
+	model.regeneration.Cancel();
+	if (model.evaluating)
 	{
-		const float t = lerp(t_min, t_max, i / t_num);
+		model.curvePending = true;
+		model.pendingCurve = inputs;
+		return;
+	}
+	StartCurveRegeneration(model, inputs);
+}
+
+void Graphics::StartCurveRegeneration(Model& model, const CurveInputs& inputs)
+{
+	model.regeneration = CancelToken();
+	model.evaluating = true;
+	RegenerateCurve(&model, inputs, model.regeneration);
+}
 
-		const float phi = t;
-		const float r = a * phi;
-		float x = r * cos(phi);
-		float y = r * sin(phi);
-		float z = zCoord;
+void Graphics::FinishCurveEvaluation(Model& model)
+{
+	model.evaluating = false;
+	if (!model.curvePending)
+		return;
+	model.curvePending = false;
+	StartCurveRegeneration(model, model.pendingCurve);
+}
 
-		vertices.emplace_back(x, y, z);
+Pipeline Graphics::RegenerateCurve(Model* model, CurveInputs inputs, CancelToken token)
+{
+	const PipelineCount counted(curvePipelines);
+	// Gives the graph back however the pipeline ends. Nothing is locked
+	// while it evaluates: the graph waits for jobs, and a thread waiting
+	// for jobs runs whatever others are queued, so it could come back for
+	// a lock it already holds.
+	UpdateLease graphLease(updateTasks, [this, model]() { FinishCurveEvaluation(*model); });
+
+	// Only what changed since the model's last evaluation is computed.
+	co_await ResumeOnJobs(token);
+	CurveProducts products;
+	model->derived->Evaluate(inputs, products);
+	const std::vector<XMFLOAT3>& points = *products.points;
+
+	// Publish on the update thread, which owns the model's curve data.
+	co_await ResumeOn(updateTasks, token);
+	graphLease.Release();
+	curveGraphHistory.Record(products.nodes);
+	if (points.size() > model->curveCapacity)
+	{
+		// Its size, fixed at start-up, is all this side knows of the buffer.
+		ErrorLogger::Log("Curve doesn't fit into its vertex buffer.");
+		model->curveVertices = 0;
+		co_return;
+	}
+	model->curveVertices = static_cast<UINT>(points.size());
+	model->arcLength = products.arcLength;
+	model->curveBounds = products.bounds;
+	model->curvePoints = products.simplified;
+	strokeDirty = true;
+
+	// Pack the points straight into the buffer on the render thread, which
+	// owns it and maps it, before it draws its next frame. Packing runs on
+	// this thread alone: waiting for jobs here could stall the frame behind
+	// other work on the workers.
+	co_await ResumeOn(renderTasks, token);
+	std::span<VertexCommon> mapped;
+	HRESULT hr = model->vertices.Map(MapMode::WRITE_DISCARD, mapped);
+	if (FAILED(hr))
+	{
+		ErrorLogger::Log(hr, "Failed to map curve vertex buffer.");
+		co_return;
 	}
+	const UINT count = static_cast<UINT>((std::min)(points.size(), mapped.size()));
+	PackCurveVertices(points.data(), count, inputs.color, mapped.data());
+	model->vertices.Unmap(count);
+	model->chunks = *products.chunks;
+}
 
-	HRESULT hr = model.vertices.Initialize(this->device.Get(), vertices.data(), vertices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create vertex buffer for ArhimedeslModel.");
+void Graphics::EvictCurveModel(Model& model)
+{
+	// The parameters and points stay on this side to rebuild it from.
+	model.regeneration.Cancel();
+	model.curvePending = false;
+	model.curveVertices = 0;
+	Model* target = &model;
+	renderTasks.Push([target]()
+	{
+		target->vertices.Release();
+		target->indices.Release();
+		target->cb.Release();
+		target->chunks.clear();
+	});
+}
 
-	std::vector<DWORD> indices(vertices.size());
-	std::iota(indices.begin(), indices.end(), 0);
+void Graphics::RestoreCurveModel(Model& model)
+{
+	// Only the buffers: the caller uploads the curve into them next.
+	Model* target = &model;
+	const UINT numVertices = model.curveCapacity;
+	renderTasks.Push([this, target, numVertices]()
+	{
+		std::vector<DWORD> indices(numVertices);
+		std::iota(indices.begin(), indices.end(), 0);
+
+		HRESULT hr = target->vertices.Initialize(this->renderDevice.get(), nullptr, numVertices);
+		if (SUCCEEDED(hr))
+			hr = target->indices.Initialize(this->renderDevice.get(), indices.data(), numVertices);
+		if (SUCCEEDED(hr))
+			hr = target->cb.Initialize(this->renderDevice.get());
+		if (FAILED(hr))
+			ErrorLogger::Log(hr, "Failed to restore curve buffers.");
+	});
+	residency.MarkResident(model.residency);
+}
 
-	hr = model.indices.Initialize(this->device.Get(), indices.data(), indices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create indices buffer for ArhimedeslModel.");
+void Graphics::RenderSamplingImGui()
+{
+	int sampling = static_cast<int>(curveSampling);
+	ImGui::Combo("Sampling", &sampling, "Uniform phi\0Equal arc length\0");
+	curveSampling = static_cast<CurveSampling>(sampling);
+	if (curveSampling == CurveSampling::ARC_LENGTH)
+		ImGui::SliderInt("Arc-length vertices", &arcLengthVertices, 100, static_cast<int>(t_num));
+}
 
-	hr = model.cb.Initialize(this->device.Get(), this->deviceContext.Get());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create constant buffer for ArhimedeslModel.");
+void Graphics::RenderAccuracyImGui(CurveType type)
+{
+	int accuracy = static_cast<int>(curveAccuracy[static_cast<int>(type)]);
+	ImGui::Combo("Math accuracy", &accuracy, "Precise (1 ulp)\0Standard (4 ulp)\0Fast\0");
+	curveAccuracy[static_cast<int>(type)] = static_cast<MathAccuracy>(accuracy);
+}
+
+void Graphics::InitArhimedeslModel()
+{
+	InitCurveModel(arhimedesModel, MakeCurveParams(CurveType::ARHIMEDES, 0.33f, 0.0f, 3.14f * 10.0f), "ArhimedeslModel");
 }
 
 void Graphics::UpdateArhimedesModel(float a, float t_min, float t_max, const XMFLOAT4& color)
 {
-	Model& model = arhimedesModel;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINESTRIP;
-	model.transformatin = XMMatrixIdentity();
+	UpdateCurveModel(arhimedesModel, MakeCurveParams(CurveType::ARHIMEDES, a, t_min, t_max), color, curveSampling);
+}
+
+void Graphics::InitFermatModel()
+{
+	InitCurveModel(fermatModel, MakeCurveParams(CurveType::FERMAT, 2.5f, 0.0f, 3.14f * 10.0f), "FermatModel");
+}
 
-	std::vector<VertexCommon> vertices;
-	for (int i = 0; i < t_num; ++i)
+void Graphics::UpdateFermatModel(float a, float t_min, float t_max, const XMFLOAT4& color)
+{
+	UpdateCurveModel(fermatModel, MakeCurveParams(CurveType::FERMAT, a, t_min, t_max), color, curveSampling);
+}
+
+void Graphics::InitLemniscateOfBernoulliModel()
+{
+	// r^2 = a^2 * cos(2*phi)
+	InitCurveModel(lemniscateOfBernoulliModel, MakeCurveParams(CurveType::BERNOULLI, 5.0f, 0.0f, 1000.0f, 2.0f), "LemniscateOfBernoulliModel");
+}
+
+void Graphics::UpdateLemniscateOfBernoulliModel(float a, float t_min, float t_max, float phi_scale, const XMFLOAT4& color)
+{
+	UpdateCurveModel(lemniscateOfBernoulliModel, MakeCurveParams(CurveType::BERNOULLI, a, t_min, t_max, phi_scale), color, curveSampling);
+}
+
+void Graphics::BuildCurveFamily(const CurveFamilyDesc& desc)
+{
+	ClearCurveFamily();
+	familyDesc = desc;
+
+	GenerateCurveFamily(desc, [this](const CurveFamilyBatch& batch)
 	{
-		const float t = lerp(t_min, t_max, i / t_num);
-		const float phi = t;
-		const float r = a * phi;
-		float x = r * cos(phi);
-		float y = r * sin(phi);
-		float z = zCoord;
+		// Members are separated by strip-cut indices so the whole batch is one draw.
+		std::shared_ptr<std::vector<DWORD>> indices = std::make_shared<std::vector<DWORD>>();
+		indices->reserve(static_cast<size_t>(batch.memberCount) * (batch.verticesPerMember + 1));
+		for (UINT member = 0; member < batch.memberCount; ++member)
+		{
+			if (member > 0)
+				indices->push_back(0xFFFFFFFF);
+			const DWORD first = member * batch.verticesPerMember;
+			for (UINT i = 0; i < batch.verticesPerMember; ++i)
+				indices->push_back(first + i);
+		}
+		// The batch storage is reused for the next batch.
+		std::shared_ptr<std::vector<VertexCommon>> vertices = std::make_shared<std::vector<VertexCommon>>(batch.vertices);
 
-		vertices.emplace_back(x, y, z, color.x, color.y, color.z, color.w);
+		familyMembers += batch.memberCount;
+		familyVertices += batch.vertices.size();
+		renderTasks.Push([this, vertices, indices]()
+		{
+			std::unique_ptr<Model> model = std::make_unique<Model>();
+			model->vs = commonVS.Handle();
+			model->inputLayout = commonVS.LayoutHandle();
+			model->ps = coloredPS.Handle();
+			model->topology = PrimitiveTopology::LINE_STRIP;
+			model->transformatin = XMMatrixIdentity();
+
+			// Batches come and go with every rebuild; they share the heap's
+			// buffers instead of creating their own.
+			model->heap = &geometryHeap;
+			HRESULT hr = geometryHeap.Add(vertices->data(), static_cast<UINT>(vertices->size()),
+				indices->data(), static_cast<UINT>(indices->size()), model->geometry);
+			if (FAILED(hr))
+			{
+				ErrorLogger::Log(hr, "Failed to add curve family to the geometry heap.");
+				return;
+			}
+
+			// The constants go to the arena when the device can bind them from
+			// there; a batch only needs a buffer of its own otherwise.
+			if (!renderDevice->SupportsConstantBufferOffsets())
+			{
+				hr = model->cb.Initialize(this->renderDevice.get());
+				if (FAILED(hr))
+				{
+					ErrorLogger::Log(hr, "Failed to create constant buffer for curve family.");
+					return;
+				}
+			}
+			familyBatches.push_back(std::move(model));
+		});
+	});
+}
+
+void Graphics::ClearCurveFamily()
+{
+	familyMembers = 0;
+	familyVertices = 0;
+	renderTasks.Push([this]() { familyBatches.clear(); });
+}
+
+void Graphics::RenderFamilyImGui(const CurveParams& base)
+{
+	if (!ImGui::CollapsingHeader("Parameter sweep"))
+		return;
+
+	static CurveFamilyDesc desc;
+	static int samples = 10000;
+	static int palette = 0;
+
+	ImGui::DragFloatRange2("a range", &desc.aMin, &desc.aMax, 0.01f, -3.14f*3.0f, 3.14f*3.0f);
+	ImGui::SliderFloat("a step", &desc.aStep, 0.001f, 1.0f, "%.3f");
+	ImGui::SliderInt("Samples per member", &samples, 100, 100000);
+	ImGui::Combo("Palette", &palette, "Rainbow\0Heat\0Grayscale\0");
+	ImGui::Text("Members: %u", CurveFamilyMemberCount(desc));
+
+	if (ImGui::Button("Build family"))
+	{
+		desc.base = base;
+		desc.base.t_num = samples;
+		desc.palette = static_cast<Palette>(palette);
+		BuildCurveFamily(desc);
 	}
+	ImGui::SameLine();
+	if (ImGui::Button("Clear family")) ClearCurveFamily();
+	ImGui::Text("Family: %u members, %llu vertices, %u draw calls", familyMembers, familyVertices, feedback.familyBatches);
+	ImGui::Text("Geometry heap: %.1f / %.1f MB, %u free blocks, %.0f%% fragmented, %.1f KB moved",
+		feedback.heapUsed * sizeof(VertexCommon) / (1024.0 * 1024.0), feedback.heapCapacity * sizeof(VertexCommon) / (1024.0 * 1024.0),
+		feedback.heapFreeBlocks, feedback.heapFragmentation * 100.0f, feedback.heapMovedBytes / 1024.0);
+}
 
-	model.vertices.Update(deviceContext.Get(), vertices.data(), vertices.size());
+void Graphics::RenderAnimationImGui(const CurveParams& base, const XMFLOAT4& color)
+{
+	if (!ImGui::CollapsingHeader("Animation"))
+		return;
+
+	static float aRange[2] = { 0.1f, 3.0f };
+	static float aSpeed = 0.5f;
+	static float tMaxRange[2] = { 0.0f, 3.14f*10.0f };
+	static float tMaxSpeed = 5.0f;
+	static bool loop = true;
+	static bool pingPong = true;
+	static int samples = 1000000;
+
+	ImGui::Checkbox("Animate a", &animatedCurve.animateA);
+	ImGui::DragFloatRange2("a keyframes", &aRange[0], &aRange[1], 0.01f, -3.14f*3.0f, 3.14f*3.0f);
+	ImGui::SliderFloat("a units/s", &aSpeed, 0.01f, 10.0f);
+	ImGui::Checkbox("Animate t_max", &animatedCurve.animateTMax);
+	ImGui::DragFloatRange2("t_max keyframes", &tMaxRange[0], &tMaxRange[1], 0.1f, -3.14f*100, 3.14f*100);
+	ImGui::SliderFloat("t_max units/s", &tMaxSpeed, 0.1f, 100.0f);
+	ImGui::Checkbox("Loop", &loop);
+	ImGui::SameLine();
+	ImGui::Checkbox("Ping-pong", &pingPong);
+	ImGui::SliderInt("Animation samples", &samples, 1000, 1000000);
+	ImGui::SliderFloat("Frame budget (ms)", &animationBudgetMs, 0.5f, 16.0f);
+
+	animatedCurve.aTrack.SetSweep(aRange[0], aRange[1], aSpeed);
+	animatedCurve.aTrack.looping = loop;
+	animatedCurve.aTrack.pingPong = pingPong;
+	animatedCurve.tMaxTrack.SetSweep(tMaxRange[0], tMaxRange[1], tMaxSpeed);
+	animatedCurve.tMaxTrack.looping = loop;
+	animatedCurve.tMaxTrack.pingPong = pingPong;
+
+	if (ImGui::Button(animatedCurve.IsPlaying() ? "Pause" : "Play"))
+	{
+		if (animatedCurve.IsPlaying())
+		{
+			animatedCurve.Pause();
+		}
+		else
+		{
+			CurveParams params = base;
+			params.t_num = samples;
+			animatedCurve.Play(params, color);
+		}
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Stop")) animatedCurve.Stop();
+
+	if (animatedCurve.IsActive())
+	{
+		const CurveParams& shown = animatedCurve.DisplayedParams();
+		ImGui::Text("t = %.2f s;    a = %f;    t_max = %f", animatedCurve.Time(), shown.a, shown.t_max);
+		ImGui::Text("Streamed %u vertices this frame, %.1f curve updates/s", animatedCurve.StreamedLastFrame(), animatedCurve.UpdatesPerSecond());
+	}
 }
 
-void Graphics::InitFermatModel()
+void Graphics::PublishFrame(float frameSeconds)
 {
-	Model& model = fermatModel;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINESTRIP;
-	model.transformatin = XMMatrixIdentity();
+	if (renderThread.joinable())
+	{
+		// Packets the render thread never takes are wasted work, so stay at
+		// most one ahead of it. The timeout keeps the window responsive if
+		// it ever stalls.
+		std::unique_lock<std::mutex> lock(pacingMutex);
+		pacing.wait_for(lock, std::chrono::milliseconds(100), [this]()
+		{
+			return packetsTaken.load(std::memory_order_acquire) >= packetsPublished;
+		});
+	}
+	curveGraphHistory.BeginFrame();
+	updateTasks.Run();
+	if (renderFeedback.Acquire())
+		feedback = renderFeedback.ReadBuffer();
+	updateTimes.Add(frameSeconds * 1000.0f);
+	float presentMs = 0.0f;
+	while (presentIntervals.TryPop(presentMs))
+		presentTimes.Add(presentMs);
+
+	RenderFunctionsImGui();
+	animatedCurve.Update(frameSeconds, animationBudgetMs);
 
-	float a = 2.5f;
-	float t_min = 0;
-	float t_max = 3.14f * 10.0;
+	// Render tasks posted above are run before this packet is drawn.
+	BuildFramePacket(framePackets.WriteBuffer());
+	framePackets.Publish();
 
-	std::vector<VertexCommon> vertices;
-	// - branch
-	for (int i = (t_num / 2) - 1; i >= 0; --i)
+	packetsAvailable.store(packetsPublished, std::memory_order_release);
 	{
-		const float t = lerp(t_min, t_max, i / (t_num/2));
-		const float phi = t;
-		const float r = a * -sqrt(phi);
-		const float x = r * cos(phi);
-		const float y = r * sin(phi);
-		const float z = zCoord;
-		vertices.emplace_back(x, y, z);
+		std::lock_guard<std::mutex> lock(renderWakeMutex);
 	}
-	// + branch
-	for (int i = 0; i < t_num/2; ++i)
+	renderWake.notify_one();
+}
+
+void Graphics::BuildFramePacket(FramePacket& packet)
+{
+	packet.sequence = ++packetsPublished;
+	packet.viewProjection = camera.GetViewProjectionMatrix();
+	packet.continuous = !renderOnDemand;
+	UpdateGrid(packet);
+
+	residency.BeginFrame();
+	packet.curves.clear();
+	if (Model* model = GetFunctionModel())
 	{
-		const float t = lerp(t_min, t_max, i / (t_num/2));
-		const float phi = t;
-		const float r = a * +sqrt(phi);
-		const float x = r * cos(phi);
-		const float y = r * sin(phi);
-		const float z = zCoord;
-		vertices.emplace_back(x, y, z);
+		// Regenerated from its parameters if it was evicted while hidden.
+		if (!residency.Touch(model->residency))
+		{
+			const CurveParams params = model->curve;
+			const XMFLOAT4 color = model->curveColor;
+			UpdateCurveModel(*model, params, color, model->curveSampling);
+		}
+		CurveDraw curve;
+		curve.type = model->curve.type;
+		curve.animated = animatedCurve.IsActive() && model == GetFunctionModel(animatedCurve.Type());
+		// Its buffer holds nothing until the first regeneration is uploaded.
+		if (curve.animated || model->curveVertices > 0)
+		{
+			curve.enableSpherical = sphericalCoordinates[funcType];
+			curve.stroked = thickLines && !curve.animated && StrokeCurve(*model, curve.enableSpherical, packet.viewProjection);
+			packet.curves.push_back(curve);
+		}
 	}
+	packet.ui.CopyFrom(ImGui::GetDrawData());
+	UpdateResidency();
+}
 
-	HRESULT hr = model.vertices.Initialize(this->device.Get(), vertices.data(), vertices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create vertex buffer for FermatModel.");
+void Graphics::RenderLoop()
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	Clock::time_point lastPresent = Clock::now();
+	bool hasPacket = false;
+	bool slept = false;
+	while (rendering.load(std::memory_order_acquire))
+	{
+		const bool fresh = framePackets.Acquire();
+		if (fresh)
+		{
+			hasPacket = true;
+			packetsTaken.store(framePackets.ReadBuffer().sequence, std::memory_order_release);
+			// Taking the lock once makes sure the update thread is either
+			// before its check or already waiting, so the wake-up isn't lost.
+			{
+				std::lock_guard<std::mutex> lock(pacingMutex);
+			}
+			pacing.notify_one();
+		}
+		RunRenderTasks();
 
-	std::vector<DWORD> indices(vertices.size());
-	std::iota(indices.begin(), indices.end(), 0);
+		// Without a new packet the last one is drawn again, so presents
+		// keep their pace whatever the update thread is doing. On demand,
+		// an unchanged packet isn't worth drawing: sleep until the next.
+		if (!hasPacket || (!fresh && !framePackets.ReadBuffer().continuous))
+		{
+			std::unique_lock<std::mutex> lock(renderWakeMutex);
+			renderWake.wait(lock, [this]()
+			{
+				return !rendering.load(std::memory_order_acquire) ||
+					packetsAvailable.load(std::memory_order_acquire) > packetsTaken.load(std::memory_order_relaxed);
+			});
+			slept = true;
+			continue;
+		}
 
-	hr = model.indices.Initialize(this->device.Get(), indices.data(), indices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create indices buffer for FermatModel.");
+		const FramePacket& packet = framePackets.ReadBuffer();
+		RenderPacket(packet);
+		this->swapchain->Present(1, NULL);
+
+		// An interval that includes sleeping says nothing about frame time.
+		const Clock::time_point now = Clock::now();
+		const float presentMs = std::chrono::duration<float, std::milli>(now - lastPresent).count();
+		if (!slept)
+			presentIntervals.Push(presentMs);
+		ReportFrame(packet, slept ? 0.0f : presentMs);
+		lastPresent = now;
+		slept = false;
+	}
+}
 
-	hr = model.cb.Initialize(this->device.Get(), this->deviceContext.Get());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create constant buffer for FermatModel.");
+void Graphics::RunRenderTasks()
+{
+	RenderTask task;
+	while (renderTasks.TryPop(task))
+		task();
 }
 
-void Graphics::UpdateFermatModel(float a, float t_min, float t_max, const XMFLOAT4& color)
+void Graphics::RenderPacket(const FramePacket& packet)
 {
-	Model& model = fermatModel;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINESTRIP;
-	model.transformatin = XMMatrixIdentity();
+	// Setup common rendering.
+	float bgcolor[] = { 0.1f, 0.1f, 0.1f, 1.0f };
+	this->deviceContext->ClearRenderTargetView(this->renderTargetView.Get(), bgcolor);
+	this->deviceContext->ClearDepthStencilView(this->depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	this->deviceContext->RSSetState(this->rasterizerState.Get());
+	this->deviceContext->OMSetDepthStencilState(this->depthStencilState.Get(), 0);
+	renderDevice->BeginFrame();
+	uploadRing.BeginFrame();
+	geometryHeap.Defragment(defragmentBudget);
+
+	// Every draw of the frame is recorded first and submitted sorted by
+	// state. Layer 0 holds the grid, layer 1 the curves drawn over it.
+	const XMMATRIX viewProjection = packet.viewProjection;
+	drawCommands.Clear();
 
-	std::vector<VertexCommon> vertices;
-	// - branch
-	for (int i = (t_num / 2) - 1; i >= 0; --i)
+	// Render grid lines, both planes in one draw:
+	if (packet.drawGrid && gridVertexCount > 0)
 	{
-		const float t = lerp(t_min, t_max, i / (t_num/2));
-		const float phi = t;
-		const float r = a * -sqrt(phi);
-		const float x = r * cos(phi);
-		const float y = r * sin(phi);
-		const float z = zCoord;
-		vertices.emplace_back(x, y, z, color.x, color.y, color.z, color.w);
+		cb_vs_vertexshader.data.wvp = XMMatrixTranspose(viewProjection);
+		cb_vs_vertexshader.data.enableSpherical = 0;
+
+		DrawCommand lines;
+		lines.topology = PrimitiveTopology::LINE_LIST;
+		lines.inputLayout = commonVS.LayoutHandle();
+		lines.vs = commonVS.Handle();
+		lines.ps = coloredPS.Handle();
+		lines.blend = BlendMode::ALPHA;
+		lines.vertexBuffer = gridVertices.Get();
+		lines.vertexStride = gridVertices.Stride();
+		lines.count = gridVertexCount;
+		if (drawCommands.BindConstants(lines, cb_vs_vertexshader))
+			drawCommands.Add(lines);
 	}
-	// + branch
-	for (int i = 0; i < t_num / 2; ++i)
+
+	// Render Functions
+	for (const CurveDraw& curve : packet.curves)
 	{
-		const float t = lerp(t_min, t_max, i / (t_num/2));
-		const float phi = t;
-		const float r = a * +sqrt(phi);
-		const float x = r * cos(phi);
-		const float y = r * sin(phi);
-		const float z = zCoord;
-		vertices.emplace_back(x, y, z, color.x, color.y, color.z, color.w);
+		if (curve.animated)
+		{
+			animatedCurve.Draw(drawCommands, viewProjection, curve.enableSpherical, 1);
+		}
+		else if (curve.stroked)
+		{
+			// Already in normalized device coordinates, no constants needed.
+			DrawCommand stroke;
+			stroke.layer = 1;
+			stroke.topology = PrimitiveTopology::TRIANGLE_LIST;
+			stroke.inputLayout = strokeVS.LayoutHandle();
+			stroke.vs = strokeVS.Handle();
+			stroke.ps = coloredPS.Handle();
+			stroke.blend = BlendMode::ALPHA;
+			stroke.vertexBuffer = strokeVertices.Get();
+			stroke.vertexStride = strokeVertices.Stride();
+			stroke.indexBuffer = strokeIndices.Get();
+			stroke.count = strokeIndexCount;
+			drawCommands.Add(stroke);
+		}
+		else if (Model* model = GetFunctionModel(curve.type))
+		{
+			model->cb.data.enableSpherical = curve.enableSpherical;
+			model->draw(drawCommands, viewProjection, 1);
+		}
 	}
+	for (const std::unique_ptr<Model>& batch : familyBatches)
+		batch->draw(drawCommands, viewProjection, 1);
 
-	model.vertices.Update(deviceContext.Get(), vertices.data(), vertices.size());
+	drawCommands.Submit(*renderDevice);
+
+	// The UI goes last so it stays on top of the scene. The backend only
+	// reads the lists.
+	if (packet.ui.Data().Valid)
+		ImGui_ImplDX11_RenderDrawData(const_cast<ImDrawData*>(&packet.ui.Data()));
 }
 
-void Graphics::InitLemniscateOfBernoulliModel()
+void Graphics::ReportFrame(const FramePacket& packet, float presentIntervalMs)
 {
-	Model& model = lemniscateOfBernoulliModel;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINESTRIP;
-	model.transformatin = XMMatrixIdentity();
+	RenderFeedback& report = renderFeedback.WriteBuffer();
+	report.framesRendered = renderDevice->FrameIndex();
+	report.lastPacket = packet.sequence;
+	report.presentIntervalMs = presentIntervalMs;
+	report.stats = renderDevice->LastFrameStats();
+	report.drawCommands = static_cast<UINT>(drawCommands.Size());
+	report.skippedBindings = drawCommands.SkippedBindings();
+	report.arenaBytes = constantArena.LastFrameBytes();
+	report.arenaCapacity = constantArena.CapacityBytes();
+	report.ringUsed = uploadRing.UsedBytes();
+	report.ringCapacity = uploadRing.CapacityBytes();
+	report.ringFallbacks = uploadRing.FallbackUploads();
+
+	const FreeListAllocator& heapVertices = geometryHeap.Vertices();
+	report.heapUsed = heapVertices.UsedSize();
+	report.heapCapacity = heapVertices.Capacity();
+	report.heapFreeBlocks = heapVertices.FreeBlockCount();
+	report.heapFragmentation = heapVertices.Fragmentation();
+	report.heapMovedBytes = geometryHeap.MovedBytesLastFrame();
+	report.familyBatches = static_cast<UINT>(familyBatches.size());
+	report.heapBytes = heapVertices.Capacity() * geometryHeap.VertexStride() + geometryHeap.Indices().Capacity() * sizeof(DWORD);
+	report.strokeBytes = strokeVertices.BufferSize() * strokeVertices.Stride() + strokeIndices.BufferSize() * sizeof(DWORD);
+	report.gridBytes = gridVertices.BufferSize() * gridVertices.Stride();
+
+	report.visibleChunks = 0;
+	report.totalChunks = 0;
+	if (!packet.curves.empty() && !packet.curves.front().animated)
+	{
+		if (const Model* model = GetFunctionModel(packet.curves.front().type))
+		{
+			report.visibleChunks = model->visibleChunks;
+			report.totalChunks = static_cast<UINT>(model->chunks.size());
+		}
+	}
+	renderFeedback.Publish();
+}
 
-	const float a = 5;
-	const float t_min = 0;
-	const float t_max = 1000;
-	const float phi_scale = 2;
-	const float a_pow = 2;
+void Graphics::RenderTimingImGui()
+{
+	if (!ImGui::CollapsingHeader("Frame timing"))
+		return;
+
+	RenderFrameTimesImGui("Update", updateTimes);
+	RenderFrameTimesImGui("Present", presentTimes);
+	ImGui::InputText("Frame times file", frameTimesPath, sizeof(frameTimesPath));
+	if (ImGui::Button("Dump frame times")) DumpFrameTimes(frameTimesPath);
+	if (!frameTimesStatus.empty())
+		ImGui::Text("%s", frameTimesStatus.c_str());
+}
 
-	// r^2 = a^2 * cos(2*phi)
-	std::vector<VertexCommon> vertices;
-	for (int i = 0; i < t_num; ++i)
+void Graphics::RenderFrameTimesImGui(const char* label, FrameTimeHistogram& histogram)
+{
+	const FrameTimeHistogram::Summary summary = histogram.Summarize();
+	ImGui::Text("%s: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms", label, summary.p50, summary.p95, summary.p99, summary.max);
+	ImGui::Text("%u hitches in the last %u frames, %llu in %llu frames overall",
+		summary.hitches, summary.frames, histogram.TotalHitches(), histogram.TotalFrames());
+
+	ImGui::PushID(label);
+	const float scale = (std::max)(summary.p99 * 1.5f, 1.0f);
+	histogram.Recent(timingPlot);
+	ImGui::PlotHistogram("Frame times", timingPlot.data(), static_cast<int>(timingPlot.size()), 0, nullptr, 0.0f, scale, ImVec2(0, 50));
+	histogram.Distribution(1.0f, 50, timingPlot);
+	ImGui::PlotHistogram("Frames per ms", timingPlot.data(), static_cast<int>(timingPlot.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 50));
+	ImGui::PopID();
+}
+
+void Graphics::DumpFrameTimes(const std::string& path)
+{
+	std::ofstream file(path);
+	if (file)
+	{
+		file << "series,frame,ms,hitch\n";
+		updateTimes.WriteCsv(file, "update");
+		presentTimes.WriteCsv(file, "present");
+	}
+	if (!file)
 	{
-		const float t = lerp(t_min, t_max, i / t_num);
-		const float phi = t;
-		const float r = sqrt(pow(a, a_pow) * cos(phi*phi_scale));
-		const float x = r * cos(phi);
-		const float y = r * sin(phi);
-		const float z = zCoord;
-		vertices.emplace_back(x, y, z);
+		ErrorLogger::Log("Failed to write " + path + ".");
+		frameTimesStatus.clear();
+		return;
 	}
 
-	HRESULT hr = model.vertices.Initialize(this->device.Get(), vertices.data(), vertices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create vertex buffer for LemniscateOfBernoulliModel.");
+	std::ostringstream status;
+	status << "Saved " << updateTimes.Count() << " update and " << presentTimes.Count() << " present frames to " << path;
+	frameTimesStatus = status.str();
+}
 
-	std::vector<DWORD> indices(vertices.size());
-	std::iota(indices.begin(), indices.end(), 0);
+bool Graphics::StrokeCurve(const Model& model, bool enableSpherical, const XMMATRIX& viewProjection)
+{
+	if (!model.curvePoints || model.curvePoints->size() < 2)
+		return false;
 
-	hr = model.indices.Initialize(this->device.Get(), indices.data(), indices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create indices buffer for LemniscateOfBernoulliModel.");
+	StrokeView view;
+	XMFLOAT4X4 matrix;
+	XMStoreFloat4x4(&matrix, viewProjection);
+	memcpy(view.viewProjection, matrix.m, sizeof(view.viewProjection));
+	view.width = static_cast<float>(windowWidth);
+	view.height = static_cast<float>(windowHeight);
+	view.spherical = enableSpherical;
+
+	// A still camera keeps the last stroke; any change re-strokes the whole
+	// curve, which the stroker is built to do every frame.
+	const StrokeStyle& style = strokeStyle;
+	const bool sameView = memcmp(view.viewProjection, strokedView.viewProjection, sizeof(view.viewProjection)) == 0
+		&& view.width == strokedView.width && view.height == strokedView.height && view.spherical == strokedView.spherical;
+	const bool sameStyle = style.width == strokedStyle.width && style.fringe == strokedStyle.fringe
+		&& style.join == strokedStyle.join && style.cap == strokedStyle.cap;
+	if (!strokeDirty && &model == strokedModel && sameView && sameStyle)
+		return true;
+
+	std::shared_ptr<StrokeMesh> mesh;
+	if (!strokeMeshes.TryPop(mesh))
+		mesh = std::make_shared<StrokeMesh>();
+
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point start = Clock::now();
+	const XMFLOAT4& color = model.curveColor;
+	stroker.Stroke(model.curvePoints->data(), model.curvePoints->size(), sizeof(XMFLOAT3), view, style,
+		PackStrokeColor(color.x, color.y, color.z, color.w), *mesh);
+	strokeMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	strokeKept = static_cast<UINT>(stroker.KeptPoints());
+	strokeTriangles = static_cast<UINT>(mesh->indices.size() / 3);
+
+	strokedModel = &model;
+	strokedView = view;
+	strokedStyle = style;
+	strokeDirty = false;
+
+	renderTasks.Push([this, mesh]()
+	{
+		UploadStroke(*mesh);
+		strokeMeshes.Push(mesh);
+	});
+	return true;
+}
 
-	hr = model.cb.Initialize(this->device.Get(), this->deviceContext.Get());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create constant buffer for LemniscateOfBernoulliModel.");
+void Graphics::UploadStroke(const StrokeMesh& mesh)
+{
+	strokeIndexCount = 0;
+	if (mesh.indices.empty())
+		return;
+
+	// The mesh changes size with every view, so the buffers grow with some
+	// room to spare instead of being recreated each time.
+	const UINT numVertices = static_cast<UINT>(mesh.vertices.size());
+	const UINT numIndices = static_cast<UINT>(mesh.indices.size());
+	HRESULT hr = S_OK;
+	if (numVertices > strokeVertices.BufferSize())
+	{
+		hr = strokeVertices.Initialize(this->renderDevice.get(), nullptr, numVertices + numVertices / 2);
+		if (FAILED(hr))
+		{
+			ErrorLogger::Log(hr, "Failed to create stroke vertex buffer.");
+			return;
+		}
+	}
+	if (numIndices > strokeIndices.BufferSize())
+	{
+		hr = strokeIndices.Initialize(this->renderDevice.get(), nullptr, numIndices + numIndices / 2, true);
+		if (FAILED(hr))
+		{
+			ErrorLogger::Log(hr, "Failed to create stroke index buffer.");
+			return;
+		}
+	}
+
+	hr = strokeVertices.Update(mesh.vertices.data(), numVertices);
+	if (SUCCEEDED(hr))
+		hr = strokeIndices.Update(mesh.indices.data(), numIndices);
+	if (FAILED(hr))
+	{
+		ErrorLogger::Log(hr, "Failed to update stroke buffers.");
+		return;
+	}
+	strokeIndexCount = numIndices;
 }
 
-void Graphics::UpdateLemniscateOfBernoulliModel(float a, float t_min, float t_max, float phi_scale, const XMFLOAT4& color)
+void Graphics::UpdateGrid(FramePacket& packet)
 {
-	Model& model = lemniscateOfBernoulliModel;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINESTRIP;
-	model.transformatin = XMMatrixIdentity();
+	// The camera looks down the view matrix's third column; the projection
+	// scales y by 1 / tan(fov / 2).
+	XMFLOAT4X4 view;
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&view, camera.GetViewMatrix());
+	XMStoreFloat4x4(&projection, camera.GetProjectionMatrix());
+	GridView gridView;
+	XMStoreFloat3(&gridView.eye, camera.GetPosition());
+	gridView.forward = XMFLOAT3(view._13, view._23, view._33);
+	gridView.tanHalfFov = 1.0f / projection._22;
+	gridView.viewportHeight = static_cast<float>(windowHeight);
+
+	packet.drawGrid = renderXYaxis || renderXZaxis;
+	if (!grid.Update(gridView, gridStyle, renderXYaxis, renderXZaxis))
+		return;
+
+	std::shared_ptr<std::vector<VertexCommon>> vertices;
+	if (!gridUploads.TryPop(vertices))
+		vertices = std::make_shared<std::vector<VertexCommon>>();
+	*vertices = grid.Vertices();
+	renderTasks.Push([this, vertices]()
+	{
+		UploadGrid(*vertices);
+		gridUploads.Push(vertices);
+	});
+}
 
-	// r^2 = a^2 * cos(2*phi)
-	std::vector<VertexCommon> vertices;
-	for (int i = 0; i < t_num; ++i)
+void Graphics::UploadGrid(const std::vector<VertexCommon>& vertices)
+{
+	gridVertexCount = 0;
+	if (vertices.empty())
+		return;
+
+	const UINT numVertices = static_cast<UINT>(vertices.size());
+	HRESULT hr = S_OK;
+	if (numVertices > gridVertices.BufferSize())
+	{
+		hr = gridVertices.Initialize(this->renderDevice.get(), nullptr, numVertices + numVertices / 2);
+		if (FAILED(hr))
+		{
+			ErrorLogger::Log(hr, "Failed to create grid vertex buffer.");
+			return;
+		}
+	}
+	hr = gridVertices.Update(vertices.data(), numVertices);
+	if (FAILED(hr))
 	{
-		const float t = lerp(t_min, t_max, i / t_num);
-		const float phi = t;
-		const float r = sqrt(pow(a, 2) * cos(phi * phi_scale));
-		const float x = r * cos(phi);
-		const float y = r * sin(phi);
-		const float z = zCoord;
-		vertices.emplace_back(x, y, z, color.x, color.y, color.z, color.w);
+		ErrorLogger::Log(hr, "Failed to update grid vertex buffer.");
+		return;
 	}
+	gridVertexCount = numVertices;
+}
 
-	model.vertices.Update(deviceContext.Get(), vertices.data(), vertices.size());
+void Graphics::RenderGridImGui()
+{
+	if (!ImGui::CollapsingHeader("Grid"))
+		return;
+
+	int kind = static_cast<int>(gridStyle.kind);
+	ImGui::Combo("Kind", &kind, "Cartesian\0Polar\0");
+	gridStyle.kind = static_cast<GridKind>(kind);
+	ImGui::SliderFloat("Min spacing", &gridStyle.minSpacing, 4.0f, 64.0f, "%.0f px");
+	if (gridStyle.kind == GridKind::POLAR)
+		ImGui::SliderFloat("Radial lines", &gridStyle.radialDegrees, 5.0f, 90.0f, "every %.0f deg");
+	ImGui::SliderFloat("Minor alpha", &gridStyle.minorAlpha, 0.0f, 1.0f);
+	ImGui::SliderFloat("Major alpha", &gridStyle.majorAlpha, 0.0f, 1.0f);
+
+	const bool planes[2] = { renderXYaxis, renderXZaxis };
+	const char* names[2] = { "X-Y", "X-Z" };
+	for (int p = 0; p < 2; ++p)
+	{
+		if (!planes[p])
+			continue;
+		const GridLevel& level = grid.Level(p == 0 ? GridPlane::XY : GridPlane::XZ);
+		ImGui::Text("%s: spacing 1e%d, fade %.2f", names[p], level.exponent, level.fade);
+	}
+	ImGui::Text("%u vertices, %u cached levels", static_cast<UINT>(grid.Vertices().size()), static_cast<UINT>(grid.CachedLevels()));
 }
 
-void Graphics::InitGridModels()
+void Graphics::RenderStrokeImGui()
 {
-	const XMFLOAT4 gridColor = { 0.3f, 0.3f, 0.3f, 1.0f };
+	if (!ImGui::CollapsingHeader("Lines"))
+		return;
+
+	ImGui::Checkbox("Thick lines", &thickLines);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Draw the curve as anti-aliased triangles instead of 1 px lines");
+	ImGui::SliderFloat("Width", &strokeStyle.width, 0.5f, 16.0f, "%.1f px");
+	ImGui::SliderFloat("Fringe", &strokeStyle.fringe, 0.0f, 3.0f, "%.1f px");
+	int join = static_cast<int>(strokeStyle.join);
+	ImGui::Combo("Joins", &join, "Miter\0Bevel\0Round\0");
+	strokeStyle.join = static_cast<LineJoin>(join);
+	int cap = static_cast<int>(strokeStyle.cap);
+	ImGui::Combo("Caps", &cap, "Butt\0Square\0Round\0");
+	strokeStyle.cap = static_cast<LineCap>(cap);
+	if (ImGui::SliderFloat("Simplify", &simplifyTolerance, 0.0f, 0.05f, "%.4f"))
+	{
+		// Only the simplified polyline depends on it.
+		if (Model* model = GetFunctionModel())
+		{
+			const CurveParams params = model->curve;
+			const XMFLOAT4 color = model->curveColor;
+			UpdateCurveModel(*model, params, color, model->curveSampling);
+		}
+	}
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Drop points closer than this, in world units, to the line through their neighbours before stroking");
+	if (thickLines)
+		ImGui::Text("Last stroke: %u points kept, %u triangles, %.2f ms", strokeKept, strokeTriangles, strokeMs);
+}
 
-	Model& model = gridXY;
-	model.vs = commonVS;
-	model.ps = coloredPS;
-	model.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINELIST;
-	model.transformatin = XMMatrixIdentity();
+void Graphics::UpdateResidency()
+{
+	// Sizes of what the render thread allocates come back with the
+	// feedback, a frame or two late.
+	residency.SetBytes(heapResidency, feedback.heapBytes);
+	residency.SetBytes(animationResidency, animatedCurve.ResidentBytes());
+	residency.SetBytes(strokeResidency, feedback.strokeBytes);
+	residency.SetBytes(gridResidency, feedback.gridBytes);
+	residency.SetBytes(ringResidency, feedback.ringCapacity);
+	residency.SetBytes(arenaResidency, feedback.arenaCapacity);
+	residency.Enforce();
+}
 
-	const int numOfLines = (gridMax - gridMin) / gridStep;
-	const int pointsPerLine = 100;
+void Graphics::RenderMemoryImGui()
+{
+	if (!ImGui::CollapsingHeader("GPU memory"))
+		return;
+
+	const double mb = 1024.0 * 1024.0;
+	int budgetMb = static_cast<int>(residency.budgetBytes / (1024 * 1024));
+	ImGui::SliderInt("Budget", &budgetMb, 8, 1024, "%d MB");
+	residency.budgetBytes = static_cast<unsigned long long>(budgetMb) * 1024 * 1024;
+	const double total = residency.TotalBytes() / mb;
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "%.1f / %d MB", total, budgetMb);
+	ImGui::ProgressBar(static_cast<float>(total / budgetMb), ImVec2(-1, 0), overlay);
+	ImGui::Text("%llu evictions", residency.TotalEvictions());
+
+	for (int c = 0; c < static_cast<int>(ResidencyCategory::COUNT); ++c)
+	{
+		const ResidencyCategory category = static_cast<ResidencyCategory>(c);
+		const ResidencyManager::CategoryUsage& usage = residency.Usage(category);
+		ImGui::Text("%s: %.2f MB resident, %.2f MB evicted, %u resources, %u evictions", ResidencyCategoryName(category),
+			usage.residentBytes / mb, usage.evictedBytes / mb, usage.resources, usage.evictions);
+	}
 
-	std::vector<VertexCommon> vertices;
-	vertices.emplace_back(gridMin, 0, 0, gridColor.x*2, gridColor.y*2, gridColor.z*2, gridColor.w);
-	vertices.emplace_back(gridMax, 0, 0, gridColor.x*2, gridColor.y*2, gridColor.z*2, gridColor.w);
-	vertices.emplace_back(0, gridMin, 0, gridColor.x*2, gridColor.y*2, gridColor.z*2, gridColor.w);
-	vertices.emplace_back(0, gridMax, 0, gridColor.x*2, gridColor.y*2, gridColor.z*2, gridColor.w);
+	if (ImGui::TreeNode("Resources"))
+	{
+		residency.Resources(residencyInfo);
+		for (const ResidencyManager::ResourceInfo& info : residencyInfo)
+		{
+			ImGui::Text("%s (%s): %.2f MB, %s, last used %llu frames ago", info.name.c_str(), ResidencyCategoryName(info.category),
+				info.bytes / mb, info.resident ? (info.evictable ? "resident" : "pinned") : "evicted", info.idleFrames);
+		}
+		ImGui::TreePop();
+	}
+}
 
-	for (int i = 1; i <= numOfLines/2; ++i)
+void Graphics::RenderMathImGui()
+{
+	if (!ImGui::CollapsingHeader("Math"))
+		return;
+
+	const CpuFeatures& cpu = GetCpuFeatures();
+	const KernelSelection& kernels = SelectKernels(nullptr);
+	ImGui::Text("CPU: %s", cpu.brand[0] != '\0' ? cpu.brand : "unknown");
+	ImGui::Text("SSE2 %d, SSE4.2 %d, AVX %d, AVX2 %d, FMA %d, BMI2 %d, AVX-512 F %d BW %d DQ %d VL %d", cpu.sse2, cpu.sse42, cpu.avx,
+		cpu.avx2, cpu.fma, cpu.bmi2, cpu.avx512f, cpu.avx512bw, cpu.avx512dq, cpu.avx512vl);
+	ImGui::Text("SIMD kernels: %s (best %s, %s)", SimdTierName(kernels.active), SimdTierName(kernels.best), kernels.source);
+	if (kernels.warning[0] != '\0')
+		ImGui::TextWrapped("%s", kernels.warning);
+	ImGui::Text("Backend: %s", ENGINE_MATH_BACKEND);
+	if (mathBenchmarkRun.valid() && mathBenchmarkRun.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		mathBenchmarks = mathBenchmarkRun.get();
+	const bool benchmarking = mathBenchmarkRun.valid();
+	if (benchmarking)
+		ImGui::Text("Benchmarking...");
+	else if (ImGui::Button("Run benchmark"))
 	{
-		vertices.emplace_back(gridMin, gridStep*i, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
-		vertices.emplace_back(gridMax, gridStep*i, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
+		mathBenchmarkRun = std::async(std::launch::async, [results = mathBenchmarks]() mutable
+		{
+			RunMathBenchmark(1 << 20, results.math);
+			return results;
+		});
+	}
+	for (const MathBenchmarkResult& result : mathBenchmarks.math)
+	{
+		ImGui::Text("%s: %.2f ns, scalar %.2f ns (%.2fx)", result.name, result.nsPerOp, result.scalarNsPerOp,
+			result.nsPerOp > 0.0 ? result.scalarNsPerOp / result.nsPerOp : 0.0);
+	}
 
-		vertices.emplace_back(gridMin, -gridStep*i, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
-		vertices.emplace_back(gridMax, -gridStep*i, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
+	ImGui::Separator();
+	ImGui::Text("Transform streams: %s", TransformStreamBackend());
+	ImGui::InputInt("Points", &transformBenchmarkPoints, 1 << 16, 1 << 20);
+	transformBenchmarkPoints = (std::min)((std::max)(transformBenchmarkPoints, 1024), 1 << 24);
+	if (!benchmarking && ImGui::Button("Run transform benchmark"))
+	{
+		const size_t points = static_cast<size_t>(transformBenchmarkPoints);
+		mathBenchmarkRun = std::async(std::launch::async, [results = mathBenchmarks, points]() mutable
+		{
+			RunTransformBenchmark(points, 5, results.transform);
+			return results;
+		});
+	}
+	for (const TransformBenchmarkResult& result : mathBenchmarks.transform)
+		ImGui::Text("%s (%s): %.2f GB/s, %.3f ms", result.name, result.tier, result.gigabytesPerSecond, result.msPerRun);
 
-		vertices.emplace_back(gridStep*i, gridMin, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
-		vertices.emplace_back(gridStep*i, gridMax, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
+	ImGui::Separator();
+	ImGui::Text("sin, cos, sqrt, pow: %s", TranscendentalBackend());
+	if (!benchmarking && ImGui::Button("Run throughput benchmark"))
+	{
+		mathBenchmarkRun = std::async(std::launch::async, [results = mathBenchmarks]() mutable
+		{
+			RunTranscendentalBenchmark(1 << 16, 20, results.transcendental);
+			return results;
+		});
+	}
+	for (const TranscendentalBenchmarkResult& result : mathBenchmarks.transcendental)
+	{
+		ImGui::Text("%s, %s (%s): %.0f M/s, C library %.0f M/s", result.function, MathAccuracyName(result.accuracy),
+			result.tier, result.millionsPerSecond, result.libmMillionsPerSecond);
+	}
 
-		vertices.emplace_back(-gridStep*i, gridMin, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
-		vertices.emplace_back(-gridStep*i, gridMax, 0, gridColor.x, gridColor.y, gridColor.z, gridColor.w);
+	if (accuracyCheck.valid() && accuracyCheck.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		accuracyReports = accuracyCheck.get();
+	if (accuracyCheck.valid())
+	{
+		ImGui::Text("Checking accuracy...");
+	}
+	else
+	{
+		ImGui::Checkbox("Every float", &exhaustiveCheck);
+		ImGui::SameLine();
+		if (ImGui::Button("Check accuracy"))
+		{
+			const unsigned int step = exhaustiveCheck ? 1 : 257;
+			accuracyCheck = std::async(std::launch::async, [step]()
+			{
+				std::vector<AccuracyReport> reports;
+				for (int function = 0; function < static_cast<int>(MathFunction::COUNT); ++function)
+				{
+					for (int tier = 0; tier < static_cast<int>(MathAccuracy::COUNT); ++tier)
+					{
+						// The fast sin and cos are only meant for |x| up to 1e5.
+						const bool trig = function == static_cast<int>(MathFunction::SIN) || function == static_cast<int>(MathFunction::COS);
+						const float maxInput = trig && tier == static_cast<int>(MathAccuracy::FAST) ? 1e5f : FLT_MAX;
+						reports.push_back(CheckAccuracy(static_cast<MathFunction>(function), static_cast<MathAccuracy>(tier), step, maxInput));
+					}
+				}
+				return reports;
+			});
+		}
+	}
+	for (const AccuracyReport& report : accuracyReports)
+	{
+		ImGui::Text("%s, %s: %.2f ulp at %g, %.1e relative, %llu special mismatches", MathFunctionName(report.function),
+			MathAccuracyName(report.accuracy), report.maxUlp, report.worstInput, report.maxRelError, report.specialMismatches);
 	}
+}
 
-	HRESULT hr = model.vertices.Initialize(this->device.Get(), vertices.data(), vertices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create vertex buffer for grid.");
+void Graphics::RenderJobsImGui()
+{
+	if (!ImGui::CollapsingHeader("Jobs"))
+		return;
+
+	JobSystem& jobs = Jobs();
+	ImGui::Text("%u workers plus the waiting thread, %u active", jobs.WorkerCount(), jobs.ActiveWorkers());
+	if (jobBenchmarkRun.valid() && jobBenchmarkRun.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		jobBenchmark = jobBenchmarkRun.get();
+	if (jobBenchmarkRun.valid())
+	{
+		ImGui::Text("Benchmarking...");
+	}
+	else if (ImGui::Button("Run scalability benchmark"))
+	{
+		jobBenchmarkRun = std::async(std::launch::async, []()
+		{
+			std::vector<JobBenchmarkResult> results;
+			RunJobBenchmark(3, results);
+			return results;
+		});
+	}
+	for (const JobBenchmarkResult& result : jobBenchmark)
+	{
+		ImGui::Text("%s, %u threads: %.2f ms (%.2fx)", result.name, result.threads, result.msPerRun, result.speedup);
+	}
+}
 
-	std::vector<DWORD> indices(vertices.size());
-	std::iota(indices.begin(), indices.end(), 0);
+void Graphics::RenderCurveGraphImGui()
+{
+	if (!ImGui::CollapsingHeader("Curve graph"))
+		return;
 
-	hr = model.indices.Initialize(this->device.Get(), indices.data(), indices.size());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create indices buffer for grid.");
+	const int frames = 48;
+	ImGui::Text("Last %d frames, newest on the right: C computed, M memo hit", frames);
+	char strip[frames + 1];
+	for (const ComputeGraphHistory::Row& row : curveGraphHistory.Rows())
+	{
+		for (int i = 0; i < frames; ++i)
+		{
+			const std::uint64_t bit = 1ull << (frames - 1 - i);
+			strip[i] = (row.computed & bit) ? 'C' : ((row.memoHits & bit) ? 'M' : '.');
+		}
+		strip[frames] = '\0';
+		ImGui::Text("%-18s %s  %-8s %6.2f ms, %u computed, %u memo hits", row.name.c_str(), strip,
+			NodeStatusName(row.last.status), row.last.lastMs, row.last.computes, row.last.memoHits);
+	}
+}
 
-	hr = model.cb.Initialize(this->device.Get(), this->deviceContext.Get());
-	if (FAILED(hr)) ErrorLogger::Log(hr, "Failed to create constant buffer for grid.");
+void Graphics::RenderExportImGui()
+{
+	if (!ImGui::CollapsingHeader("Software render"))
+		return;
+
+	ImGui::InputText("File", exportPath, sizeof(exportPath));
+	ImGui::Checkbox("Anti-aliasing", &exportAntialias);
+	if (ImGui::Button("Save PNG")) ExportImage(exportPath, true);
+	ImGui::SameLine();
+	if (ImGui::Button("Save PPM")) ExportImage(exportPath, false);
+	if (!exportStatus.empty())
+		ImGui::Text("%s", exportStatus.c_str());
 }
 
-void Graphics::RenderFrame()
+void Graphics::ExportImage(const std::string& path, bool png)
 {
-	// Setup common rendering.
-	float bgcolor[] = { 0.1f, 0.1f, 0.1f, 1.0f };
-	this->deviceContext->ClearRenderTargetView(this->renderTargetView.Get(), bgcolor);
-	this->deviceContext->ClearDepthStencilView(this->depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	this->deviceContext->RSSetState(this->rasterizerState.Get());
-	this->deviceContext->OMSetDepthStencilState(this->depthStencilState.Get(), 0);
+	typedef std::chrono::high_resolution_clock Clock;
+	const Clock::time_point start = Clock::now();
+
+	SoftwareRasterizer rasterizer(windowWidth, windowHeight);
+	const XMFLOAT4 background(0.1f, 0.1f, 0.1f, 1.0f);
+	rasterizer.Clear(background);
+
+	// Same draws as RenderPacket. Curves are regenerated from their
+	// parameters instead of being read back from the GPU; the rasterizer
+	// transforms vertices as they are queued, so one scratch vector will do.
+	const XMMATRIX viewProjection = camera.GetViewProjectionMatrix();
+	// The rasterizer doesn't blend by alpha, so the grid's colors are
+	// mixed with the background up front.
+	exportVertices = grid.Vertices();
+	for (VertexCommon& vertex : exportVertices)
+	{
+		XMFLOAT4& c = vertex.color;
+		c = XMFLOAT4(background.x + (c.x - background.x) * c.w, background.y + (c.y - background.y) * c.w,
+			background.z + (c.z - background.z) * c.w, 1.0f);
+	}
+	if (!exportVertices.empty())
+		rasterizer.DrawLineList(exportVertices.data(), exportVertices.size(), viewProjection);
 
-	// Render grid lines:
-	cb_vs_vertexshader.data.wvp = camera.GetViewMatrix() * camera.GetProjectionMatrix();
-	cb_vs_vertexshader.data.wvp = XMMatrixTranspose(cb_vs_vertexshader.data.wvp);
-	cb_vs_vertexshader.ApplyChanges();
+	if (Model* model = GetFunctionModel())
+	{
+		exportVertices.clear();
+		if (animatedCurve.IsActive() && model == GetFunctionModel(animatedCurve.Type()))
+		{
+			const CurveParams& params = animatedCurve.DisplayedParams();
+			exportVertices.resize(CurveVertexCount(params));
+			GenerateCurve(params, animatedCurve.Color(), std::span<VertexCommon>(exportVertices.data(), exportVertices.size()));
+		}
+		else if (model->curveSampling == CurveSampling::ARC_LENGTH)
+		{
+			ResampleCurve(model->curve, model->curveColor, model->curveVertices, denseVertices, exportVertices);
+		}
+		else if (model->curveVertices > 0)
+		{
+			exportVertices.resize(model->curveVertices);
+			GenerateCurve(model->curve, model->curveColor, std::span<VertexCommon>(exportVertices.data(), exportVertices.size()));
+		}
+		rasterizer.DrawLineStrip(exportVertices.data(), exportVertices.size(), model->transformatin * viewProjection, sphericalCoordinates[funcType]);
+	}
 
-	this->deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_LINELIST);
-	this->deviceContext->IASetInputLayout(this->vs_3d_colors.GetInputLayout());
-	this->deviceContext->VSSetShader(vs_3d_colors.GetShader(), NULL, 0);
-	this->deviceContext->PSSetShader(ps_3d_colors.GetShader(), NULL, 0);
-	this->deviceContext->VSSetConstantBuffers(0, 1, this->cb_vs_vertexshader.GetAddressOf());
+	if (familyMembers > 0)
+	{
+		GenerateCurveFamily(familyDesc, [&](const CurveFamilyBatch& batch)
+		{
+			for (UINT member = 0; member < batch.memberCount; ++member)
+				rasterizer.DrawLineStrip(batch.vertices.data() + static_cast<size_t>(member) * batch.verticesPerMember, batch.verticesPerMember, viewProjection);
+		});
+	}
 
-	UINT offset2 = 0;
-	this->deviceContext->IASetVertexBuffers(0, 1, vb_grid.GetAddressOf(), vb_grid.Stride(), &offset2);
-	
-	if (renderXZaxis) this->deviceContext->Draw(this->vb_grid.BufferSize()/2, 0);
+	rasterizer.Render(exportAntialias);
+	const bool written = png ? WritePNG(rasterizer.Image(), path) : WritePPM(rasterizer.Image(), path);
+	const float ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	if (!written)
+	{
+		ErrorLogger::Log("Failed to write " + path + ".");
+		exportStatus.clear();
+		return;
+	}
 
-	if (renderXYaxis) gridXY.draw(deviceContext, camera);//this->deviceContext->Draw(this->vb_grid.BufferSize() / 2, this->vb_grid.BufferSize() / 2);
+	std::ostringstream status;
+	status << "Saved " << path << ": " << rasterizer.SegmentCount() << " segments in " << std::fixed << std::setprecision(1) << ms << " ms";
+	exportStatus = status.str();
+}
 
-	// Render UI tool.
-	RenderFunctionsImGui();
+Model* Graphics::GetFunctionModel(CurveType type)
+{
+	switch (type)
+	{
+	case CurveType::ARHIMEDES: return &arhimedesModel;
+	case CurveType::FERMAT: return &fermatModel;
+	case CurveType::BERNOULLI: return &lemniscateOfBernoulliModel;
+	default: return nullptr;
+	}
+}
 
-	// Render Functions
+Model* Graphics::GetFunctionModel()
+{
 	switch (funcType)
 	{
-	case ARHIMEDES:
-		arhimedesModel.draw(deviceContext, camera);
-		break;
-	case FERMAT:
-		fermatModel.draw(deviceContext, camera);
-		break;
-	case BERNOULLI:
-		lemniscateOfBernoulliModel.draw(deviceContext, camera);
-		break;
-	default:
-		break;
+	case ARHIMEDES: return &arhimedesModel;
+	case FERMAT: return &fermatModel;
+	case BERNOULLI: return &lemniscateOfBernoulliModel;
+	default: return nullptr;
 	}
-
-	this->swapchain->Present(1, NULL);
 }
 
 bool Graphics::InitializeDirectX(HWND hwnd, int width, int height)
@@ -538,6 +1561,7 @@ bool Graphics::InitializeDirectX(HWND hwnd, int width, int height)
 	}
 
 	this->deviceContext->OMSetRenderTargets(1, this->renderTargetView.GetAddressOf(), this->depthStencilView.Get());
+	this->renderDevice = std::make_unique<D3D11RenderDevice>(this->device.Get(), this->deviceContext.Get());
 
 	//Create depth stencil state
 	D3D11_DEPTH_STENCIL_DESC depthstencildesc;
@@ -588,6 +1612,9 @@ bool Graphics::InitializeDirectX(HWND hwnd, int width, int height)
 	ImGui_ImplWin32_Init(hwnd);
 	ImGui_ImplDX11_Init(this->device.Get(), this->deviceContext.Get());
 	ImGui::StyleColorsDark();
+	// Created now rather than on the first NewFrame, which runs on the
+	// update thread once rendering has moved to its own.
+	ImGui_ImplDX11_CreateDeviceObjects();
 
 	return true;
 }
@@ -614,30 +1641,26 @@ bool Graphics::InitializeShaders()
 #endif
 	}
 
-	D3D11_INPUT_ELEMENT_DESC inputLayout_3d_colors[] =
+	D3D11_INPUT_ELEMENT_DESC inputLayout_common[] =
 	{
 		{"POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
-		{"COLOR", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
+		{"COLOR", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
+		{"TEXCOORD", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
 	};
-	UINT numElements = ARRAYSIZE(inputLayout_3d_colors);
+	UINT numElements = ARRAYSIZE(inputLayout_common);
 
 
-	if (!vs_3d_colors.Initialize(this->device, shaderfolder + L"vs_3d_colors.cso", inputLayout_3d_colors, numElements))
-		return false;
-
-	if (!ps_3d_colors.Initialize(this->device, shaderfolder + L"ps_3d_colors.cso"))
+	if (!commonVS.Initialize(this->device, shaderfolder + L"CommonVS.cso", inputLayout_common, numElements))
 		return false;
 
-	D3D11_INPUT_ELEMENT_DESC inputLayout_common[] =
+	D3D11_INPUT_ELEMENT_DESC inputLayout_stroke[] =
 	{
 		{"POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
-		{"COLOR", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
-		{"TEXCOORD", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
+		{"COLOR", 0, DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0  },
 	};
-	numElements = ARRAYSIZE(inputLayout_common);
-
+	numElements = ARRAYSIZE(inputLayout_stroke);
 
-	if (!commonVS.Initialize(this->device, shaderfolder + L"CommonVS.cso", inputLayout_common, numElements))
+	if (!strokeVS.Initialize(this->device, shaderfolder + L"StrokeVS.cso", inputLayout_stroke, numElements))
 		return false;
 
 	if (!coloredPS.Initialize(this->device, shaderfolder + L"ColoredPS.cso"))
@@ -651,60 +1674,51 @@ bool Graphics::InitializeShaders()
 
 bool Graphics::InitializeScene()
 {
-	const XMFLOAT4 gridColor = {1.0f, 1.0f, 1.0f, 1.0f};
-
 	//Set up constant buffer for vertex shader
-	HRESULT hr = cb_vs_vertexshader.Initialize(this->device.Get(), this->deviceContext.Get());
+	HRESULT hr = cb_vs_vertexshader.Initialize(this->renderDevice.get());
 	if (FAILED(hr))
 	{
 		ErrorLogger::Log(hr, "Failed to create constant buffer.");
 		return false;
 	}
 
-	//draw x grid
-	std::vector<Vertex_COLOR> v2;
-	float gridDimension = 25.0f;
-	int gridSections = 25;
-	//Draw -Z -> +Z (Red->White) //[X-Z Axis]
-	for (int i = 0; i < gridSections; i++)
-	{
-		v2.push_back(Vertex_COLOR(0.0f - gridDimension / 2 + i * gridDimension / gridSections, 0.0f, -gridDimension / 2.0f, 1.0f, 0.0f, 0.0f));
-		v2.push_back(Vertex_COLOR(0.0f - gridDimension / 2 + i * gridDimension / gridSections, 0.0f, +(gridDimension) / 2.0f - gridDimension / gridSections, 1.0f, 1.0f, 1.0f));
-	}
-	//Draw -X -> +X (Blue->White)  //[X-Z Axis]
-	for (int i = 0; i < gridSections; i++)
-	{
-		v2.push_back(Vertex_COLOR(-gridDimension/2.0f, 0.0f, 0.0f - gridDimension / 2 + i * gridDimension / gridSections, 0.0f, 0.0f, 1.0f));
-		v2.push_back(Vertex_COLOR(+gridDimension/2.0f - gridDimension / gridSections, 0.0f, 0.0f - gridDimension / 2 + i * gridDimension / gridSections, 1.0f, 1.0f, 1.0f));
-	}
-	//Draw -X -> +X (Blue->White) //[X-Y Axis]
-	for (int i = 0; i < gridSections; i++)
-	{
-		v2.push_back(Vertex_COLOR(-gridDimension / 2.0f, 0.0f - gridDimension / 2 + i * gridDimension / gridSections, 0.0f, 0.0f, 0.0f, 1.0f));
-		v2.push_back(Vertex_COLOR(+gridDimension / 2.0f - gridDimension / gridSections, 0.0f - gridDimension / 2 + i * gridDimension / gridSections, 0.0f, 1.0f, 1.0f, 1.0f));
-	}
-	//Draw -Y -> +Y (Green->White) //[X-Y Axis]
-	for (int i = 0; i < gridSections; i++)
-	{
-		v2.push_back(Vertex_COLOR(0.0f - gridDimension / 2 + i * gridDimension / gridSections, -gridDimension/2.0f, 0.0f, 0.0f, 1.0f, 0.0f));
-		v2.push_back(Vertex_COLOR(0.0f - gridDimension / 2 + i * gridDimension / gridSections, +gridDimension / 2.0f - gridDimension / gridSections, 0.0f, 1.0f, 1.0f, 1.0f));
-	}
-
-	hr = vb_grid.Initialize(this->device.Get(), v2.data(), v2.size());
+	// Room for 256 draws to start with; grows when a frame needs more.
+	hr = constantArena.Initialize(this->renderDevice.get(), 256 * ConstantArena::blockAlignment);
 	if (FAILED(hr))
 	{
-		ErrorLogger::Log(hr, "Failed to create vertex buffer.");
+		ErrorLogger::Log(hr, "Failed to create constant arena.");
 		return false;
 	}
+	drawCommands.SetConstantArena(&constantArena);
+
+	heapResidency = residency.Register(ResidencyCategory::FAMILY, "Geometry heap");
+	animationResidency = residency.Register(ResidencyCategory::ANIMATION, "Animated curve");
+	strokeResidency = residency.Register(ResidencyCategory::STROKE, "Stroke buffers");
+	gridResidency = residency.Register(ResidencyCategory::GRID, "Grid lines");
+	ringResidency = residency.Register(ResidencyCategory::STAGING, "Upload ring");
+	arenaResidency = residency.Register(ResidencyCategory::STAGING, "Constant arena");
 
 	camera.SetProjectionValues(60, windowWidth, windowHeight, 1.0f, 1000.0f);
 	camera.SetPosition(0.0f, 0.0f, -20.0f);
 	ImGui::SetNextWindowSize(ImVec2(1000, 400));
 
-	InitGridModels();
 	InitArhimedeslModel();
 	InitFermatModel();
 	InitLemniscateOfBernoulliModel();
+	hr = uploadRing.Initialize(this->renderDevice.get(), 8 * 1024 * 1024);
+	if (FAILED(hr))
+	{
+		ErrorLogger::Log(hr, "Failed to create upload ring.");
+		return false;
+	}
+	hr = geometryHeap.Initialize(this->renderDevice.get(), &uploadRing, 1 << 20, 1 << 20);
+	if (FAILED(hr))
+	{
+		ErrorLogger::Log(hr, "Failed to create geometry heap.");
+		return false;
+	}
+	if (!animatedCurve.Initialize(&renderTasks, this->renderDevice.get(), &uploadRing, commonVS.Handle(), commonVS.LayoutHandle(), coloredPS.Handle()))
+		return false;
 
 	return true;
 }
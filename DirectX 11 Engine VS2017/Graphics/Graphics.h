@@ -1,29 +1,69 @@
 #pragma once
 #include "AdapterReader.h"
 #include "Shaders.h"
+#include "D3D11RenderDevice.h"
 #include "Vertex.h"
 #include <SpriteBatch.h>
 #include <SpriteFont.h>
 #include <WICTextureLoader.h>
-#include "ConstantBuffer.h"
-#include "VertexBuffer.h"
-#include "IndexBuffer.h"
-#include "Camera.h"
+#include "Model.h"
+#include "CurveFamily.h"
+#include "AnimatedCurve.h"
+#include "ArcLength.h"
+#include "SoftwareRasterizer.h"
+#include "LineStroke.h"
+#include "AdaptiveGrid.h"
+#include "ResidencyManager.h"
+#include "FramePacket.h"
+#include "RenderTaskQueue.h"
+#include "../Jobs/TripleBuffer.h"
+#include "../Jobs/Coroutine.h"
+#include "../Jobs/TaskQueue.h"
+#include "../Jobs/JobBenchmark.h"
+#include "../Math/MathBenchmark.h"
+#include "../Math/TransformStream.h"
+#include "../Math/TranscendentalCheck.h"
+#include "../Timing/FrameTimeHistogram.h"
 #include "imgui.h"
 #include "imgui_impl_dx11.h"
 #include "imgui_impl_win32.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+// The window thread runs the UI and the curve generation and publishes a
+// FramePacket per frame; a render thread of its own draws the newest packet
+// and presents, so slow UI or generation work never delays a present.
+// After StartRenderThread only the render thread touches the device
+// context: buffer work from the update side is posted as render tasks.
 class Graphics
 {
 public:
+	~Graphics();
 	bool Initialize(HWND hwnd, int width, int height);
-	void RenderFrame();
+	void StartRenderThread();
+	void StopRenderThread();
+	// Update thread: runs the UI and hands the frame to the render thread.
+	// Waits, at most about a frame, until the previous one has been taken.
+	// frameSeconds is the time since the last call.
+	void PublishFrame(float frameSeconds);
+	// False when the scene stays the same until new input arrives, so the
+	// caller may sleep until then.
+	bool NeedsContinuousFrames() const;
 	Camera camera;
 
 private:
 	void RenderFunctionsImGui();
+	void BuildFramePacket(FramePacket& packet);
+	void RenderLoop();
+	void RenderPacket(const FramePacket& packet);
+	void RunRenderTasks();
+	void ReportFrame(const FramePacket& packet, float presentIntervalMs);
 	bool InitializeDirectX(HWND hwnd, int width, int height);
 	bool InitializeShaders();
 	bool InitializeScene();
@@ -41,18 +81,59 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> deviceContext;
 	Microsoft::WRL::ComPtr<IDXGISwapChain> swapchain;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTargetView;
-
-	VertexShader vs_3d_colors;
-	PixelShader ps_3d_colors;
+	// Declared before every buffer so it outlives them.
+	std::unique_ptr<D3D11RenderDevice> renderDevice;
 
 	VertexShader commonVS;
+	VertexShader strokeVS;
 	PixelShader coloredPS;
 	PixelShader texturedPS;
 
-	VertexBuffer<Vertex_COLOR> vb_grid;
-
 	ConstantBuffer<CB_VS_vertexshader> cb_vs_vertexshader;
 
+	// Draws of the current frame, submitted sorted by state, and the
+	// constants they read.
+	ConstantArena constantArena;
+	// Staging for data streamed into static buffers.
+	UploadRing uploadRing;
+	// Vertices and indices of the curve family batches.
+	GeometryHeap geometryHeap;
+	UINT defragmentBudget = 1024 * 1024;
+	DrawCommandBuffer drawCommands;
+
+	RenderTaskQueue renderTasks;
+	// Run by the update thread at the start of every frame; for work that
+	// comes back from other threads, like the stages of a pipeline.
+	TaskQueue updateTasks;
+	TripleBuffer<FramePacket> framePackets;
+	TripleBuffer<RenderFeedback> renderFeedback;
+	// The update thread's copy of the newest feedback.
+	RenderFeedback feedback;
+	unsigned long long packetsPublished = 0;
+	std::atomic<unsigned long long> packetsTaken{ 0 };
+	std::atomic<bool> rendering{ false };
+	// Only used to sleep until the render thread takes a packet.
+	std::mutex pacingMutex;
+	std::condition_variable pacing;
+	// And for the render thread to sleep until there is a new one.
+	std::atomic<unsigned long long> packetsAvailable{ 0 };
+	std::mutex renderWakeMutex;
+	std::condition_variable renderWake;
+	// Idle, with no input, animation or camera movement, nothing is drawn.
+	bool renderOnDemand = true;
+	std::thread renderThread;
+
+	void RenderTimingImGui();
+	void RenderFrameTimesImGui(const char* label, FrameTimeHistogram& histogram);
+	void DumpFrameTimes(const std::string& path);
+	FrameTimeHistogram updateTimes;
+	FrameTimeHistogram presentTimes;
+	// Every present interval, in ms, from the render thread.
+	SpscQueue<float> presentIntervals;
+	std::vector<float> timingPlot;
+	char frameTimesPath[260] = "frametimes.csv";
+	std::string frameTimesStatus;
+
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencilView;
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> depthStencilBuffer;
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthStencilState;
@@ -67,45 +148,146 @@ private:
 
 	enum FuntionType { NONE, ARHIMEDES, FERMAT, BERNOULLI };
 	FuntionType funcType = ARHIMEDES;
+	bool sphericalCoordinates[4] = {};
 
-	struct Model
-	{
-		VertexShader vs;
-		PixelShader ps;
-		D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_POINTLIST;
-		DirectX::XMMATRIX transformatin = XMMatrixIdentity();
-		VertexBuffer<VertexCommon> vertices;
-		IndexBuffer indices;
-		ConstantBuffer<CB_VS_vertexshader> cb;
-
-		void draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> deviceContext, Camera& camera)
-		{
-			const UINT offset = 0;
-			cb.data.wvp = transformatin * camera.GetViewMatrix() * camera.GetProjectionMatrix();
-			cb.data.wvp = XMMatrixTranspose(cb.data.wvp);
-			cb.ApplyChanges();
-
-			deviceContext->IASetPrimitiveTopology(topology);
-			deviceContext->IASetInputLayout(vs.GetInputLayout());
-			deviceContext->VSSetShader(vs.GetShader(), NULL, 0);
-			deviceContext->PSSetShader(ps.GetShader(), NULL, 0);
-			deviceContext->IASetVertexBuffers(0, 1, vertices.GetAddressOf(), vertices.Stride(), &offset);
-			deviceContext->IASetIndexBuffer(indices.Get(), DXGI_FORMAT_R32_UINT, 0);
-			deviceContext->VSSetConstantBuffers(0, 1, cb.GetAddressOf());
-			deviceContext->DrawIndexed(this->indices.BufferSize(), 0, 0);
-		}
-	};
-
-	void InitGridModels();
-	const float gridMin = -10.0f;
-	const float gridMax = 10.0f;
-	const float gridStep = 1.0f;
-	Model gridXY;
-	Model gridXZ;
+	// The grid lines follow the camera. They are rebuilt on the update
+	// thread when it has moved far enough and uploaded by a render task.
+	void UpdateGrid(FramePacket& packet);
+	void UploadGrid(const std::vector<VertexCommon>& vertices);
+	void RenderGridImGui();
+	AdaptiveGrid grid;
+	GridStyle gridStyle;
+	// Vertex lists come back once the render thread has uploaded them.
+	SpscQueue<std::shared_ptr<std::vector<VertexCommon>>> gridUploads;
+	// Render thread.
+	VertexBuffer<VertexCommon> gridVertices;
+	UINT gridVertexCount = 0;
 
 	const float t_num = 100000;
+	const UINT curveChunkSize = 4096;
 	float zCoord = 0.0f;
 	Model arhimedesModel;
 	Model fermatModel;
 	Model lemniscateOfBernoulliModel;
+
+	CurveParams MakeCurveParams(CurveType type, float a, float t_min, float t_max, float phi_scale = 2.0f) const;
+	void InitCurveModel(Model& model, const CurveParams& params, const std::string& name);
+	// Starts regenerating the curve and cancels the regeneration still in
+	// flight for the model, if any; the new curve shows up a few frames
+	// later. Regenerations of different models run side by side.
+	void UpdateCurveModel(Model& model, const CurveParams& params, const XMFLOAT4& color, CurveSampling sampling);
+	void StartCurveRegeneration(Model& model, const CurveInputs& inputs);
+	// Evaluates the model's curve graph on the job system, hands positions
+	// and arc length to the model on the update thread and uploads the
+	// vertices on the render thread, each at its next frame.
+	Pipeline RegenerateCurve(Model* model, CurveInputs inputs, CancelToken token);
+	// On the update thread once a regeneration is done with the model's
+	// graph, finished or cancelled; starts the curve that waited for it.
+	void FinishCurveEvaluation(Model& model);
+	void EvictCurveModel(Model& model);
+	void RestoreCurveModel(Model& model);
+	Model* GetFunctionModel();
+	Model* GetFunctionModel(CurveType type);
+	void RenderSamplingImGui();
+	CurveSampling curveSampling = CurveSampling::UNIFORM_PHI;
+	void RenderAccuracyImGui(CurveType type);
+	// Indexed by CurveType.
+	MathAccuracy curveAccuracy[3] = { MathAccuracy::PRECISE, MathAccuracy::PRECISE, MathAccuracy::PRECISE };
+	int arcLengthVertices = 10000;
+	std::vector<VertexCommon> denseVertices;
+	// Regenerations started and not yet finished or cancelled.
+	std::atomic<unsigned int> curvePipelines{ 0 };
+	// Which nodes of the curve graphs recomputed in the last frames.
+	void RenderCurveGraphImGui();
+	ComputeGraphHistory curveGraphHistory;
+
+	void BuildCurveFamily(const CurveFamilyDesc& desc);
+	void RenderFamilyImGui(const CurveParams& base);
+	void ClearCurveFamily();
+	// Render thread.
+	std::vector<std::unique_ptr<Model>> familyBatches;
+	CurveFamilyDesc familyDesc;
+	UINT familyMembers = 0;
+	unsigned long long familyVertices = 0;
+
+	void RenderAnimationImGui(const CurveParams& base, const XMFLOAT4& color);
+	AnimatedCurve animatedCurve;
+	float animationBudgetMs = 4.0f;
+
+	// The current curve can be drawn as a thick, anti-aliased stroke
+	// instead of a 1 px line strip. It is stroked on the update thread
+	// whenever the view, the style or the curve changes, and the mesh is
+	// uploaded by a render task. Returns false when there is nothing to
+	// stroke. Off by default: a stroked curve is drawn whole, without the
+	// per-chunk culling of the line strips.
+	bool StrokeCurve(const Model& model, bool enableSpherical, const XMMATRIX& viewProjection);
+	void UploadStroke(const StrokeMesh& mesh);
+	void RenderStrokeImGui();
+	bool thickLines = false;
+	StrokeStyle strokeStyle;
+	// Of the polyline stroked, in world units.
+	float simplifyTolerance = 0.0f;
+	LineStroker stroker;
+	// What the last stroke was made from.
+	const Model* strokedModel = nullptr;
+	StrokeView strokedView;
+	StrokeStyle strokedStyle;
+	bool strokeDirty = true;
+	float strokeMs = 0.0f;
+	UINT strokeKept = 0;
+	UINT strokeTriangles = 0;
+	// Meshes come back once the render thread has uploaded them.
+	SpscQueue<std::shared_ptr<StrokeMesh>> strokeMeshes;
+	// Render thread.
+	VertexBuffer<StrokeVertex> strokeVertices;
+	IndexBuffer strokeIndices;
+	UINT strokeIndexCount = 0;
+
+	// GPU memory per resource under a budget. The function models are
+	// evicted when they haven't been shown for a while and the budget is
+	// exceeded, and regenerated from their parameters when shown again;
+	// everything else is only accounted for.
+	void UpdateResidency();
+	void RenderMemoryImGui();
+	ResidencyManager residency;
+	ResidencyManager::ResourceId heapResidency = 0;
+	ResidencyManager::ResourceId animationResidency = 0;
+	ResidencyManager::ResourceId strokeResidency = 0;
+	ResidencyManager::ResourceId gridResidency = 0;
+	ResidencyManager::ResourceId ringResidency = 0;
+	ResidencyManager::ResourceId arenaResidency = 0;
+	std::vector<ResidencyManager::ResourceInfo> residencyInfo;
+
+	// The benchmarks run in the background one at a time, so the UI keeps
+	// drawing; the MathBench tool runs them from the command line. Each run
+	// replaces only its own results.
+	void RenderMathImGui();
+	struct MathBenchmarks
+	{
+		std::vector<MathBenchmarkResult> math;
+		std::vector<TransformBenchmarkResult> transform;
+		std::vector<TranscendentalBenchmarkResult> transcendental;
+	};
+	MathBenchmarks mathBenchmarks;
+	std::future<MathBenchmarks> mathBenchmarkRun;
+	int transformBenchmarkPoints = 1 << 20;
+	// The accuracy check runs in the background too, the exhaustive one for
+	// minutes; TranscendentalCheck runs it from the command line.
+	bool exhaustiveCheck = false;
+	std::future<std::vector<AccuracyReport>> accuracyCheck;
+	std::vector<AccuracyReport> accuracyReports;
+
+	// The job system's threads and how work scales across them. The
+	// benchmark runs on a thread of its own, like the math benchmarks; the
+	// frames' jobs share the workers with it meanwhile.
+	void RenderJobsImGui();
+	std::vector<JobBenchmarkResult> jobBenchmark;
+	std::future<std::vector<JobBenchmarkResult>> jobBenchmarkRun;
+
+	void RenderExportImGui();
+	void ExportImage(const std::string& path, bool png);
+	char exportPath[260] = "plot.png";
+	bool exportAntialias = true;
+	std::string exportStatus;
+	std::vector<VertexCommon> exportVertices;
 };
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "ImageWriter.h"
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	// LSB-first bit writer for deflate streams.
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::vector<std::uint8_t>& out) : out(out) {}
+
+		void Write(std::uint32_t bits, int count)
+		{
+			buffer |= bits << used;
+			used += count;
+			while (used >= 8)
+			{
+				out.push_back(static_cast<std::uint8_t>(buffer));
+				buffer >>= 8;
+				used -= 8;
+			}
+		}
+
+		// Huffman codes go out most significant bit first.
+		void WriteCode(std::uint32_t code, int length)
+		{
+			std::uint32_t reversed = 0;
+			for (int i = 0; i < length; ++i)
+				reversed |= ((code >> i) & 1) << (length - 1 - i);
+			Write(reversed, length);
+		}
+
+		void Flush()
+		{
+			if (used > 0)
+				out.push_back(static_cast<std::uint8_t>(buffer));
+			buffer = 0;
+			used = 0;
+		}
+
+	private:
+		std::vector<std::uint8_t>& out;
+		std::uint32_t buffer = 0;
+		int used = 0;
+	};
+
+	void WriteLiteral(BitWriter& writer, unsigned int symbol)
+	{
+		// Fixed Huffman code of RFC 1951, section 3.2.6.
+		if (symbol < 144)
+			writer.WriteCode(0x30 + symbol, 8);
+		else if (symbol < 256)
+			writer.WriteCode(0x190 + symbol - 144, 9);
+		else if (symbol < 280)
+			writer.WriteCode(symbol - 256, 7);
+		else
+			writer.WriteCode(0xC0 + symbol - 280, 8);
+	}
+
+	void WriteRepeat(BitWriter& writer, unsigned int length)
+	{
+		static const unsigned short base[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const unsigned char extra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+		int code = static_cast<int>(sizeof(base) / sizeof(base[0])) - 1;
+		while (base[code] > length)
+			--code;
+		WriteLiteral(writer, 257 + code);
+		writer.Write(length - base[code], extra[code]);
+		// Distance 1: code 0, no extra bits.
+		writer.WriteCode(0, 5);
+	}
+
+	// Single fixed-Huffman block whose only matches repeat the previous
+	// byte. After the Sub filter a plot is mostly runs of zeros, which this
+	// shrinks well without a full LZ77 matcher.
+	std::vector<std::uint8_t> Deflate(const std::vector<std::uint8_t>& data)
+	{
+		std::vector<std::uint8_t> out;
+		BitWriter writer(out);
+		writer.Write(1, 1); // BFINAL
+		writer.Write(1, 2); // BTYPE = fixed Huffman
+
+		size_t i = 0;
+		while (i < data.size())
+		{
+			size_t run = 0;
+			if (i > 0)
+			{
+				while (run < 258 && i + run < data.size() && data[i + run] == data[i - 1])
+					++run;
+			}
+			if (run >= 3)
+			{
+				WriteRepeat(writer, static_cast<unsigned int>(run));
+				i += run;
+			}
+			else
+			{
+				WriteLiteral(writer, data[i]);
+				++i;
+			}
+		}
+		WriteLiteral(writer, 256);
+		writer.Flush();
+		return out;
+	}
+
+	std::uint32_t Crc32(const std::uint8_t* data, size_t size, std::uint32_t crc = 0)
+	{
+		static std::uint32_t table[256];
+		static const bool initialized = []()
+		{
+			for (std::uint32_t n = 0; n < 256; ++n)
+			{
+				std::uint32_t c = n;
+				for (int k = 0; k < 8; ++k)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				table[n] = c;
+			}
+			return true;
+		}();
+		(void)initialized;
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; ++i)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	std::uint32_t Adler32(const std::vector<std::uint8_t>& data)
+	{
+		std::uint32_t a = 1, b = 0;
+		for (size_t i = 0; i < data.size(); )
+		{
+			// 5552 is the longest run that can't overflow before the modulo.
+			const size_t end = i + 5552 < data.size() ? i + 5552 : data.size();
+			for (; i < end; ++i)
+			{
+				a += data[i];
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	void PutBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value)
+	{
+		out.push_back(static_cast<std::uint8_t>(value >> 24));
+		out.push_back(static_cast<std::uint8_t>(value >> 16));
+		out.push_back(static_cast<std::uint8_t>(value >> 8));
+		out.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	void WriteChunk(std::ofstream& file, const char* type, const std::vector<std::uint8_t>& data)
+	{
+		std::vector<std::uint8_t> chunk;
+		PutBigEndian(chunk, static_cast<std::uint32_t>(data.size()));
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		PutBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+		file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+	}
+}
+
+bool WritePPM(const RasterImage& image, const std::string& path)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	file << "P6\n" << image.width << " " << image.height << "\n255\n";
+	std::vector<std::uint8_t> row(static_cast<size_t>(image.width) * 3);
+	for (int y = 0; y < image.height; ++y)
+	{
+		const std::uint8_t* src = image.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+		for (int x = 0; x < image.width; ++x)
+		{
+			row[3 * x + 0] = src[4 * x + 0];
+			row[3 * x + 1] = src[4 * x + 1];
+			row[3 * x + 2] = src[4 * x + 2];
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+	return static_cast<bool>(file);
+}
+
+bool WritePNG(const RasterImage& image, const std::string& path)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	static const std::uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	std::vector<std::uint8_t> header;
+	PutBigEndian(header, static_cast<std::uint32_t>(image.width));
+	PutBigEndian(header, static_cast<std::uint32_t>(image.height));
+	header.push_back(8); // bit depth
+	header.push_back(2); // truecolor RGB
+	header.push_back(0); // deflate
+	header.push_back(0); // adaptive filtering
+	header.push_back(0); // no interlace
+	WriteChunk(file, "IHDR", header);
+
+	// Every row uses the Sub filter: each byte minus the same channel of
+	// the pixel to its left.
+	const size_t stride = static_cast<size_t>(image.width) * 3;
+	std::vector<std::uint8_t> filtered;
+	filtered.reserve((stride + 1) * image.height);
+	for (int y = 0; y < image.height; ++y)
+	{
+		const std::uint8_t* src = image.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+		filtered.push_back(1);
+		for (int x = 0; x < image.width; ++x)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				const std::uint8_t left = x > 0 ? src[4 * (x - 1) + c] : 0;
+				filtered.push_back(static_cast<std::uint8_t>(src[4 * x + c] - left));
+			}
+		}
+	}
+
+	std::vector<std::uint8_t> zlib = { 0x78, 0x01 };
+	const std::vector<std::uint8_t> deflated = Deflate(filtered);
+	zlib.insert(zlib.end(), deflated.begin(), deflated.end());
+	PutBigEndian(zlib, Adler32(filtered));
+	WriteChunk(file, "IDAT", zlib);
+	WriteChunk(file, "IEND", std::vector<std::uint8_t>());
+	return static_cast<bool>(file);
+}
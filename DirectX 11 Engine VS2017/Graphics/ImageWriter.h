@@ -0,0 +1,7 @@
+#pragma once
+#include "SoftwareRasterizer.h"
+#include <string>
+
+// Both return false if the file can't be written. Alpha is dropped.
+bool WritePPM(const RasterImage& image, const std::string& path);
+bool WritePNG(const RasterImage& image, const std::string& path);
@@ -1,28 +1,37 @@
 #ifndef IndicesBuffer_h__
 #define IndicesBuffer_h__
-#include <d3d11.h>
-#include <wrl/client.h>
-#include <vector>
+#include "RenderDevice.h"
+#include <cstring>
 
 class IndexBuffer
 {
 private:
 	IndexBuffer(const IndexBuffer& rhs);
+	IndexBuffer& operator=(const IndexBuffer& rhs);
 
 private:
-	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+	RenderDevice* device = nullptr;
+	DeviceBuffer* buffer = nullptr;
 	UINT bufferSize = 0;
 public:
 	IndexBuffer() {}
 
-	ID3D11Buffer* Get()const
+	~IndexBuffer()
 	{
-		return buffer.Get();
+		Release();
 	}
 
-	ID3D11Buffer* const* GetAddressOf()const
+	void Release()
 	{
-		return buffer.GetAddressOf();
+		if (device)
+			device->ReleaseBuffer(buffer);
+		buffer = nullptr;
+		bufferSize = 0;
+	}
+
+	DeviceBuffer* Get()const
+	{
+		return buffer;
 	}
 
 	UINT BufferSize() const
@@ -30,24 +39,37 @@ public:
 		return this->bufferSize;
 	}
 
-	HRESULT Initialize(ID3D11Device *device, DWORD * data, UINT numIndices)
+	HRESULT Initialize(RenderDevice* device, const DWORD * data, UINT numIndices, bool dynamic = false)
 	{
-		buffer.Reset();
-		this->bufferSize = numIndices;
+		Release();
+		this->device = device;
+
 		//Load Index Data
-		D3D11_BUFFER_DESC indexBufferDesc;
-		ZeroMemory(&indexBufferDesc, sizeof(indexBufferDesc));
-		indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-		indexBufferDesc.ByteWidth = sizeof(DWORD)*numIndices;
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-
-		D3D11_SUBRESOURCE_DATA indexBufferData;
-		indexBufferData.pSysMem = data;
-		HRESULT hr = device->CreateBuffer(&indexBufferDesc, &indexBufferData, buffer.GetAddressOf());
+		BufferDesc desc;
+		desc.type = BufferType::INDEX;
+		desc.byteWidth = sizeof(DWORD)*numIndices;
+		desc.dynamic = dynamic;
+
+		HRESULT hr = device->CreateBuffer(desc, data, &this->buffer);
+		if (SUCCEEDED(hr))
+			this->bufferSize = numIndices;
 		return hr;
 	}
+
+	// Dynamic buffers only.
+	HRESULT Update(const DWORD* data, UINT numIndices)
+	{
+		if (numIndices > this->bufferSize)
+			return E_INVALIDARG;
+
+		void* mapped = nullptr;
+		HRESULT hr = device->Map(buffer, MapMode::WRITE_DISCARD, &mapped);
+		if (FAILED(hr))
+			return hr;
+		memcpy(mapped, data, sizeof(DWORD) * numIndices);
+		device->Unmap(buffer, sizeof(DWORD) * numIndices);
+		return S_OK;
+	}
 };
 
-#endif // IndicesBuffer_h__
\ No newline at end of file
+#endif // IndicesBuffer_h__
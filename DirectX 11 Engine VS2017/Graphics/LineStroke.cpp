@@ -0,0 +1,521 @@
+#include "LineStroke.h"
+#include "../Jobs/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const float pi = 3.14159265f;
+	// Points at least this close to the camera plane can't be projected.
+	const float minW = 1e-5f;
+	const int maxArcSteps = 64;
+
+	// How a kept point is emitted. Every point with a segment leading in
+	// starts with the row of four vertices that segment ends at, and every
+	// point with a segment leading out ends with the row it starts from, so
+	// a segment's quads only need the first vertex of its end point.
+	enum Kind : std::uint8_t
+	{
+		SKIP,   // nothing visible on either side
+		START,  // cap, then the outgoing row
+		END,    // incoming row, then cap
+		SHARED, // one row along the miter for both segments
+		SPLIT   // incoming row, bevel or round join, outgoing row
+	};
+
+	// Across a row: outer left, inner left, inner right, outer right; left
+	// is the side the normal points to. Three quads join two rows.
+	const UINT rowVertices = 4;
+	const UINT bandIndices = 18;
+
+	UINT ArcVertices(UINT steps)
+	{
+		return 1 + 2 * (steps + 1);
+	}
+
+	UINT ArcIndices(UINT steps)
+	{
+		return 9 * steps;
+	}
+
+	// Segments needed so no chord strays more than `tolerance` from an arc
+	// of `radius` over `angle`.
+	UINT ArcSteps(float angle, float radius, float tolerance)
+	{
+		const float stepAngle = 2.0f * std::acos((std::max)(0.0f, 1.0f - tolerance / radius));
+		if (!(stepAngle > 0.0f))
+			return maxArcSteps;
+		return static_cast<UINT>((std::min)((std::max)(std::ceil(angle / stepAngle), 1.0f), static_cast<float>(maxArcSteps)));
+	}
+
+	// The mapping CommonVS applies when enableSpherical is set: x and y are
+	// angles scaled by the radius z, and the sphere is turned by pi/2
+	// about y.
+	inline void ToSphere(float& x, float& y, float& z)
+	{
+		const float r = z;
+		const float phi = y / r;
+		const float theta = pi / 2 - x / r;
+		const float sx = r * std::cos(phi) * std::sin(theta);
+		const float sy = r * std::sin(phi) * std::sin(theta);
+		const float sz = r * std::cos(theta);
+		x = -sz;
+		y = sy;
+		z = sx;
+	}
+
+	// Screen positions in pixels, from the center of the viewport, y up.
+	template<bool spherical>
+	void ProjectRange(const char* points, size_t stride, size_t begin, size_t end, const StrokeView& view,
+		float* px, float* py, float* pz, std::uint8_t* pvalid)
+	{
+		const float (&m)[4][4] = view.viewProjection;
+		const float halfWidth = view.width * 0.5f;
+		const float halfHeight = view.height * 0.5f;
+		for (size_t i = begin; i < end; ++i)
+		{
+			const DirectX::XMFLOAT3& p = *reinterpret_cast<const DirectX::XMFLOAT3*>(points + i * stride);
+			float x = p.x;
+			float y = p.y;
+			float z = p.z;
+			if (spherical)
+				ToSphere(x, y, z);
+			const float cx = x * m[0][0] + y * m[1][0] + z * m[2][0] + m[3][0];
+			const float cy = x * m[0][1] + y * m[1][1] + z * m[2][1] + m[3][1];
+			const float cz = x * m[0][2] + y * m[1][2] + z * m[2][2] + m[3][2];
+			const float cw = x * m[0][3] + y * m[1][3] + z * m[2][3] + m[3][3];
+			const float invW = 1.0f / (cw > minW ? cw : minW);
+			px[i] = cx * invW * halfWidth;
+			py[i] = cy * invW * halfHeight;
+			pz[i] = cz * invW;
+			pvalid[i] = cw > minW ? 1 : 0;
+		}
+	}
+
+	// Writes the vertices and indices of one chunk.
+	class StrokeWriter
+	{
+	public:
+		StrokeWriter(StrokeMesh& out, size_t firstVertex, size_t firstIndex, const StrokeView& view, std::uint32_t color)
+			: vertex(out.vertices.data() + firstVertex)
+			, index(out.indices.data() + firstIndex)
+			, next(static_cast<DWORD>(firstVertex))
+			, toNdcX(2.0f / view.width)
+			, toNdcY(2.0f / view.height)
+			, color(color)
+			, clear(color & 0x00ffffffu)
+		{
+		}
+
+		DWORD Next() const
+		{
+			return next;
+		}
+
+		void Vertex(float x, float y, float z, std::uint32_t c)
+		{
+			vertex->pos.x = x * toNdcX;
+			vertex->pos.y = y * toNdcY;
+			vertex->pos.z = z;
+			vertex->color = c;
+			++vertex;
+			++next;
+		}
+
+		void Triangle(DWORD a, DWORD b, DWORD c)
+		{
+			index[0] = a;
+			index[1] = b;
+			index[2] = c;
+			index += 3;
+		}
+
+		// A row across the line at (x, y) along the normal (nx, ny). Rows
+		// at the very end of a cap are transparent all the way across.
+		void Row(float x, float y, float z, float nx, float ny, float inner, float outer, bool transparent = false)
+		{
+			const std::uint32_t core = transparent ? clear : color;
+			Vertex(x + nx * outer, y + ny * outer, z, clear);
+			Vertex(x + nx * inner, y + ny * inner, z, core);
+			Vertex(x - nx * inner, y - ny * inner, z, core);
+			Vertex(x - nx * outer, y - ny * outer, z, clear);
+		}
+
+		void Band(DWORD a, DWORD b)
+		{
+			for (DWORD q = 0; q < 3; ++q)
+			{
+				Triangle(a + q, b + q, a + q + 1);
+				Triangle(a + q + 1, b + q, b + q + 1);
+			}
+		}
+
+		// A fan around (x, y) from direction (dx, dy), turning by `angle`
+		// (counterclockwise when positive), with its fringe.
+		void Arc(float x, float y, float z, float dx, float dy, float angle, UINT steps, float inner, float outer)
+		{
+			const float c = std::cos(angle / steps);
+			const float s = std::sin(angle / steps);
+			const DWORD center = next;
+			Vertex(x, y, z, color);
+			for (int ring = 0; ring < 2; ++ring)
+			{
+				const float radius = ring == 0 ? inner : outer;
+				float ux = dx;
+				float uy = dy;
+				for (UINT j = 0; j <= steps; ++j)
+				{
+					Vertex(x + ux * radius, y + uy * radius, z, ring == 0 ? color : clear);
+					const float rx = ux * c - uy * s;
+					uy = ux * s + uy * c;
+					ux = rx;
+				}
+			}
+			const DWORD core = center + 1;
+			const DWORD fringe = core + steps + 1;
+			for (DWORD j = 0; j < steps; ++j)
+			{
+				Triangle(center, core + j, core + j + 1);
+				Triangle(core + j, fringe + j, core + j + 1);
+				Triangle(core + j + 1, fringe + j, fringe + j + 1);
+			}
+		}
+
+	private:
+		StrokeVertex* vertex;
+		DWORD* index;
+		DWORD next;
+		float toNdcX;
+		float toNdcY;
+		std::uint32_t color;
+		std::uint32_t clear;
+	};
+}
+
+std::uint32_t PackStrokeColor(float r, float g, float b, float a)
+{
+	auto channel = [](float value)
+	{
+		return static_cast<std::uint32_t>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	};
+	return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+}
+
+void LineStroker::Stroke(const DirectX::XMFLOAT3* points, size_t count, size_t stride, const StrokeView& view,
+	const StrokeStyle& style, std::uint32_t color, StrokeMesh& out)
+{
+	out.vertices.clear();
+	out.indices.clear();
+	keptPoints = 0;
+	if (count < 2 || style.width <= 0.0f || view.width <= 0.0f || view.height <= 0.0f)
+		return;
+
+	Project(points, count, stride, view);
+
+	const size_t grain = (std::max)(chunkSize, static_cast<size_t>(2));
+	chunks.resize((count + grain - 1) / grain);
+	ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; ++c)
+			Thin(chunks[c], c * grain, (std::min)(count, (c + 1) * grain), count, style.minSegment);
+	});
+	// Classifying a chunk looks at the points its neighbours kept.
+	ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; ++c)
+			Classify(c, view, style);
+	});
+
+	size_t numVertices = 0;
+	size_t numIndices = 0;
+	for (Chunk& chunk : chunks)
+	{
+		chunk.firstVertex = numVertices;
+		chunk.firstIndex = numIndices;
+		numVertices += chunk.numVertices;
+		numIndices += chunk.numIndices;
+		keptPoints += chunk.kept.size();
+	}
+	out.vertices.resize(numVertices);
+	out.indices.resize(numIndices);
+	ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; ++c)
+			Emit(chunks[c], view, style, color, out);
+	});
+}
+
+size_t LineStroker::KeptPoints() const
+{
+	return keptPoints;
+}
+
+void LineStroker::Project(const DirectX::XMFLOAT3* points, size_t count, size_t stride, const StrokeView& view)
+{
+	px.resize(count);
+	py.resize(count);
+	pz.resize(count);
+	pvalid.resize(count);
+	const char* bytes = reinterpret_cast<const char*>(points);
+	ParallelFor(count, chunkSize, [&](size_t begin, size_t end)
+	{
+		if (view.spherical)
+			ProjectRange<true>(bytes, stride, begin, end, view, px.data(), py.data(), pz.data(), pvalid.data());
+		else
+			ProjectRange<false>(bytes, stride, begin, end, view, px.data(), py.data(), pz.data(), pvalid.data());
+	});
+}
+
+void LineStroker::Thin(Chunk& chunk, size_t begin, size_t end, size_t count, float minSegment) const
+{
+	// The first point of every chunk is kept, so chunks can be thinned
+	// independently and still agree on the segments between them.
+	chunk.kept.clear();
+	chunk.kept.push_back(static_cast<std::uint32_t>(begin));
+	const float minSquared = (std::max)(minSegment * minSegment, 1e-12f);
+	size_t last = begin;
+	for (size_t i = begin + 1; i < end; ++i)
+	{
+		const bool valid = pvalid[i] != 0;
+		if (valid != (pvalid[last] != 0))
+		{
+			chunk.kept.push_back(static_cast<std::uint32_t>(i));
+			last = i;
+			continue;
+		}
+		if (!valid)
+			continue;
+
+		const float dx = px[i] - px[last];
+		const float dy = py[i] - py[last];
+		if (dx * dx + dy * dy >= minSquared)
+		{
+			chunk.kept.push_back(static_cast<std::uint32_t>(i));
+			last = i;
+		}
+		else if (i == count - 1)
+		{
+			// The curve must still end where it ends; move the last point
+			// there rather than add one too close to it.
+			if (chunk.kept.size() > 1)
+				chunk.kept.back() = static_cast<std::uint32_t>(i);
+			else
+				chunk.kept.push_back(static_cast<std::uint32_t>(i));
+		}
+	}
+}
+
+void LineStroker::Classify(size_t c, const StrokeView& view, const StrokeStyle& style)
+{
+	Chunk& chunk = chunks[c];
+	chunk.hasPrevious = c > 0;
+	const bool hasNext = c + 1 < chunks.size();
+
+	// Gather the chunk's points, with one neighbour on either side, into
+	// contiguous arrays so the segment loops below vectorize.
+	const size_t numPoints = chunk.kept.size() + (chunk.hasPrevious ? 1 : 0) + (hasNext ? 1 : 0);
+	chunk.x.resize(numPoints);
+	chunk.y.resize(numPoints);
+	chunk.z.resize(numPoints);
+	chunk.valid.resize(numPoints);
+	size_t n = 0;
+	auto gather = [&](std::uint32_t i)
+	{
+		chunk.x[n] = px[i];
+		chunk.y[n] = py[i];
+		chunk.z[n] = pz[i];
+		chunk.valid[n] = pvalid[i];
+		++n;
+	};
+	if (chunk.hasPrevious)
+		gather(chunks[c - 1].kept.back());
+	for (std::uint32_t i : chunk.kept)
+		gather(i);
+	if (hasNext)
+		gather(chunks[c + 1].kept.front());
+
+	const size_t numSegments = numPoints - 1;
+	chunk.tx.resize(numSegments);
+	chunk.ty.resize(numSegments);
+	chunk.visible.resize(numSegments);
+	const float* x = chunk.x.data();
+	const float* y = chunk.y.data();
+	float* tx = chunk.tx.data();
+	float* ty = chunk.ty.data();
+	for (size_t i = 0; i < numSegments; ++i)
+	{
+		const float dx = x[i + 1] - x[i];
+		const float dy = y[i + 1] - y[i];
+		// A zero-length segment gets a zero tangent instead of a NaN.
+		const float invLength = 1.0f / std::sqrt(dx * dx + dy * dy + 1e-30f);
+		tx[i] = dx * invLength;
+		ty[i] = dy * invLength;
+	}
+
+	// Segments entirely on one side of the screen, grown by what a cap or
+	// join may add, are culled.
+	const float h = style.width * 0.5f;
+	const float reach = 2.0f * h + style.fringe;
+	const float maxX = view.width * 0.5f + reach;
+	const float maxY = view.height * 0.5f + reach;
+	const std::uint8_t* valid = chunk.valid.data();
+	std::uint8_t* visible = chunk.visible.data();
+	for (size_t i = 0; i < numSegments; ++i)
+	{
+		const bool off = (x[i] < -maxX && x[i + 1] < -maxX) || (x[i] > maxX && x[i + 1] > maxX)
+			|| (y[i] < -maxY && y[i + 1] < -maxY) || (y[i] > maxY && y[i + 1] > maxY);
+		visible[i] = (valid[i] & valid[i + 1]) && !off ? 1 : 0;
+	}
+
+	const float outer = h + style.fringe;
+	const UINT capSteps = style.cap == LineCap::ROUND ? ArcSteps(pi, outer, style.roundTolerance) : 0;
+	const UINT capVertices = style.cap == LineCap::ROUND ? ArcVertices(capSteps) + rowVertices : 3 * rowVertices;
+	const UINT capIndices = style.cap == LineCap::ROUND ? ArcIndices(capSteps) : 2 * bandIndices;
+	// A shared row stands in for the join when it strays no further from
+	// the round one than the tolerance, and for a miter within its limit.
+	const float maxSharedScale = style.join == LineJoin::MITER
+		? style.miterLimit
+		: 1.0f + style.roundTolerance / outer;
+
+	chunk.kinds.resize(chunk.kept.size());
+	chunk.steps.resize(chunk.kept.size());
+	chunk.numVertices = 0;
+	chunk.numIndices = 0;
+	const size_t offset = chunk.hasPrevious ? 1 : 0;
+	for (size_t j = 0; j < chunk.kept.size(); ++j)
+	{
+		const size_t k = j + offset;
+		const bool in = k > 0 && visible[k - 1];
+		const bool out = k < numSegments && visible[k];
+		std::uint8_t kind = SKIP;
+		UINT steps = 0;
+		if (in && out)
+		{
+			const float inX = tx[k - 1], inY = ty[k - 1];
+			const float outX = tx[k], outY = ty[k];
+			// Normals are the tangents turned left; the miter halves them.
+			const float mx = -inY - outY;
+			const float my = inX + outX;
+			const float mLength = std::sqrt(mx * mx + my * my);
+			const float cosHalf = mLength > 1e-6f ? (-mx * inY + my * inX) / mLength : 0.0f;
+			if (cosHalf > 0.0f && 1.0f / cosHalf <= maxSharedScale)
+			{
+				kind = SHARED;
+				chunk.numVertices += rowVertices;
+				chunk.numIndices += bandIndices;
+			}
+			else
+			{
+				kind = SPLIT;
+				if (style.join == LineJoin::ROUND)
+				{
+					const float cross = inX * outY - inY * outX;
+					const float dot = inX * outX + inY * outY;
+					steps = ArcSteps(std::atan2(std::fabs(cross), dot), outer, style.roundTolerance);
+				}
+				else
+					steps = 1;
+				chunk.numVertices += 2 * rowVertices + ArcVertices(steps);
+				chunk.numIndices += bandIndices + ArcIndices(steps);
+			}
+		}
+		else if (out || in)
+		{
+			kind = out ? START : END;
+			steps = capSteps;
+			chunk.numVertices += capVertices;
+			chunk.numIndices += capIndices + (in ? bandIndices : 0);
+		}
+		chunk.kinds[j] = kind;
+		chunk.steps[j] = static_cast<std::uint8_t>(steps);
+	}
+}
+
+void LineStroker::Emit(const Chunk& chunk, const StrokeView& view, const StrokeStyle& style, std::uint32_t color, StrokeMesh& out) const
+{
+	StrokeWriter writer(out, chunk.firstVertex, chunk.firstIndex, view, color);
+	const float h = style.width * 0.5f;
+	const float outer = h + style.fringe;
+	const float extend = style.cap == LineCap::SQUARE ? h : 0.0f;
+	const size_t offset = chunk.hasPrevious ? 1 : 0;
+	for (size_t j = 0; j < chunk.kept.size(); ++j)
+	{
+		const std::uint8_t kind = chunk.kinds[j];
+		if (kind == SKIP)
+			continue;
+
+		const size_t k = j + offset;
+		const float x = chunk.x[k];
+		const float y = chunk.y[k];
+		const float z = chunk.z[k];
+		const UINT steps = chunk.steps[j];
+		// The previous point ended with the row this segment starts from.
+		if (kind != START)
+			writer.Band(writer.Next() - rowVertices, writer.Next());
+
+		if (kind == SHARED)
+		{
+			const float nx = -chunk.ty[k - 1] - chunk.ty[k];
+			const float ny = chunk.tx[k - 1] + chunk.tx[k];
+			const float invLength = 1.0f / std::sqrt(nx * nx + ny * ny);
+			const float mx = nx * invLength;
+			const float my = ny * invLength;
+			const float scale = 1.0f / (mx * -chunk.ty[k - 1] + my * chunk.tx[k - 1]);
+			writer.Row(x, y, z, mx, my, h * scale, outer * scale);
+		}
+		else if (kind == SPLIT)
+		{
+			const float inX = chunk.tx[k - 1], inY = chunk.ty[k - 1];
+			const float outX = chunk.tx[k], outY = chunk.ty[k];
+			writer.Row(x, y, z, -inY, inX, h, outer);
+			// The join fills the outer side of the corner, on the right
+			// when the line turns left.
+			const float cross = inX * outY - inY * outX;
+			const float dot = inX * outX + inY * outY;
+			const float side = cross > 0.0f ? -1.0f : 1.0f;
+			const float angle = std::atan2(std::fabs(cross), dot);
+			writer.Arc(x, y, z, -inY * side, inX * side, cross > 0.0f ? angle : -angle, steps, h, outer);
+			writer.Row(x, y, z, -outY, outX, h, outer);
+		}
+		else
+		{
+			// Caps point away from the line: backwards at its start.
+			const bool start = kind == START;
+			const float lineX = start ? chunk.tx[k] : chunk.tx[k - 1];
+			const float lineY = start ? chunk.ty[k] : chunk.ty[k - 1];
+			const float dirX = start ? -lineX : lineX;
+			const float dirY = start ? -lineY : lineY;
+			const float leftX = -lineY;
+			const float leftY = lineX;
+			if (style.cap == LineCap::ROUND)
+			{
+				if (!start)
+					writer.Row(x, y, z, leftX, leftY, h, outer);
+				// From the left side round the end to the right side.
+				writer.Arc(x, y, z, leftX, leftY, start ? pi : -pi, steps, h, outer);
+				if (start)
+					writer.Row(x, y, z, leftX, leftY, h, outer);
+			}
+			else
+			{
+				const DWORD first = writer.Next();
+				const float ex = x + dirX * extend, ey = y + dirY * extend;
+				const float fx = x + dirX * (extend + style.fringe), fy = y + dirY * (extend + style.fringe);
+				if (start)
+				{
+					writer.Row(fx, fy, z, leftX, leftY, h, outer, true);
+					writer.Row(ex, ey, z, leftX, leftY, h, outer);
+					writer.Row(x, y, z, leftX, leftY, h, outer);
+				}
+				else
+				{
+					writer.Row(x, y, z, leftX, leftY, h, outer);
+					writer.Row(ex, ey, z, leftX, leftY, h, outer);
+					writer.Row(fx, fy, z, leftX, leftY, h, outer, true);
+				}
+				writer.Band(first, first + rowVertices);
+				writer.Band(first + rowVertices, first + 2 * rowVertices);
+			}
+		}
+	}
+}
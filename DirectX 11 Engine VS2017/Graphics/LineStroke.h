@@ -0,0 +1,106 @@
+#pragma once
+#include "Vertex.h"
+#include "../Platform.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class LineJoin { MITER, BEVEL, ROUND };
+enum class LineCap { BUTT, SQUARE, ROUND };
+
+struct StrokeStyle
+{
+	// Pixels. The line is opaque across `width` and fades out over `fringe`
+	// more on either side, which is what anti-aliases its edges.
+	float width = 2.0f;
+	float fringe = 1.0f;
+	LineJoin join = LineJoin::MITER;
+	LineCap cap = LineCap::BUTT;
+	// Miters longer than miterLimit half widths are cut to a bevel.
+	float miterLimit = 4.0f;
+	// How far round joins and caps may stray from the true arc, in pixels.
+	float roundTolerance = 0.25f;
+	// Points closer than this many pixels to the previous one are dropped.
+	float minSegment = 0.5f;
+};
+
+// Where a stroke is drawn. The points are transformed the way CommonVS
+// does it, the spherical projection included.
+struct StrokeView
+{
+	// Row-vector convention, as DirectXMath stores an XMMATRIX.
+	float viewProjection[4][4] = {};
+	float width = 1.0f;
+	float height = 1.0f;
+	bool spherical = false;
+};
+
+struct StrokeMesh
+{
+	std::vector<StrokeVertex> vertices;
+	// Triangle list.
+	std::vector<DWORD> indices;
+};
+
+// RGBA8 with red in the lowest byte, as StrokeVertex::color expects.
+std::uint32_t PackStrokeColor(float r, float g, float b, float a);
+
+// Turns polylines into triangles of a given width on the screen. The
+// points are projected into structure-of-arrays scratch, thinned to about
+// one per pixel and extruded along their normals; every step runs over
+// chunks of the polyline in parallel, so re-stroking a curve of a million
+// points whenever the view changes stays cheap. Scratch memory is kept
+// from one call to the next.
+class LineStroker
+{
+public:
+	// Consecutive points are `stride` bytes apart, so positions can be read
+	// straight out of a vertex array. Segments with an end behind the
+	// camera or entirely off the screen are left out, and the pieces either
+	// side of them get caps.
+	void Stroke(const DirectX::XMFLOAT3* points, size_t count, size_t stride, const StrokeView& view,
+		const StrokeStyle& style, std::uint32_t color, StrokeMesh& out);
+
+	// Points left after thinning, in the last Stroke.
+	size_t KeptPoints() const;
+
+	size_t chunkSize = 16384;
+
+private:
+	// Per chunk of the input: the points kept from it, then the segments
+	// leading in and out of each of them, and what they emit.
+	struct Chunk
+	{
+		std::vector<std::uint32_t> kept;
+		// Kept points plus the last one of the previous chunk and the
+		// first one of the next, in screen pixels.
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<std::uint8_t> valid;
+		// Segment i runs from point i to point i + 1 of the arrays above.
+		std::vector<float> tx;
+		std::vector<float> ty;
+		std::vector<std::uint8_t> visible;
+		// How each kept point is emitted, and the arc steps of its join or cap.
+		std::vector<std::uint8_t> kinds;
+		std::vector<std::uint8_t> steps;
+		bool hasPrevious = false;
+		size_t numVertices = 0;
+		size_t numIndices = 0;
+		size_t firstVertex = 0;
+		size_t firstIndex = 0;
+	};
+
+	void Project(const DirectX::XMFLOAT3* points, size_t count, size_t stride, const StrokeView& view);
+	void Thin(Chunk& chunk, size_t begin, size_t end, size_t count, float minSegment) const;
+	void Classify(size_t c, const StrokeView& view, const StrokeStyle& style);
+	void Emit(const Chunk& chunk, const StrokeView& view, const StrokeStyle& style, std::uint32_t color, StrokeMesh& out) const;
+
+	std::vector<float> px;
+	std::vector<float> py;
+	std::vector<float> pz;
+	std::vector<std::uint8_t> pvalid;
+	std::vector<Chunk> chunks;
+	size_t keptPoints = 0;
+};
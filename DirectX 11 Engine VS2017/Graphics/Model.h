@@ -0,0 +1,153 @@
+#pragma once
+#include "RenderDevice.h"
+#include "DrawCommandBuffer.h"
+#include "Vertex.h"
+#include "ConstantBuffer.h"
+#include "GeometryHeap.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Camera.h"
+#include "CurveChunks.h"
+#include "Curves.h"
+#include "ArcLength.h"
+#include "CurveGraph.h"
+#include "ResidencyManager.h"
+#include "../Jobs/CancelToken.h"
+#include <memory>
+#include <vector>
+
+struct Model
+{
+	DeviceVertexShader* vs = nullptr;
+	DeviceInputLayout* inputLayout = nullptr;
+	DevicePixelShader* ps = nullptr;
+	PrimitiveTopology topology = PrimitiveTopology::POINT_LIST;
+	DirectX::XMMATRIX transformatin = XMMatrixIdentity();
+	VertexBuffer<VertexCommon> vertices;
+	IndexBuffer indices;
+	ConstantBuffer<CB_VS_vertexshader> cb;
+	// When heap is set the geometry lives there instead of in the two
+	// buffers above.
+	GeometryHeap* heap = nullptr;
+	GeometryHandle geometry;
+	std::vector<CurveChunk> chunks;
+	UINT visibleChunks = 0;
+
+	// What a curve model was last generated, or is being generated, from,
+	// so the curve can be rebuilt on the CPU without reading the buffer
+	// back. curveVertices is 0 for models that aren't curves, and while the
+	// buffer holds nothing to draw. These belong to the update thread,
+	// everything above to the render thread.
+	CurveParams curve;
+	DirectX::XMFLOAT4 curveColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+	CurveSampling curveSampling = CurveSampling::UNIFORM_PHI;
+	UINT curveVertices = 0;
+	float arcLength = 0.0f;
+	AABB curveBounds;
+	// The curve's simplified polyline, for stroking it on the CPU.
+	std::shared_ptr<const std::vector<DirectX::XMFLOAT3>> curvePoints;
+	// Vertices the buffers were created for, and the model's entry in the
+	// residency manager. The buffers are released while it is evicted.
+	UINT curveCapacity = 0;
+	ResidencyManager::ResourceId residency = 0;
+	// Cancels the curve's regeneration in flight, if any.
+	CancelToken regeneration;
+	// What the curve's data is derived through; regenerations of the model
+	// use it from the job system, one at a time. While one evaluates it, a
+	// newer curve waits in pendingCurve and starts once the graph is free.
+	std::unique_ptr<CurveGraph> derived;
+	bool evaluating = false;
+	bool curvePending = false;
+	CurveInputs pendingCurve;
+
+	Model() {}
+	Model(const Model&) = delete;
+	Model& operator=(const Model&) = delete;
+
+	~Model()
+	{
+		if (heap)
+			heap->Remove(geometry);
+	}
+
+	// Curves may use fewer vertices than their buffers hold; the chunks
+	// always cover exactly the vertices in use.
+	UINT IndexCount() const
+	{
+		if (chunks.empty())
+			return heap ? heap->IndexCount(geometry) : indices.BufferSize();
+		return chunks.back().firstIndex + chunks.back().indexCount;
+	}
+
+	// Uploads the constants and records the draws of the visible chunks.
+	// viewProjection is computed once per frame by the caller.
+	void draw(DrawCommandBuffer& commands, const XMMATRIX& viewProjection, UINT layer = 0)
+	{
+		const XMMATRIX wvp = transformatin * viewProjection;
+		cb.data.wvp = XMMatrixTranspose(wvp);
+
+		DrawCommand command;
+		command.layer = layer;
+		command.topology = topology;
+		command.inputLayout = inputLayout;
+		command.vs = vs;
+		command.ps = ps;
+		command.vertexBuffer = vertices.Get();
+		command.vertexStride = vertices.Stride();
+		command.indexBuffer = indices.Get();
+		UINT indexOffset = 0;
+		if (heap)
+		{
+			command.vertexBuffer = heap->VertexBuffer();
+			command.vertexStride = heap->VertexStride();
+			command.indexBuffer = heap->IndexBuffer();
+			command.baseVertex = heap->BaseVertex(geometry);
+			indexOffset = heap->FirstIndex(geometry);
+			command.start = indexOffset;
+		}
+		if (!commands.BindConstants(command, cb))
+			return;
+
+		// Chunk bounds are in model space and don't hold once the shader
+		// projects the curve onto a sphere, so fall back to a full draw.
+		if (chunks.empty() || cb.data.enableSpherical)
+		{
+			visibleChunks = static_cast<UINT>(chunks.size());
+			command.count = IndexCount();
+			commands.Add(command);
+			return;
+		}
+
+		// Cull chunks and merge adjacent visible ones into a single draw.
+		const Frustum frustum(wvp);
+		UINT runStart = 0;
+		UINT runCount = 0;
+		visibleChunks = 0;
+		for (const CurveChunk& chunk : chunks)
+		{
+			if (!frustum.Intersects(chunk.bounds))
+				continue;
+
+			++visibleChunks;
+			if (runCount > 0 && chunk.firstIndex <= runStart + runCount)
+			{
+				runCount = chunk.firstIndex + chunk.indexCount - runStart;
+				continue;
+			}
+			if (runCount > 0)
+			{
+				command.start = indexOffset + runStart;
+				command.count = runCount;
+				commands.Add(command);
+			}
+			runStart = chunk.firstIndex;
+			runCount = chunk.indexCount;
+		}
+		if (runCount > 0)
+		{
+			command.start = indexOffset + runStart;
+			command.count = runCount;
+			commands.Add(command);
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "NullRenderDevice.h"
+#include <cstring>
+
+NullRenderDevice::NullRenderDevice()
+{
+	constantBufferOffsets = true;
+}
+
+const std::vector<RecordedCall>& NullRenderDevice::Calls() const
+{
+	return calls;
+}
+
+const std::vector<std::uint8_t>& NullRenderDevice::BufferContents(DeviceBuffer* buffer) const
+{
+	return reinterpret_cast<const NullBuffer*>(buffer)->data;
+}
+
+UINT NullRenderDevice::LiveBuffers() const
+{
+	return liveBuffers;
+}
+
+void NullRenderDevice::Record(RenderCall call, const void* object, std::int64_t a, std::int64_t b, std::int64_t c)
+{
+	if (!recordCalls)
+		return;
+	RecordedCall recorded;
+	recorded.call = call;
+	recorded.object = object;
+	recorded.args[0] = a;
+	recorded.args[1] = b;
+	recorded.args[2] = c;
+	calls.push_back(recorded);
+}
+
+void NullRenderDevice::OnBeginFrame()
+{
+	calls.clear();
+}
+
+HRESULT NullRenderDevice::DoCreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer)
+{
+	NullBuffer* created = new NullBuffer();
+	created->desc = desc;
+	created->data.resize(desc.byteWidth);
+	if (initialData)
+		std::memcpy(created->data.data(), initialData, desc.byteWidth);
+	++liveBuffers;
+
+	*buffer = reinterpret_cast<DeviceBuffer*>(created);
+	Record(RenderCall::CREATE_BUFFER, created, static_cast<std::int64_t>(desc.type), desc.byteWidth, desc.dynamic);
+	return S_OK;
+}
+
+void NullRenderDevice::DoReleaseBuffer(DeviceBuffer* buffer)
+{
+	Record(RenderCall::RELEASE_BUFFER, buffer);
+	delete reinterpret_cast<NullBuffer*>(buffer);
+	--liveBuffers;
+}
+
+HRESULT NullRenderDevice::DoMap(DeviceBuffer* buffer, MapMode mode, void** data)
+{
+	NullBuffer* nullBuffer = reinterpret_cast<NullBuffer*>(buffer);
+	if (!nullBuffer->desc.dynamic || nullBuffer->mapped)
+		return E_FAIL;
+	nullBuffer->mapped = true;
+	*data = nullBuffer->data.data();
+	Record(RenderCall::MAP, buffer, static_cast<std::int64_t>(mode));
+	return S_OK;
+}
+
+void NullRenderDevice::DoUnmap(DeviceBuffer* buffer)
+{
+	reinterpret_cast<NullBuffer*>(buffer)->mapped = false;
+	Record(RenderCall::UNMAP, buffer);
+}
+
+void NullRenderDevice::DoUpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size)
+{
+	NullBuffer* nullBuffer = reinterpret_cast<NullBuffer*>(buffer);
+	if (nullBuffer->desc.dynamic || offset > nullBuffer->data.size() || size > nullBuffer->data.size() - offset)
+		return;
+	std::memcpy(nullBuffer->data.data() + offset, data, size);
+	Record(RenderCall::UPDATE_BUFFER, buffer, offset, size);
+}
+
+void NullRenderDevice::DoCopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size)
+{
+	// Like D3D11, copies out of range, into a dynamic buffer or within one
+	// buffer are dropped.
+	NullBuffer* dst = reinterpret_cast<NullBuffer*>(destination);
+	const NullBuffer* src = reinterpret_cast<const NullBuffer*>(source);
+	if (dst == src || dst->desc.dynamic || dstOffset > dst->data.size() || size > dst->data.size() - dstOffset
+		|| srcOffset > src->data.size() || size > src->data.size() - srcOffset)
+		return;
+	std::memcpy(dst->data.data() + dstOffset, src->data.data() + srcOffset, size);
+	Record(RenderCall::COPY_BUFFER, destination, dstOffset, srcOffset, size);
+}
+
+void NullRenderDevice::DoSetPrimitiveTopology(PrimitiveTopology topology)
+{
+	Record(RenderCall::SET_PRIMITIVE_TOPOLOGY, nullptr, static_cast<std::int64_t>(topology));
+}
+
+void NullRenderDevice::DoSetInputLayout(DeviceInputLayout* layout)
+{
+	Record(RenderCall::SET_INPUT_LAYOUT, layout);
+}
+
+void NullRenderDevice::DoSetVertexShader(DeviceVertexShader* shader)
+{
+	Record(RenderCall::SET_VERTEX_SHADER, shader);
+}
+
+void NullRenderDevice::DoSetPixelShader(DevicePixelShader* shader)
+{
+	Record(RenderCall::SET_PIXEL_SHADER, shader);
+}
+
+void NullRenderDevice::DoSetBlendMode(BlendMode mode)
+{
+	Record(RenderCall::SET_BLEND_MODE, nullptr, static_cast<std::int64_t>(mode));
+}
+
+void NullRenderDevice::DoSetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset)
+{
+	Record(RenderCall::SET_VERTEX_BUFFER, buffer, stride, offset);
+}
+
+void NullRenderDevice::DoSetIndexBuffer(DeviceBuffer* buffer)
+{
+	Record(RenderCall::SET_INDEX_BUFFER, buffer);
+}
+
+void NullRenderDevice::DoSetVSConstantBuffer(UINT slot, DeviceBuffer* buffer)
+{
+	Record(RenderCall::SET_VS_CONSTANT_BUFFER, buffer, slot);
+}
+
+void NullRenderDevice::DoSetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	Record(RenderCall::SET_VS_CONSTANT_BUFFER_RANGE, buffer, slot, firstConstant, numConstants);
+}
+
+void NullRenderDevice::DoDraw(UINT vertexCount, UINT startVertex)
+{
+	Record(RenderCall::DRAW, nullptr, vertexCount, startVertex);
+}
+
+void NullRenderDevice::DoDrawIndexed(UINT indexCount, UINT startIndex, int baseVertex)
+{
+	Record(RenderCall::DRAW_INDEXED, nullptr, indexCount, startIndex, baseVertex);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "RenderDevice.h"
+#include <cstdint>
+#include <vector>
+
+enum class RenderCall
+{
+	CREATE_BUFFER, RELEASE_BUFFER, MAP, UNMAP, UPDATE_BUFFER, COPY_BUFFER,
+	SET_PRIMITIVE_TOPOLOGY, SET_INPUT_LAYOUT, SET_VERTEX_SHADER, SET_PIXEL_SHADER, SET_BLEND_MODE,
+	SET_VERTEX_BUFFER, SET_INDEX_BUFFER, SET_VS_CONSTANT_BUFFER, SET_VS_CONSTANT_BUFFER_RANGE,
+	DRAW, DRAW_INDEXED
+};
+
+// One recorded call: `object` is the buffer, shader or layout it refers
+// to, the meaning of args[] follows the parameter order of the call.
+struct RecordedCall
+{
+	RenderCall call;
+	const void* object;
+	std::int64_t args[3];
+};
+
+// Backend without a GPU. Buffers live in system memory so Map works, and
+// every call of the current frame is recorded. Used to measure the CPU
+// cost of building a frame where no D3D11 device is available.
+class NullRenderDevice : public RenderDevice
+{
+public:
+	NullRenderDevice();
+
+	// Calls since the last BeginFrame. Turn off for long benchmark runs.
+	const std::vector<RecordedCall>& Calls() const;
+	bool recordCalls = true;
+
+	// Backing memory of a buffer, to inspect what was uploaded.
+	const std::vector<std::uint8_t>& BufferContents(DeviceBuffer* buffer) const;
+	// Buffers created and not yet released, to catch leaks.
+	UINT LiveBuffers() const;
+
+protected:
+	void OnBeginFrame() override;
+	HRESULT DoCreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer) override;
+	void DoReleaseBuffer(DeviceBuffer* buffer) override;
+	HRESULT DoMap(DeviceBuffer* buffer, MapMode mode, void** data) override;
+	void DoUnmap(DeviceBuffer* buffer) override;
+	void DoUpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size) override;
+	void DoCopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size) override;
+	void DoSetPrimitiveTopology(PrimitiveTopology topology) override;
+	void DoSetInputLayout(DeviceInputLayout* layout) override;
+	void DoSetVertexShader(DeviceVertexShader* shader) override;
+	void DoSetPixelShader(DevicePixelShader* shader) override;
+	void DoSetBlendMode(BlendMode mode) override;
+	void DoSetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset) override;
+	void DoSetIndexBuffer(DeviceBuffer* buffer) override;
+	void DoSetVSConstantBuffer(UINT slot, DeviceBuffer* buffer) override;
+	void DoSetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants) override;
+	void DoDraw(UINT vertexCount, UINT startVertex) override;
+	void DoDrawIndexed(UINT indexCount, UINT startIndex, int baseVertex) override;
+
+private:
+	struct NullBuffer
+	{
+		BufferDesc desc;
+		std::vector<std::uint8_t> data;
+		bool mapped = false;
+	};
+
+	void Record(RenderCall call, const void* object, std::int64_t a = 0, std::int64_t b = 0, std::int64_t c = 0);
+
+	std::vector<RecordedCall> calls;
+	UINT liveBuffers = 0;
+};
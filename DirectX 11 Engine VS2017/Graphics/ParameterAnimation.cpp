@@ -0,0 +1,60 @@
+#include "ParameterAnimation.h"
+#include <algorithm>
+#include <cmath>
+
+void ParameterTrack::SetKeyframes(std::vector<Keyframe> keyframes)
+{
+	std::sort(keyframes.begin(), keyframes.end(), [](const Keyframe& lhs, const Keyframe& rhs) { return lhs.time < rhs.time; });
+	this->keyframes = std::move(keyframes);
+}
+
+void ParameterTrack::SetSweep(float from, float to, float unitsPerSecond)
+{
+	const float speed = std::fabs(unitsPerSecond);
+	const float duration = speed > 0.0f ? std::fabs(to - from) / speed : 0.0f;
+
+	Keyframe start;
+	start.value = from;
+	Keyframe end;
+	end.time = duration;
+	end.value = to;
+	SetKeyframes({ start, end });
+}
+
+float ParameterTrack::Evaluate(float time) const
+{
+	if (keyframes.empty())
+		return 0.0f;
+
+	const float first = keyframes.front().time;
+	const float duration = Duration();
+	float t = time - first;
+	if (looping && duration > 0.0f)
+	{
+		const float cycles = std::floor(t / duration);
+		t -= cycles * duration;
+		if (pingPong && static_cast<long long>(cycles) % 2 != 0)
+			t = duration - t;
+	}
+	t += first;
+
+	if (t <= first)
+		return keyframes.front().value;
+	if (t >= keyframes.back().time)
+		return keyframes.back().value;
+
+	auto next = std::upper_bound(keyframes.begin(), keyframes.end(), t, [](float value, const Keyframe& key) { return value < key.time; });
+	auto prev = next - 1;
+	const float f = (t - prev->time) / (next->time - prev->time);
+	return prev->value + f * (next->value - prev->value);
+}
+
+float ParameterTrack::Duration() const
+{
+	return keyframes.empty() ? 0.0f : keyframes.back().time - keyframes.front().time;
+}
+
+bool ParameterTrack::IsEmpty() const
+{
+	return keyframes.empty();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+
+struct Keyframe
+{
+	float time = 0.0f;
+	float value = 0.0f;
+};
+
+// Piecewise linear curve of a single parameter over time.
+class ParameterTrack
+{
+public:
+	// Keyframes don't have to be sorted.
+	void SetKeyframes(std::vector<Keyframe> keyframes);
+	// Two keyframes going from `from` to `to` at unitsPerSecond.
+	void SetSweep(float from, float to, float unitsPerSecond);
+
+	float Evaluate(float time) const;
+	float Duration() const;
+	bool IsEmpty() const;
+
+	bool looping = true;
+	// When looping, play every other cycle backwards instead of jumping back.
+	bool pingPong = false;
+
+private:
+	std::vector<Keyframe> keyframes;
+};
@@ -0,0 +1,148 @@
+#include "RenderDevice.h"
+
+void RenderDevice::BeginFrame()
+{
+	last = current;
+	current = RenderStats();
+	++frameIndex;
+	OnBeginFrame();
+}
+
+unsigned long long RenderDevice::FrameIndex() const
+{
+	return frameIndex;
+}
+
+const RenderStats& RenderDevice::CurrentFrameStats() const
+{
+	return current;
+}
+
+const RenderStats& RenderDevice::LastFrameStats() const
+{
+	return last;
+}
+
+HRESULT RenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer)
+{
+	*buffer = nullptr;
+	if (desc.byteWidth == 0)
+		return E_INVALIDARG;
+
+	HRESULT hr = DoCreateBuffer(desc, initialData, buffer);
+	if (FAILED(hr))
+		return hr;
+	++current.buffersCreated;
+	if (initialData)
+		current.uploadedBytes += desc.byteWidth;
+	return S_OK;
+}
+
+void RenderDevice::ReleaseBuffer(DeviceBuffer* buffer)
+{
+	if (buffer)
+		DoReleaseBuffer(buffer);
+}
+
+HRESULT RenderDevice::Map(DeviceBuffer* buffer, MapMode mode, void** data)
+{
+	*data = nullptr;
+	if (!buffer)
+		return E_INVALIDARG;
+	++current.maps;
+	return DoMap(buffer, mode, data);
+}
+
+void RenderDevice::Unmap(DeviceBuffer* buffer, UINT bytesWritten)
+{
+	current.uploadedBytes += bytesWritten;
+	DoUnmap(buffer);
+}
+
+HRESULT RenderDevice::UpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size)
+{
+	if (!buffer || !data)
+		return E_INVALIDARG;
+	current.uploadedBytes += size;
+	DoUpdateBuffer(buffer, offset, data, size);
+	return S_OK;
+}
+
+void RenderDevice::CopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size)
+{
+	++current.copies;
+	DoCopyBuffer(destination, dstOffset, source, srcOffset, size);
+}
+
+void RenderDevice::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+	++current.stateChanges;
+	DoSetPrimitiveTopology(topology);
+}
+
+void RenderDevice::SetInputLayout(DeviceInputLayout* layout)
+{
+	++current.stateChanges;
+	DoSetInputLayout(layout);
+}
+
+void RenderDevice::SetVertexShader(DeviceVertexShader* shader)
+{
+	++current.stateChanges;
+	DoSetVertexShader(shader);
+}
+
+void RenderDevice::SetPixelShader(DevicePixelShader* shader)
+{
+	++current.stateChanges;
+	DoSetPixelShader(shader);
+}
+
+void RenderDevice::SetBlendMode(BlendMode mode)
+{
+	++current.stateChanges;
+	DoSetBlendMode(mode);
+}
+
+void RenderDevice::SetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset)
+{
+	++current.stateChanges;
+	DoSetVertexBuffer(buffer, stride, offset);
+}
+
+void RenderDevice::SetIndexBuffer(DeviceBuffer* buffer)
+{
+	++current.stateChanges;
+	DoSetIndexBuffer(buffer);
+}
+
+void RenderDevice::SetVSConstantBuffer(UINT slot, DeviceBuffer* buffer)
+{
+	++current.stateChanges;
+	DoSetVSConstantBuffer(slot, buffer);
+}
+
+bool RenderDevice::SupportsConstantBufferOffsets() const
+{
+	return constantBufferOffsets;
+}
+
+void RenderDevice::SetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	++current.stateChanges;
+	DoSetVSConstantBufferRange(slot, buffer, firstConstant, numConstants);
+}
+
+void RenderDevice::Draw(UINT vertexCount, UINT startVertex)
+{
+	++current.draws;
+	current.drawnElements += vertexCount;
+	DoDraw(vertexCount, startVertex);
+}
+
+void RenderDevice::DrawIndexed(UINT indexCount, UINT startIndex, int baseVertex)
+{
+	++current.draws;
+	current.drawnElements += indexCount;
+	DoDrawIndexed(indexCount, startIndex, baseVertex);
+}
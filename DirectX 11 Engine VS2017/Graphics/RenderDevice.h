@@ -0,0 +1,109 @@
+#pragma once
+#include "../Platform.h"
+
+// Opaque resource handles. Each backend decides what they point at.
+struct DeviceBuffer;
+struct DeviceVertexShader;
+struct DevicePixelShader;
+struct DeviceInputLayout;
+
+enum class BufferType { VERTEX, INDEX, CONSTANT };
+enum class MapMode { WRITE_DISCARD, WRITE_NO_OVERWRITE };
+enum class PrimitiveTopology { POINT_LIST, LINE_LIST, LINE_STRIP, TRIANGLE_LIST, TRIANGLE_STRIP };
+// ALPHA blends with straight, non-premultiplied alpha.
+enum class BlendMode { NONE, ALPHA };
+
+struct BufferDesc
+{
+	BufferType type = BufferType::VERTEX;
+	UINT byteWidth = 0;
+	// Dynamic buffers are written through Map; the others only get their
+	// initial data.
+	bool dynamic = false;
+};
+
+// What was submitted to the device during one frame.
+struct RenderStats
+{
+	UINT draws = 0;
+	unsigned long long drawnElements = 0; // vertices or indices
+	UINT stateChanges = 0;
+	UINT maps = 0;
+	// Bytes written through Map or UpdateBuffer.
+	unsigned long long uploadedBytes = 0;
+	UINT copies = 0;
+	UINT buffersCreated = 0;
+};
+
+// The calls the engine makes to render a frame. Public methods count
+// every call into the frame's RenderStats and forward to the backend, so
+// all backends report the same numbers for the same frame.
+class RenderDevice
+{
+public:
+	virtual ~RenderDevice() {}
+
+	// Ends the current frame's statistics and starts new ones.
+	void BeginFrame();
+	// Number of BeginFrame calls so far.
+	unsigned long long FrameIndex() const;
+	const RenderStats& CurrentFrameStats() const;
+	const RenderStats& LastFrameStats() const;
+
+	HRESULT CreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer);
+	void ReleaseBuffer(DeviceBuffer* buffer);
+
+	// Dynamic buffers only. The pointer is to the start of the buffer;
+	// bytesWritten only feeds the statistics.
+	HRESULT Map(DeviceBuffer* buffer, MapMode mode, void** data);
+	void Unmap(DeviceBuffer* buffer, UINT bytesWritten);
+	// Writes into a non-dynamic buffer through the driver's own copy.
+	HRESULT UpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size);
+	// GPU copy between buffers; the destination must not be dynamic.
+	void CopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size);
+
+	void SetPrimitiveTopology(PrimitiveTopology topology);
+	void SetInputLayout(DeviceInputLayout* layout);
+	void SetVertexShader(DeviceVertexShader* shader);
+	void SetPixelShader(DevicePixelShader* shader);
+	void SetBlendMode(BlendMode mode);
+	void SetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset);
+	// Indices are 32-bit.
+	void SetIndexBuffer(DeviceBuffer* buffer);
+	void SetVSConstantBuffer(UINT slot, DeviceBuffer* buffer);
+	// Binds numConstants 16-byte constants starting at firstConstant; both
+	// must be multiples of 16. Only on devices that support it.
+	bool SupportsConstantBufferOffsets() const;
+	void SetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants);
+
+	void Draw(UINT vertexCount, UINT startVertex);
+	void DrawIndexed(UINT indexCount, UINT startIndex, int baseVertex);
+
+protected:
+	virtual void OnBeginFrame() {}
+	virtual HRESULT DoCreateBuffer(const BufferDesc& desc, const void* initialData, DeviceBuffer** buffer) = 0;
+	virtual void DoReleaseBuffer(DeviceBuffer* buffer) = 0;
+	virtual HRESULT DoMap(DeviceBuffer* buffer, MapMode mode, void** data) = 0;
+	virtual void DoUnmap(DeviceBuffer* buffer) = 0;
+	virtual void DoUpdateBuffer(DeviceBuffer* buffer, UINT offset, const void* data, UINT size) = 0;
+	virtual void DoCopyBuffer(DeviceBuffer* destination, UINT dstOffset, DeviceBuffer* source, UINT srcOffset, UINT size) = 0;
+	virtual void DoSetPrimitiveTopology(PrimitiveTopology topology) = 0;
+	virtual void DoSetInputLayout(DeviceInputLayout* layout) = 0;
+	virtual void DoSetVertexShader(DeviceVertexShader* shader) = 0;
+	virtual void DoSetPixelShader(DevicePixelShader* shader) = 0;
+	virtual void DoSetBlendMode(BlendMode mode) = 0;
+	virtual void DoSetVertexBuffer(DeviceBuffer* buffer, UINT stride, UINT offset) = 0;
+	virtual void DoSetIndexBuffer(DeviceBuffer* buffer) = 0;
+	virtual void DoSetVSConstantBuffer(UINT slot, DeviceBuffer* buffer) = 0;
+	virtual void DoSetVSConstantBufferRange(UINT slot, DeviceBuffer* buffer, UINT firstConstant, UINT numConstants) = 0;
+	virtual void DoDraw(UINT vertexCount, UINT startVertex) = 0;
+	virtual void DoDrawIndexed(UINT indexCount, UINT startIndex, int baseVertex) = 0;
+
+	// Set by backends that implement DoSetVSConstantBufferRange.
+	bool constantBufferOffsets = false;
+
+private:
+	RenderStats current;
+	RenderStats last;
+	unsigned long long frameIndex = 0;
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "../Jobs/SpscQueue.h"
+#include <functional>
+
+// GPU work handed from the update thread to the render thread, run in order
+// before the render thread draws its next frame. Only the render thread
+// uses the device context once it is running, so anything that fills,
+// creates or releases buffers after start-up goes through here.
+typedef std::function<void()> RenderTask;
+typedef SpscQueue<RenderTask> RenderTaskQueue;
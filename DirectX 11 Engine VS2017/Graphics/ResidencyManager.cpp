@@ -0,0 +1,198 @@
+#include "ResidencyManager.h"
+#include <algorithm>
+
+const char* ResidencyCategoryName(ResidencyCategory category)
+{
+	switch (category)
+	{
+	case ResidencyCategory::CURVES: return "Curves";
+	case ResidencyCategory::FAMILY: return "Curve family";
+	case ResidencyCategory::ANIMATION: return "Animation";
+	case ResidencyCategory::STROKE: return "Strokes";
+	case ResidencyCategory::GRID: return "Grid";
+	case ResidencyCategory::STAGING: return "Staging";
+	default: return "";
+	}
+}
+
+ResidencyManager::ResourceId ResidencyManager::Register(ResidencyCategory category, const std::string& name, Evictor evict)
+{
+	ResourceId id;
+	if (!freeIds.empty())
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else
+	{
+		resources.emplace_back();
+		id = static_cast<ResourceId>(resources.size());
+	}
+
+	Resource& resource = resources[id - 1];
+	resource = Resource();
+	resource.registered = true;
+	resource.name = name;
+	resource.category = category;
+	resource.evict = std::move(evict);
+	resource.lastUsed = frame;
+	++usage[static_cast<int>(category)].resources;
+	return id;
+}
+
+void ResidencyManager::Unregister(ResourceId id)
+{
+	Resource* resource = Find(id);
+	if (!resource)
+		return;
+	SetBytes(id, 0);
+	--usage[static_cast<int>(resource->category)].resources;
+	*resource = Resource();
+	freeIds.push_back(id);
+}
+
+void ResidencyManager::SetBytes(ResourceId id, unsigned long long bytes)
+{
+	Resource* resource = Find(id);
+	if (!resource)
+		return;
+	CategoryUsage& category = usage[static_cast<int>(resource->category)];
+	if (resource->resident)
+	{
+		category.residentBytes += bytes - resource->bytes;
+		totalBytes += bytes - resource->bytes;
+	}
+	else
+	{
+		category.evictedBytes += bytes - resource->bytes;
+	}
+	resource->bytes = bytes;
+}
+
+void ResidencyManager::BeginFrame()
+{
+	++frame;
+}
+
+bool ResidencyManager::Touch(ResourceId id)
+{
+	Resource* resource = Find(id);
+	if (!resource)
+		return false;
+	resource->lastUsed = frame;
+	return resource->resident;
+}
+
+void ResidencyManager::MarkResident(ResourceId id)
+{
+	Resource* resource = Find(id);
+	if (!resource || resource->resident)
+		return;
+	CategoryUsage& category = usage[static_cast<int>(resource->category)];
+	category.evictedBytes -= resource->bytes;
+	category.residentBytes += resource->bytes;
+	totalBytes += resource->bytes;
+	resource->resident = true;
+}
+
+bool ResidencyManager::IsResident(ResourceId id) const
+{
+	const Resource* resource = Find(id);
+	return resource && resource->resident;
+}
+
+unsigned int ResidencyManager::Enforce()
+{
+	if (totalBytes <= budgetBytes)
+		return 0;
+
+	candidates.clear();
+	for (Resource& resource : resources)
+	{
+		if (resource.registered && resource.resident && resource.evict && resource.bytes > 0 &&
+			frame - resource.lastUsed >= minIdleFrames)
+			candidates.push_back(&resource);
+	}
+	// Oldest first; among equally old ones the largest, so fewer go.
+	std::sort(candidates.begin(), candidates.end(), [](const Resource* a, const Resource* b)
+	{
+		if (a->lastUsed != b->lastUsed)
+			return a->lastUsed < b->lastUsed;
+		return a->bytes > b->bytes;
+	});
+
+	unsigned int evicted = 0;
+	for (Resource* resource : candidates)
+	{
+		if (totalBytes <= budgetBytes)
+			break;
+		Evict(*resource);
+		++evicted;
+	}
+	return evicted;
+}
+
+void ResidencyManager::Evict(Resource& resource)
+{
+	CategoryUsage& category = usage[static_cast<int>(resource.category)];
+	category.residentBytes -= resource.bytes;
+	category.evictedBytes += resource.bytes;
+	++category.evictions;
+	totalBytes -= resource.bytes;
+	++totalEvictions;
+	resource.resident = false;
+	resource.evict();
+}
+
+unsigned long long ResidencyManager::TotalBytes() const
+{
+	return totalBytes;
+}
+
+const ResidencyManager::CategoryUsage& ResidencyManager::Usage(ResidencyCategory category) const
+{
+	return usage[static_cast<int>(category)];
+}
+
+unsigned long long ResidencyManager::TotalEvictions() const
+{
+	return totalEvictions;
+}
+
+void ResidencyManager::Resources(std::vector<ResourceInfo>& out) const
+{
+	out.clear();
+	for (size_t i = 0; i < resources.size(); ++i)
+	{
+		const Resource& resource = resources[i];
+		if (!resource.registered)
+			continue;
+		ResourceInfo info;
+		info.id = static_cast<ResourceId>(i + 1);
+		info.name = resource.name;
+		info.category = resource.category;
+		info.bytes = resource.bytes;
+		info.evictable = static_cast<bool>(resource.evict);
+		info.resident = resource.resident;
+		info.idleFrames = frame - resource.lastUsed;
+		out.push_back(info);
+	}
+	std::stable_sort(out.begin(), out.end(), [](const ResourceInfo& a, const ResourceInfo& b)
+	{
+		return a.idleFrames < b.idleFrames;
+	});
+}
+
+ResidencyManager::Resource* ResidencyManager::Find(ResourceId id)
+{
+	if (id == 0 || id > resources.size() || !resources[id - 1].registered)
+		return nullptr;
+	return &resources[id - 1];
+}
+
+const ResidencyManager::Resource* ResidencyManager::Find(ResourceId id) const
+{
+	if (id == 0 || id > resources.size() || !resources[id - 1].registered)
+		return nullptr;
+	return &resources[id - 1];
+}
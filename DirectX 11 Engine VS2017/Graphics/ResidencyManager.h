@@ -0,0 +1,98 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+enum class ResidencyCategory { CURVES, FAMILY, ANIMATION, STROKE, GRID, STAGING, COUNT };
+
+const char* ResidencyCategoryName(ResidencyCategory category);
+
+// GPU memory by resource and category, kept under a budget. Resources
+// registered with an evict function may be evicted when the total goes
+// over the budget, least recently used first; the caller then rebuilds
+// them before their next use and marks them resident again. Resources
+// without one are only accounted for.
+//
+// Owned by the update thread, which decides what each frame draws. Evict
+// functions run there too, so they post the actual release to the render
+// thread like every other buffer change. They must not register or
+// unregister resources.
+class ResidencyManager
+{
+public:
+	typedef unsigned int ResourceId;
+	typedef std::function<void()> Evictor;
+
+	struct CategoryUsage
+	{
+		unsigned long long residentBytes = 0;
+		// What the evicted resources of the category would take back.
+		unsigned long long evictedBytes = 0;
+		unsigned int resources = 0;
+		unsigned int evictions = 0;
+	};
+
+	struct ResourceInfo
+	{
+		ResourceId id = 0;
+		std::string name;
+		ResidencyCategory category = ResidencyCategory::CURVES;
+		unsigned long long bytes = 0;
+		bool evictable = false;
+		bool resident = true;
+		// Frames since the resource was last used.
+		unsigned long long idleFrames = 0;
+	};
+
+	// Resources start resident, 0 bytes in size and used in this frame.
+	ResourceId Register(ResidencyCategory category, const std::string& name, Evictor evict = Evictor());
+	void Unregister(ResourceId id);
+	// Size while resident.
+	void SetBytes(ResourceId id, unsigned long long bytes);
+
+	// Starts a new frame of use.
+	void BeginFrame();
+	// Marks the resource as used by this frame. False when it is evicted
+	// and has to be rebuilt before it is used.
+	bool Touch(ResourceId id);
+	void MarkResident(ResourceId id);
+	bool IsResident(ResourceId id) const;
+	// Evicts until the resident total fits the budget; resources used in
+	// the last minIdleFrames frames stay. Returns the number evicted.
+	unsigned int Enforce();
+
+	unsigned long long TotalBytes() const;
+	const CategoryUsage& Usage(ResidencyCategory category) const;
+	unsigned long long TotalEvictions() const;
+	// Registered resources, most recently used first.
+	void Resources(std::vector<ResourceInfo>& out) const;
+
+	unsigned long long budgetBytes = 64ull * 1024 * 1024;
+	unsigned int minIdleFrames = 2;
+
+private:
+	struct Resource
+	{
+		bool registered = false;
+		std::string name;
+		ResidencyCategory category = ResidencyCategory::CURVES;
+		unsigned long long bytes = 0;
+		Evictor evict;
+		bool resident = true;
+		unsigned long long lastUsed = 0;
+	};
+
+	Resource* Find(ResourceId id);
+	const Resource* Find(ResourceId id) const;
+	void Evict(Resource& resource);
+
+	// Ids are slot indices plus one, so 0 is never a valid id. Slots of
+	// unregistered resources are reused.
+	std::vector<Resource> resources;
+	std::vector<ResourceId> freeIds;
+	CategoryUsage usage[static_cast<int>(ResidencyCategory::COUNT)];
+	unsigned long long totalBytes = 0;
+	unsigned long long totalEvictions = 0;
+	unsigned long long frame = 0;
+	std::vector<Resource*> candidates;
+};
@@ -1,4 +1,5 @@
 #include "Shaders.h"
+#include "D3D11RenderDevice.h"
 
 bool VertexShader::Initialize(Microsoft::WRL::ComPtr<ID3D11Device>& device, std::wstring shaderpath, D3D11_INPUT_ELEMENT_DESC * layoutDesc, UINT numElements)
 {
@@ -45,6 +46,16 @@ ID3D11InputLayout * VertexShader::GetInputLayout()
 	return this->inputLayout.Get();
 }
 
+DeviceVertexShader * VertexShader::Handle()
+{
+	return D3D11RenderDevice::ToHandle(this->shader.Get());
+}
+
+DeviceInputLayout * VertexShader::LayoutHandle()
+{
+	return D3D11RenderDevice::ToHandle(this->inputLayout.Get());
+}
+
 bool PixelShader::Initialize(Microsoft::WRL::ComPtr<ID3D11Device>& device, std::wstring shaderpath)
 {
 	HRESULT hr = D3DReadFileToBlob(shaderpath.c_str(), this->shader_buffer.GetAddressOf());
@@ -76,4 +87,9 @@ ID3D11PixelShader * PixelShader::GetShader()
 ID3D10Blob * PixelShader::GetBuffer()
 {
 	return this->shader_buffer.Get();
+}
+
+DevicePixelShader * PixelShader::Handle()
+{
+	return D3D11RenderDevice::ToHandle(this->shader.Get());
 }
\ No newline at end of file
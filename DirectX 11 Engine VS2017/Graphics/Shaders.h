@@ -4,6 +4,7 @@
 #include <d3d11.h>
 #include <wrl/client.h>
 #include <d3dcompiler.h>
+#include "RenderDevice.h"
 
 class VertexShader
 {
@@ -12,6 +13,8 @@ public:
 	ID3D11VertexShader * GetShader();
 	ID3D10Blob * GetBuffer();
 	ID3D11InputLayout * GetInputLayout();
+	DeviceVertexShader * Handle();
+	DeviceInputLayout * LayoutHandle();
 private:
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> shader;
 	Microsoft::WRL::ComPtr<ID3D10Blob> shader_buffer;
@@ -24,6 +27,7 @@ public:
 	bool Initialize(Microsoft::WRL::ComPtr<ID3D11Device> &device, std::wstring shaderpath);
 	ID3D11PixelShader * GetShader();
 	ID3D10Blob * GetBuffer();
+	DevicePixelShader * Handle();
 private:
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> shader;
 	Microsoft::WRL::ComPtr<ID3D10Blob> shader_buffer;
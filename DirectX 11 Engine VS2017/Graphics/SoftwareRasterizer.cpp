@@ -0,0 +1,454 @@
+#include "SoftwareRasterizer.h"
+#include "../Jobs/ParallelFor.h"
+#include "../Math/TransformStream.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+using namespace DirectX;
+
+namespace
+{
+	const size_t setupGrain = 1 << 16;
+	const size_t transformBatch = 256;
+	const size_t binBlockSize = 1 << 16;
+	// Wu lines touch pixels up to one pixel away from the line.
+	const float binMargin = 1.0f;
+
+	std::uint32_t PackColor(float r, float g, float b, float a)
+	{
+		auto channel = [](float value) -> std::uint32_t
+		{
+			if (!(value > 0.0f))
+				return 0;
+			return value >= 1.0f ? 255u : static_cast<std::uint32_t>(value * 255.0f + 0.5f);
+		};
+		return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+	}
+
+	void UnpackColor(std::uint32_t color, float out[4])
+	{
+		for (int i = 0; i < 4; ++i)
+			out[i] = static_cast<float>((color >> (8 * i)) & 0xFF);
+	}
+
+	std::uint32_t LerpColor(std::uint32_t c0, std::uint32_t c1, float t)
+	{
+		float a[4], b[4];
+		UnpackColor(c0, a);
+		UnpackColor(c1, b);
+		std::uint32_t out = 0;
+		for (int i = 0; i < 4; ++i)
+			out |= static_cast<std::uint32_t>(a[i] + (b[i] - a[i]) * t + 0.5f) << (8 * i);
+		return out;
+	}
+
+	// Same projection onto a sphere as CommonVS.hlsl, followed by its
+	// rotation by pi/2 around Y.
+	XMFLOAT3 ProjectToSphere(const XMFLOAT3& p)
+	{
+		const float pi = 3.14159265f;
+		const float r = p.z;
+		const float phi = p.y / r;
+		const float theta = pi / 2 - p.x / r;
+		const float x = r * std::cos(phi) * std::sin(theta);
+		const float y = r * std::sin(phi) * std::sin(theta);
+		const float z = r * std::cos(theta);
+		const float c = std::cos(pi / 2);
+		const float s = std::sin(pi / 2);
+		return XMFLOAT3(x * c - z * s, y, x * s + z * c);
+	}
+
+	// Liang-Barsky step: keeps the part of [t0, t1] where d0 + t * (d1 - d0) >= 0.
+	bool ClipHalfSpace(float d0, float d1, float& t0, float& t1)
+	{
+		if (d0 < 0.0f && d1 < 0.0f)
+			return false;
+		if (d0 < 0.0f)
+			t0 = (std::max)(t0, d0 / (d0 - d1));
+		else if (d1 < 0.0f)
+			t1 = (std::min)(t1, d0 / (d0 - d1));
+		return t0 <= t1;
+	}
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, int tileSize)
+	: width((std::max)(width, 1))
+	, height((std::max)(height, 1))
+	, tileSize((std::max)(tileSize, 8))
+{
+	this->tilesX = (this->width + this->tileSize - 1) / this->tileSize;
+	this->tilesY = (this->height + this->tileSize - 1) / this->tileSize;
+	image.width = this->width;
+	image.height = this->height;
+	image.pixels.assign(static_cast<size_t>(this->width) * this->height * 4, 0);
+}
+
+void SoftwareRasterizer::Clear(const XMFLOAT4& color)
+{
+	clearColor = PackColor(color.x, color.y, color.z, color.w);
+	vertices.clear();
+	segments.clear();
+}
+
+void SoftwareRasterizer::DrawLineStrip(const VertexCommon* vertices, size_t count, const XMMATRIX& wvp, bool enableSpherical)
+{
+	AddVertices(vertices, count, true, wvp, enableSpherical);
+}
+
+void SoftwareRasterizer::DrawLineList(const VertexCommon* vertices, size_t count, const XMMATRIX& wvp, bool enableSpherical)
+{
+	AddVertices(vertices, count, false, wvp, enableSpherical);
+}
+
+void SoftwareRasterizer::AddVertices(const VertexCommon* input, size_t count, bool strip, const XMMATRIX& wvp, bool enableSpherical)
+{
+	// Segments address vertices with 32-bit indices.
+	const size_t base = this->vertices.size();
+	count = (std::min)(count, static_cast<size_t>((std::numeric_limits<std::uint32_t>::max)()) - base);
+	if (count < 2)
+		return;
+
+	const float halfWidth = 0.5f * width;
+	const float halfHeight = 0.5f * height;
+	this->vertices.resize(base + count);
+	ClipVertex* out = this->vertices.data() + base;
+	ParallelFor(count, setupGrain, [&](size_t begin, size_t end)
+	{
+		// Positions go through the transform stream a batch at a time.
+		alignas(64) float position[3][transformBatch];
+		alignas(64) float clip[4][transformBatch];
+		SoaPoints3 positions;
+		positions.x = position[0];
+		positions.y = position[1];
+		positions.z = position[2];
+		SoaPoints4 clipPositions;
+		clipPositions.x = clip[0];
+		clipPositions.y = clip[1];
+		clipPositions.z = clip[2];
+		clipPositions.w = clip[3];
+		for (size_t first = begin; first < end; first += transformBatch)
+		{
+			const size_t n = (std::min)(transformBatch, end - first);
+			for (size_t j = 0; j < n; ++j)
+			{
+				const XMFLOAT3& pos = input[first + j].pos;
+				const XMFLOAT3 p = enableSpherical ? ProjectToSphere(pos) : pos;
+				position[0][j] = p.x;
+				position[1][j] = p.y;
+				position[2][j] = p.z;
+			}
+			TransformPointsSerial(positions, n, wvp, clipPositions);
+
+			for (size_t j = 0; j < n; ++j)
+			{
+				ClipVertex& v = out[first + j];
+				v.x = clip[0][j];
+				v.y = clip[1][j];
+				v.z = clip[2][j];
+				v.w = clip[3][j];
+				const XMFLOAT4& c = input[first + j].color;
+				v.color = PackColor(c.x, c.y, c.z, c.w);
+
+				v.inside = false;
+				if (v.w > 0.0f && v.z >= 0.0f && v.z <= v.w)
+				{
+					v.screenX = (v.x / v.w + 1.0f) * halfWidth;
+					v.screenY = (1.0f - v.y / v.w) * halfHeight;
+					v.screenZ = v.z / v.w;
+					v.inside = v.screenX >= -binMargin && v.screenX <= width + binMargin &&
+						v.screenY >= -binMargin && v.screenY <= height + binMargin;
+				}
+			}
+		}
+	});
+
+	const size_t numSegments = strip ? count - 1 : count / 2;
+	const size_t firstSegment = segments.size();
+	segments.resize(firstSegment + numSegments);
+	std::uint32_t* segmentOut = segments.data() + firstSegment;
+	ParallelFor(numSegments, setupGrain, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+			segmentOut[i] = static_cast<std::uint32_t>(base + (strip ? i : 2 * i));
+	});
+}
+
+bool SoftwareRasterizer::ToScreen(std::uint32_t segment, ScreenSegment& out) const
+{
+	const ClipVertex& a = vertices[segment];
+	const ClipVertex& b = vertices[segment + 1];
+	if (a.inside && b.inside)
+	{
+		out.x0 = a.screenX;
+		out.y0 = a.screenY;
+		out.z0 = a.screenZ;
+		out.x1 = b.screenX;
+		out.y1 = b.screenY;
+		out.z1 = b.screenZ;
+		out.color0 = a.color;
+		out.color1 = b.color;
+		return true;
+	}
+
+	if (!std::isfinite(a.x + a.y + a.z + a.w) || !std::isfinite(b.x + b.y + b.z + b.w))
+		return false;
+
+	// Near (z >= 0) and far (z <= w) planes, as the D3D11 clipper does.
+	float t0 = 0.0f;
+	float t1 = 1.0f;
+	if (!ClipHalfSpace(a.z, b.z, t0, t1) || !ClipHalfSpace(a.w - a.z, b.w - b.z, t0, t1))
+		return false;
+
+	auto lerp = [](float x, float y, float t) { return x + (y - x) * t; };
+	const float w0 = lerp(a.w, b.w, t0);
+	const float w1 = lerp(a.w, b.w, t1);
+	if (!(w0 > 0.0f) || !(w1 > 0.0f))
+		return false;
+
+	const float halfWidth = 0.5f * width;
+	const float halfHeight = 0.5f * height;
+	float x0 = (lerp(a.x, b.x, t0) / w0 + 1.0f) * halfWidth;
+	float y0 = (1.0f - lerp(a.y, b.y, t0) / w0) * halfHeight;
+	float z0 = lerp(a.z, b.z, t0) / w0;
+	float x1 = (lerp(a.x, b.x, t1) / w1 + 1.0f) * halfWidth;
+	float y1 = (1.0f - lerp(a.y, b.y, t1) / w1) * halfHeight;
+	float z1 = lerp(a.z, b.z, t1) / w1;
+	std::uint32_t c0 = t0 > 0.0f ? LerpColor(a.color, b.color, t0) : a.color;
+	std::uint32_t c1 = t1 < 1.0f ? LerpColor(a.color, b.color, t1) : b.color;
+
+	// Trim to the viewport plus a guard pixel so coordinates stay small
+	// enough for integer conversion.
+	float s0 = 0.0f;
+	float s1 = 1.0f;
+	const float minX = -binMargin, maxX = width + binMargin;
+	const float minY = -binMargin, maxY = height + binMargin;
+	if (!ClipHalfSpace(x0 - minX, x1 - minX, s0, s1) || !ClipHalfSpace(maxX - x0, maxX - x1, s0, s1) ||
+		!ClipHalfSpace(y0 - minY, y1 - minY, s0, s1) || !ClipHalfSpace(maxY - y0, maxY - y1, s0, s1))
+		return false;
+
+	out.x0 = lerp(x0, x1, s0);
+	out.y0 = lerp(y0, y1, s0);
+	out.z0 = lerp(z0, z1, s0);
+	out.x1 = lerp(x0, x1, s1);
+	out.y1 = lerp(y0, y1, s1);
+	out.z1 = lerp(z0, z1, s1);
+	out.color0 = s0 > 0.0f ? LerpColor(c0, c1, s0) : c0;
+	out.color1 = s1 < 1.0f ? LerpColor(c0, c1, s1) : c1;
+	return true;
+}
+
+namespace
+{
+	// Calls func(tile) for every tile the segment passes within binMargin of.
+	template<class Func>
+	void ForEachTile(const float x0, const float y0, const float x1, const float y1,
+		int tileSize, int tilesX, int tilesY, const Func& func)
+	{
+		const int tx0 = (std::max)(0, static_cast<int>(std::floor(((std::min)(x0, x1) - binMargin) / tileSize)));
+		const int ty0 = (std::max)(0, static_cast<int>(std::floor(((std::min)(y0, y1) - binMargin) / tileSize)));
+		const int tx1 = (std::min)(tilesX - 1, static_cast<int>(std::floor(((std::max)(x0, x1) + binMargin) / tileSize)));
+		const int ty1 = (std::min)(tilesY - 1, static_cast<int>(std::floor(((std::max)(y0, y1) + binMargin) / tileSize)));
+
+		// Line equation n.p = c, used to skip tiles of the bounding box the
+		// segment doesn't cross.
+		const float nx = y1 - y0;
+		const float ny = x0 - x1;
+		const float c = nx * x0 + ny * y0;
+		const float reach = binMargin * (std::abs(nx) + std::abs(ny));
+
+		for (int ty = ty0; ty <= ty1; ++ty)
+		{
+			for (int tx = tx0; tx <= tx1; ++tx)
+			{
+				if (tx0 != tx1 && ty0 != ty1)
+				{
+					const float cx = (tx + 0.5f) * tileSize;
+					const float cy = (ty + 0.5f) * tileSize;
+					const float extent = 0.5f * tileSize * (std::abs(nx) + std::abs(ny));
+					if (std::abs(nx * cx + ny * cy - c) > extent + reach)
+						continue;
+				}
+				func(ty * tilesX + tx);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::BinSegments()
+{
+	const size_t numTiles = static_cast<size_t>(tilesX) * tilesY;
+	const size_t numBlocks = (segments.size() + binBlockSize - 1) / binBlockSize;
+
+	// Count per (block, tile), turn the counts into write cursors and fill.
+	// Cursors are laid out tile-major so every bin keeps submission order,
+	// which the depth test relies on for ties.
+	std::vector<std::uint32_t> cursors(numBlocks * numTiles, 0);
+	auto visit = [&](bool fill)
+	{
+		ParallelFor(numBlocks, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t block = begin; block < end; ++block)
+			{
+				std::uint32_t* blockCursors = cursors.data() + block * numTiles;
+				const size_t last = (std::min)(segments.size(), (block + 1) * binBlockSize);
+				for (size_t i = block * binBlockSize; i < last; ++i)
+				{
+					ScreenSegment s;
+					if (!ToScreen(segments[i], s))
+						continue;
+					ForEachTile(s.x0, s.y0, s.x1, s.y1, tileSize, tilesX, tilesY, [&](int tile)
+					{
+						if (fill)
+							binnedSegments[blockCursors[tile]++] = segments[i];
+						else
+							++blockCursors[tile];
+					});
+				}
+			}
+		});
+	};
+
+	visit(false);
+
+	binOffsets.resize(numTiles + 1);
+	std::uint32_t total = 0;
+	for (size_t tile = 0; tile < numTiles; ++tile)
+	{
+		binOffsets[tile] = total;
+		for (size_t block = 0; block < numBlocks; ++block)
+		{
+			const std::uint32_t count = cursors[block * numTiles + tile];
+			cursors[block * numTiles + tile] = total;
+			total += count;
+		}
+	}
+	binOffsets[numTiles] = total;
+	binnedSegments.resize(total);
+
+	visit(true);
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile, bool antialias)
+{
+	const int left = (tile % tilesX) * tileSize;
+	const int top = (tile / tilesX) * tileSize;
+	const int right = (std::min)(left + tileSize, width);
+	const int bottom = (std::min)(top + tileSize, height);
+	const int tileWidth = right - left;
+
+	std::vector<std::uint32_t> color(static_cast<size_t>(tileWidth) * (bottom - top), clearColor);
+	std::vector<float> depth(color.size(), 1.0f);
+
+	for (std::uint32_t i = binOffsets[tile]; i < binOffsets[tile + 1]; ++i)
+	{
+		ScreenSegment s;
+		if (!ToScreen(binnedSegments[i], s))
+			continue;
+
+		float c0[4], c1[4];
+		UnpackColor(s.color0, c0);
+		UnpackColor(s.color1, c1);
+
+		// Step along the major axis u, one pixel center at a time; v is the
+		// minor axis.
+		const bool steep = std::abs(s.y1 - s.y0) > std::abs(s.x1 - s.x0);
+		float u0 = steep ? s.y0 : s.x0, v0 = steep ? s.x0 : s.y0;
+		float u1 = steep ? s.y1 : s.x1, v1 = steep ? s.x1 : s.y1;
+		float z0 = s.z0, z1 = s.z1;
+		if (u0 > u1)
+		{
+			std::swap(u0, u1);
+			std::swap(v0, v1);
+			std::swap(z0, z1);
+			for (int k = 0; k < 4; ++k)
+				std::swap(c0[k], c1[k]);
+		}
+		const float length = u1 - u0;
+		if (!(length > 1e-6f))
+			continue;
+
+		const int uMin = steep ? top : left, uMax = steep ? bottom : right;
+		const int vMin = steep ? left : top, vMax = steep ? right : bottom;
+		const int first = (std::max)(static_cast<int>(std::ceil(u0 - 0.5f)), uMin);
+		const int last = (std::min)(static_cast<int>(std::floor(u1 - 0.5f)), uMax - 1);
+		const float slope = (v1 - v0) / length;
+
+		auto plot = [&](int u, int v, float t, float coverage)
+		{
+			if (v < vMin || v >= vMax || coverage <= 0.0f)
+				return;
+			const int x = steep ? v : u;
+			const int y = steep ? u : v;
+			const size_t index = static_cast<size_t>(y - top) * tileWidth + (x - left);
+			const float z = z0 + (z1 - z0) * t;
+			if (z > depth[index])
+				return;
+
+			float dst[4];
+			UnpackColor(color[index], dst);
+			std::uint32_t packed = 0;
+			for (int k = 0; k < 4; ++k)
+			{
+				const float src = c0[k] + (c1[k] - c0[k]) * t;
+				packed |= static_cast<std::uint32_t>(dst[k] + (src - dst[k]) * coverage + 0.5f) << (8 * k);
+			}
+			color[index] = packed;
+			if (coverage >= 0.5f)
+				depth[index] = z;
+		};
+
+		for (int u = first; u <= last; ++u)
+		{
+			const float center = u + 0.5f;
+			const float t = (center - u0) / length;
+			const float v = v0 + slope * (center - u0);
+			if (antialias)
+			{
+				// Xiaolin Wu: split the pixel between the two rows the line
+				// passes between.
+				const float below = v - 0.5f;
+				const float row = std::floor(below);
+				const float frac = below - row;
+				plot(u, static_cast<int>(row), t, 1.0f - frac);
+				plot(u, static_cast<int>(row) + 1, t, frac);
+			}
+			else
+			{
+				plot(u, static_cast<int>(std::floor(v)), t, 1.0f);
+			}
+		}
+	}
+
+	for (int y = top; y < bottom; ++y)
+	{
+		std::uint8_t* row = image.pixels.data() + (static_cast<size_t>(y) * width + left) * 4;
+		const std::uint32_t* src = color.data() + static_cast<size_t>(y - top) * tileWidth;
+		for (int x = 0; x < tileWidth; ++x)
+		{
+			row[4 * x + 0] = static_cast<std::uint8_t>(src[x]);
+			row[4 * x + 1] = static_cast<std::uint8_t>(src[x] >> 8);
+			row[4 * x + 2] = static_cast<std::uint8_t>(src[x] >> 16);
+			row[4 * x + 3] = static_cast<std::uint8_t>(src[x] >> 24);
+		}
+	}
+}
+
+void SoftwareRasterizer::Render(bool antialias)
+{
+	BinSegments();
+	ParallelFor(static_cast<size_t>(tilesX) * tilesY, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t tile = begin; tile < end; ++tile)
+			RasterizeTile(static_cast<int>(tile), antialias);
+	});
+}
+
+const RasterImage& SoftwareRasterizer::Image() const
+{
+	return image;
+}
+
+size_t SoftwareRasterizer::SegmentCount() const
+{
+	return segments.size();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Vertex.h"
+#include <cstdint>
+#include <vector>
+
+// 8-bit RGBA image, rows from top to bottom.
+struct RasterImage
+{
+	int width = 0;
+	int height = 0;
+	std::vector<std::uint8_t> pixels;
+};
+
+// CPU line renderer producing the same picture as the D3D11 pipeline:
+// CommonVS.hlsl transforms (including spherical mode), line topologies,
+// per-vertex color and a LESS_EQUAL depth test. Segments are binned into
+// screen tiles and the tiles are rasterized in parallel, so it runs
+// without a window or a GPU.
+class SoftwareRasterizer
+{
+public:
+	SoftwareRasterizer(int width, int height, int tileSize = 64);
+
+	void Clear(const DirectX::XMFLOAT4& color);
+
+	// Queue geometry; wvp is the untransposed world * view * projection.
+	void DrawLineStrip(const VertexCommon* vertices, size_t count, const DirectX::XMMATRIX& wvp, bool enableSpherical = false);
+	void DrawLineList(const VertexCommon* vertices, size_t count, const DirectX::XMMATRIX& wvp, bool enableSpherical = false);
+
+	// Rasterizes everything queued since the last Clear.
+	void Render(bool antialias);
+
+	const RasterImage& Image() const;
+	size_t SegmentCount() const;
+
+private:
+	// Vertex after the vertex shader. Vertices that need no clipping also
+	// carry their screen position so most segments skip the clipper.
+	struct ClipVertex
+	{
+		ClipVertex() {}
+
+		float x, y, z, w;
+		float screenX, screenY, screenZ;
+		std::uint32_t color;
+		bool inside;
+	};
+
+	struct ScreenSegment
+	{
+		float x0, y0, z0;
+		float x1, y1, z1;
+		std::uint32_t color0, color1;
+	};
+
+	void AddVertices(const VertexCommon* vertices, size_t count, bool strip, const DirectX::XMMATRIX& wvp, bool enableSpherical);
+	bool ToScreen(std::uint32_t segment, ScreenSegment& out) const;
+	void BinSegments();
+	void RasterizeTile(int tile, bool antialias);
+
+	int width;
+	int height;
+	int tileSize;
+	int tilesX;
+	int tilesY;
+	std::uint32_t clearColor = 0xFF000000;
+
+	std::vector<ClipVertex> vertices;
+	// Index of the first vertex of every segment, the second one follows it.
+	std::vector<std::uint32_t> segments;
+	// Segments of tile t are binnedSegments[binOffsets[t], binOffsets[t + 1]),
+	// in submission order.
+	std::vector<std::uint32_t> binOffsets;
+	std::vector<std::uint32_t> binnedSegments;
+
+	RasterImage image;
+};
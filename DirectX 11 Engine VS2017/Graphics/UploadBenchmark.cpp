@@ -0,0 +1,101 @@
+#include "UploadBenchmark.h"
+#include "Curves.h"
+#include "VertexBuffer.h"
+#include "../ErrorLogger.h"
+#include <chrono>
+#include <functional>
+
+using namespace DirectX;
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double BestOf(unsigned int runs, const std::function<bool()>& body)
+	{
+		double best = 0.0;
+		for (unsigned int run = 0; run < runs; ++run)
+		{
+			const Clock::time_point start = Clock::now();
+			if (!body())
+				return 0.0;
+			const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			best = run == 0 ? ms : (std::min)(best, ms);
+		}
+		return best;
+	}
+
+	void Add(const char* name, bool staged, double ms, unsigned long long bytes, std::vector<UploadBenchmarkResult>& out)
+	{
+		UploadBenchmarkResult result;
+		result.name = name;
+		result.staged = staged;
+		result.msPerRun = ms;
+		result.gigabytesPerSecond = ms > 0.0 ? bytes / (ms * 1e6) : 0.0;
+		result.bytesMoved = staged ? 3 * bytes : bytes;
+		out.push_back(result);
+	}
+}
+
+void RunUploadBenchmark(RenderDevice& device, unsigned int vertices, unsigned int runs, std::vector<UploadBenchmarkResult>& out)
+{
+	out.clear();
+	if (runs == 0 || vertices < 2)
+		return;
+
+	CurveParams params;
+	params.type = CurveType::ARHIMEDES;
+	params.a = 0.33f;
+	params.t_max = 31.4f;
+	params.t_num = vertices;
+	const unsigned int count = CurveVertexCount(params);
+	const XMFLOAT4 color(1.0f, 1.0f, 1.0f, 1.0f);
+	const unsigned long long bytes = static_cast<unsigned long long>(count) * sizeof(VertexCommon);
+
+	VertexBuffer<VertexCommon> buffer;
+	HRESULT hr = buffer.Initialize(&device, nullptr, count);
+	if (FAILED(hr))
+	{
+		ErrorLogger::Log(hr, "Failed to create the upload benchmark's vertex buffer.");
+		return;
+	}
+	std::vector<VertexCommon> staging(count);
+
+	const double staged = BestOf(runs, [&]()
+	{
+		GenerateCurve(params, color, std::span<VertexCommon>(staging.data(), staging.size()));
+		return SUCCEEDED(buffer.Update(staging.data(), count));
+	});
+	const double mapped = BestOf(runs, [&]()
+	{
+		std::span<VertexCommon> target;
+		if (FAILED(buffer.Map(MapMode::WRITE_DISCARD, target)))
+			return false;
+		const UINT written = GenerateCurve(params, color, target);
+		buffer.Unmap(written);
+		return written == count;
+	});
+	Add("Generate curve", true, staged, bytes, out);
+	Add("Generate curve", false, mapped, bytes, out);
+
+	// What a curve model's regeneration uploads: points the curve graph
+	// computed earlier, packed with the color.
+	std::vector<XMFLOAT3> points(count);
+	GenerateCurvePoints(params, std::span<XMFLOAT3>(points.data(), points.size()));
+	const double stagedPack = BestOf(runs, [&]()
+	{
+		PackCurveVertices(points.data(), count, color, staging.data());
+		return SUCCEEDED(buffer.Update(staging.data(), count));
+	});
+	const double mappedPack = BestOf(runs, [&]()
+	{
+		std::span<VertexCommon> target;
+		if (FAILED(buffer.Map(MapMode::WRITE_DISCARD, target)))
+			return false;
+		PackCurveVertices(points.data(), count, color, target.data());
+		buffer.Unmap(count);
+		return true;
+	});
+	Add("Pack points", true, stagedPack, bytes, out);
+	Add("Pack points", false, mappedPack, bytes, out);
+}
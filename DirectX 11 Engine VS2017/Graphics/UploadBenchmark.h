@@ -0,0 +1,26 @@
+#pragma once
+#include "RenderDevice.h"
+#include <vector>
+
+// What writing vertices straight into a mapped buffer saves over writing
+// them to system memory first and copying them in with
+// VertexBuffer::Update.
+struct UploadBenchmarkResult
+{
+	const char* name = "";
+	// Through a staging vector, or straight into the mapped buffer.
+	bool staged = false;
+	double msPerRun = 0.0;
+	// Bytes of vertices uploaded per second.
+	double gigabytesPerSecond = 0.0;
+	// Bytes the CPU read and wrote for one upload: staging writes the
+	// vertices, reads them back and writes them again.
+	unsigned long long bytesMoved = 0;
+};
+
+// Generates a curve of `vertices` vertices into a dynamic vertex buffer of
+// `device`, and packs precomputed points of it into the buffer as curve
+// models do, both ways, and reports the best of `runs` runs of each. With
+// the null device the buffer is plain system memory; with D3D11 it is
+// whatever the driver maps, usually write-combined memory.
+void RunUploadBenchmark(RenderDevice& device, unsigned int vertices, unsigned int runs, std::vector<UploadBenchmarkResult>& out);
@@ -0,0 +1,197 @@
+#include "UploadRing.h"
+#include "../ErrorLogger.h"
+#include <cstring>
+
+void RingAllocator::Reset(UINT capacity)
+{
+	this->capacity = capacity;
+	this->head = 0;
+	this->tail = 0;
+	this->allocated = 0;
+	this->freed = 0;
+	this->frames.clear();
+}
+
+UINT RingAllocator::Allocate(UINT size, UINT alignment, bool& wrapped)
+{
+	wrapped = false;
+	if (size == 0 || size > this->capacity)
+		return invalidOffset;
+
+	const UINT used = Used();
+	if (used == 0)
+	{
+		// Nothing is live, so the free space starts at the head.
+		this->tail = this->head;
+	}
+	else if (used == this->capacity)
+		return invalidOffset;
+
+	const std::uint64_t aligned = (static_cast<std::uint64_t>(this->head) + alignment - 1) & ~static_cast<std::uint64_t>(alignment - 1);
+	if (this->head >= this->tail)
+	{
+		// Free space is [head, capacity) followed by [0, tail).
+		if (aligned + size <= this->capacity)
+		{
+			this->allocated += aligned + size - this->head;
+			this->head = static_cast<UINT>(aligned + size);
+			return static_cast<UINT>(aligned);
+		}
+		if (used == 0)
+		{
+			// Empty: start over at 0 whatever the tail was. Frames with
+			// nothing allocated may still point at the old head.
+			for (FrameMark& mark : this->frames)
+				mark.end = 0;
+			this->tail = 0;
+		}
+		else if (size > this->tail)
+			return invalidOffset;
+		else
+			this->allocated += this->capacity - this->head;
+
+		wrapped = true;
+		this->allocated += size;
+		this->head = size;
+		return 0;
+	}
+
+	// Wrapped already: free space is [head, tail).
+	if (aligned + size > this->tail)
+		return invalidOffset;
+	this->allocated += aligned + size - this->head;
+	this->head = static_cast<UINT>(aligned + size);
+	return static_cast<UINT>(aligned);
+}
+
+void RingAllocator::EndFrame(std::uint64_t frame)
+{
+	FrameMark mark;
+	mark.frame = frame;
+	mark.end = this->head;
+	mark.allocated = this->allocated;
+	this->frames.push_back(mark);
+}
+
+void RingAllocator::Retire(std::uint64_t completedFrame)
+{
+	while (!this->frames.empty() && this->frames.front().frame <= completedFrame)
+	{
+		this->tail = this->frames.front().end;
+		this->freed = this->frames.front().allocated;
+		this->frames.pop_front();
+	}
+}
+
+UINT RingAllocator::Used() const
+{
+	return static_cast<UINT>(this->allocated - this->freed);
+}
+
+UINT RingAllocator::Capacity() const
+{
+	return this->capacity;
+}
+
+UploadRing::~UploadRing()
+{
+	if (device)
+		device->ReleaseBuffer(buffer);
+}
+
+HRESULT UploadRing::CreateBuffer(UINT byteWidth)
+{
+	if (device)
+		device->ReleaseBuffer(buffer);
+	buffer = nullptr;
+	ring.Reset(0);
+
+	BufferDesc desc;
+	desc.type = BufferType::VERTEX;
+	desc.byteWidth = byteWidth;
+	desc.dynamic = true;
+
+	HRESULT hr = device->CreateBuffer(desc, nullptr, &buffer);
+	if (SUCCEEDED(hr))
+		ring.Reset(byteWidth);
+	discarded = false;
+	return hr;
+}
+
+HRESULT UploadRing::Initialize(RenderDevice* device, UINT byteWidth)
+{
+	this->device = device;
+	this->overflowBytes = 0;
+	return CreateBuffer((byteWidth + alignment - 1) / alignment * alignment);
+}
+
+void UploadRing::BeginFrame()
+{
+	if (!device)
+		return;
+
+	// The previous frame ends here; frames the GPU has certainly finished
+	// give their ranges back.
+	const std::uint64_t frame = device->FrameIndex();
+	if (frame > 0)
+		ring.EndFrame(frame - 1);
+	if (frame > framesInFlight)
+		ring.Retire(frame - framesInFlight - 1);
+
+	if (overflowBytes > 0 && ring.Capacity() < maxByteWidth)
+	{
+		// Dropping the old buffer is safe: pending copies keep it alive.
+		const std::uint64_t needed = static_cast<std::uint64_t>(ring.Capacity()) + overflowBytes;
+		UINT byteWidth = ring.Capacity() > 0 ? ring.Capacity() : alignment;
+		while (byteWidth < maxByteWidth && byteWidth < needed)
+			byteWidth *= 2;
+		HRESULT hr = CreateBuffer(byteWidth);
+		if (FAILED(hr))
+			ErrorLogger::Log(hr, "Failed to grow upload ring.");
+	}
+	overflowBytes = 0;
+}
+
+HRESULT UploadRing::Upload(DeviceBuffer* destination, UINT dstOffset, const void* data, UINT size)
+{
+	if (!destination || size == 0)
+		return E_INVALIDARG;
+
+	bool wrapped = false;
+	const UINT offset = buffer ? ring.Allocate(size, alignment, wrapped) : RingAllocator::invalidOffset;
+	if (offset == RingAllocator::invalidOffset)
+	{
+		overflowBytes += size;
+		++fallbackUploads;
+		return device->UpdateBuffer(destination, dstOffset, data, size);
+	}
+
+	// Ranges not handed out since the last discard were never drawn from,
+	// so appending can't stall; a wrap starts a fresh buffer.
+	const MapMode mode = wrapped || !discarded ? MapMode::WRITE_DISCARD : MapMode::WRITE_NO_OVERWRITE;
+	void* mapped = nullptr;
+	HRESULT hr = device->Map(buffer, mode, &mapped);
+	if (FAILED(hr))
+		return hr;
+	discarded = true;
+	memcpy(static_cast<std::uint8_t*>(mapped) + offset, data, size);
+	device->Unmap(buffer, size);
+
+	device->CopyBuffer(destination, dstOffset, buffer, offset, size);
+	return S_OK;
+}
+
+UINT UploadRing::UsedBytes() const
+{
+	return ring.Used();
+}
+
+UINT UploadRing::CapacityBytes() const
+{
+	return ring.Capacity();
+}
+
+UINT UploadRing::FallbackUploads() const
+{
+	return fallbackUploads;
+}
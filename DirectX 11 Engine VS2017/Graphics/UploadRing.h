@@ -0,0 +1,88 @@
+#pragma once
+#include "RenderDevice.h"
+#include <cstdint>
+#include <deque>
+
+// Hands out ranges of a circular buffer in allocation order and takes them
+// back a whole frame at a time, once the frame is known to be finished.
+// Allocations never straddle the end: a range that doesn't fit before the
+// end starts over at offset 0 and reports the wrap.
+class RingAllocator
+{
+public:
+	static const UINT invalidOffset = 0xFFFFFFFF;
+
+	void Reset(UINT capacity);
+	// alignment must be a power of two. Returns invalidOffset when the
+	// range doesn't fit next to the data of unfinished frames.
+	UINT Allocate(UINT size, UINT alignment, bool& wrapped);
+	// Everything allocated since the previous EndFrame belongs to `frame`.
+	void EndFrame(std::uint64_t frame);
+	// Frees the ranges of frames up to and including completedFrame.
+	void Retire(std::uint64_t completedFrame);
+
+	// Bytes held by unfinished frames, wasted space before a wrap included.
+	UINT Used() const;
+	UINT Capacity() const;
+
+private:
+	struct FrameMark
+	{
+		std::uint64_t frame;
+		UINT end;
+		std::uint64_t allocated;
+	};
+
+	UINT capacity = 0;
+	UINT head = 0;
+	UINT tail = 0;
+	// Bytes ever allocated and ever freed; their difference is in use.
+	std::uint64_t allocated = 0;
+	std::uint64_t freed = 0;
+	std::deque<FrameMark> frames;
+};
+
+// Streams data into static (GPU-only) buffers. Each upload is written to
+// the next range of one dynamic staging buffer with WRITE_NO_OVERWRITE and
+// copied from there on the GPU; the staging buffer is only discarded when
+// the ring wraps. Ranges are reused once the frame that wrote them is more
+// than framesInFlight frames old, counted with RenderDevice::FrameIndex.
+//
+// An upload that finds the ring full goes through RenderDevice::UpdateBuffer
+// instead, and the ring doubles at the next BeginFrame.
+class UploadRing
+{
+public:
+	// DXGI lets the CPU run up to three frames ahead by default.
+	static const UINT framesInFlight = 3;
+	static const UINT alignment = 16;
+	static const UINT maxByteWidth = 256 * 1024 * 1024;
+
+	UploadRing() {}
+	~UploadRing();
+
+	HRESULT Initialize(RenderDevice* device, UINT byteWidth);
+	// Call once per frame, after RenderDevice::BeginFrame.
+	void BeginFrame();
+	// Writes size bytes at dstOffset of a non-dynamic buffer.
+	HRESULT Upload(DeviceBuffer* destination, UINT dstOffset, const void* data, UINT size);
+
+	UINT UsedBytes() const;
+	UINT CapacityBytes() const;
+	// Uploads that went around the ring since Initialize.
+	UINT FallbackUploads() const;
+
+private:
+	UploadRing(const UploadRing& rhs);
+	UploadRing& operator=(const UploadRing& rhs);
+
+	HRESULT CreateBuffer(UINT byteWidth);
+
+	RenderDevice* device = nullptr;
+	DeviceBuffer* buffer = nullptr;
+	RingAllocator ring;
+	// Staging data of this frame that didn't fit, to size the next ring.
+	UINT overflowBytes = 0;
+	UINT fallbackUploads = 0;
+	bool discarded = false;
+};
@@ -1,5 +1,6 @@
 #pragma once
-#include <DirectXMath.h>
+#include "../Math/VectorMath.h"
+#include <cstdint>
 
 struct Vertex
 {
@@ -11,16 +12,6 @@ struct Vertex
 	DirectX::XMFLOAT2 texCoord;
 };
 
-struct Vertex_COLOR
-{
-	Vertex_COLOR() {}
-	Vertex_COLOR(float x, float y, float z, float r, float g, float b)
-		: pos(x, y, z), color(r, g, b) {}
-
-	DirectX::XMFLOAT3 pos;
-	DirectX::XMFLOAT3 color;
-};
-
 struct VertexCommon
 {
 	VertexCommon() = default;
@@ -34,4 +25,12 @@ struct VertexCommon
 	DirectX::XMFLOAT3 pos = { 0, 0, 0 };
 	DirectX::XMFLOAT4 color = { 0, 0, 0, 0 };
 	DirectX::XMFLOAT2 texCoord = { 0, 0 };
+};
+
+// Stroked lines, already extruded into normalized device coordinates on
+// the CPU. The color is RGBA8, red in the lowest byte.
+struct StrokeVertex
+{
+	DirectX::XMFLOAT3 pos;
+	std::uint32_t color;
 };
\ No newline at end of file
@@ -1,32 +1,41 @@
 #ifndef VertexBuffer_h__
 #define VertexBuffer_h__
-#include <d3d11.h>
-#include "ConstantBufferTypes.h"
-#include <wrl/client.h>
-#include <vector>
+#include "RenderDevice.h"
+#include "UploadRing.h"
+#include <cstring>
+#include <span>
 
 template<class T>
 class VertexBuffer
 {
 private:
-	VertexBuffer(const ConstantBuffer<T>& rhs);
+	VertexBuffer(const VertexBuffer<T>& rhs);
+	VertexBuffer& operator=(const VertexBuffer<T>& rhs);
 
 private:
-	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
-	std::unique_ptr<UINT> stride;
+	RenderDevice* device = nullptr;
+	DeviceBuffer* buffer = nullptr;
 	UINT bufferSize = 0;
 
 public:
 	VertexBuffer() {}
 
-	ID3D11Buffer* Get()const
+	~VertexBuffer()
 	{
-		return buffer.Get();
+		Release();
 	}
 
-	ID3D11Buffer* const* GetAddressOf()const
+	void Release()
 	{
-		return buffer.GetAddressOf();
+		if (device)
+			device->ReleaseBuffer(buffer);
+		buffer = nullptr;
+		bufferSize = 0;
+	}
+
+	DeviceBuffer* Get()const
+	{
+		return buffer;
 	}
 
 	UINT BufferSize() const
@@ -34,41 +43,87 @@ public:
 		return this->bufferSize;
 	}
 
-	const UINT * Stride() const
+	UINT Stride() const
 	{
-		return this->stride.get();
+		return sizeof(T);
 	}
 
-	HRESULT Initialize(ID3D11Device *device, T * data, UINT numElements)
+	// Dynamic buffers are written with Map and the Update functions,
+	// static ones live in GPU memory and are written with UploadRange.
+	HRESULT Initialize(RenderDevice* device, const T * data, UINT numElements, bool dynamic = true)
 	{
-		buffer.Reset();
-		this->bufferSize = numElements;
-		this->stride = std::make_unique<UINT>(sizeof(T));
+		Release();
+		this->device = device;
 
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		ZeroMemory(&vertexBufferDesc, sizeof(vertexBufferDesc));
+		BufferDesc desc;
+		desc.type = BufferType::VERTEX;
+		desc.byteWidth = sizeof(T) * numElements;
+		desc.dynamic = dynamic;
 
-		vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-		vertexBufferDesc.ByteWidth = sizeof(T) * numElements;
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		vertexBufferDesc.MiscFlags = 0;
+		HRESULT hr = device->CreateBuffer(desc, data, &this->buffer);
+		if (SUCCEEDED(hr))
+			this->bufferSize = numElements;
+		return hr;
+	}
 
-		D3D11_SUBRESOURCE_DATA vertexBufferData;
-		ZeroMemory(&vertexBufferData, sizeof(vertexBufferData));
-		vertexBufferData.pSysMem = data;
+	// Maps the whole buffer for writing. Callers generate straight into the
+	// span and call Unmap with the number of elements written; the memory
+	// may be write-combined, so it should be written sequentially and never
+	// read.
+	HRESULT Map(MapMode mode, std::span<T>& mapped)
+	{
+		void* data = nullptr;
+		HRESULT hr = device->Map(buffer, mode, &data);
+		if (FAILED(hr))
+			return hr;
+		mapped = std::span<T>(static_cast<T*>(data), this->bufferSize);
+		return S_OK;
+	}
 
-		HRESULT hr = device->CreateBuffer(&vertexBufferDesc, &vertexBufferData, this->buffer.GetAddressOf());
-		return hr;
+	void Unmap(UINT numWritten)
+	{
+		device->Unmap(buffer, sizeof(T) * numWritten);
+	}
+
+	HRESULT Update(const T* data, UINT numElements)
+	{
+		if (numElements > this->bufferSize)
+			return E_INVALIDARG;
+
+		void* mapped = nullptr;
+		HRESULT hr = device->Map(buffer, MapMode::WRITE_DISCARD, &mapped);
+		if (FAILED(hr))
+			return hr;
+		memcpy(mapped, data, sizeof(T) * numElements);
+		device->Unmap(buffer, sizeof(T) * numElements);
+		return S_OK;
+	}
+
+	// Writes elements [first, first + numElements) and leaves the rest of the
+	// buffer alone. Use MapMode::WRITE_DISCARD for the first write into a
+	// buffer the GPU may still read and MapMode::WRITE_NO_OVERWRITE for the
+	// following writes to ranges not drawn since that discard.
+	HRESULT UpdateRange(const T* data, UINT first, UINT numElements, MapMode mode)
+	{
+		if (first > this->bufferSize || numElements > this->bufferSize - first)
+			return E_INVALIDARG;
+
+		void* mapped = nullptr;
+		HRESULT hr = device->Map(buffer, mode, &mapped);
+		if (FAILED(hr))
+			return hr;
+		memcpy(static_cast<T*>(mapped) + first, data, sizeof(T) * numElements);
+		device->Unmap(buffer, sizeof(T) * numElements);
+		return S_OK;
 	}
 
-	void Update(ID3D11DeviceContext* deviceContext, T* data, UINT numElements)
+	// Same for static buffers, staged through the upload ring.
+	HRESULT UploadRange(UploadRing& uploads, const T* data, UINT first, UINT numElements)
 	{
-		D3D11_MAPPED_SUBRESOURCE resource;
-		deviceContext->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
-		memcpy(resource.pData, data, sizeof(T) * numElements);
-		deviceContext->Unmap(buffer.Get(), 0);
+		if (first > this->bufferSize || numElements > this->bufferSize - first)
+			return E_INVALIDARG;
+		return uploads.Upload(buffer, sizeof(T) * first, data, sizeof(T) * numElements);
 	}
 };
 
-#endif // VertexBuffer_h__
\ No newline at end of file
+#endif // VertexBuffer_h__
@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+// Copies share one flag: whoever keeps a copy can cancel the work that got
+// another one. Work checks it between steps and stops at the next.
+class CancelToken
+{
+public:
+	CancelToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+	void Cancel()
+	{
+		cancelled->store(true, std::memory_order_release);
+	}
+
+	bool Cancelled() const
+	{
+		return cancelled->load(std::memory_order_acquire);
+	}
+
+	// Valid for as long as a copy of the token is.
+	const std::atomic<bool>* Flag() const
+	{
+		return cancelled.get();
+	}
+
+private:
+	std::shared_ptr<std::atomic<bool>> cancelled;
+};
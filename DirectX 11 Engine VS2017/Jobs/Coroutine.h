@@ -0,0 +1,130 @@
+#pragma once
+#include "CancelToken.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+
+// Return type of a coroutine that runs as a chain of stages on different
+// threads: it starts on the calling thread, and every
+//     co_await ResumeOnJobs(token);
+//     co_await ResumeOn(queue, token);
+// moves the rest of it to the job system or to the thread that runs a
+// queue. Nobody waits for it; the stages hand their results on themselves.
+// Once the token is cancelled the coroutine is destroyed instead of moving
+// on, which runs the destructors of its locals, so a cancelled chain
+// stops at the next stage boundary and frees what it held.
+struct Pipeline
+{
+	struct promise_type
+	{
+		Pipeline get_return_object()
+		{
+			return Pipeline();
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return std::suspend_never();
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return std::suspend_never();
+		}
+
+		void return_void() {}
+
+		// Nothing in the engine throws; an exception leaving a stage is a bug.
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+};
+
+namespace CoroutineDetail
+{
+	inline void Continue(std::coroutine_handle<> coroutine, const std::atomic<bool>* cancelled)
+	{
+		if (cancelled->load(std::memory_order_acquire))
+			coroutine.destroy();
+		else
+			coroutine.resume();
+	}
+}
+
+class JobResume
+{
+public:
+	explicit JobResume(const CancelToken& token) : token(token) {}
+
+	// Without active workers a job only runs once its thread waits for
+	// something, so the stage runs right here instead.
+	bool await_ready() const
+	{
+		return !token.Cancelled() && Jobs().ActiveWorkers() == 0;
+	}
+
+	void await_suspend(std::coroutine_handle<> coroutine)
+	{
+		if (token.Cancelled())
+		{
+			coroutine.destroy();
+			return;
+		}
+		// The job may resume the coroutine, and destroy this awaiter with
+		// it, before Run returns.
+		const std::atomic<bool>* cancelled = token.Flag();
+		Jobs().Run([coroutine, cancelled]() { CoroutineDetail::Continue(coroutine, cancelled); });
+	}
+
+	void await_resume() const {}
+
+private:
+	const CancelToken& token;
+};
+
+// Queue is anything with Push(std::function<void()>) that is safe to call
+// from the thread awaiting.
+template<class Queue>
+class QueueResume
+{
+public:
+	QueueResume(Queue& queue, const CancelToken& token) : queue(queue), token(token) {}
+
+	bool await_ready() const
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> coroutine)
+	{
+		if (token.Cancelled())
+		{
+			coroutine.destroy();
+			return;
+		}
+		const std::atomic<bool>* cancelled = token.Flag();
+		queue.Push([coroutine, cancelled]() { CoroutineDetail::Continue(coroutine, cancelled); });
+	}
+
+	void await_resume() const {}
+
+private:
+	Queue& queue;
+	const CancelToken& token;
+};
+
+// The token has to live in the coroutine, as a parameter or a local.
+inline JobResume ResumeOnJobs(const CancelToken& token)
+{
+	return JobResume(token);
+}
+
+template<class Queue>
+QueueResume<Queue> ResumeOn(Queue& queue, const CancelToken& token)
+{
+	return QueueResume<Queue>(queue, token);
+}
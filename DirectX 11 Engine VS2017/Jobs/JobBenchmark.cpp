@@ -0,0 +1,138 @@
+#include "JobBenchmark.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// Keeps the results alive so the compiler can't drop the work.
+	volatile float sink;
+
+	double BestOf(unsigned int runs, const std::function<void()>& body)
+	{
+		double best = 0.0;
+		for (unsigned int run = 0; run < runs; ++run)
+		{
+			const Clock::time_point start = Clock::now();
+			body();
+			const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			best = run == 0 ? ms : (std::min)(best, ms);
+		}
+		return best;
+	}
+
+	// A few dozen flops per item, enough that memory doesn't limit scaling.
+	float Work(size_t i)
+	{
+		float x = static_cast<float>(i & 1023) * 0.001f;
+		for (int k = 0; k < 16; ++k)
+			x = x * (1.0f - x) * 3.9f + 0.01f;
+		return x;
+	}
+}
+
+void RunJobBenchmark(unsigned int runs, std::vector<JobBenchmarkResult>& out)
+{
+	out.clear();
+	if (runs == 0)
+		return;
+
+	JobSystem& jobs = Jobs();
+	const unsigned int previousWorkers = jobs.ActiveWorkers();
+	const unsigned int maxThreads = jobs.WorkerCount() + 1;
+
+	const size_t items = 1 << 22;
+	std::vector<float> values(items);
+	float* data = values.data();
+
+	// Layers of jobs, each depending on two of the layer before.
+	const unsigned int layers = 32;
+	const unsigned int width = 64;
+	std::vector<JobHandle> graph(layers * width);
+	std::vector<float> graphValues(layers * width);
+
+	struct Workload
+	{
+		const char* name;
+		std::function<void()> body;
+	};
+	const Workload workloads[] =
+	{
+		{ "Parallel for, 4096-item blocks", [&]()
+			{
+				jobs.ParallelFor(items, 4096, [data](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+						data[i] = Work(i);
+				});
+			} },
+		{ "Parallel for, 256-item blocks", [&]()
+			{
+				jobs.ParallelFor(items, 256, [data](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+						data[i] = Work(i);
+				});
+			} },
+		{ "64k empty jobs", [&]()
+			{
+				const JobHandle root = jobs.Create([]() {});
+				for (unsigned int i = 0; i < 1 << 16; ++i)
+					jobs.Run([]() {}, root);
+				jobs.Submit(root);
+				jobs.Wait(root);
+			} },
+		{ "Dependency graph, 32 x 64 jobs", [&]()
+			{
+				float* values = graphValues.data();
+				for (unsigned int layer = 0; layer < layers; ++layer)
+				{
+					for (unsigned int i = 0; i < width; ++i)
+					{
+						const unsigned int index = layer * width + i;
+						graph[index] = jobs.Create([values, index]()
+						{
+							float sum = 0.0f;
+							for (size_t k = 0; k < 2048; ++k)
+								sum += Work(index + k);
+							values[index] = sum;
+						});
+						if (layer > 0)
+						{
+							jobs.DependsOn(graph[index], graph[index - width]);
+							jobs.DependsOn(graph[index], graph[(layer - 1) * width + (i + 1) % width]);
+						}
+					}
+				}
+				for (JobHandle job : graph)
+					jobs.Submit(job);
+				for (JobHandle job : graph)
+					jobs.Wait(job);
+			} },
+	};
+
+	for (const Workload& workload : workloads)
+	{
+		double oneThread = 0.0;
+		for (unsigned int threads = 1;; threads = (std::min)(threads * 2, maxThreads))
+		{
+			jobs.SetActiveWorkers(threads - 1);
+			JobBenchmarkResult result;
+			result.name = workload.name;
+			result.threads = threads;
+			result.msPerRun = BestOf(runs, workload.body);
+			if (threads == 1)
+				oneThread = result.msPerRun;
+			result.speedup = result.msPerRun > 0.0 ? oneThread / result.msPerRun : 0.0;
+			out.push_back(result);
+			if (threads == maxThreads)
+				break;
+		}
+	}
+
+	jobs.SetActiveWorkers(previousWorkers);
+	sink = values[items / 2] + graphValues[graphValues.size() - 1];
+}
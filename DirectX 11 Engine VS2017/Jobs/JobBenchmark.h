@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+
+// How the job system scales: each workload with 1, 2, 4 ... threads up to
+// the calling thread plus every worker, limited with SetActiveWorkers.
+struct JobBenchmarkResult
+{
+	const char* name = "";
+	unsigned int threads = 0;
+	double msPerRun = 0.0;
+	// One-thread time over this one.
+	double speedup = 0.0;
+};
+
+// Reports the best of `runs` runs of every workload at every thread count.
+// Other work submitted meanwhile, by the render thread for one, shares the
+// threads and shows up in the times.
+void RunJobBenchmark(unsigned int runs, std::vector<JobBenchmarkResult>& out);
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Chase-Lev deque of fixed capacity, of the job system's tasks. The owner
+// pushes and pops at the bottom, thieves take from the top; the only
+// contended case, one task left, is settled by a compare-exchange on top.
+template<class T>
+class JobDeque
+{
+public:
+	static const std::int64_t capacity = 1024;
+
+	JobDeque() : top(0), bottom(0)
+	{
+		for (std::atomic<T*>& task : this->buffer)
+			task.store(nullptr, std::memory_order_relaxed);
+	}
+
+	// Owner only. False when full.
+	bool Push(T* task)
+	{
+		const std::int64_t b = this->bottom.load(std::memory_order_relaxed);
+		const std::int64_t t = this->top.load(std::memory_order_acquire);
+		if (b - t >= capacity)
+			return false;
+		this->buffer[b & mask].store(task, std::memory_order_relaxed);
+		this->bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Owner only, newest first.
+	T* Pop()
+	{
+		const std::int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+		this->bottom.store(b, std::memory_order_seq_cst);
+		std::int64_t t = this->top.load(std::memory_order_seq_cst);
+		if (t > b)
+		{
+			this->bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		T* task = this->buffer[b & mask].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				task = nullptr;
+			this->bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return task;
+	}
+
+	// Any thread, oldest first. Null when empty or when another thread got
+	// there first.
+	T* Steal()
+	{
+		std::int64_t t = this->top.load(std::memory_order_seq_cst);
+		const std::int64_t b = this->bottom.load(std::memory_order_seq_cst);
+		if (t >= b)
+			return nullptr;
+		T* task = this->buffer[t & mask].load(std::memory_order_relaxed);
+		if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return task;
+	}
+
+private:
+	static const std::int64_t mask = capacity - 1;
+
+	// Apart, so thieves and the owner don't share a cache line.
+	std::atomic<std::int64_t> top;
+	char padding[64];
+	std::atomic<std::int64_t> bottom;
+	std::atomic<T*> buffer[capacity];
+};
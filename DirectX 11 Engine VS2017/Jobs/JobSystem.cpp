@@ -0,0 +1,468 @@
+#include "JobSystem.h"
+#include "JobDeque.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+struct JobTask
+{
+	void (*run)(const void* data) = nullptr;
+	alignas(std::max_align_t) unsigned char data[JobSystem::jobDataSize];
+	JobTask* parent = nullptr;
+	// The task's own run plus its children that haven't finished.
+	std::atomic<int> unfinished;
+	// Submit plus dependencies that haven't finished.
+	std::atomic<int> pending;
+	// Odd while the task is in use; counted up when it is allocated and
+	// again when it finishes.
+	std::atomic<std::uint32_t> generation;
+	// Guards the dependents against a task finishing while one is added.
+	std::atomic<bool> locked;
+	unsigned int dependentCount = 0;
+	JobTask* dependents[JobSystem::maxDependents];
+
+	JobTask() : unfinished(0), pending(0), generation(0), locked(false) {}
+
+	void Lock()
+	{
+		while (this->locked.exchange(true, std::memory_order_acquire))
+			std::this_thread::yield();
+	}
+
+	void Unlock()
+	{
+		this->locked.store(false, std::memory_order_release);
+	}
+};
+
+struct JobSlot
+{
+	// Tasks are allocated in blocks of this many; a thread with that many
+	// unfinished tasks gets another block.
+	static const size_t blockSize = 1024;
+
+	JobDeque<JobTask> deque;
+	std::vector<std::unique_ptr<JobTask[]>> pool;
+	size_t cursor = 0;
+	// State of the xorshift that picks where to steal from first.
+	std::uint32_t random = 1;
+	std::atomic<bool> owned;
+
+	JobSlot() : owned(false)
+	{
+		this->pool.emplace_back(new JobTask[blockSize]);
+	}
+};
+
+namespace
+{
+	// Hands a thread's slot back when the thread exits.
+	struct SlotLease
+	{
+		JobSlot* slot = nullptr;
+
+		~SlotLease()
+		{
+			if (this->slot)
+				this->slot->owned.store(false, std::memory_order_release);
+		}
+	};
+
+	thread_local SlotLease lease;
+
+	// Idle rounds a worker spins through before it sleeps.
+	const unsigned int spinRounds = 64;
+
+	std::string EnvironmentVariable(const char* name)
+	{
+#ifdef _MSC_VER
+		char* value = nullptr;
+		size_t length = 0;
+		if (_dupenv_s(&value, &length, name) != 0 || value == nullptr)
+			return std::string();
+		const std::string result = value;
+		std::free(value);
+		return result;
+#else
+		const char* value = std::getenv(name);
+		return value ? std::string(value) : std::string();
+#endif
+	}
+
+	unsigned int DefaultWorkers(unsigned int maxWorkers)
+	{
+		const std::string requested = EnvironmentVariable("ENGINE_JOB_WORKERS");
+		unsigned int workers = std::thread::hardware_concurrency();
+		workers = workers > 1 ? workers - 1 : 0;
+		if (!requested.empty())
+			workers = static_cast<unsigned int>(std::strtoul(requested.c_str(), nullptr, 10));
+		return (std::min)(workers, maxWorkers);
+	}
+
+	struct ForRange
+	{
+		const void* loop;
+		size_t first;
+		size_t end;
+	};
+}
+
+JobSystem& Jobs()
+{
+	// Leaves room for threads other than the workers to get slots.
+	static JobSystem system(DefaultWorkers(48));
+	return system;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+	: slotCount(0)
+	, activeWorkers(workerCount)
+	, stop(false)
+	, workEpoch(0)
+	, sleepers(0)
+{
+	for (std::atomic<JobSlot*>& slot : this->slots)
+		slot.store(nullptr, std::memory_order_relaxed);
+	this->workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; ++i)
+		this->workers.emplace_back([this, i]() { this->WorkerLoop(i); });
+}
+
+JobSystem::~JobSystem()
+{
+	this->stop.store(true);
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+	}
+	this->wake.notify_all();
+	this->parked.notify_all();
+	for (std::thread& worker : this->workers)
+		worker.join();
+	// At exit: thread-local leases, the main thread's included, are gone by
+	// now.
+	for (std::atomic<JobSlot*>& slot : this->slots)
+		delete slot.load();
+}
+
+unsigned int JobSystem::WorkerCount() const
+{
+	return static_cast<unsigned int>(this->workers.size());
+}
+
+void JobSystem::SetActiveWorkers(unsigned int count)
+{
+	this->activeWorkers.store((std::min)(count, this->WorkerCount()));
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+	}
+	this->parked.notify_all();
+}
+
+unsigned int JobSystem::ActiveWorkers() const
+{
+	return this->activeWorkers.load(std::memory_order_relaxed);
+}
+
+JobHandle JobSystem::Create(JobFunction run, const void* data, size_t size, JobHandle parent)
+{
+	JobTask* task = this->Allocate(*this->CurrentSlot());
+	task->run = run;
+	if (size != 0)
+		std::memcpy(task->data, data, size);
+	task->parent = parent.task;
+	task->unfinished.store(1, std::memory_order_relaxed);
+	task->pending.store(1, std::memory_order_relaxed);
+	task->dependentCount = 0;
+	if (parent.task)
+		parent.task->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+	JobHandle handle;
+	handle.task = task;
+	handle.generation = task->generation.load(std::memory_order_relaxed);
+	return handle;
+}
+
+void JobSystem::DependsOn(JobHandle job, JobHandle dependency)
+{
+	JobTask* task = dependency.task;
+	if (!task)
+		return;
+	JobHandle relay;
+	for (;;)
+	{
+		task->Lock();
+		if (task->generation.load(std::memory_order_relaxed) != dependency.generation)
+		{
+			task->Unlock();
+			break;
+		}
+		if (task->dependentCount < maxDependents)
+		{
+			job.task->pending.fetch_add(1, std::memory_order_relaxed);
+			task->dependents[task->dependentCount++] = job.task;
+			task->Unlock();
+			break;
+		}
+		if (!relay.task)
+		{
+			// Allocating may run other jobs, so not under the lock.
+			task->Unlock();
+			relay = this->Create(&JobSystem::Nothing, nullptr, 0, JobHandle());
+			continue;
+		}
+		// Full: an empty relay job takes the place of the last dependent and
+		// releases it and job in turn. The relay stays pending until task
+		// finishes.
+		JobTask* relayTask = relay.task;
+		relayTask->dependents[0] = task->dependents[maxDependents - 1];
+		relayTask->dependents[1] = job.task;
+		relayTask->dependentCount = 2;
+		job.task->pending.fetch_add(1, std::memory_order_relaxed);
+		task->dependents[maxDependents - 1] = relayTask;
+		task->Unlock();
+		return;
+	}
+	// Not needed after all.
+	if (relay.task)
+		this->Submit(relay);
+}
+
+void JobSystem::Submit(JobHandle job)
+{
+	this->Release(job.task);
+}
+
+bool JobSystem::Done(JobHandle job) const
+{
+	return !job.task || job.task->generation.load(std::memory_order_acquire) != job.generation;
+}
+
+void JobSystem::Wait(JobHandle job)
+{
+	JobSlot& slot = *this->CurrentSlot();
+	while (!this->Done(job))
+	{
+		if (!this->RunOne(slot))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::RunForLoop(ForLoop& loop, size_t numBlocks)
+{
+	ForRange range;
+	range.loop = &loop;
+	range.first = 0;
+	range.end = numBlocks;
+	loop.root = this->Create(&JobSystem::RunForRange, &range, sizeof(range), JobHandle());
+	// The root range runs here rather than going through the deque; its
+	// children are what the other threads steal.
+	this->Execute(loop.root.task);
+	this->Wait(loop.root);
+}
+
+void JobSystem::Nothing(const void*)
+{
+}
+
+void JobSystem::RunForRange(const void* data)
+{
+	const ForRange& range = *static_cast<const ForRange*>(data);
+	const ForLoop& loop = *static_cast<const ForLoop*>(range.loop);
+	size_t end = range.end;
+	while (end - range.first > 1)
+	{
+		ForRange upper;
+		upper.loop = range.loop;
+		upper.first = range.first + (end - range.first) / 2;
+		upper.end = end;
+		loop.system->Submit(loop.system->Create(&JobSystem::RunForRange, &upper, sizeof(upper), loop.root));
+		end = upper.first;
+	}
+	const size_t begin = range.first * loop.grain;
+	loop.call(loop.func, begin, (std::min)(loop.count, begin + loop.grain));
+}
+
+JobSlot* JobSystem::CurrentSlot()
+{
+	if (!lease.slot)
+		lease.slot = this->AcquireSlot();
+	return lease.slot;
+}
+
+JobSlot* JobSystem::AcquireSlot()
+{
+	for (;;)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->slotMutex);
+			const unsigned int count = this->slotCount.load(std::memory_order_relaxed);
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				JobSlot* slot = this->slots[i].load(std::memory_order_relaxed);
+				if (!slot->owned.load(std::memory_order_acquire))
+				{
+					slot->owned.store(true, std::memory_order_relaxed);
+					return slot;
+				}
+			}
+			if (count < maxSlots)
+			{
+				JobSlot* slot = new JobSlot();
+				slot->owned.store(true, std::memory_order_relaxed);
+				slot->random = 2654435761u * (count + 1);
+				this->slots[count].store(slot, std::memory_order_release);
+				this->slotCount.store(count + 1, std::memory_order_release);
+				return slot;
+			}
+		}
+		// Every slot is taken; one frees up when its thread exits.
+		std::this_thread::yield();
+	}
+}
+
+JobTask* JobSystem::Allocate(JobSlot& slot)
+{
+	const size_t poolSize = slot.pool.size() * JobSlot::blockSize;
+	for (size_t i = 0; i < poolSize; ++i)
+	{
+		const size_t index = slot.cursor++ % poolSize;
+		JobTask& task = slot.pool[index / JobSlot::blockSize][index % JobSlot::blockSize];
+		const std::uint32_t generation = task.generation.load(std::memory_order_acquire);
+		if (generation & 1)
+			continue;
+		// A stale handle may be looking at the generation in DependsOn.
+		task.Lock();
+		task.generation.store(generation + 1, std::memory_order_relaxed);
+		task.Unlock();
+		return &task;
+	}
+
+	// Every task is unfinished. Only this thread touches the pool itself,
+	// other threads hold pointers to tasks, which stay where they are.
+	slot.pool.emplace_back(new JobTask[JobSlot::blockSize]);
+	slot.cursor = poolSize + 1;
+	JobTask& task = slot.pool.back()[0];
+	task.generation.store(1, std::memory_order_relaxed);
+	return &task;
+}
+
+void JobSystem::Push(JobTask* task)
+{
+	if (!this->CurrentSlot()->deque.Push(task))
+	{
+		// A full deque has plenty for the other threads to steal.
+		this->Execute(task);
+		return;
+	}
+	this->Signal();
+}
+
+JobTask* JobSystem::FindTask(JobSlot& slot)
+{
+	if (JobTask* task = slot.deque.Pop())
+		return task;
+	const unsigned int count = this->slotCount.load(std::memory_order_acquire);
+	slot.random ^= slot.random << 13;
+	slot.random ^= slot.random >> 17;
+	slot.random ^= slot.random << 5;
+	const unsigned int start = slot.random % count;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		JobSlot* victim = this->slots[(start + i) % count].load(std::memory_order_acquire);
+		if (victim == &slot)
+			continue;
+		if (JobTask* task = victim->deque.Steal())
+			return task;
+	}
+	return nullptr;
+}
+
+bool JobSystem::RunOne(JobSlot& slot)
+{
+	JobTask* task = this->FindTask(slot);
+	if (!task)
+		return false;
+	this->Execute(task);
+	return true;
+}
+
+void JobSystem::Execute(JobTask* task)
+{
+	task->run(task->data);
+	this->Finish(task);
+}
+
+void JobSystem::Finish(JobTask* task)
+{
+	if (task->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	// Everything needed is read before the generation moves on: from then
+	// on the owner may hand the task out again.
+	JobTask* parent = task->parent;
+	JobTask* dependents[maxDependents];
+	task->Lock();
+	const unsigned int dependentCount = task->dependentCount;
+	for (unsigned int i = 0; i < dependentCount; ++i)
+		dependents[i] = task->dependents[i];
+	task->generation.fetch_add(1, std::memory_order_release);
+	task->Unlock();
+
+	for (unsigned int i = 0; i < dependentCount; ++i)
+		this->Release(dependents[i]);
+	if (parent)
+		this->Finish(parent);
+}
+
+void JobSystem::Release(JobTask* task)
+{
+	if (task->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		this->Push(task);
+}
+
+void JobSystem::Signal()
+{
+	// Paired with the sleeper count in WorkerLoop: either the worker sees
+	// the new epoch before it sleeps or this sees it sleeping.
+	this->workEpoch.fetch_add(1);
+	if (this->sleepers.load() == 0)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+	}
+	this->wake.notify_one();
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	JobSlot& slot = *this->CurrentSlot();
+	unsigned int idle = 0;
+	while (!this->stop.load())
+	{
+		if (index >= this->activeWorkers.load())
+		{
+			std::unique_lock<std::mutex> lock(this->sleepMutex);
+			this->parked.wait(lock, [&]() { return this->stop.load() || index < this->activeWorkers.load(); });
+			continue;
+		}
+
+		const std::uint64_t epoch = this->workEpoch.load();
+		if (this->RunOne(slot))
+		{
+			idle = 0;
+			continue;
+		}
+		if (++idle < spinRounds)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		idle = 0;
+		std::unique_lock<std::mutex> lock(this->sleepMutex);
+		this->sleepers.fetch_add(1);
+		this->wake.wait(lock, [&]() { return this->stop.load() || this->workEpoch.load() != epoch; });
+		this->sleepers.fetch_sub(1);
+	}
+}
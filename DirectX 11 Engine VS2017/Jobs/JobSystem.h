@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct JobTask;
+struct JobSlot;
+
+// Refers to one submitted job. Tasks are recycled once they finish, so a
+// handle outliving its task only ever reads as done.
+struct JobHandle
+{
+	JobTask* task = nullptr;
+	std::uint32_t generation = 0;
+};
+
+// Work-stealing scheduler; Jobs() returns the engine's instance. Every
+// thread that submits work gets a slot of its own: a deque it pushes to and
+// pops from at one end while idle threads steal from the other, and a ring
+// of tasks it allocates from without locking. A thread waiting for a job
+// runs other jobs until it is done, so waiting inside a job, or on the main
+// thread, keeps every thread busy.
+class JobSystem
+{
+public:
+	// Bytes a job's function object may take; it is copied into the task.
+	static const size_t jobDataSize = 64;
+	// Jobs one job releases itself; more are chained through relay jobs.
+	static const unsigned int maxDependents = 16;
+
+	~JobSystem();
+
+	// A job that runs func() once submitted and once every job it depends
+	// on is done. func has to be trivially copyable and is copied, so
+	// lambdas capture by reference or capture small values. A parent is
+	// only done once all of its children are.
+	template<class Func>
+	JobHandle Create(const Func& func, JobHandle parent = JobHandle())
+	{
+		static_assert(std::is_trivially_copyable<Func>::value, "job functions are copied with memcpy");
+		static_assert(sizeof(Func) <= jobDataSize, "job function too large, capture by reference");
+		static_assert(alignof(Func) <= alignof(std::max_align_t), "job functions are stored with the alignment of new");
+		return this->Create(&JobSystem::Invoke<Func>, &func, sizeof(Func), parent);
+	}
+
+	// job doesn't start before dependency is done. Only before job is
+	// submitted; the dependency may be submitted or not.
+	void DependsOn(JobHandle job, JobHandle dependency);
+	void Submit(JobHandle job);
+
+	template<class Func>
+	JobHandle Run(const Func& func, JobHandle parent = JobHandle())
+	{
+		const JobHandle job = this->Create(func, parent);
+		this->Submit(job);
+		return job;
+	}
+
+	bool Done(JobHandle job) const;
+	// Runs other jobs until job is done.
+	void Wait(JobHandle job);
+
+	// Splits [0, count) into blocks of `grain` items and runs func(begin,
+	// end) once for every block. Ranges of blocks are halved recursively
+	// into jobs, so idle threads steal large ranges and the calling thread
+	// works through small ones. Returns when every block is done.
+	template<class Func>
+	void ParallelFor(size_t count, size_t grain, const Func& func)
+	{
+		if (count == 0)
+			return;
+		if (grain == 0)
+			grain = 1;
+		const size_t numBlocks = (count + grain - 1) / grain;
+		if (numBlocks == 1 || this->ActiveWorkers() == 0)
+		{
+			for (size_t begin = 0; begin < count; begin += grain)
+				func(begin, (std::min)(count, begin + grain));
+			return;
+		}
+		ForLoop loop;
+		loop.func = &func;
+		loop.call = &JobSystem::CallRange<Func>;
+		loop.count = count;
+		loop.grain = grain;
+		loop.system = this;
+		this->RunForLoop(loop, numBlocks);
+	}
+
+	unsigned int WorkerCount() const;
+	// Workers past the first `count` sleep; for measuring how work scales.
+	void SetActiveWorkers(unsigned int count);
+	unsigned int ActiveWorkers() const;
+
+private:
+	typedef void (*JobFunction)(const void* data);
+
+	struct ForLoop
+	{
+		const void* func = nullptr;
+		void (*call)(const void* func, size_t begin, size_t end) = nullptr;
+		size_t count = 0;
+		size_t grain = 0;
+		JobSystem* system = nullptr;
+		JobHandle root;
+	};
+
+	template<class Func>
+	static void Invoke(const void* data)
+	{
+		(*static_cast<const Func*>(data))();
+	}
+
+	template<class Func>
+	static void CallRange(const void* func, size_t begin, size_t end)
+	{
+		(*static_cast<const Func*>(func))(begin, end);
+	}
+
+	friend JobSystem& Jobs();
+	explicit JobSystem(unsigned int workerCount);
+
+	JobHandle Create(JobFunction run, const void* data, size_t size, JobHandle parent);
+	void RunForLoop(ForLoop& loop, size_t numBlocks);
+	static void RunForRange(const void* data);
+	static void Nothing(const void* data);
+
+	JobSlot* CurrentSlot();
+	JobSlot* AcquireSlot();
+	JobTask* Allocate(JobSlot& slot);
+	void Push(JobTask* task);
+	JobTask* FindTask(JobSlot& slot);
+	bool RunOne(JobSlot& slot);
+	void Execute(JobTask* task);
+	void Finish(JobTask* task);
+	void Release(JobTask* task);
+	void Signal();
+	void WorkerLoop(unsigned int index);
+
+	JobSystem(const JobSystem& rhs);
+	JobSystem& operator=(const JobSystem& rhs);
+
+	static const unsigned int maxSlots = 64;
+	std::atomic<JobSlot*> slots[maxSlots];
+	std::atomic<unsigned int> slotCount;
+	std::mutex slotMutex;
+
+	std::vector<std::thread> workers;
+	std::atomic<unsigned int> activeWorkers;
+	std::atomic<bool> stop;
+
+	// Idle workers sleep until the epoch changes; Signal counts it up.
+	// Workers past activeWorkers are parked on a condition of their own, so
+	// they can't swallow a wake-up meant for an active one.
+	std::atomic<std::uint64_t> workEpoch;
+	std::atomic<unsigned int> sleepers;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::condition_variable parked;
+};
+
+// The engine's scheduler, started on first use with a worker per hardware
+// thread but one, or ENGINE_JOB_WORKERS workers if that is set.
+JobSystem& Jobs();
@@ -0,0 +1,10 @@
+#pragma once
+#include "JobSystem.h"
+
+// Splits [0, count) into blocks of `grain` items and runs func(begin, end)
+// for every block on the engine's job system, the calling thread included.
+template<class Func>
+void ParallelFor(size_t count, size_t grain, const Func& func)
+{
+	Jobs().ParallelFor(count, grain, func);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Unbounded first-in first-out queue from one producer thread to one
+// consumer thread. Push and TryPop never block: the producer links a new
+// node after the last one and the consumer follows the links, each side
+// touching only its own end.
+template<class T>
+class SpscQueue
+{
+public:
+	SpscQueue()
+	{
+		head = tail = new Node();
+	}
+
+	~SpscQueue()
+	{
+		while (head)
+		{
+			Node* next = head->next.load(std::memory_order_relaxed);
+			delete head;
+			head = next;
+		}
+	}
+
+	// Producer only.
+	void Push(T value)
+	{
+		Node* node = new Node();
+		node->value = std::move(value);
+		tail->next.store(node, std::memory_order_release);
+		tail = node;
+	}
+
+	// Consumer only. Returns false when the queue is empty.
+	bool TryPop(T& value)
+	{
+		Node* next = head->next.load(std::memory_order_acquire);
+		if (!next)
+			return false;
+		// The popped node becomes the new empty head.
+		value = std::move(next->value);
+		next->value = T();
+		delete head;
+		head = next;
+		return true;
+	}
+
+private:
+	struct Node
+	{
+		std::atomic<Node*> next;
+		T value;
+
+		Node() : next(nullptr) {}
+	};
+
+	SpscQueue(const SpscQueue& rhs);
+	SpscQueue& operator=(const SpscQueue& rhs);
+
+	Node* head;
+	Node* tail;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Tasks posted from any thread and run by one thread whenever it calls Run,
+// in the order they were posted. Tasks posted while Run is going wait for
+// the next call, so a thread that runs the queue once per frame runs each
+// task at a frame boundary.
+class TaskQueue
+{
+public:
+	TaskQueue() {}
+
+	void Push(std::function<void()> task)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+
+	// Returns the number of tasks run.
+	size_t Run()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running.swap(tasks);
+		}
+		const size_t count = running.size();
+		for (std::function<void()>& task : running)
+			task();
+		running.clear();
+		return count;
+	}
+
+private:
+	TaskQueue(const TaskQueue& rhs);
+	TaskQueue& operator=(const TaskQueue& rhs);
+
+	std::mutex mutex;
+	std::vector<std::function<void()>> tasks;
+	// Only touched by the thread calling Run; keeps its capacity.
+	std::vector<std::function<void()>> running;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+
+// Hands the latest of a stream of values from one producer thread to one
+// consumer thread without locks. Each side owns a slot and the third one is
+// shared: Publish swaps the producer's slot with the shared one, Acquire
+// swaps it out again on the other side. A value published twice before the
+// consumer looks is replaced, so the consumer always gets the newest one
+// and neither side ever waits for the other.
+template<class T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : shared(2) {}
+
+	// Producer: the slot to fill. It still holds a value published earlier,
+	// so every field has to be written again.
+	T& WriteBuffer()
+	{
+		return slots[writeIndex];
+	}
+
+	void Publish()
+	{
+		// Release makes the slot's contents visible with its index; acquire
+		// makes sure the consumer is done with the slot handed back.
+		const unsigned previous = shared.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+		writeIndex = previous & indexMask;
+	}
+
+	// Consumer: takes the newest published value, if there is one since the
+	// last call, and returns whether ReadBuffer changed.
+	bool Acquire()
+	{
+		if ((shared.load(std::memory_order_relaxed) & freshBit) == 0)
+			return false;
+		const unsigned previous = shared.exchange(readIndex, std::memory_order_acq_rel);
+		readIndex = previous & indexMask;
+		return true;
+	}
+
+	const T& ReadBuffer() const
+	{
+		return slots[readIndex];
+	}
+
+private:
+	TripleBuffer(const TripleBuffer& rhs);
+	TripleBuffer& operator=(const TripleBuffer& rhs);
+
+	static const unsigned indexMask = 3;
+	static const unsigned freshBit = 4;
+
+	T slots[3];
+	std::atomic<unsigned> shared;
+	unsigned writeIndex = 0;
+	unsigned readIndex = 1;
+};
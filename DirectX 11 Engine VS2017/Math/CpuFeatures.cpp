@@ -0,0 +1,123 @@
+#include "CpuFeatures.h"
+#include <cstring>
+
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(CPU_FEATURES_X86)
+#include <cpuid.h>
+#endif
+
+namespace
+{
+	void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+	{
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+		int values[4];
+		__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int i = 0; i < 4; ++i)
+			regs[i] = static_cast<unsigned int>(values[i]);
+#elif defined(CPU_FEATURES_X86)
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+		(void)leaf;
+		(void)subleaf;
+		regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+	}
+
+	// XCR0: which register states the operating system saves on a switch.
+	unsigned long long EnabledRegisterStates()
+	{
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+		return _xgetbv(0);
+#elif defined(CPU_FEATURES_X86)
+		unsigned int low = 0;
+		unsigned int high = 0;
+		__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		return (static_cast<unsigned long long>(high) << 32) | low;
+#else
+		return 0;
+#endif
+	}
+
+	bool Bit(unsigned int value, int bit)
+	{
+		return (value >> bit & 1) != 0;
+	}
+
+	CpuFeatures Detect()
+	{
+		CpuFeatures features;
+		unsigned int regs[4];
+		Cpuid(0, 0, regs);
+		const unsigned int maxLeaf = regs[0];
+		if (maxLeaf < 1)
+			return features;
+
+		Cpuid(1, 0, regs);
+		features.sse2 = Bit(regs[3], 26);
+		features.sse42 = Bit(regs[2], 20);
+		features.fma = Bit(regs[2], 12);
+		const bool osSavesRegisters = Bit(regs[2], 27);
+		const unsigned long long states = osSavesRegisters ? EnabledRegisterStates() : 0;
+		// SSE and AVX state; opmask and both halves of the upper ZMM state.
+		const bool osAvx = (states & 0x6) == 0x6;
+		const bool osAvx512 = osAvx && (states & 0xE0) == 0xE0;
+		features.avx = Bit(regs[2], 28) && osAvx;
+		features.fma = features.fma && features.avx;
+
+		if (maxLeaf >= 7)
+		{
+			Cpuid(7, 0, regs);
+			features.bmi1 = Bit(regs[1], 3);
+			features.bmi2 = Bit(regs[1], 8);
+			features.avx2 = Bit(regs[1], 5) && features.avx;
+			features.avx512f = Bit(regs[1], 16) && osAvx512;
+			features.avx512dq = Bit(regs[1], 17) && osAvx512;
+			features.avx512cd = Bit(regs[1], 28) && osAvx512;
+			features.avx512bw = Bit(regs[1], 30) && osAvx512;
+			features.avx512vl = Bit(regs[1], 31) && osAvx512;
+		}
+
+		Cpuid(0x80000000u, 0, regs);
+		if (regs[0] >= 0x80000004u)
+		{
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				Cpuid(0x80000002u + i, 0, regs);
+				std::memcpy(features.brand + 16 * i, regs, 16);
+			}
+		}
+		return features;
+	}
+}
+
+const char* SimdTierName(SimdTier tier)
+{
+	switch (tier)
+	{
+	case SimdTier::SCALAR: return "Scalar";
+	case SimdTier::SSE2: return "SSE2";
+	case SimdTier::AVX2: return "AVX2";
+	case SimdTier::AVX512: return "AVX-512";
+	default: return "";
+	}
+}
+
+const CpuFeatures& GetCpuFeatures()
+{
+	static const CpuFeatures features = Detect();
+	return features;
+}
+
+SimdTier BestSimdTier(const CpuFeatures& features)
+{
+	const bool avx2 = features.avx2 && features.fma && features.bmi1 && features.bmi2;
+	if (avx2 && features.avx512f && features.avx512cd && features.avx512bw && features.avx512dq && features.avx512vl)
+		return SimdTier::AVX512;
+	if (avx2)
+		return SimdTier::AVX2;
+	if (features.sse2)
+		return SimdTier::SSE2;
+	return SimdTier::SCALAR;
+}
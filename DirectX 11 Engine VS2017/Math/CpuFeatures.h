@@ -0,0 +1,38 @@
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_FEATURES_X86
+#endif
+
+// Instruction sets the SIMD kernels are built for, narrowest first.
+enum class SimdTier { SCALAR, SSE2, AVX2, AVX512, COUNT };
+
+// "Scalar", "SSE2", "AVX2" or "AVX-512".
+const char* SimdTierName(SimdTier tier);
+
+// What CPUID reports, with the AVX and AVX-512 flags cleared when the
+// operating system doesn't save the wider registers.
+struct CpuFeatures
+{
+	bool sse2 = false;
+	bool sse42 = false;
+	bool avx = false;
+	bool avx2 = false;
+	bool fma = false;
+	bool bmi1 = false;
+	bool bmi2 = false;
+	bool avx512f = false;
+	bool avx512cd = false;
+	bool avx512bw = false;
+	bool avx512dq = false;
+	bool avx512vl = false;
+	char brand[49] = {};
+};
+
+// Detected on the first call.
+const CpuFeatures& GetCpuFeatures();
+
+// The widest tier whose kernels can run on a CPU with these features. The
+// AVX2 tier also needs FMA, BMI1 and BMI2 and the AVX-512 one F, CD, BW,
+// DQ and VL, the sets the compilers assume for those targets.
+SimdTier BestSimdTier(const CpuFeatures& features);
@@ -0,0 +1,22 @@
+// Compiled with /arch:AVX2 (the project sets it for this file only, other
+// compilers need -mavx2 -mfma -mbmi -mbmi2). Nothing in here may run
+// before CpuFeatures has found AVX2 on the CPU.
+#include "MathKernels.h"
+
+#if defined(CPU_FEATURES_X86) && !defined(ENGINE_MATH_SCALAR)
+#define SIMD_KERNELS_TIER SimdTier::AVX2
+#include "SimdKernels.h"
+#if !defined(SIMD_LANES_AVX2)
+#error KernelsAvx2.cpp has to be compiled for AVX2 without AVX-512
+#endif
+
+const MathKernels* Avx2Kernels()
+{
+	return &simdKernels;
+}
+#else
+const MathKernels* Avx2Kernels()
+{
+	return nullptr;
+}
+#endif
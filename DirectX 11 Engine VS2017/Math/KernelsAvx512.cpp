@@ -0,0 +1,23 @@
+// Compiled with /arch:AVX512 (the project sets it for this file only,
+// other compilers need -mavx512f -mavx512cd -mavx512bw -mavx512dq
+// -mavx512vl -mavx2 -mfma -mbmi -mbmi2). Nothing in here may run before
+// CpuFeatures has found AVX-512 on the CPU.
+#include "MathKernels.h"
+
+#if defined(CPU_FEATURES_X86) && !defined(ENGINE_MATH_SCALAR)
+#define SIMD_KERNELS_TIER SimdTier::AVX512
+#include "SimdKernels.h"
+#if !defined(SIMD_LANES_AVX512)
+#error KernelsAvx512.cpp has to be compiled for AVX-512
+#endif
+
+const MathKernels* Avx512Kernels()
+{
+	return &simdKernels;
+}
+#else
+const MathKernels* Avx512Kernels()
+{
+	return nullptr;
+}
+#endif
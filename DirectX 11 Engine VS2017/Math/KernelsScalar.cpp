@@ -0,0 +1,12 @@
+// Plain C++ kernels, for CPUs without SSE2 and for testing the others
+// against.
+#ifndef ENGINE_MATH_SCALAR
+#define ENGINE_MATH_SCALAR
+#endif
+#define SIMD_KERNELS_TIER SimdTier::SCALAR
+#include "SimdKernels.h"
+
+const MathKernels* ScalarKernels()
+{
+	return &simdKernels;
+}
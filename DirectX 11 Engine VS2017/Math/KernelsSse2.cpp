@@ -0,0 +1,20 @@
+// Compiled for the project's baseline, which is SSE2 on x86 and x64.
+#include "MathKernels.h"
+
+#if defined(CPU_FEATURES_X86) && !defined(ENGINE_MATH_SCALAR)
+#define SIMD_KERNELS_TIER SimdTier::SSE2
+#include "SimdKernels.h"
+#if !defined(SIMD_LANES_SSE2)
+#error KernelsSse2.cpp has to be compiled for SSE2 without AVX
+#endif
+
+const MathKernels* Sse2Kernels()
+{
+	return &simdKernels;
+}
+#else
+const MathKernels* Sse2Kernels()
+{
+	return nullptr;
+}
+#endif
@@ -0,0 +1,257 @@
+#include "MathBenchmark.h"
+#include "VectorMath.h"
+#include "ScalarMath.h"
+#include "TransformStream.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// Small enough to stay in L1, so the timings are of the arithmetic.
+	const unsigned int inputCount = 256;
+
+	struct Inputs
+	{
+		std::vector<XMFLOAT4> a;
+		std::vector<XMFLOAT4> b;
+		std::vector<XMMATRIX> m;
+		std::vector<ScalarMath::Vector> scalarA;
+		std::vector<ScalarMath::Vector> scalarB;
+		std::vector<ScalarMath::Matrix> scalarM;
+	};
+
+	// Results are summed and written here, so no operation is optimized away.
+	volatile float sink;
+
+	ScalarMath::Vector ToScalar(FXMVECTOR v)
+	{
+		XMFLOAT4 f;
+		XMStoreFloat4(&f, v);
+		return ScalarMath::VectorSet(f.x, f.y, f.z, f.w);
+	}
+
+	void Generate(Inputs& inputs)
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+		for (unsigned int i = 0; i < inputCount; ++i)
+		{
+			inputs.a.push_back(XMFLOAT4(value(random), value(random), value(random), 1.0f));
+			inputs.b.push_back(XMFLOAT4(value(random), value(random), value(random), 1.0f));
+			XMMATRIX m;
+			for (int r = 0; r < 4; ++r)
+				m.r[r] = XMVectorSet(value(random), value(random), value(random), value(random));
+			// Keeps the w of transformed points away from 0.
+			m.r[3] = XMVectorSetW(m.r[3], 20.0f);
+			inputs.m.push_back(m);
+
+			inputs.scalarA.push_back(ToScalar(XMLoadFloat4(&inputs.a.back())));
+			inputs.scalarB.push_back(ToScalar(XMLoadFloat4(&inputs.b.back())));
+			ScalarMath::Matrix scalarM;
+			for (int r = 0; r < 4; ++r)
+				scalarM.r[r] = ToScalar(m.r[r]);
+			inputs.scalarM.push_back(scalarM);
+		}
+	}
+
+	XMVECTOR XM_CALLCONV SumRows(FXMMATRIX m)
+	{
+		return XMVectorAdd(XMVectorAdd(m.r[0], m.r[1]), XMVectorAdd(m.r[2], m.r[3]));
+	}
+
+	ScalarMath::Vector SumRows(const ScalarMath::Matrix& m)
+	{
+		return ScalarMath::VectorAdd(ScalarMath::VectorAdd(m.r[0], m.r[1]), ScalarMath::VectorAdd(m.r[2], m.r[3]));
+	}
+
+	// Best of `runs` runs of body, in milliseconds.
+	double BestOf(unsigned int runs, const std::function<void()>& body)
+	{
+		double best = 0.0;
+		for (unsigned int run = 0; run < runs; ++run)
+		{
+			const Clock::time_point start = Clock::now();
+			body();
+			const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			best = run == 0 ? ms : (std::min)(best, ms);
+		}
+		return best;
+	}
+
+	template<typename Body>
+	double Time(unsigned int iterations, Body body)
+	{
+		const Clock::time_point start = Clock::now();
+		for (unsigned int i = 0; i < iterations; ++i)
+			body(i % inputCount);
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+	}
+
+	template<typename Fast, typename Scalar>
+	void Measure(const char* name, unsigned int iterations, Fast fast, Scalar scalar, std::vector<MathBenchmarkResult>& out)
+	{
+		MathBenchmarkResult result;
+		result.name = name;
+		result.nsPerOp = Time(iterations, fast);
+		result.scalarNsPerOp = Time(iterations, scalar);
+		out.push_back(result);
+	}
+}
+
+void RunMathBenchmark(unsigned int iterations, std::vector<MathBenchmarkResult>& out)
+{
+	out.clear();
+	if (iterations == 0)
+		return;
+
+	Inputs in;
+	Generate(in);
+	XMVECTOR sum = XMVectorZero();
+	ScalarMath::Vector scalarSum = ScalarMath::VectorZero();
+
+	Measure("Vector3Dot", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, XMVector3Dot(XMLoadFloat4(&in.a[i]), XMLoadFloat4(&in.b[i]))); },
+		[&](unsigned int i) { scalarSum.v[0] += ScalarMath::Vector3Dot(in.scalarA[i], in.scalarB[i]); }, out);
+	Measure("Vector3Cross", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, XMVector3Cross(XMLoadFloat4(&in.a[i]), XMLoadFloat4(&in.b[i]))); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, ScalarMath::Vector3Cross(in.scalarA[i], in.scalarB[i])); }, out);
+	Measure("Vector3Normalize", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, XMVector3Normalize(XMLoadFloat4(&in.a[i]))); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, ScalarMath::Vector3Normalize(in.scalarA[i])); }, out);
+	Measure("Vector3TransformCoord", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, XMVector3TransformCoord(XMLoadFloat4(&in.a[i]), in.m[i])); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, ScalarMath::Vector3TransformCoord(in.scalarA[i], in.scalarM[i])); }, out);
+	Measure("Vector4Transform", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, XMVector4Transform(XMLoadFloat4(&in.a[i]), in.m[i])); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, ScalarMath::Vector4Transform(in.scalarA[i], in.scalarM[i])); }, out);
+	Measure("MatrixMultiply", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, SumRows(XMMatrixMultiply(in.m[i], in.m[(i + 1) % inputCount]))); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, SumRows(ScalarMath::MatrixMultiply(in.scalarM[i], in.scalarM[(i + 1) % inputCount]))); }, out);
+	Measure("MatrixTranspose", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, XMMatrixTranspose(in.m[i]).r[1]); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, ScalarMath::MatrixTranspose(in.scalarM[i]).r[1]); }, out);
+	Measure("MatrixLookAtLH", iterations,
+		[&](unsigned int i) { sum = XMVectorAdd(sum, SumRows(XMMatrixLookAtLH(XMLoadFloat4(&in.a[i]), XMLoadFloat4(&in.b[i]), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)))); },
+		[&](unsigned int i) { scalarSum = ScalarMath::VectorAdd(scalarSum, SumRows(ScalarMath::MatrixLookAtLH(in.scalarA[i], in.scalarB[i], ScalarMath::VectorSet(0.0f, 1.0f, 0.0f, 0.0f)))); }, out);
+
+	sink = XMVectorGetX(sum) + scalarSum.v[0] + scalarSum.v[1] + scalarSum.v[2] + scalarSum.v[3];
+}
+
+void RunTransformBenchmark(size_t points, unsigned int runs, std::vector<TransformBenchmarkResult>& out)
+{
+	out.clear();
+	if (points == 0 || runs == 0)
+		return;
+
+	std::mt19937 random(2);
+	std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+	std::vector<XMFLOAT3> aos(points);
+	std::vector<XMFLOAT4> aosOut(points);
+	std::vector<float> soa(points * 3);
+	std::vector<float> soaOut(points * 4);
+	for (size_t i = 0; i < points; ++i)
+	{
+		aos[i] = XMFLOAT3(value(random), value(random), value(random));
+		soa[i] = aos[i].x;
+		soa[points + i] = aos[i].y;
+		soa[2 * points + i] = aos[i].z;
+	}
+	SoaPoints3 in;
+	in.x = soa.data();
+	in.y = in.x + points;
+	in.z = in.y + points;
+	SoaPoints4 clip;
+	clip.x = soaOut.data();
+	clip.y = clip.x + points;
+	clip.z = clip.y + points;
+	clip.w = clip.z + points;
+	const XMMATRIX m = XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, -10.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) *
+		XMMatrixPerspectiveFovLH(XMConvertToRadians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	const double bytes = static_cast<double>(points) * (3 + 4) * sizeof(float);
+	auto measure = [&](const char* name, const char* tier, const std::function<void()>& body)
+	{
+		const double best = BestOf(runs, body);
+		TransformBenchmarkResult result;
+		result.name = name;
+		result.tier = tier;
+		result.msPerRun = best;
+		result.gigabytesPerSecond = best > 0.0 ? bytes / (best * 1e6) : 0.0;
+		out.push_back(result);
+	};
+
+	measure("AoS, XMVector4Transform", ENGINE_MATH_BACKEND, [&]()
+	{
+		for (size_t i = 0; i < points; ++i)
+			XMStoreFloat4(&aosOut[i], XMVector4Transform(XMVectorSetW(XMLoadFloat3(&aos[i]), 1.0f), m));
+	});
+	measure("SoA, one thread", TransformStreamBackend(), [&]() { TransformPointsSerial(in, points, m, clip); });
+	measure("SoA, all threads", TransformStreamBackend(), [&]() { TransformPoints(in, points, m, clip); });
+
+	sink = aosOut[points / 2].x + clip.x[points / 2];
+}
+
+void RunTranscendentalBenchmark(size_t count, unsigned int runs, std::vector<TranscendentalBenchmarkResult>& out)
+{
+	out.clear();
+	if (count == 0 || runs == 0)
+		return;
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> angle(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> positive(0.01f, 100.0f);
+	std::uniform_real_distribution<float> exponent(-4.0f, 4.0f);
+	std::vector<float> angles(count);
+	std::vector<float> bases(count);
+	std::vector<float> exponents(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		angles[i] = angle(random);
+		bases[i] = positive(random);
+		exponents[i] = exponent(random);
+	}
+	std::vector<float> result(count);
+	std::vector<float> result2(count);
+	const float* x = angles.data();
+	const float* b = bases.data();
+	const float* e = exponents.data();
+	float* r = result.data();
+	float* r2 = result2.data();
+
+	auto measure = [&](const char* function, const std::function<void(MathAccuracy)>& body, const std::function<void()>& libm)
+	{
+		const double libmMs = BestOf(runs, libm);
+		for (int tier = 0; tier < static_cast<int>(MathAccuracy::COUNT); ++tier)
+		{
+			const MathAccuracy accuracy = static_cast<MathAccuracy>(tier);
+			const double ms = BestOf(runs, [&]() { body(accuracy); });
+			TranscendentalBenchmarkResult entry;
+			entry.function = function;
+			entry.accuracy = accuracy;
+			entry.tier = TranscendentalBackend();
+			entry.millionsPerSecond = ms > 0.0 ? count / (ms * 1e3) : 0.0;
+			entry.libmMillionsPerSecond = libmMs > 0.0 ? count / (libmMs * 1e3) : 0.0;
+			out.push_back(entry);
+		}
+	};
+
+	measure("sin", [&](MathAccuracy accuracy) { VectorSin(x, r, count, accuracy); },
+		[&]() { for (size_t i = 0; i < count; ++i) r[i] = std::sin(x[i]); });
+	measure("cos", [&](MathAccuracy accuracy) { VectorCos(x, r, count, accuracy); },
+		[&]() { for (size_t i = 0; i < count; ++i) r[i] = std::cos(x[i]); });
+	measure("sincos", [&](MathAccuracy accuracy) { VectorSinCos(x, r, r2, count, accuracy); },
+		[&]() { for (size_t i = 0; i < count; ++i) { r[i] = std::sin(x[i]); r2[i] = std::cos(x[i]); } });
+	measure("sqrt", [&](MathAccuracy accuracy) { VectorSqrt(b, r, count, accuracy); },
+		[&]() { for (size_t i = 0; i < count; ++i) r[i] = std::sqrt(b[i]); });
+	measure("pow", [&](MathAccuracy accuracy) { VectorPow(b, e, r, count, accuracy); },
+		[&]() { for (size_t i = 0; i < count; ++i) r[i] = std::pow(b[i], e[i]); });
+
+	sink = result[count / 2] + result2[count / 2];
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Transcendental.h"
+#include <cstddef>
+#include <vector>
+
+// Times the math operations the engine uses, as VectorMath provides them,
+// against their ScalarMath versions.
+struct MathBenchmarkResult
+{
+	const char* name = "";
+	double nsPerOp = 0.0;
+	double scalarNsPerOp = 0.0;
+};
+
+// Runs every operation `iterations` times on each side.
+void RunMathBenchmark(unsigned int iterations, std::vector<MathBenchmarkResult>& out);
+
+struct TransformBenchmarkResult
+{
+	const char* name = "";
+	// The math backend or SIMD tier the loop ran on.
+	const char* tier = "";
+	// Points read plus clip coordinates written, per second.
+	double gigabytesPerSecond = 0.0;
+	double msPerRun = 0.0;
+};
+
+// Transforms `points` points to clip space with a per-point XMVECTOR loop
+// over arrays of structures and with the structure-of-arrays streams, and
+// reports the best of `runs` runs of each.
+void RunTransformBenchmark(size_t points, unsigned int runs, std::vector<TransformBenchmarkResult>& out);
+
+struct TranscendentalBenchmarkResult
+{
+	const char* function = "";
+	MathAccuracy accuracy = MathAccuracy::PRECISE;
+	// SIMD tier of the kernels, see MathKernels.h.
+	const char* tier = "";
+	// Results per second, in millions, and the same for a loop calling the
+	// C library's float overloads.
+	double millionsPerSecond = 0.0;
+	double libmMillionsPerSecond = 0.0;
+};
+
+// Runs sin, cos, sincos, sqrt and pow over `count` values at every accuracy
+// tier and reports the best of `runs` runs of each.
+void RunTranscendentalBenchmark(size_t count, unsigned int runs, std::vector<TranscendentalBenchmarkResult>& out);
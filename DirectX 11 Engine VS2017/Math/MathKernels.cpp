@@ -0,0 +1,127 @@
+#include "MathKernels.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+namespace
+{
+	std::once_flag selectOnce;
+	KernelSelection selection;
+	const MathKernels* active = nullptr;
+
+	std::string EnvironmentVariable(const char* name)
+	{
+#ifdef _MSC_VER
+		char* value = nullptr;
+		size_t length = 0;
+		if (_dupenv_s(&value, &length, name) != 0 || value == nullptr)
+			return std::string();
+		const std::string result = value;
+		std::free(value);
+		return result;
+#else
+		const char* value = std::getenv(name);
+		return value ? std::string(value) : std::string();
+#endif
+	}
+
+	// Lower case without dashes, so "AVX-512" and "avx512" compare equal.
+	std::string TierKey(const char* name)
+	{
+		std::string key;
+		for (const char* c = name; *c; ++c)
+		{
+			if (*c != '-')
+				key += static_cast<char>(std::tolower(static_cast<unsigned char>(*c)));
+		}
+		return key;
+	}
+
+	void Select(const char* requested)
+	{
+		selection.best = BestSimdTier(GetCpuFeatures());
+		// The best tier may not be built in; step down to one that is.
+		while (selection.best != SimdTier::SCALAR && !KernelsForTier(selection.best))
+			selection.best = static_cast<SimdTier>(static_cast<int>(selection.best) - 1);
+		selection.active = selection.best;
+
+		std::string request = requested ? requested : "";
+		selection.source = "command line";
+		if (request.empty())
+		{
+			request = EnvironmentVariable("ENGINE_SIMD_TIER");
+			selection.source = "ENGINE_SIMD_TIER";
+		}
+		if (request.empty())
+		{
+			selection.source = "detected";
+		}
+		else
+		{
+			SimdTier forced;
+			if (!ParseSimdTier(request.c_str(), forced))
+			{
+				std::snprintf(selection.warning, sizeof(selection.warning), "Unknown SIMD tier \"%s\" from %s, using %s.",
+					request.c_str(), selection.source, SimdTierName(selection.best));
+				selection.source = "detected";
+			}
+			else if (!KernelsSupported(forced))
+			{
+				std::snprintf(selection.warning, sizeof(selection.warning), "%s from %s can't run here, using %s.",
+					SimdTierName(forced), selection.source, SimdTierName(selection.best));
+				selection.source = "detected";
+			}
+			else
+			{
+				selection.active = forced;
+			}
+		}
+		active = KernelsForTier(selection.active);
+	}
+}
+
+const MathKernels* KernelsForTier(SimdTier tier)
+{
+	switch (tier)
+	{
+	case SimdTier::SCALAR: return ScalarKernels();
+	case SimdTier::SSE2: return Sse2Kernels();
+	case SimdTier::AVX2: return Avx2Kernels();
+	case SimdTier::AVX512: return Avx512Kernels();
+	default: return nullptr;
+	}
+}
+
+bool KernelsSupported(SimdTier tier)
+{
+	// The CPU first: a tier's functions may not run on a CPU without it.
+	return static_cast<int>(tier) <= static_cast<int>(BestSimdTier(GetCpuFeatures())) && KernelsForTier(tier) != nullptr;
+}
+
+bool ParseSimdTier(const char* text, SimdTier& tier)
+{
+	const std::string name = TierKey(text);
+	for (int i = 0; i < static_cast<int>(SimdTier::COUNT); ++i)
+	{
+		if (name == TierKey(SimdTierName(static_cast<SimdTier>(i))))
+		{
+			tier = static_cast<SimdTier>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+const KernelSelection& SelectKernels(const char* requested)
+{
+	std::call_once(selectOnce, Select, requested);
+	return selection;
+}
+
+const MathKernels& Kernels()
+{
+	SelectKernels(nullptr);
+	return *active;
+}
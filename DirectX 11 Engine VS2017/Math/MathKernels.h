@@ -0,0 +1,64 @@
+#pragma once
+#include "CpuFeatures.h"
+#include "SoaPoints.h"
+#include "Transcendental.h"
+#include <cstddef>
+
+// The hot loops, built once per SimdTier in translation units of their
+// own (KernelsScalar.cpp, KernelsSse2.cpp, KernelsAvx2.cpp and
+// KernelsAvx512.cpp, each compiled for its instruction set) and picked at
+// startup for the CPU the program runs on. The public functions in
+// Transcendental.h and TransformStream.h call through Kernels().
+struct MathKernels
+{
+	SimdTier tier = SimdTier::SCALAR;
+
+	void (*sin)(const float* x, float* out, size_t count, MathAccuracy accuracy) = nullptr;
+	void (*cos)(const float* x, float* out, size_t count, MathAccuracy accuracy) = nullptr;
+	void (*sinCos)(const float* x, float* sinOut, float* cosOut, size_t count, MathAccuracy accuracy) = nullptr;
+	void (*sqrt)(const float* x, float* out, size_t count, MathAccuracy accuracy) = nullptr;
+	void (*pow)(const float* x, const float* y, float* out, size_t count, MathAccuracy accuracy) = nullptr;
+
+	// Points [begin, end) of in by the row-major matrix m[16].
+	void (*transformPoints)(const SoaPoints3& in, size_t begin, size_t end, const float* m, const TransformStreamDesc& desc,
+		const SoaPoints4& out) = nullptr;
+
+	// count points with one color into out, nine floats per point in the
+	// layout of VertexCommon: position, color and a zero texture
+	// coordinate. out is only written, in order, so it can be mapped,
+	// write-combined buffer memory.
+	void (*packVertices)(const SoaPoints3& in, size_t count, const float* color, float* out) = nullptr;
+};
+
+// The kernels of each tier, or nullptr where the build leaves a tier out
+// (all but scalar off x86 and with ENGINE_MATH_SCALAR).
+const MathKernels* ScalarKernels();
+const MathKernels* Sse2Kernels();
+const MathKernels* Avx2Kernels();
+const MathKernels* Avx512Kernels();
+const MathKernels* KernelsForTier(SimdTier tier);
+// Whether the tier is built in and the CPU can run it.
+bool KernelsSupported(SimdTier tier);
+
+struct KernelSelection
+{
+	SimdTier best = SimdTier::SCALAR;
+	SimdTier active = SimdTier::SCALAR;
+	// "detected", or where a forced tier came from.
+	const char* source = "detected";
+	// Why a forced tier wasn't used, empty otherwise.
+	char warning[160] = {};
+};
+
+// Picks the kernels once: `requested` (a command-line value, may be null)
+// if given, else the ENGINE_SIMD_TIER environment variable, else the best
+// tier for the CPU. Tier names are scalar, sse2, avx2 and avx512; a tier
+// the CPU can't run falls back to the best one it can, with a warning.
+// Later calls change nothing. Kernels() calls it with null if nothing did
+// before.
+const KernelSelection& SelectKernels(const char* requested);
+
+const MathKernels& Kernels();
+
+// Parses a tier name, case-insensitively; "avx-512" works too.
+bool ParseSimdTier(const char* text, SimdTier& tier);
@@ -0,0 +1,636 @@
+#pragma once
+#include "ScalarMath.h"
+#include <cmath>
+
+// The part of the DirectXMath API the engine uses, for builds without the
+// Windows SDK. Types, names and conventions match DirectXMath, so the
+// engine's math compiles unchanged against either. Vectors are SSE2
+// registers where the target has them, matrix products use AVX2 when the
+// compiler targets it, and everything falls back to ScalarMath
+// otherwise or when ENGINE_MATH_SCALAR is defined. Trigonometry goes
+// through the C library, so results may differ from DirectXMath's
+// polynomial approximations in the last bits.
+#if defined(ENGINE_MATH_SCALAR)
+#define PORTABLE_MATH_BACKEND "Scalar"
+#elif defined(__AVX2__)
+#define PORTABLE_MATH_SSE2
+#define PORTABLE_MATH_AVX2
+#define PORTABLE_MATH_BACKEND "AVX2"
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PORTABLE_MATH_SSE2
+#define PORTABLE_MATH_BACKEND "SSE2"
+#else
+#define PORTABLE_MATH_BACKEND "Scalar"
+#endif
+
+#if defined(PORTABLE_MATH_AVX2)
+#include <immintrin.h>
+#elif defined(PORTABLE_MATH_SSE2)
+#include <emmintrin.h>
+#endif
+
+#ifndef XM_CALLCONV
+#define XM_CALLCONV
+#endif
+
+namespace DirectX
+{
+	const float XM_PI = 3.141592654f;
+	const float XM_2PI = 6.283185307f;
+	const float XM_1DIVPI = 0.318309886f;
+	const float XM_PIDIV2 = 1.570796327f;
+	const float XM_PIDIV4 = 0.785398163f;
+
+	inline float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.0f); }
+	inline float XMConvertToDegrees(float radians) { return radians * (180.0f / XM_PI); }
+
+#if defined(PORTABLE_MATH_SSE2)
+	typedef __m128 XMVECTOR;
+#else
+	typedef ScalarMath::Vector XMVECTOR;
+#endif
+	typedef const XMVECTOR FXMVECTOR;
+	typedef const XMVECTOR GXMVECTOR;
+	typedef const XMVECTOR HXMVECTOR;
+	typedef const XMVECTOR& CXMVECTOR;
+
+	struct XMMATRIX;
+	typedef const XMMATRIX& FXMMATRIX;
+	typedef const XMMATRIX& CXMMATRIX;
+
+	struct XMFLOAT2
+	{
+		float x;
+		float y;
+
+		XMFLOAT2() = default;
+		XMFLOAT2(float x, float y) : x(x), y(y) {}
+	};
+
+	struct XMFLOAT3
+	{
+		float x;
+		float y;
+		float z;
+
+		XMFLOAT3() = default;
+		XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) {}
+	};
+
+	struct XMFLOAT4
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+
+		XMFLOAT4() = default;
+		XMFLOAT4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	};
+
+	struct XMFLOAT4X4
+	{
+		union
+		{
+			struct
+			{
+				float _11, _12, _13, _14;
+				float _21, _22, _23, _24;
+				float _31, _32, _33, _34;
+				float _41, _42, _43, _44;
+			};
+			float m[4][4];
+		};
+
+		XMFLOAT4X4() = default;
+	};
+
+	XMVECTOR XM_CALLCONV XMVectorSet(float x, float y, float z, float w);
+
+	struct alignas(16) XMMATRIX
+	{
+		XMVECTOR r[4];
+
+		XMMATRIX() = default;
+		XMMATRIX(FXMVECTOR r0, FXMVECTOR r1, FXMVECTOR r2, CXMVECTOR r3)
+		{
+			r[0] = r0;
+			r[1] = r1;
+			r[2] = r2;
+			r[3] = r3;
+		}
+		XMMATRIX(float m00, float m01, float m02, float m03,
+			float m10, float m11, float m12, float m13,
+			float m20, float m21, float m22, float m23,
+			float m30, float m31, float m32, float m33)
+		{
+			r[0] = XMVectorSet(m00, m01, m02, m03);
+			r[1] = XMVectorSet(m10, m11, m12, m13);
+			r[2] = XMVectorSet(m20, m21, m22, m23);
+			r[3] = XMVectorSet(m30, m31, m32, m33);
+		}
+
+		XMMATRIX XM_CALLCONV operator*(FXMMATRIX m) const;
+		XMMATRIX& XM_CALLCONV operator*=(FXMMATRIX m);
+	};
+
+#if !defined(PORTABLE_MATH_SSE2)
+	inline const ScalarMath::Matrix& AsScalar(FXMMATRIX m)
+	{
+		return reinterpret_cast<const ScalarMath::Matrix&>(m);
+	}
+
+	inline XMMATRIX FromScalar(const ScalarMath::Matrix& m)
+	{
+		return XMMATRIX(m.r[0], m.r[1], m.r[2], m.r[3]);
+	}
+#endif
+
+	// Vectors.
+
+	inline XMVECTOR XM_CALLCONV XMVectorSet(float x, float y, float z, float w)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_set_ps(w, z, y, x);
+#else
+		return ScalarMath::VectorSet(x, y, z, w);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorZero()
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_setzero_ps();
+#else
+		return ScalarMath::VectorZero();
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorReplicate(float value)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_set1_ps(value);
+#else
+		return ScalarMath::VectorReplicate(value);
+#endif
+	}
+
+#if defined(PORTABLE_MATH_SSE2)
+	// Component i of v in every lane.
+	template<int i>
+	inline XMVECTOR XM_CALLCONV Splat(FXMVECTOR v)
+	{
+		return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+	}
+
+	// v with component i set to value: i is swapped into x, replaced and
+	// swapped back.
+	template<int i>
+	inline XMVECTOR XM_CALLCONV Insert(FXMVECTOR v, float value)
+	{
+		const int swap = i == 1 ? _MM_SHUFFLE(3, 2, 0, 1) : i == 2 ? _MM_SHUFFLE(3, 0, 1, 2) : _MM_SHUFFLE(0, 2, 1, 3);
+		XMVECTOR t = _mm_shuffle_ps(v, v, swap);
+		t = _mm_move_ss(t, _mm_set_ss(value));
+		return _mm_shuffle_ps(t, t, swap);
+	}
+#endif
+
+	inline float XM_CALLCONV XMVectorGetX(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_cvtss_f32(v);
+#else
+		return v.v[0];
+#endif
+	}
+
+	inline float XM_CALLCONV XMVectorGetY(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_cvtss_f32(Splat<1>(v));
+#else
+		return v.v[1];
+#endif
+	}
+
+	inline float XM_CALLCONV XMVectorGetZ(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_cvtss_f32(Splat<2>(v));
+#else
+		return v.v[2];
+#endif
+	}
+
+	inline float XM_CALLCONV XMVectorGetW(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_cvtss_f32(Splat<3>(v));
+#else
+		return v.v[3];
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorSetX(FXMVECTOR v, float x)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_move_ss(v, _mm_set_ss(x));
+#else
+		XMVECTOR result = v;
+		result.v[0] = x;
+		return result;
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorSetY(FXMVECTOR v, float y)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return Insert<1>(v, y);
+#else
+		XMVECTOR result = v;
+		result.v[1] = y;
+		return result;
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorSetZ(FXMVECTOR v, float z)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return Insert<2>(v, z);
+#else
+		XMVECTOR result = v;
+		result.v[2] = z;
+		return result;
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorSetW(FXMVECTOR v, float w)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return Insert<3>(v, w);
+#else
+		XMVECTOR result = v;
+		result.v[3] = w;
+		return result;
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorAdd(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_add_ps(a, b);
+#else
+		return ScalarMath::VectorAdd(a, b);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorSubtract(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_sub_ps(a, b);
+#else
+		return ScalarMath::VectorSubtract(a, b);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorMultiply(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_mul_ps(a, b);
+#else
+		return ScalarMath::VectorMultiply(a, b);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorDivide(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_div_ps(a, b);
+#else
+		return ScalarMath::VectorDivide(a, b);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorScale(FXMVECTOR v, float s)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_mul_ps(v, _mm_set1_ps(s));
+#else
+		return ScalarMath::VectorScale(v, s);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorNegate(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+#else
+		return ScalarMath::VectorNegate(v);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVectorLerp(FXMVECTOR a, FXMVECTOR b, float t)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+#else
+		return ScalarMath::VectorLerp(a, b, t);
+#endif
+	}
+
+	// Replicated into every lane.
+	inline XMVECTOR XM_CALLCONV XMVector3Dot(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		// x + y, then + z, as the scalar version sums.
+		const XMVECTOR products = _mm_mul_ps(a, b);
+		XMVECTOR sum = _mm_add_ss(products, Splat<1>(products));
+		sum = _mm_add_ss(sum, Splat<2>(products));
+		return Splat<0>(sum);
+#else
+		return ScalarMath::VectorReplicate(ScalarMath::Vector3Dot(a, b));
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3Cross(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		const XMVECTOR a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		const XMVECTOR b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+		const XMVECTOR a2 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+		const XMVECTOR b2 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		const XMVECTOR cross = _mm_sub_ps(_mm_mul_ps(a1, b1), _mm_mul_ps(a2, b2));
+		return _mm_and_ps(cross, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+#else
+		return ScalarMath::Vector3Cross(a, b);
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3Length(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_sqrt_ps(XMVector3Dot(v, v));
+#else
+		return ScalarMath::VectorReplicate(std::sqrt(ScalarMath::Vector3Dot(v, v)));
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3Normalize(FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		// Lanes where the length isn't positive, NaN included, end up 0.
+		const XMVECTOR length = XMVector3Length(v);
+		const XMVECTOR positive = _mm_cmpgt_ps(length, _mm_setzero_ps());
+		return _mm_and_ps(_mm_div_ps(v, length), positive);
+#else
+		return ScalarMath::Vector3Normalize(v);
+#endif
+	}
+
+	inline bool XM_CALLCONV XMVector3Equal(FXMVECTOR a, FXMVECTOR b)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return (_mm_movemask_ps(_mm_cmpeq_ps(a, b)) & 7) == 7;
+#else
+		return ScalarMath::Vector3Equal(a, b);
+#endif
+	}
+
+	inline bool XM_CALLCONV XMVector3NotEqual(FXMVECTOR a, FXMVECTOR b)
+	{
+		return !XMVector3Equal(a, b);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector4Transform(FXMVECTOR v, FXMMATRIX m)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		XMVECTOR result = _mm_mul_ps(Splat<0>(v), m.r[0]);
+		result = _mm_add_ps(result, _mm_mul_ps(Splat<1>(v), m.r[1]));
+		result = _mm_add_ps(result, _mm_mul_ps(Splat<2>(v), m.r[2]));
+		return _mm_add_ps(result, _mm_mul_ps(Splat<3>(v), m.r[3]));
+#else
+		return ScalarMath::Vector4Transform(v, AsScalar(m));
+#endif
+	}
+
+	inline XMVECTOR XM_CALLCONV XMVector3TransformCoord(FXMVECTOR v, FXMMATRIX m)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		XMVECTOR result = _mm_mul_ps(Splat<0>(v), m.r[0]);
+		result = _mm_add_ps(result, _mm_mul_ps(Splat<1>(v), m.r[1]));
+		result = _mm_add_ps(result, _mm_mul_ps(Splat<2>(v), m.r[2]));
+		result = _mm_add_ps(result, m.r[3]);
+		return _mm_div_ps(result, Splat<3>(result));
+#else
+		return ScalarMath::Vector3TransformCoord(v, AsScalar(m));
+#endif
+	}
+
+	// Divides the plane by the length of its normal.
+	inline XMVECTOR XM_CALLCONV XMPlaneNormalize(FXMVECTOR p)
+	{
+		return XMVector3Normalize(p);
+	}
+
+	// Loads and stores. Unused components load as 0.
+
+	inline XMVECTOR XM_CALLCONV XMLoadFloat2(const XMFLOAT2* source)
+	{
+		return XMVectorSet(source->x, source->y, 0.0f, 0.0f);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMLoadFloat3(const XMFLOAT3* source)
+	{
+		return XMVectorSet(source->x, source->y, source->z, 0.0f);
+	}
+
+	inline XMVECTOR XM_CALLCONV XMLoadFloat4(const XMFLOAT4* source)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		return _mm_loadu_ps(&source->x);
+#else
+		return XMVectorSet(source->x, source->y, source->z, source->w);
+#endif
+	}
+
+	inline void XM_CALLCONV XMStoreFloat2(XMFLOAT2* destination, FXMVECTOR v)
+	{
+		destination->x = XMVectorGetX(v);
+		destination->y = XMVectorGetY(v);
+	}
+
+	inline void XM_CALLCONV XMStoreFloat3(XMFLOAT3* destination, FXMVECTOR v)
+	{
+		destination->x = XMVectorGetX(v);
+		destination->y = XMVectorGetY(v);
+		destination->z = XMVectorGetZ(v);
+	}
+
+	inline void XM_CALLCONV XMStoreFloat4(XMFLOAT4* destination, FXMVECTOR v)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		_mm_storeu_ps(&destination->x, v);
+#else
+		*destination = XMFLOAT4(v.v[0], v.v[1], v.v[2], v.v[3]);
+#endif
+	}
+
+	inline XMMATRIX XM_CALLCONV XMLoadFloat4x4(const XMFLOAT4X4* source)
+	{
+		XMMATRIX m;
+		for (int i = 0; i < 4; ++i)
+			m.r[i] = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(source->m[i]));
+		return m;
+	}
+
+	inline void XM_CALLCONV XMStoreFloat4x4(XMFLOAT4X4* destination, FXMMATRIX m)
+	{
+		for (int i = 0; i < 4; ++i)
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destination->m[i]), m.r[i]);
+	}
+
+	// Matrices.
+
+	inline XMMATRIX XM_CALLCONV XMMatrixIdentity()
+	{
+		return XMMATRIX(1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b)
+	{
+#if defined(PORTABLE_MATH_AVX2)
+		// Two rows per 256-bit register, in the same order of operations
+		// as XMVector4Transform.
+		XMMATRIX result;
+		const __m256 b0 = _mm256_broadcast_ps(&b.r[0]);
+		const __m256 b1 = _mm256_broadcast_ps(&b.r[1]);
+		const __m256 b2 = _mm256_broadcast_ps(&b.r[2]);
+		const __m256 b3 = _mm256_broadcast_ps(&b.r[3]);
+		for (int i = 0; i < 4; i += 2)
+		{
+			const __m256 rows = _mm256_insertf128_ps(_mm256_castps128_ps256(a.r[i]), a.r[i + 1], 1);
+			__m256 sum = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+			result.r[i] = _mm256_castps256_ps128(sum);
+			result.r[i + 1] = _mm256_extractf128_ps(sum, 1);
+		}
+		return result;
+#elif defined(PORTABLE_MATH_SSE2)
+		return XMMATRIX(XMVector4Transform(a.r[0], b), XMVector4Transform(a.r[1], b),
+			XMVector4Transform(a.r[2], b), XMVector4Transform(a.r[3], b));
+#else
+		return FromScalar(ScalarMath::MatrixMultiply(AsScalar(a), AsScalar(b)));
+#endif
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMATRIX::operator*(FXMMATRIX m) const
+	{
+		return XMMatrixMultiply(*this, m);
+	}
+
+	inline XMMATRIX& XM_CALLCONV XMMATRIX::operator*=(FXMMATRIX m)
+	{
+		*this = XMMatrixMultiply(*this, m);
+		return *this;
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixTranspose(FXMMATRIX m)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		XMVECTOR r0 = m.r[0];
+		XMVECTOR r1 = m.r[1];
+		XMVECTOR r2 = m.r[2];
+		XMVECTOR r3 = m.r[3];
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		return XMMATRIX(r0, r1, r2, r3);
+#else
+		return FromScalar(ScalarMath::MatrixTranspose(AsScalar(m)));
+#endif
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixTranslation(float x, float y, float z)
+	{
+		return XMMATRIX(1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			x, y, z, 1.0f);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixScaling(float x, float y, float z)
+	{
+		return XMMATRIX(x, 0.0f, 0.0f, 0.0f,
+			0.0f, y, 0.0f, 0.0f,
+			0.0f, 0.0f, z, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	// A handful of scalars each, so every backend computes them the same way.
+	inline XMMATRIX XM_CALLCONV XMMatrixRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		const ScalarMath::Matrix m = ScalarMath::MatrixRotationRollPitchYaw(pitch, yaw, roll);
+		return XMMATRIX(
+			m.r[0].v[0], m.r[0].v[1], m.r[0].v[2], m.r[0].v[3],
+			m.r[1].v[0], m.r[1].v[1], m.r[1].v[2], m.r[1].v[3],
+			m.r[2].v[0], m.r[2].v[1], m.r[2].v[2], m.r[2].v[3],
+			m.r[3].v[0], m.r[3].v[1], m.r[3].v[2], m.r[3].v[3]);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		const ScalarMath::Matrix m = ScalarMath::MatrixPerspectiveFovLH(fovAngleY, aspectRatio, nearZ, farZ);
+		return XMMATRIX(
+			m.r[0].v[0], m.r[0].v[1], m.r[0].v[2], m.r[0].v[3],
+			m.r[1].v[0], m.r[1].v[1], m.r[1].v[2], m.r[1].v[3],
+			m.r[2].v[0], m.r[2].v[1], m.r[2].v[2], m.r[2].v[3],
+			m.r[3].v[0], m.r[3].v[1], m.r[3].v[2], m.r[3].v[3]);
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixLookToLH(FXMVECTOR eye, FXMVECTOR direction, FXMVECTOR up)
+	{
+#if defined(PORTABLE_MATH_SSE2)
+		const XMVECTOR r2 = XMVector3Normalize(direction);
+		const XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(up, r2));
+		const XMVECTOR r1 = XMVector3Cross(r2, r0);
+		const XMVECTOR negEye = XMVectorNegate(eye);
+		// Rows of the rotation with the translation in w, transposed.
+		XMVECTOR c0 = XMVectorSetW(r0, XMVectorGetX(XMVector3Dot(r0, negEye)));
+		XMVECTOR c1 = XMVectorSetW(r1, XMVectorGetX(XMVector3Dot(r1, negEye)));
+		XMVECTOR c2 = XMVectorSetW(r2, XMVectorGetX(XMVector3Dot(r2, negEye)));
+		XMVECTOR c3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		return XMMATRIX(c0, c1, c2, c3);
+#else
+		return FromScalar(ScalarMath::MatrixLookToLH(eye, direction, up));
+#endif
+	}
+
+	inline XMMATRIX XM_CALLCONV XMMatrixLookAtLH(FXMVECTOR eye, FXMVECTOR focus, FXMVECTOR up)
+	{
+		return XMMatrixLookToLH(eye, XMVectorSubtract(focus, eye), up);
+	}
+
+#if defined(PORTABLE_MATH_SSE2) && defined(_MSC_VER) && !defined(__clang__)
+	// GCC and Clang have these built in for vector types; MSVC's __m128 is
+	// a union and needs them spelled out, as DirectXMath does.
+	inline XMVECTOR XM_CALLCONV operator+(FXMVECTOR v) { return v; }
+	inline XMVECTOR XM_CALLCONV operator-(FXMVECTOR v) { return XMVectorNegate(v); }
+	inline XMVECTOR XM_CALLCONV operator+(FXMVECTOR a, FXMVECTOR b) { return XMVectorAdd(a, b); }
+	inline XMVECTOR XM_CALLCONV operator-(FXMVECTOR a, FXMVECTOR b) { return XMVectorSubtract(a, b); }
+	inline XMVECTOR XM_CALLCONV operator*(FXMVECTOR a, FXMVECTOR b) { return XMVectorMultiply(a, b); }
+	inline XMVECTOR XM_CALLCONV operator/(FXMVECTOR a, FXMVECTOR b) { return XMVectorDivide(a, b); }
+	inline XMVECTOR XM_CALLCONV operator*(FXMVECTOR v, float s) { return XMVectorScale(v, s); }
+	inline XMVECTOR XM_CALLCONV operator*(float s, FXMVECTOR v) { return XMVectorScale(v, s); }
+	inline XMVECTOR XM_CALLCONV operator/(FXMVECTOR v, float s) { return XMVectorDivide(v, XMVectorReplicate(s)); }
+	inline XMVECTOR& XM_CALLCONV operator+=(XMVECTOR& a, FXMVECTOR b) { a = XMVectorAdd(a, b); return a; }
+	inline XMVECTOR& XM_CALLCONV operator-=(XMVECTOR& a, FXMVECTOR b) { a = XMVectorSubtract(a, b); return a; }
+	inline XMVECTOR& XM_CALLCONV operator*=(XMVECTOR& a, FXMVECTOR b) { a = XMVectorMultiply(a, b); return a; }
+	inline XMVECTOR& XM_CALLCONV operator/=(XMVECTOR& a, FXMVECTOR b) { a = XMVectorDivide(a, b); return a; }
+	inline XMVECTOR& XM_CALLCONV operator*=(XMVECTOR& v, float s) { v = XMVectorScale(v, s); return v; }
+	inline XMVECTOR& XM_CALLCONV operator/=(XMVECTOR& v, float s) { v = XMVectorDivide(v, XMVectorReplicate(s)); return v; }
+#endif
+}
@@ -0,0 +1,220 @@
+#pragma once
+#include <cmath>
+
+// Plain C++ versions of the vector and matrix operations the engine uses,
+// with the conventions of DirectXMath: row vectors, v * M, left-handed
+// view and projection matrices. PortableMath falls back to them where
+// there is no SIMD, and the math benchmark measures against them.
+// Sums are taken in the same order as the SIMD versions, so both give the
+// same results unless the compiler contracts them into fused multiplies.
+namespace ScalarMath
+{
+	struct alignas(16) Vector
+	{
+		float v[4];
+	};
+
+	struct Matrix
+	{
+		Vector r[4];
+	};
+
+	inline Vector VectorSet(float x, float y, float z, float w)
+	{
+		Vector result = { { x, y, z, w } };
+		return result;
+	}
+
+	inline Vector VectorZero()
+	{
+		return VectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+
+	inline Vector VectorReplicate(float value)
+	{
+		return VectorSet(value, value, value, value);
+	}
+
+	inline Vector VectorAdd(const Vector& a, const Vector& b)
+	{
+		return VectorSet(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]);
+	}
+
+	inline Vector VectorSubtract(const Vector& a, const Vector& b)
+	{
+		return VectorSet(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]);
+	}
+
+	inline Vector VectorMultiply(const Vector& a, const Vector& b)
+	{
+		return VectorSet(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]);
+	}
+
+	inline Vector VectorDivide(const Vector& a, const Vector& b)
+	{
+		return VectorSet(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]);
+	}
+
+	inline Vector VectorScale(const Vector& a, float s)
+	{
+		return VectorSet(a.v[0] * s, a.v[1] * s, a.v[2] * s, a.v[3] * s);
+	}
+
+	inline Vector VectorNegate(const Vector& a)
+	{
+		return VectorSet(-a.v[0], -a.v[1], -a.v[2], -a.v[3]);
+	}
+
+	inline Vector VectorLerp(const Vector& a, const Vector& b, float t)
+	{
+		return VectorAdd(a, VectorScale(VectorSubtract(b, a), t));
+	}
+
+	// The operators DirectXMath defines on XMVECTOR, which is a Vector when
+	// PortableMath has no SIMD.
+	inline Vector operator-(const Vector& a) { return VectorNegate(a); }
+	inline Vector operator+(const Vector& a, const Vector& b) { return VectorAdd(a, b); }
+	inline Vector operator-(const Vector& a, const Vector& b) { return VectorSubtract(a, b); }
+	inline Vector operator*(const Vector& a, const Vector& b) { return VectorMultiply(a, b); }
+	inline Vector operator/(const Vector& a, const Vector& b) { return VectorDivide(a, b); }
+	inline Vector operator*(const Vector& a, float s) { return VectorScale(a, s); }
+	inline Vector operator*(float s, const Vector& a) { return VectorScale(a, s); }
+	inline Vector operator/(const Vector& a, float s) { return VectorDivide(a, VectorReplicate(s)); }
+	inline Vector& operator+=(Vector& a, const Vector& b) { a = VectorAdd(a, b); return a; }
+	inline Vector& operator-=(Vector& a, const Vector& b) { a = VectorSubtract(a, b); return a; }
+	inline Vector& operator*=(Vector& a, const Vector& b) { a = VectorMultiply(a, b); return a; }
+	inline Vector& operator/=(Vector& a, const Vector& b) { a = VectorDivide(a, b); return a; }
+	inline Vector& operator*=(Vector& a, float s) { a = VectorScale(a, s); return a; }
+	inline Vector& operator/=(Vector& a, float s) { a = VectorDivide(a, VectorReplicate(s)); return a; }
+
+	inline float Vector3Dot(const Vector& a, const Vector& b)
+	{
+		return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2];
+	}
+
+	inline Vector Vector3Cross(const Vector& a, const Vector& b)
+	{
+		return VectorSet(a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2], a.v[0] * b.v[1] - a.v[1] * b.v[0], 0.0f);
+	}
+
+	// All four components are divided by the length of x, y and z; a zero
+	// vector stays zero.
+	inline Vector Vector3Normalize(const Vector& a)
+	{
+		const float length = std::sqrt(Vector3Dot(a, a));
+		if (!(length > 0.0f))
+			return VectorZero();
+		return VectorSet(a.v[0] / length, a.v[1] / length, a.v[2] / length, a.v[3] / length);
+	}
+
+	inline bool Vector3Equal(const Vector& a, const Vector& b)
+	{
+		return a.v[0] == b.v[0] && a.v[1] == b.v[1] && a.v[2] == b.v[2];
+	}
+
+	// (x, y, z, 1) * m, divided by the resulting w.
+	inline Vector Vector3TransformCoord(const Vector& a, const Matrix& m)
+	{
+		float out[4];
+		for (int j = 0; j < 4; ++j)
+			out[j] = a.v[0] * m.r[0].v[j] + a.v[1] * m.r[1].v[j] + a.v[2] * m.r[2].v[j] + m.r[3].v[j];
+		return VectorSet(out[0] / out[3], out[1] / out[3], out[2] / out[3], out[3] / out[3]);
+	}
+
+	inline Vector Vector4Transform(const Vector& a, const Matrix& m)
+	{
+		float out[4];
+		for (int j = 0; j < 4; ++j)
+			out[j] = a.v[0] * m.r[0].v[j] + a.v[1] * m.r[1].v[j] + a.v[2] * m.r[2].v[j] + a.v[3] * m.r[3].v[j];
+		return VectorSet(out[0], out[1], out[2], out[3]);
+	}
+
+	inline Matrix MatrixSet(const Vector& r0, const Vector& r1, const Vector& r2, const Vector& r3)
+	{
+		Matrix m;
+		m.r[0] = r0;
+		m.r[1] = r1;
+		m.r[2] = r2;
+		m.r[3] = r3;
+		return m;
+	}
+
+	inline Matrix MatrixIdentity()
+	{
+		return MatrixSet(VectorSet(1.0f, 0.0f, 0.0f, 0.0f), VectorSet(0.0f, 1.0f, 0.0f, 0.0f),
+			VectorSet(0.0f, 0.0f, 1.0f, 0.0f), VectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	inline Matrix MatrixMultiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix m;
+		for (int i = 0; i < 4; ++i)
+			m.r[i] = Vector4Transform(a.r[i], b);
+		return m;
+	}
+
+	inline Matrix MatrixTranspose(const Matrix& a)
+	{
+		Matrix m;
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				m.r[i].v[j] = a.r[j].v[i];
+		return m;
+	}
+
+	inline Matrix MatrixTranslation(float x, float y, float z)
+	{
+		Matrix m = MatrixIdentity();
+		m.r[3] = VectorSet(x, y, z, 1.0f);
+		return m;
+	}
+
+	inline Matrix MatrixScaling(float x, float y, float z)
+	{
+		return MatrixSet(VectorSet(x, 0.0f, 0.0f, 0.0f), VectorSet(0.0f, y, 0.0f, 0.0f),
+			VectorSet(0.0f, 0.0f, z, 0.0f), VectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	// Roll about z, then pitch about x, then yaw about y.
+	inline Matrix MatrixRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		const float cp = std::cos(pitch);
+		const float sp = std::sin(pitch);
+		const float cy = std::cos(yaw);
+		const float sy = std::sin(yaw);
+		const float cr = std::cos(roll);
+		const float sr = std::sin(roll);
+		return MatrixSet(
+			VectorSet(cr * cy + sr * sp * sy, sr * cp, sr * sp * cy - cr * sy, 0.0f),
+			VectorSet(cr * sp * sy - sr * cy, cr * cp, sr * sy + cr * sp * cy, 0.0f),
+			VectorSet(cp * sy, -sp, cp * cy, 0.0f),
+			VectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	inline Matrix MatrixLookToLH(const Vector& eye, const Vector& direction, const Vector& up)
+	{
+		const Vector r2 = Vector3Normalize(direction);
+		const Vector r0 = Vector3Normalize(Vector3Cross(up, r2));
+		const Vector r1 = Vector3Cross(r2, r0);
+		const Vector negEye = VectorNegate(eye);
+		return MatrixSet(
+			VectorSet(r0.v[0], r1.v[0], r2.v[0], 0.0f),
+			VectorSet(r0.v[1], r1.v[1], r2.v[1], 0.0f),
+			VectorSet(r0.v[2], r1.v[2], r2.v[2], 0.0f),
+			VectorSet(Vector3Dot(r0, negEye), Vector3Dot(r1, negEye), Vector3Dot(r2, negEye), 1.0f));
+	}
+
+	inline Matrix MatrixLookAtLH(const Vector& eye, const Vector& focus, const Vector& up)
+	{
+		return MatrixLookToLH(eye, VectorSubtract(focus, eye), up);
+	}
+
+	inline Matrix MatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		const float height = std::cos(0.5f * fovAngleY) / std::sin(0.5f * fovAngleY);
+		const float width = height / aspectRatio;
+		const float range = farZ / (farZ - nearZ);
+		return MatrixSet(VectorSet(width, 0.0f, 0.0f, 0.0f), VectorSet(0.0f, height, 0.0f, 0.0f),
+			VectorSet(0.0f, 0.0f, range, 1.0f), VectorSet(0.0f, 0.0f, -range * nearZ, 0.0f));
+	}
+}
@@ -0,0 +1,504 @@
+#pragma once
+// The kernels behind MathKernels, written once over Simd::Lanes. Only the
+// Kernels*.cpp files include this, each compiled for its own instruction
+// set; everything here has internal linkage so the linker can't swap one
+// tier's copy of a function for another's.
+#include "MathKernels.h"
+#include "SimdLanes.h"
+#include <cfloat>
+#include <cmath>
+
+// Every tier gives the same results, so a tier forced for testing behaves
+// like the detected one: no fused multiply-adds where the code doesn't ask
+// for them. Other compilers get -ffp-contract=off on these files from the
+// build.
+#ifdef _MSC_VER
+#pragma fp_contract(off)
+#endif
+
+namespace
+{
+	typedef Simd::Lanes L;
+	typedef L::F F;
+	typedef L::I I;
+	typedef L::M M;
+	typedef L::D D;
+
+	const float twoOverPi = 0.636619772f;
+
+	// pi/2 in three parts for the single-precision reduction: q times the
+	// first is exact for |q| < 2^16, and the sum is pi/2 to about 2^-50.
+	const float pio2Part1 = 1.5703125f;
+	const float pio2Part2 = 4.837512969970703125e-4f;
+	const float pio2Part3 = 7.54978995489188216e-8f;
+	// The first two merged, for the fast reduction.
+	const float pio2Fast2 = 4.83826794e-4f;
+	// pi/2 in two doubles; q times the first is exact for |q| < 2^20.
+	const double pio2High = 1.5707963267341256141662597656250;
+	const double pio2Low = 6.0771005065061922e-11;
+
+	// Past these the reductions lose precision and lanes take the C library.
+	const float standardTrigLimit = 8192.0f;
+	const float preciseTrigLimit = 1.0e6f;
+
+	const double ln2 = 0.69314718055994530942;
+	const double log2e = 1.44269504088896340736;
+
+	size_t LanesAt(size_t i, size_t count)
+	{
+		return count - i < L::width ? count - i : L::width;
+	}
+
+	F XorSign(F a, I sign)
+	{
+		return L::AsFloat(L::XorInt(L::AsInt(a), sign));
+	}
+
+	// NaN for infinite and NaN x, 0 otherwise.
+	F NonFinite(F x)
+	{
+		return L::Sub(x, x);
+	}
+
+	// sin(x) and cos(x) from sin(r) and cos(r), x = r + q * pi/2.
+	void ApplyQuadrant(I q, F sinR, F cosR, F& sinX, F& cosX)
+	{
+		const M swap = L::EqInt(L::AndInt(q, L::SetInt(1)), L::SetInt(1));
+		const F sinBase = L::Select(swap, cosR, sinR);
+		const F cosBase = L::Select(swap, sinR, cosR);
+		sinX = XorSign(sinBase, L::ShiftLeft<30>(L::AndInt(q, L::SetInt(2))));
+		cosX = XorSign(cosBase, L::ShiftLeft<30>(L::AndInt(L::AddInt(q, L::SetInt(1)), L::SetInt(2))));
+	}
+
+	// Taylor series to r^13 and r^14; both are far below 2^-24 relative
+	// for |r| < 0.9, which covers the reduction done in single precision.
+	void SinCosPrecise(F x, F& sinX, F& cosX)
+	{
+		const I q = L::RoundToInt(L::Mul(x, L::Set1(twoOverPi)));
+		D xd[L::doubleHalves];
+		D qd[L::doubleHalves];
+		D sinD[L::doubleHalves];
+		D cosD[L::doubleHalves];
+		L::Widen(x, xd);
+		L::Widen(L::ToFloat(q), qd);
+		for (int h = 0; h < L::doubleHalves; ++h)
+		{
+			const D r = L::SubD(L::SubD(xd[h], L::MulD(qd[h], L::Set1D(pio2High))), L::MulD(qd[h], L::Set1D(pio2Low)));
+			const D z = L::MulD(r, r);
+			D s = L::Set1D(1.0 / 6227020800.0);
+			s = L::AddD(L::MulD(s, z), L::Set1D(-1.0 / 39916800.0));
+			s = L::AddD(L::MulD(s, z), L::Set1D(1.0 / 362880.0));
+			s = L::AddD(L::MulD(s, z), L::Set1D(-1.0 / 5040.0));
+			s = L::AddD(L::MulD(s, z), L::Set1D(1.0 / 120.0));
+			s = L::AddD(L::MulD(s, z), L::Set1D(-1.0 / 6.0));
+			sinD[h] = L::AddD(r, L::MulD(L::MulD(r, z), s));
+			D c = L::Set1D(1.0 / 87178291200.0);
+			c = L::AddD(L::MulD(c, z), L::Set1D(-1.0 / 479001600.0));
+			c = L::AddD(L::MulD(c, z), L::Set1D(1.0 / 3628800.0));
+			c = L::AddD(L::MulD(c, z), L::Set1D(-1.0 / 40320.0));
+			c = L::AddD(L::MulD(c, z), L::Set1D(1.0 / 720.0));
+			c = L::AddD(L::MulD(c, z), L::Set1D(-1.0 / 24.0));
+			c = L::AddD(L::MulD(c, z), L::Set1D(0.5));
+			cosD[h] = L::SubD(L::Set1D(1.0), L::MulD(z, c));
+		}
+		ApplyQuadrant(q, L::Narrow(sinD), L::Narrow(cosD), sinX, cosX);
+	}
+
+	// Cephes sinf and cosf polynomials on [-pi/4, pi/4]. The last part of
+	// pi/2 is only good to 2^-24, which costs up to |q| * 2^-47 in r: lanes
+	// where that could be more than half an ulp, close to the zeros of sin
+	// or cos, are marked for the C library.
+	void SinCosStandard(F x, F& sinX, F& cosX, M& cancelled)
+	{
+		const I q = L::RoundToInt(L::Mul(x, L::Set1(twoOverPi)));
+		const F qf = L::ToFloat(q);
+		F r = L::Sub(x, L::Mul(qf, L::Set1(pio2Part1)));
+		r = L::Sub(r, L::Mul(qf, L::Set1(pio2Part2)));
+		r = L::Sub(r, L::Mul(qf, L::Set1(pio2Part3)));
+		cancelled = L::Lt(L::Abs(r), L::Mul(L::Abs(qf), L::Set1(2.38418579e-7f)));
+		const F z = L::Mul(r, r);
+
+		F s = L::Set1(-1.9515295891e-4f);
+		s = L::Add(L::Mul(s, z), L::Set1(8.3321608736e-3f));
+		s = L::Add(L::Mul(s, z), L::Set1(-1.6666654611e-1f));
+		const F sinR = L::Add(r, L::Mul(L::Mul(r, z), s));
+
+		F c = L::Set1(2.443315711809948e-5f);
+		c = L::Add(L::Mul(c, z), L::Set1(-1.388731625493765e-3f));
+		c = L::Add(L::Mul(c, z), L::Set1(4.166664568298827e-2f));
+		const F cosR = L::Add(L::Sub(L::Mul(L::Mul(z, z), c), L::Mul(z, L::Set1(0.5f))), L::Set1(1.0f));
+		ApplyQuadrant(q, sinR, cosR, sinX, cosX);
+	}
+
+	// Minimax fits of sin(r) / r and cos(r) in r^2, errors 1.5e-6 and 1e-5.
+	void SinCosFast(F x, F& sinX, F& cosX)
+	{
+		const I q = L::RoundToInt(L::Mul(x, L::Set1(twoOverPi)));
+		const F qf = L::ToFloat(q);
+		F r = L::Sub(x, L::Mul(qf, L::Set1(pio2Part1)));
+		r = L::Sub(r, L::Mul(qf, L::Set1(pio2Fast2)));
+		const F z = L::Mul(r, r);
+
+		F s = L::Set1(8.151599473e-3f);
+		s = L::Add(L::Mul(s, z), L::Set1(-1.666247850e-1f));
+		s = L::Add(L::Mul(s, z), L::Set1(9.999985686e-1f));
+		F c = L::Set1(4.039828445e-2f);
+		c = L::Add(L::Mul(c, z), L::Set1(-4.997080239e-1f));
+		c = L::Add(L::Mul(c, z), L::Set1(9.999900290e-1f));
+		ApplyQuadrant(q, L::Mul(r, s), c, sinX, cosX);
+
+		const F nonFinite = NonFinite(x);
+		const M invalid = L::IsNaN(nonFinite);
+		sinX = L::Select(invalid, nonFinite, sinX);
+		cosX = L::Select(invalid, nonFinite, cosX);
+	}
+
+	template<MathAccuracy accuracy, bool wantSin, bool wantCos>
+	void SinCosArray(const float* x, float* sinOut, float* cosOut, size_t count)
+	{
+		const float limit = accuracy == MathAccuracy::PRECISE ? preciseTrigLimit : standardTrigLimit;
+		for (size_t i = 0; i < count; i += L::width)
+		{
+			const size_t n = LanesAt(i, count);
+			const F v = L::Load(x + i, n);
+			F s, c;
+			M outsideMask = L::Not(L::Le(L::Abs(v), L::Set1(limit)));
+			if (accuracy == MathAccuracy::PRECISE)
+			{
+				SinCosPrecise(v, s, c);
+			}
+			else if (accuracy == MathAccuracy::STANDARD)
+			{
+				M cancelled;
+				SinCosStandard(v, s, c, cancelled);
+				outsideMask = L::Or(outsideMask, cancelled);
+			}
+			else
+			{
+				SinCosFast(v, s, c);
+			}
+
+			// Inputs are kept first, the output may overwrite them.
+			unsigned int outside = accuracy == MathAccuracy::FAST ? 0 : L::Bits(outsideMask);
+			float input[L::width];
+			if (outside)
+				L::Store(input, v, L::width);
+			if (wantSin)
+				L::Store(sinOut + i, s, n);
+			if (wantCos)
+				L::Store(cosOut + i, c, n);
+			for (size_t lane = 0; outside != 0 && lane < n; ++lane, outside >>= 1)
+			{
+				if (!(outside & 1))
+					continue;
+				const double value = input[lane];
+				if (wantSin)
+					sinOut[i + lane] = static_cast<float>(std::sin(value));
+				if (wantCos)
+					cosOut[i + lane] = static_cast<float>(std::cos(value));
+			}
+		}
+	}
+
+	template<bool wantSin, bool wantCos>
+	void SinCosDispatch(const float* x, float* sinOut, float* cosOut, size_t count, MathAccuracy accuracy)
+	{
+		switch (accuracy)
+		{
+		case MathAccuracy::PRECISE: SinCosArray<MathAccuracy::PRECISE, wantSin, wantCos>(x, sinOut, cosOut, count); break;
+		case MathAccuracy::STANDARD: SinCosArray<MathAccuracy::STANDARD, wantSin, wantCos>(x, sinOut, cosOut, count); break;
+		default: SinCosArray<MathAccuracy::FAST, wantSin, wantCos>(x, sinOut, cosOut, count); break;
+		}
+	}
+
+	// Lanes where the vector pow applies: positive normal x, finite y.
+	M PowInRange(F x, F y)
+	{
+		const F infinity = L::Set1(INFINITY);
+		return L::And(L::And(L::Le(L::Set1(FLT_MIN), x), L::Lt(x, infinity)), L::Lt(L::Abs(y), infinity));
+	}
+
+	// x = m * 2^e with m in [sqrt(1/2), sqrt(2)), for positive normal x.
+	void SplitExponent(F x, F& m, F& e)
+	{
+		const I bits = L::AsInt(x);
+		e = L::ToFloat(L::SubInt(L::ShiftRightLogical<23>(bits), L::SetInt(127)));
+		m = L::AsFloat(L::OrInt(L::AndInt(bits, L::SetInt(0x007FFFFF)), L::SetInt(0x3F800000)));
+		const M high = L::Lt(L::Set1(1.41421356f), m);
+		m = L::Select(high, L::Mul(m, L::Set1(0.5f)), m);
+		e = L::Select(high, L::Add(e, L::Set1(1.0f)), e);
+	}
+
+	// exp2(y * log2(x)) in double: ln(m) = 2 atanh((m - 1) / (m + 1)) to
+	// s^13 and exp of the fraction to u^11, both far below 2^-24.
+	F PowPrecise(F x, F y)
+	{
+		F m, e;
+		SplitExponent(x, m, e);
+		D md[L::doubleHalves];
+		D ed[L::doubleHalves];
+		D yd[L::doubleHalves];
+		D result[L::doubleHalves];
+		L::Widen(m, md);
+		L::Widen(e, ed);
+		L::Widen(y, yd);
+		const D one = L::Set1D(1.0);
+		for (int h = 0; h < L::doubleHalves; ++h)
+		{
+			const D s = L::DivD(L::SubD(md[h], one), L::AddD(md[h], one));
+			const D s2 = L::MulD(s, s);
+			D series = L::Set1D(1.0 / 13.0);
+			series = L::AddD(L::MulD(series, s2), L::Set1D(1.0 / 11.0));
+			series = L::AddD(L::MulD(series, s2), L::Set1D(1.0 / 9.0));
+			series = L::AddD(L::MulD(series, s2), L::Set1D(1.0 / 7.0));
+			series = L::AddD(L::MulD(series, s2), L::Set1D(1.0 / 5.0));
+			series = L::AddD(L::MulD(series, s2), L::Set1D(1.0 / 3.0));
+			series = L::AddD(L::MulD(series, s2), one);
+			const D log2x = L::AddD(ed[h], L::MulD(L::MulD(L::MulD(L::Set1D(2.0), s), series), L::Set1D(log2e)));
+
+			// Past +-1000 the float result is 0 or infinity either way.
+			const D t = L::MaxD(L::MinD(L::MulD(yd[h], log2x), L::Set1D(1000.0)), L::Set1D(-1000.0));
+			const D n = L::SubD(L::AddD(t, L::Set1D(Simd::roundingMagic)), L::Set1D(Simd::roundingMagic));
+			const D u = L::MulD(L::SubD(t, n), L::Set1D(ln2));
+			D p = L::Set1D(1.0 / 39916800.0);
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 3628800.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 362880.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 40320.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 5040.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 720.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 120.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 24.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(1.0 / 6.0));
+			p = L::AddD(L::MulD(p, u), L::Set1D(0.5));
+			p = L::AddD(L::MulD(p, u), one);
+			p = L::AddD(L::MulD(p, u), one);
+			result[h] = L::MulD(p, L::Exp2IntD(n));
+		}
+		return L::Narrow(result);
+	}
+
+	// The same in single precision: a fitted atanh series and the Cephes
+	// exp2f polynomial.
+	F PowFast(F x, F y)
+	{
+		F m, e;
+		SplitExponent(x, m, e);
+		const F one = L::Set1(1.0f);
+		const F s = L::Div(L::Sub(m, one), L::Add(m, one));
+		const F s2 = L::Mul(s, s);
+		F series = L::Set1(2.064873236e-1f);
+		series = L::Add(L::Mul(series, s2), L::Set1(3.332609578e-1f));
+		series = L::Add(L::Mul(series, s2), L::Set1(1.000000119f));
+		const F log2x = L::Add(e, L::Mul(L::Mul(s, series), L::Set1(static_cast<float>(2.0 * log2e))));
+
+		F t = L::Mul(y, log2x);
+		t = L::Select(L::Lt(t, L::Set1(-150.0f)), L::Set1(-150.0f), t);
+		t = L::Select(L::Lt(L::Set1(128.0f), t), L::Set1(128.0f), t);
+		const I n = L::RoundToInt(t);
+		const F f = L::Sub(t, L::ToFloat(n));
+		F p = L::Set1(1.535336188319500e-4f);
+		p = L::Add(L::Mul(p, f), L::Set1(1.339887440266574e-3f));
+		p = L::Add(L::Mul(p, f), L::Set1(9.618437357674640e-3f));
+		p = L::Add(L::Mul(p, f), L::Set1(5.550332471162809e-2f));
+		p = L::Add(L::Mul(p, f), L::Set1(2.402264791363012e-1f));
+		p = L::Add(L::Mul(p, f), L::Set1(6.931472028550421e-1f));
+		p = L::Add(L::Mul(p, f), one);
+		// 2^n in two factors so both ends of the range have an exponent
+		// field: 2^(n - 1) * 2 up to 2^128, 2^(n + 64) * 2^-64 down into the
+		// denormals.
+		const M low = L::Lt(t, L::Set1(0.0f));
+		const I biased = L::RoundToInt(L::Add(L::ToFloat(n), L::Select(low, L::Set1(191.0f), L::Set1(126.0f))));
+		const F scale = L::AsFloat(L::ShiftLeft<23>(biased));
+		return L::Mul(L::Mul(p, scale), L::Select(low, L::Set1(5.42101086e-20f), L::Set1(2.0f)));
+	}
+
+	void Sin(const float* x, float* out, size_t count, MathAccuracy accuracy)
+	{
+		SinCosDispatch<true, false>(x, out, nullptr, count, accuracy);
+	}
+
+	void Cos(const float* x, float* out, size_t count, MathAccuracy accuracy)
+	{
+		SinCosDispatch<false, true>(x, nullptr, out, count, accuracy);
+	}
+
+	void SinCos(const float* x, float* sinOut, float* cosOut, size_t count, MathAccuracy accuracy)
+	{
+		SinCosDispatch<true, true>(x, sinOut, cosOut, count, accuracy);
+	}
+
+	void Sqrt(const float* x, float* out, size_t count, MathAccuracy)
+	{
+		for (size_t i = 0; i < count; i += L::width)
+		{
+			const size_t n = LanesAt(i, count);
+			const F v = L::Load(x + i, n);
+			L::Store(out + i, L::Sqrt(v), n);
+		}
+	}
+
+	void Pow(const float* x, const float* y, float* out, size_t count, MathAccuracy accuracy)
+	{
+		for (size_t i = 0; i < count; i += L::width)
+		{
+			const size_t n = LanesAt(i, count);
+			const F base = L::Load(x + i, n);
+			const F exponent = L::Load(y + i, n);
+			const F result = accuracy == MathAccuracy::FAST ? PowFast(base, exponent) : PowPrecise(base, exponent);
+
+			// Zero, negative, denormal and non-finite arguments take the C
+			// library; the inputs are kept first, the output may overwrite them.
+			unsigned int outside = L::Bits(L::Not(PowInRange(base, exponent)));
+			float bases[L::width];
+			float exponents[L::width];
+			if (outside)
+			{
+				L::Store(bases, base, L::width);
+				L::Store(exponents, exponent, L::width);
+			}
+			L::Store(out + i, result, n);
+			for (size_t lane = 0; outside != 0 && lane < n; ++lane, outside >>= 1)
+			{
+				if (outside & 1)
+					out[i + lane] = static_cast<float>(std::pow(static_cast<double>(bases[lane]), static_cast<double>(exponents[lane])));
+			}
+		}
+	}
+
+	// Matrix elements and viewport scale, each replicated across a vector.
+	struct Coefficients
+	{
+		L::F m[4][4];
+		L::F one;
+		L::F halfWidth;
+		L::F halfHeight;
+	};
+
+	void Prepare(const float* m, const TransformStreamDesc& desc, Coefficients& c)
+	{
+		for (int row = 0; row < 4; ++row)
+			for (int column = 0; column < 4; ++column)
+				c.m[row][column] = L::Set1(m[4 * row + column]);
+		c.one = L::Set1(1.0f);
+		c.halfWidth = L::Set1(0.5f * desc.viewportWidth);
+		c.halfHeight = L::Set1(0.5f * desc.viewportHeight);
+	}
+
+	// Sums in the same order as SoftwareRasterizer's scalar transform, so
+	// both agree to the bit.
+	inline L::F Row(L::F x, L::F y, L::F z, const Coefficients& c, int column)
+	{
+		L::F sum = L::Add(L::Mul(x, c.m[0][column]), L::Mul(y, c.m[1][column]));
+		sum = L::Add(sum, L::Mul(z, c.m[2][column]));
+		return L::Add(sum, c.m[3][column]);
+	}
+
+	template<TransformOutput output>
+	void TransformRange(const SoaPoints3& in, size_t begin, size_t end, const Coefficients& c, const SoaPoints4& out)
+	{
+		for (size_t i = begin; i < end; i += L::width)
+		{
+			const size_t n = end - i < L::width ? end - i : L::width;
+			const L::F x = L::Load(in.x + i, n);
+			const L::F y = L::Load(in.y + i, n);
+			const L::F z = L::Load(in.z + i, n);
+			L::F cx = Row(x, y, z, c, 0);
+			L::F cy = Row(x, y, z, c, 1);
+			L::F cz = Row(x, y, z, c, 2);
+			const L::F cw = Row(x, y, z, c, 3);
+			if (output != TransformOutput::CLIP)
+			{
+				cx = L::Div(cx, cw);
+				cy = L::Div(cy, cw);
+				cz = L::Div(cz, cw);
+			}
+			if (output == TransformOutput::SCREEN)
+			{
+				cx = L::Mul(L::Add(cx, c.one), c.halfWidth);
+				cy = L::Mul(L::Sub(c.one, cy), c.halfHeight);
+			}
+			L::Store(out.x + i, cx, n);
+			L::Store(out.y + i, cy, n);
+			L::Store(out.z + i, cz, n);
+			L::Store(out.w + i, cw, n);
+		}
+	}
+
+	void TransformPoints(const SoaPoints3& in, size_t begin, size_t end, const float* m, const TransformStreamDesc& desc, const SoaPoints4& out)
+	{
+		Coefficients c;
+		Prepare(m, desc, c);
+		switch (desc.output)
+		{
+		case TransformOutput::CLIP: TransformRange<TransformOutput::CLIP>(in, begin, end, c, out); break;
+		case TransformOutput::NDC: TransformRange<TransformOutput::NDC>(in, begin, end, c, out); break;
+		case TransformOutput::SCREEN: TransformRange<TransformOutput::SCREEN>(in, begin, end, c, out); break;
+		}
+	}
+
+#if defined(SIMD_LANES_SCALAR)
+	void PackVertices(const SoaPoints3& in, size_t count, const float* color, float* out)
+	{
+		for (size_t i = 0; i < count; ++i, out += 9)
+		{
+			out[0] = in.x[i];
+			out[1] = in.y[i];
+			out[2] = in.z[i];
+			for (int c = 0; c < 4; ++c)
+				out[3 + c] = color[c];
+			out[7] = 0.0f;
+			out[8] = 0.0f;
+		}
+	}
+#else
+	// Four vertices are 36 floats, nine 128-bit stores: the positions are
+	// shuffled in between copies of the color. Wider tiers use the same
+	// code, the stores are what limits it.
+	void PackVertices(const SoaPoints3& in, size_t count, const float* color, float* out)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 rgba = _mm_loadu_ps(color);
+		// g b a 0 and b a 0 0.
+		const __m128 gba0 = _mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(rgba), 4));
+		const __m128 ba00 = _mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(rgba), 8));
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4, out += 36)
+		{
+			const __m128 x = _mm_loadu_ps(in.x + i);
+			const __m128 y = _mm_loadu_ps(in.y + i);
+			const __m128 z = _mm_loadu_ps(in.z + i);
+			const __m128 xyLow = _mm_unpacklo_ps(x, y);
+			const __m128 xyHigh = _mm_unpackhi_ps(x, y);
+			const __m128 yzHigh = _mm_unpackhi_ps(y, z);
+			// x0 y0 z0 r | g b a 0
+			_mm_storeu_ps(out, _mm_shuffle_ps(xyLow, _mm_unpacklo_ps(z, rgba), _MM_SHUFFLE(1, 0, 1, 0)));
+			_mm_storeu_ps(out + 4, gba0);
+			// 0 x1 y1 z1 | r g b a
+			const __m128 xyz1 = _mm_shuffle_ps(xyLow, z, _MM_SHUFFLE(1, 1, 3, 2));
+			_mm_storeu_ps(out + 8, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(xyz1), 4)));
+			_mm_storeu_ps(out + 12, rgba);
+			// 0 0 x2 y2 | z2 r g b
+			_mm_storeu_ps(out + 16, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(xyHigh), 8)));
+			const __m128 z2r = _mm_shuffle_ps(z, rgba, _MM_SHUFFLE(0, 0, 2, 2));
+			_mm_storeu_ps(out + 20, _mm_shuffle_ps(z2r, rgba, _MM_SHUFFLE(2, 1, 2, 0)));
+			// a 0 0 x3 | y3 z3 r g | b a 0 0
+			_mm_storeu_ps(out + 24, _mm_shuffle_ps(gba0, _mm_unpackhi_ps(zero, x), _MM_SHUFFLE(3, 2, 3, 2)));
+			_mm_storeu_ps(out + 28, _mm_shuffle_ps(yzHigh, rgba, _MM_SHUFFLE(1, 0, 3, 2)));
+			_mm_storeu_ps(out + 32, ba00);
+		}
+		for (; i < count; ++i, out += 9)
+		{
+			out[0] = in.x[i];
+			out[1] = in.y[i];
+			out[2] = in.z[i];
+			_mm_storeu_ps(out + 3, rgba);
+			out[7] = 0.0f;
+			out[8] = 0.0f;
+		}
+	}
+#endif
+
+	// Constant-initialized: taking a table's address runs no code compiled
+	// for its instruction set.
+	const MathKernels simdKernels = { SIMD_KERNELS_TIER, Sin, Cos, SinCos, Sqrt, Pow, TransformPoints, PackVertices };
+}
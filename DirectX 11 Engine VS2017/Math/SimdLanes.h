@@ -0,0 +1,373 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Vector types for kernels written once for every instruction set. A
+// kernel is a template, or plain code, over `Lanes`: width floats per F,
+// the same number of 32-bit integers per I, a comparison result per M and
+// width / doubleHalves doubles per D. Lanes is the widest set the
+// translation unit is compiled for; ENGINE_MATH_SCALAR forces the plain
+// C++ one.
+#if defined(ENGINE_MATH_SCALAR)
+#define SIMD_LANES_SCALAR
+#elif defined(__AVX512F__)
+#define SIMD_LANES_AVX512
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define SIMD_LANES_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_LANES_SSE2
+#include <emmintrin.h>
+#else
+#define SIMD_LANES_SCALAR
+#endif
+
+// The unnamed namespace gives every translation unit its own copy of the
+// lane functions: the kernel files are compiled for different instruction
+// sets, and shared inline copies would let the linker keep the widest.
+namespace Simd
+{
+namespace
+{
+	// 1.5 * 2^52: adding it rounds a double below 2^51 in magnitude to an
+	// integer, which then sits in the low bits of the sum.
+	const double roundingMagic = 6755399441055744.0;
+
+	struct ScalarLanes
+	{
+		typedef float F;
+		typedef std::int32_t I;
+		typedef bool M;
+		typedef double D;
+		static const size_t width = 1;
+		static const int doubleHalves = 1;
+		static const char* Name() { return "Scalar"; }
+
+		static F Set1(float value) { return value; }
+		static F Load(const float* p, size_t) { return *p; }
+		static void Store(float* p, F v, size_t) { *p = v; }
+		static F Add(F a, F b) { return a + b; }
+		static F Sub(F a, F b) { return a - b; }
+		static F Mul(F a, F b) { return a * b; }
+		static F Div(F a, F b) { return a / b; }
+		static F Sqrt(F a) { return std::sqrt(a); }
+		static F Rsqrt(F a) { return 1.0f / std::sqrt(a); }
+		static F Abs(F a) { return std::fabs(a); }
+		static F Neg(F a) { return -a; }
+
+		static M Lt(F a, F b) { return a < b; }
+		static M Le(F a, F b) { return a <= b; }
+		static M Eq(F a, F b) { return a == b; }
+		static M IsNaN(F a) { return a != a; }
+		static M And(M a, M b) { return a && b; }
+		static M Or(M a, M b) { return a || b; }
+		static M Not(M a) { return !a; }
+		static unsigned int Bits(M m) { return m ? 1u : 0u; }
+		// a where m is set, b elsewhere.
+		static F Select(M m, F a, F b) { return m ? a : b; }
+
+		// Nearest, ties to even; out of range and NaN give INT32_MIN, as
+		// the SIMD conversions do.
+		static I RoundToInt(F a)
+		{
+			if (!(std::fabs(a) < 2147483520.0f))
+				return INT32_MIN;
+			return static_cast<I>(std::nearbyint(a));
+		}
+		static F ToFloat(I a) { return static_cast<F>(a); }
+		static I SetInt(std::int32_t value) { return value; }
+		static I AddInt(I a, I b) { return static_cast<I>(static_cast<std::uint32_t>(a) + static_cast<std::uint32_t>(b)); }
+		static I SubInt(I a, I b) { return static_cast<I>(static_cast<std::uint32_t>(a) - static_cast<std::uint32_t>(b)); }
+		static I AndInt(I a, I b) { return a & b; }
+		static I OrInt(I a, I b) { return a | b; }
+		static I XorInt(I a, I b) { return a ^ b; }
+		template<int n> static I ShiftLeft(I a) { return static_cast<I>(static_cast<std::uint32_t>(a) << n); }
+		template<int n> static I ShiftRightLogical(I a) { return static_cast<I>(static_cast<std::uint32_t>(a) >> n); }
+		static M EqInt(I a, I b) { return a == b; }
+		static I AsInt(F a) { I i; std::memcpy(&i, &a, sizeof(i)); return i; }
+		static F AsFloat(I a) { F f; std::memcpy(&f, &a, sizeof(f)); return f; }
+
+		static void Widen(F a, D out[doubleHalves]) { out[0] = a; }
+		static F Narrow(const D in[doubleHalves]) { return static_cast<F>(in[0]); }
+		static D Set1D(double value) { return value; }
+		static D AddD(D a, D b) { return a + b; }
+		static D SubD(D a, D b) { return a - b; }
+		static D MulD(D a, D b) { return a * b; }
+		static D DivD(D a, D b) { return a / b; }
+		static D MinD(D a, D b) { return a < b ? a : b; }
+		static D MaxD(D a, D b) { return a > b ? a : b; }
+		// 2^n for integral n in [-1022, 1023].
+		static D Exp2IntD(D n) { return std::ldexp(1.0, static_cast<int>(n)); }
+	};
+
+#if defined(SIMD_LANES_SSE2) || defined(SIMD_LANES_AVX2) || defined(SIMD_LANES_AVX512)
+	struct Sse2Lanes
+	{
+		typedef __m128 F;
+		typedef __m128i I;
+		typedef __m128 M;
+		typedef __m128d D;
+		static const size_t width = 4;
+		static const int doubleHalves = 2;
+		static const char* Name() { return "SSE2"; }
+
+		static F Set1(float value) { return _mm_set1_ps(value); }
+		// SSE2 has no masked moves; partial vectors go through a buffer.
+		static F Load(const float* p, size_t n)
+		{
+			if (n == width)
+				return _mm_loadu_ps(p);
+			float buffer[width] = {};
+			for (size_t i = 0; i < n; ++i)
+				buffer[i] = p[i];
+			return _mm_loadu_ps(buffer);
+		}
+		static void Store(float* p, F v, size_t n)
+		{
+			if (n == width)
+			{
+				_mm_storeu_ps(p, v);
+				return;
+			}
+			float buffer[width];
+			_mm_storeu_ps(buffer, v);
+			for (size_t i = 0; i < n; ++i)
+				p[i] = buffer[i];
+		}
+		static F Add(F a, F b) { return _mm_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm_div_ps(a, b); }
+		static F Sqrt(F a) { return _mm_sqrt_ps(a); }
+		static F Rsqrt(F a) { return _mm_rsqrt_ps(a); }
+		static F Abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		static F Neg(F a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+
+		static M Lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+		static M Le(F a, F b) { return _mm_cmple_ps(a, b); }
+		static M Eq(F a, F b) { return _mm_cmpeq_ps(a, b); }
+		static M IsNaN(F a) { return _mm_cmpunord_ps(a, a); }
+		static M And(M a, M b) { return _mm_and_ps(a, b); }
+		static M Or(M a, M b) { return _mm_or_ps(a, b); }
+		static M Not(M a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+		static unsigned int Bits(M m) { return static_cast<unsigned int>(_mm_movemask_ps(m)); }
+		static F Select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+		static I RoundToInt(F a) { return _mm_cvtps_epi32(a); }
+		static F ToFloat(I a) { return _mm_cvtepi32_ps(a); }
+		static I SetInt(std::int32_t value) { return _mm_set1_epi32(value); }
+		static I AddInt(I a, I b) { return _mm_add_epi32(a, b); }
+		static I SubInt(I a, I b) { return _mm_sub_epi32(a, b); }
+		static I AndInt(I a, I b) { return _mm_and_si128(a, b); }
+		static I OrInt(I a, I b) { return _mm_or_si128(a, b); }
+		static I XorInt(I a, I b) { return _mm_xor_si128(a, b); }
+		template<int n> static I ShiftLeft(I a) { return _mm_slli_epi32(a, n); }
+		template<int n> static I ShiftRightLogical(I a) { return _mm_srli_epi32(a, n); }
+		static M EqInt(I a, I b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+		static I AsInt(F a) { return _mm_castps_si128(a); }
+		static F AsFloat(I a) { return _mm_castsi128_ps(a); }
+
+		static void Widen(F a, D out[doubleHalves])
+		{
+			out[0] = _mm_cvtps_pd(a);
+			out[1] = _mm_cvtps_pd(_mm_movehl_ps(a, a));
+		}
+		static F Narrow(const D in[doubleHalves]) { return _mm_movelh_ps(_mm_cvtpd_ps(in[0]), _mm_cvtpd_ps(in[1])); }
+		static D Set1D(double value) { return _mm_set1_pd(value); }
+		static D AddD(D a, D b) { return _mm_add_pd(a, b); }
+		static D SubD(D a, D b) { return _mm_sub_pd(a, b); }
+		static D MulD(D a, D b) { return _mm_mul_pd(a, b); }
+		static D DivD(D a, D b) { return _mm_div_pd(a, b); }
+		static D MinD(D a, D b) { return _mm_min_pd(a, b); }
+		static D MaxD(D a, D b) { return _mm_max_pd(a, b); }
+		static D Exp2IntD(D n)
+		{
+			const __m128i biased = _mm_sub_epi64(_mm_castpd_si128(_mm_add_pd(n, _mm_set1_pd(roundingMagic))),
+				_mm_castpd_si128(_mm_set1_pd(roundingMagic - 1023.0)));
+			return _mm_castsi128_pd(_mm_slli_epi64(biased, 52));
+		}
+	};
+#endif
+
+#if defined(SIMD_LANES_AVX2) || defined(SIMD_LANES_AVX512)
+	struct Avx2Lanes
+	{
+		typedef __m256 F;
+		typedef __m256i I;
+		typedef __m256 M;
+		typedef __m256d D;
+		static const size_t width = 8;
+		static const int doubleHalves = 2;
+		static const char* Name() { return "AVX2"; }
+
+		static F Set1(float value) { return _mm256_set1_ps(value); }
+		static __m256i TailMask(size_t n)
+		{
+			return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+		}
+		static F Load(const float* p, size_t n)
+		{
+			if (n == width)
+				return _mm256_loadu_ps(p);
+			return _mm256_maskload_ps(p, TailMask(n));
+		}
+		static void Store(float* p, F v, size_t n)
+		{
+			if (n == width)
+				_mm256_storeu_ps(p, v);
+			else
+				_mm256_maskstore_ps(p, TailMask(n), v);
+		}
+		static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm256_div_ps(a, b); }
+		static F Sqrt(F a) { return _mm256_sqrt_ps(a); }
+		static F Rsqrt(F a) { return _mm256_rsqrt_ps(a); }
+		static F Abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+		static F Neg(F a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+
+		static M Lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static M Le(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static M Eq(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+		static M IsNaN(F a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+		static M And(M a, M b) { return _mm256_and_ps(a, b); }
+		static M Or(M a, M b) { return _mm256_or_ps(a, b); }
+		static M Not(M a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+		static unsigned int Bits(M m) { return static_cast<unsigned int>(_mm256_movemask_ps(m)); }
+		static F Select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+
+		static I RoundToInt(F a) { return _mm256_cvtps_epi32(a); }
+		static F ToFloat(I a) { return _mm256_cvtepi32_ps(a); }
+		static I SetInt(std::int32_t value) { return _mm256_set1_epi32(value); }
+		static I AddInt(I a, I b) { return _mm256_add_epi32(a, b); }
+		static I SubInt(I a, I b) { return _mm256_sub_epi32(a, b); }
+		static I AndInt(I a, I b) { return _mm256_and_si256(a, b); }
+		static I OrInt(I a, I b) { return _mm256_or_si256(a, b); }
+		static I XorInt(I a, I b) { return _mm256_xor_si256(a, b); }
+		template<int n> static I ShiftLeft(I a) { return _mm256_slli_epi32(a, n); }
+		template<int n> static I ShiftRightLogical(I a) { return _mm256_srli_epi32(a, n); }
+		static M EqInt(I a, I b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+		static I AsInt(F a) { return _mm256_castps_si256(a); }
+		static F AsFloat(I a) { return _mm256_castsi256_ps(a); }
+
+		static void Widen(F a, D out[doubleHalves])
+		{
+			out[0] = _mm256_cvtps_pd(_mm256_castps256_ps128(a));
+			out[1] = _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1));
+		}
+		static F Narrow(const D in[doubleHalves])
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(in[0])), _mm256_cvtpd_ps(in[1]), 1);
+		}
+		static D Set1D(double value) { return _mm256_set1_pd(value); }
+		static D AddD(D a, D b) { return _mm256_add_pd(a, b); }
+		static D SubD(D a, D b) { return _mm256_sub_pd(a, b); }
+		static D MulD(D a, D b) { return _mm256_mul_pd(a, b); }
+		static D DivD(D a, D b) { return _mm256_div_pd(a, b); }
+		static D MinD(D a, D b) { return _mm256_min_pd(a, b); }
+		static D MaxD(D a, D b) { return _mm256_max_pd(a, b); }
+		static D Exp2IntD(D n)
+		{
+			const __m256i biased = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(roundingMagic))),
+				_mm256_castpd_si256(_mm256_set1_pd(roundingMagic - 1023.0)));
+			return _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+		}
+	};
+#endif
+
+#if defined(SIMD_LANES_AVX512)
+	struct Avx512Lanes
+	{
+		typedef __m512 F;
+		typedef __m512i I;
+		typedef __mmask16 M;
+		typedef __m512d D;
+		static const size_t width = 16;
+		static const int doubleHalves = 2;
+		static const char* Name() { return "AVX-512"; }
+
+		static F Set1(float value) { return _mm512_set1_ps(value); }
+		static F Load(const float* p, size_t n)
+		{
+			if (n == width)
+				return _mm512_loadu_ps(p);
+			return _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << n) - 1), p);
+		}
+		static void Store(float* p, F v, size_t n)
+		{
+			if (n == width)
+				_mm512_storeu_ps(p, v);
+			else
+				_mm512_mask_storeu_ps(p, static_cast<__mmask16>((1u << n) - 1), v);
+		}
+		static F Add(F a, F b) { return _mm512_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm512_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm512_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm512_div_ps(a, b); }
+		static F Sqrt(F a) { return _mm512_sqrt_ps(a); }
+		static F Rsqrt(F a) { return _mm512_rsqrt14_ps(a); }
+		static F Abs(F a) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_set1_epi32(0x7FFFFFFF))); }
+		static F Neg(F a) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32(INT32_MIN))); }
+
+		static M Lt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+		static M Le(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+		static M Eq(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+		static M IsNaN(F a) { return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q); }
+		static M And(M a, M b) { return static_cast<M>(a & b); }
+		static M Or(M a, M b) { return static_cast<M>(a | b); }
+		static M Not(M a) { return static_cast<M>(~a); }
+		static unsigned int Bits(M m) { return static_cast<unsigned int>(m); }
+		static F Select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+
+		static I RoundToInt(F a) { return _mm512_cvtps_epi32(a); }
+		static F ToFloat(I a) { return _mm512_cvtepi32_ps(a); }
+		static I SetInt(std::int32_t value) { return _mm512_set1_epi32(value); }
+		static I AddInt(I a, I b) { return _mm512_add_epi32(a, b); }
+		static I SubInt(I a, I b) { return _mm512_sub_epi32(a, b); }
+		static I AndInt(I a, I b) { return _mm512_and_si512(a, b); }
+		static I OrInt(I a, I b) { return _mm512_or_si512(a, b); }
+		static I XorInt(I a, I b) { return _mm512_xor_si512(a, b); }
+		template<int n> static I ShiftLeft(I a) { return _mm512_slli_epi32(a, n); }
+		template<int n> static I ShiftRightLogical(I a) { return _mm512_srli_epi32(a, n); }
+		static M EqInt(I a, I b) { return _mm512_cmpeq_epi32_mask(a, b); }
+		static I AsInt(F a) { return _mm512_castps_si512(a); }
+		static F AsFloat(I a) { return _mm512_castsi512_ps(a); }
+
+		static void Widen(F a, D out[doubleHalves])
+		{
+			out[0] = _mm512_cvtps_pd(_mm512_castps512_ps256(a));
+			out[1] = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1)));
+		}
+		static F Narrow(const D in[doubleHalves])
+		{
+			const __m512d low = _mm512_castps_pd(_mm512_castps256_ps512(_mm512_cvtpd_ps(in[0])));
+			return _mm512_castpd_ps(_mm512_insertf64x4(low, _mm256_castps_pd(_mm512_cvtpd_ps(in[1])), 1));
+		}
+		static D Set1D(double value) { return _mm512_set1_pd(value); }
+		static D AddD(D a, D b) { return _mm512_add_pd(a, b); }
+		static D SubD(D a, D b) { return _mm512_sub_pd(a, b); }
+		static D MulD(D a, D b) { return _mm512_mul_pd(a, b); }
+		static D DivD(D a, D b) { return _mm512_div_pd(a, b); }
+		static D MinD(D a, D b) { return _mm512_min_pd(a, b); }
+		static D MaxD(D a, D b) { return _mm512_max_pd(a, b); }
+		static D Exp2IntD(D n)
+		{
+			const __m512i biased = _mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(n, _mm512_set1_pd(roundingMagic))),
+				_mm512_castpd_si512(_mm512_set1_pd(roundingMagic - 1023.0)));
+			return _mm512_castsi512_pd(_mm512_slli_epi64(biased, 52));
+		}
+	};
+	typedef Avx512Lanes Lanes;
+#elif defined(SIMD_LANES_AVX2)
+	typedef Avx2Lanes Lanes;
+#elif defined(SIMD_LANES_SSE2)
+	typedef Sse2Lanes Lanes;
+#else
+	typedef ScalarLanes Lanes;
+#endif
+}
+}
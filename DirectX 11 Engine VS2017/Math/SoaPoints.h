@@ -0,0 +1,37 @@
+#pragma once
+
+// Point sets stored as structure of arrays: point i is (x[i], y[i], z[i]).
+struct SoaPoints3
+{
+	const float* x = nullptr;
+	const float* y = nullptr;
+	const float* z = nullptr;
+};
+
+struct SoaPoints4
+{
+	float* x = nullptr;
+	float* y = nullptr;
+	float* z = nullptr;
+	float* w = nullptr;
+};
+
+enum class TransformOutput
+{
+	// (x, y, z, 1) * m.
+	CLIP,
+	// Clip x, y and z divided by w; w is kept so callers can reject
+	// points behind the camera.
+	NDC,
+	// NDC mapped to the viewport the way D3D11 and SoftwareRasterizer do
+	// it: x to the right and y down in pixels, z the depth. w is kept.
+	SCREEN
+};
+
+struct TransformStreamDesc
+{
+	TransformOutput output = TransformOutput::CLIP;
+	// Pixels, for SCREEN.
+	float viewportWidth = 1.0f;
+	float viewportHeight = 1.0f;
+};
@@ -0,0 +1,43 @@
+#include "Transcendental.h"
+#include "MathKernels.h"
+
+const char* MathAccuracyName(MathAccuracy accuracy)
+{
+	switch (accuracy)
+	{
+	case MathAccuracy::PRECISE: return "Precise (1 ulp)";
+	case MathAccuracy::STANDARD: return "Standard (4 ulp)";
+	case MathAccuracy::FAST: return "Fast";
+	default: return "";
+	}
+}
+
+void VectorSin(const float* x, float* out, size_t count, MathAccuracy accuracy)
+{
+	Kernels().sin(x, out, count, accuracy);
+}
+
+void VectorCos(const float* x, float* out, size_t count, MathAccuracy accuracy)
+{
+	Kernels().cos(x, out, count, accuracy);
+}
+
+void VectorSinCos(const float* x, float* sinOut, float* cosOut, size_t count, MathAccuracy accuracy)
+{
+	Kernels().sinCos(x, sinOut, cosOut, count, accuracy);
+}
+
+void VectorSqrt(const float* x, float* out, size_t count, MathAccuracy accuracy)
+{
+	Kernels().sqrt(x, out, count, accuracy);
+}
+
+void VectorPow(const float* x, const float* y, float* out, size_t count, MathAccuracy accuracy)
+{
+	Kernels().pow(x, y, out, count, accuracy);
+}
+
+const char* TranscendentalBackend()
+{
+	return SimdTierName(Kernels().tier);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+
+// How close the elementwise functions below get to the exact result, in
+// units in the last place (ulp) of the float result.
+enum class MathAccuracy
+{
+	// At most 1 ulp. Evaluated in double precision and rounded once.
+	PRECISE,
+	// At most 4 ulp. Single precision with a three-part argument reduction;
+	// pow takes the PRECISE path, single precision can't keep 4 ulp for
+	// large exponents.
+	STANDARD,
+	// Low-degree polynomials. sin and cos are within about 1e-5 of the
+	// exact value for |x| up to 1e5 and drift beyond, pow is within about
+	// 1e-5 relative and may overflow a little before FLT_MAX.
+	FAST,
+	COUNT
+};
+
+const char* MathAccuracyName(MathAccuracy accuracy);
+
+// Elementwise over `count` floats, a SIMD vector at a time. `out` may be
+// the input array. Special inputs (NaN, infinities, negative sqrt and pow
+// arguments, sin and cos beyond the range of the fast reduction) get the
+// results the C library gives for them.
+void VectorSin(const float* x, float* out, size_t count, MathAccuracy accuracy);
+void VectorCos(const float* x, float* out, size_t count, MathAccuracy accuracy);
+// Both from one argument reduction, for little more than the cost of one.
+void VectorSinCos(const float* x, float* sinOut, float* cosOut, size_t count, MathAccuracy accuracy);
+// The correctly rounded instruction at every tier: rsqrt and a Newton step
+// measured slower than it on SSE2 and AVX2.
+void VectorSqrt(const float* x, float* out, size_t count, MathAccuracy accuracy);
+void VectorPow(const float* x, const float* y, float* out, size_t count, MathAccuracy accuracy);
+
+// SIMD tier the functions were selected for at startup.
+const char* TranscendentalBackend();
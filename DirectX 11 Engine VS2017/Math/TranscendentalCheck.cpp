@@ -0,0 +1,134 @@
+#include "TranscendentalCheck.h"
+#include "../Jobs/ParallelFor.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	const size_t blockSize = 1 << 16;
+	const float powExponents[] = { 2.0f, 0.5f, -1.0f, 3.7f, -2.5f, 0.1f, 11.3f };
+
+	double Reference(MathFunction function, double x, double y)
+	{
+		switch (function)
+		{
+		case MathFunction::SIN: return std::sin(x);
+		case MathFunction::COS: return std::cos(x);
+		case MathFunction::SQRT: return std::sqrt(x);
+		default: return std::pow(x, y);
+		}
+	}
+
+	// Ulp of a float with the magnitude of `exact`, denormals included.
+	double Ulp(double exact)
+	{
+		if (exact == 0.0)
+			return std::ldexp(1.0, -149);
+		int exponent = 0;
+		std::frexp(exact, &exponent);
+		return std::ldexp(1.0, (std::max)(exponent, -125) - 24);
+	}
+
+	void Compare(float input, float result, double exact, AccuracyReport& report)
+	{
+		++report.checked;
+		const float rounded = static_cast<float>(exact);
+		if (!std::isfinite(rounded) || !std::isfinite(result))
+		{
+			const bool same = (std::isnan(rounded) && std::isnan(result)) || rounded == result;
+			if (!same)
+				++report.specialMismatches;
+			return;
+		}
+		const double error = std::fabs(static_cast<double>(result) - exact);
+		const double ulps = error / Ulp(exact);
+		if (ulps > report.maxUlp)
+		{
+			report.maxUlp = ulps;
+			report.worstInput = input;
+		}
+		report.maxAbsError = (std::max)(report.maxAbsError, error);
+		if (std::fabs(exact) >= FLT_MIN)
+			report.maxRelError = (std::max)(report.maxRelError, error / std::fabs(exact));
+	}
+
+	void Merge(const AccuracyReport& block, AccuracyReport& total)
+	{
+		total.checked += block.checked;
+		total.specialMismatches += block.specialMismatches;
+		total.maxAbsError = (std::max)(total.maxAbsError, block.maxAbsError);
+		total.maxRelError = (std::max)(total.maxRelError, block.maxRelError);
+		if (block.maxUlp > total.maxUlp)
+		{
+			total.maxUlp = block.maxUlp;
+			total.worstInput = block.worstInput;
+		}
+	}
+}
+
+const char* MathFunctionName(MathFunction function)
+{
+	switch (function)
+	{
+	case MathFunction::SIN: return "sin";
+	case MathFunction::COS: return "cos";
+	case MathFunction::SQRT: return "sqrt";
+	case MathFunction::POW: return "pow";
+	default: return "";
+	}
+}
+
+AccuracyReport CheckAccuracy(MathFunction function, MathAccuracy accuracy, unsigned int step, float maxInput)
+{
+	AccuracyReport total;
+	total.function = function;
+	total.accuracy = accuracy;
+	if (step == 0)
+		step = 1;
+
+	const std::uint64_t patterns = ((1ull << 32) + step - 1) / step;
+	const size_t numExponents = function == MathFunction::POW ? sizeof(powExponents) / sizeof(powExponents[0]) : 1;
+	std::mutex mutex;
+	ParallelFor(static_cast<size_t>(patterns), blockSize, [&](size_t begin, size_t end)
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> result(end - begin);
+		x.reserve(end - begin);
+		for (size_t i = begin; i < end; ++i)
+		{
+			const std::uint32_t bits = static_cast<std::uint32_t>(i * step);
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			if (!(std::fabs(value) > maxInput))
+				x.push_back(value);
+		}
+
+		AccuracyReport block;
+		for (size_t e = 0; e < numExponents; ++e)
+		{
+			switch (function)
+			{
+			case MathFunction::SIN: VectorSin(x.data(), result.data(), x.size(), accuracy); break;
+			case MathFunction::COS: VectorCos(x.data(), result.data(), x.size(), accuracy); break;
+			case MathFunction::SQRT: VectorSqrt(x.data(), result.data(), x.size(), accuracy); break;
+			default:
+				y.assign(x.size(), powExponents[e]);
+				VectorPow(x.data(), y.data(), result.data(), x.size(), accuracy);
+				break;
+			}
+			const double exponent = function == MathFunction::POW ? powExponents[e] : 0.0;
+			for (size_t i = 0; i < x.size(); ++i)
+				Compare(x[i], result[i], Reference(function, x[i], exponent), block);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		Merge(block, total);
+	});
+	return total;
+}
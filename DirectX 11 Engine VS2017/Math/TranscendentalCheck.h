@@ -0,0 +1,30 @@
+#pragma once
+#include "Transcendental.h"
+#include <cfloat>
+
+enum class MathFunction { SIN, COS, SQRT, POW, COUNT };
+
+const char* MathFunctionName(MathFunction function);
+
+struct AccuracyReport
+{
+	MathFunction function = MathFunction::SIN;
+	MathAccuracy accuracy = MathAccuracy::PRECISE;
+	unsigned long long checked = 0;
+	// Largest error in ulp of the exact result and the input it came from.
+	double maxUlp = 0.0;
+	float worstInput = 0.0f;
+	double maxAbsError = 0.0;
+	// Largest error relative to exact results in the normal float range,
+	// the measure for the FAST tier.
+	double maxRelError = 0.0;
+	// Results that are NaN or infinite where the exact one isn't, or the
+	// other way round.
+	unsigned long long specialMismatches = 0;
+};
+
+// Compares a function against the C library evaluated in double precision
+// over every float bit pattern, in steps of `step` (1 checks all 2^32 of
+// them), on all hardware threads. Inputs beyond maxInput in magnitude are
+// skipped. pow takes each float as x with a fixed set of exponents.
+AccuracyReport CheckAccuracy(MathFunction function, MathAccuracy accuracy, unsigned int step = 1, float maxInput = FLT_MAX);
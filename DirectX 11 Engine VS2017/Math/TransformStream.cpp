@@ -0,0 +1,43 @@
+#include "TransformStream.h"
+#include "MathKernels.h"
+#include "../Jobs/ParallelFor.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// Points per block when running in parallel; a multiple of every
+	// vector width, so blocks keep the alignment of the streams.
+	const size_t parallelGrain = 1 << 14;
+}
+
+void TransformPoints(const SoaPoints3& in, size_t count, const XMMATRIX& m, const SoaPoints4& out, const TransformStreamDesc& desc)
+{
+	if (count < transformParallelThreshold)
+	{
+		TransformPointsSerial(in, count, m, out, desc);
+		return;
+	}
+
+	XMFLOAT4X4 matrix;
+	XMStoreFloat4x4(&matrix, m);
+	const MathKernels& kernels = Kernels();
+	ParallelFor(count, parallelGrain, [&](size_t begin, size_t end)
+	{
+		kernels.transformPoints(in, begin, end, &matrix.m[0][0], desc, out);
+	});
+}
+
+void TransformPointsSerial(const SoaPoints3& in, size_t count, const XMMATRIX& m, const SoaPoints4& out, const TransformStreamDesc& desc)
+{
+	if (count == 0)
+		return;
+	XMFLOAT4X4 matrix;
+	XMStoreFloat4x4(&matrix, m);
+	Kernels().transformPoints(in, 0, count, &matrix.m[0][0], desc, out);
+}
+
+const char* TransformStreamBackend()
+{
+	return SimdTierName(Kernels().tier);
+}
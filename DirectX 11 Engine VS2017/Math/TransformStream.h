@@ -0,0 +1,22 @@
+#pragma once
+#include "VectorMath.h"
+#include "SoaPoints.h"
+#include <cstddef>
+
+// Transforms count points by m, a row-vector matrix as Camera and Model
+// return them, using the widest vectors the CPU supports. The last
+// partial vector is handled with masked loads and stores rather than a
+// scalar loop. Above parallelThreshold points the work is split across
+// all hardware threads. Input and output streams may not overlap; any
+// alignment works, 64-byte aligned streams are fastest.
+void TransformPoints(const SoaPoints3& in, size_t count, const DirectX::XMMATRIX& m, const SoaPoints4& out,
+	const TransformStreamDesc& desc = TransformStreamDesc());
+// The same on the calling thread only, for callers that already split the
+// work themselves.
+void TransformPointsSerial(const SoaPoints3& in, size_t count, const DirectX::XMMATRIX& m, const SoaPoints4& out,
+	const TransformStreamDesc& desc = TransformStreamDesc());
+
+// Name of the SIMD tier the kernels were selected for, see MathKernels.h.
+const char* TransformStreamBackend();
+
+const size_t transformParallelThreshold = 1 << 16;
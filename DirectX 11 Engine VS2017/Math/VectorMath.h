@@ -0,0 +1,12 @@
+#pragma once
+
+// DirectXMath where the Windows SDK provides it, the portable subset
+// everywhere else. Define ENGINE_PORTABLE_MATH to use the portable one on
+// Windows too.
+#if defined(_WIN32) && !defined(ENGINE_PORTABLE_MATH)
+#include <DirectXMath.h>
+#define ENGINE_MATH_BACKEND "DirectXMath"
+#else
+#include "PortableMath.h"
+#define ENGINE_MATH_BACKEND PORTABLE_MATH_BACKEND
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+// Windows types used by code that also has to build without the Windows
+// SDK: the CPU-side graphics code and the null render device.
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstdint>
+typedef std::int32_t HRESULT;
+typedef unsigned int UINT;
+typedef std::uint32_t DWORD;
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#endif
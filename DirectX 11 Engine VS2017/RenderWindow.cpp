@@ -79,6 +79,12 @@ bool RenderWindow::ProcessMessages()
 	return true;
 }
 
+void RenderWindow::WaitForMessages()
+{
+	// Only messages that arrived since the last PeekMessage wake it up.
+	MsgWaitForMultipleObjects(0, NULL, FALSE, INFINITE, QS_ALLINPUT);
+}
+
 HWND RenderWindow::GetHWND() const
 {
 	return this->handle;
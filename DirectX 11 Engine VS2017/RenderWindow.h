@@ -8,6 +8,8 @@ class RenderWindow
 public:
 	bool Initialize(WindowContainer * pWindowContainer, HINSTANCE hInstance, std::string window_title, std::string window_class, int width, int height);
 	bool ProcessMessages();
+	// Sleeps until a new message arrives for this thread.
+	void WaitForMessages();
 	HWND GetHWND() const;
 	~RenderWindow();
 private:
@@ -1,6 +1,20 @@
 //Matrices Demo 2018-10-01
 #include "Engine.h"
+#include "Math/MathKernels.h"
+#include <cwchar>
+#include <string>
 
+// The value of --simd=<tier> on the command line, empty if there is none.
+static std::string SimdTierArgument(LPCWSTR cmdLine)
+{
+	const wchar_t* arg = std::wcsstr(cmdLine, L"--simd=");
+	if (arg == nullptr)
+		return std::string();
+	std::string value;
+	for (arg += 7; *arg != L'\0' && *arg != L' ' && *arg != L'\t'; ++arg)
+		value += static_cast<char>(*arg);
+	return value;
+}
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 	_In_opt_ HINSTANCE hPrevInstance,
@@ -15,13 +29,20 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 		return -1;
 	}
 
+	// Before anything computes. Forcing a lower tier tests the kernels older
+	// CPUs get.
+	const std::string simdTier = SimdTierArgument(lpCmdLine);
+	const KernelSelection& kernels = SelectKernels(simdTier.empty() ? nullptr : simdTier.c_str());
+	if (kernels.warning[0] != '\0')
+		ErrorLogger::Log(kernels.warning);
+
 	Engine engine;
 	if (engine.Initialize(hInstance, "Math curves", "MyWindowClass", 1920, 1080))
 	{
 		while (engine.ProcessMessages() == true)
 		{
 			engine.Update();
-			engine.RenderFrame();
+			engine.PublishFrame();
 		}
 	}
 	return 0;
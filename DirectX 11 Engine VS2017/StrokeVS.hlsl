@@ -0,0 +1,23 @@
+struct VS_INPUT
+{
+    float3 inPos : POSITION;
+    float4 inColor : COLOR;
+};
+
+struct VS_OUTPUT
+{
+    float4 outPosition : SV_POSITION;
+    float4 outColor : COLOR;
+    float2 outTexCoord : TEXCOORD;
+};
+
+// Strokes are extruded on the CPU straight into normalized device
+// coordinates, so there is nothing left to transform.
+VS_OUTPUT main(VS_INPUT input)
+{
+    VS_OUTPUT output;
+    output.outPosition = float4(input.inPos, 1.0f);
+    output.outColor = input.inColor;
+    output.outTexCoord = float2(0.0f, 0.0f);
+    return output;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "FrameClock.h"
+
+FrameClock::FrameClock()
+	: last(Clock::now())
+{
+}
+
+double FrameClock::Tick()
+{
+	const Clock::time_point now = Clock::now();
+	const double seconds = std::chrono::duration<double>(now - last).count();
+	last = now;
+	return seconds;
+}
+
+FixedStep::FixedStep(double stepSeconds)
+	: step(stepSeconds)
+{
+}
+
+int FixedStep::Advance(double seconds)
+{
+	accumulator += seconds;
+	int steps = static_cast<int>(accumulator / step);
+	if (steps > maxSteps)
+	{
+		steps = maxSteps;
+		accumulator = 0.0;
+	}
+	else
+	{
+		accumulator -= steps * step;
+	}
+	return steps;
+}
+
+double FixedStep::Step() const
+{
+	return step;
+}
+
+float FixedStep::Alpha() const
+{
+	return static_cast<float>(accumulator / step);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <chrono>
+
+// Measures the time between frames. steady_clock is monotonic and, on
+// Windows, backed by QueryPerformanceCounter.
+class FrameClock
+{
+public:
+	FrameClock();
+
+	// Seconds since the previous Tick, or since construction.
+	double Tick();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point last;
+};
+
+// Splits variable frame times into updates of a fixed length. The time
+// left over is carried to the next frame; Alpha says how far it reaches
+// into the next step, for interpolating between the last two states.
+class FixedStep
+{
+public:
+	explicit FixedStep(double stepSeconds);
+
+	// Number of steps to run for a frame of `seconds`. Time beyond maxSteps
+	// steps is dropped rather than caught up on later, so a breakpoint or a
+	// dragged window doesn't turn into a burst of updates.
+	int Advance(double seconds);
+	double Step() const;
+	float Alpha() const;
+
+	int maxSteps = 8;
+
+private:
+	double step;
+	double accumulator = 0.0;
+};
@@ -0,0 +1,127 @@
+#include "FrameTimeHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+FrameTimeHistogram::FrameTimeHistogram(unsigned int capacity)
+	: samples((std::max)(capacity, 1u))
+{
+}
+
+void FrameTimeHistogram::Add(float ms)
+{
+	Sample sample;
+	sample.ms = ms;
+	sample.hitch = typicalMs > 0.0f && ms > typicalMs * hitchFactor && ms - typicalMs > hitchMinMs;
+
+	// Hitches stay out of the average so one long stall doesn't raise the
+	// bar for the next ones.
+	if (typicalMs == 0.0f)
+		typicalMs = ms;
+	else if (!sample.hitch)
+		typicalMs += (ms - typicalMs) * 0.05f;
+
+	samples[next] = sample;
+	next = (next + 1) % samples.size();
+	count = (std::min)(count + 1, static_cast<unsigned int>(samples.size()));
+	++totalFrames;
+	if (sample.hitch)
+		++totalHitches;
+}
+
+void FrameTimeHistogram::Clear()
+{
+	next = 0;
+	count = 0;
+	typicalMs = 0.0f;
+	totalFrames = 0;
+	totalHitches = 0;
+}
+
+const FrameTimeHistogram::Sample& FrameTimeHistogram::At(unsigned int i) const
+{
+	const unsigned int oldest = count < samples.size() ? 0 : next;
+	return samples[(oldest + i) % samples.size()];
+}
+
+FrameTimeHistogram::Summary FrameTimeHistogram::Summarize()
+{
+	Summary summary;
+	summary.frames = count;
+	if (count == 0)
+		return summary;
+
+	sorted.clear();
+	double total = 0.0;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const Sample& sample = At(i);
+		sorted.push_back(sample.ms);
+		total += sample.ms;
+		if (sample.hitch)
+			++summary.hitches;
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	// Nearest rank: the smallest time at least p of the frames don't exceed.
+	auto percentile = [this](float p)
+	{
+		const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+		return sorted[(std::max)(rank, static_cast<size_t>(1)) - 1];
+	};
+	summary.p50 = percentile(0.50f);
+	summary.p95 = percentile(0.95f);
+	summary.p99 = percentile(0.99f);
+	summary.max = sorted.back();
+	summary.mean = static_cast<float>(total / count);
+	return summary;
+}
+
+void FrameTimeHistogram::Recent(std::vector<float>& out) const
+{
+	out.resize(count);
+	for (unsigned int i = 0; i < count; ++i)
+		out[i] = At(i).ms;
+}
+
+void FrameTimeHistogram::Distribution(float bucketMs, unsigned int numBuckets, std::vector<float>& out) const
+{
+	out.assign(numBuckets, 0.0f);
+	if (numBuckets == 0 || bucketMs <= 0.0f)
+		return;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const unsigned int bucket = static_cast<unsigned int>(At(i).ms / bucketMs);
+		out[(std::min)(bucket, numBuckets - 1)] += 1.0f;
+	}
+}
+
+unsigned int FrameTimeHistogram::Count() const
+{
+	return count;
+}
+
+float FrameTimeHistogram::TypicalMs() const
+{
+	return typicalMs;
+}
+
+unsigned long long FrameTimeHistogram::TotalFrames() const
+{
+	return totalFrames;
+}
+
+unsigned long long FrameTimeHistogram::TotalHitches() const
+{
+	return totalHitches;
+}
+
+void FrameTimeHistogram::WriteCsv(std::ostream& out, const char* series) const
+{
+	// Frame numbers continue from the frames that already left the window.
+	const unsigned long long first = totalFrames - count;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const Sample& sample = At(i);
+		out << series << ',' << first + i << ',' << sample.ms << ',' << (sample.hitch ? 1 : 0) << '\n';
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <ostream>
+#include <vector>
+
+// Rolling window of the last frame times with percentiles and hitch
+// detection. A frame is a hitch when it takes more than hitchFactor times
+// the typical frame, an average of the frames that weren't hitches, and at
+// least hitchMinMs longer than it.
+class FrameTimeHistogram
+{
+public:
+	struct Summary
+	{
+		unsigned int frames = 0;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		float mean = 0.0f;
+		unsigned int hitches = 0;
+	};
+
+	explicit FrameTimeHistogram(unsigned int capacity = 1024);
+
+	void Add(float ms);
+	void Clear();
+
+	// Over the frames in the window.
+	Summary Summarize();
+	// Frame times in the window, oldest first.
+	void Recent(std::vector<float>& out) const;
+	// Frames in the window per bucket of bucketMs; the last bucket also
+	// counts everything longer.
+	void Distribution(float bucketMs, unsigned int numBuckets, std::vector<float>& out) const;
+	// Frames in the window.
+	unsigned int Count() const;
+	float TypicalMs() const;
+	unsigned long long TotalFrames() const;
+	unsigned long long TotalHitches() const;
+
+	// One line per frame in the window: series,frame,ms,hitch.
+	void WriteCsv(std::ostream& out, const char* series) const;
+
+	float hitchFactor = 2.0f;
+	float hitchMinMs = 2.0f;
+
+private:
+	struct Sample
+	{
+		float ms = 0.0f;
+		bool hitch = false;
+	};
+
+	const Sample& At(unsigned int i) const;
+
+	std::vector<Sample> samples;
+	unsigned int next = 0;
+	unsigned int count = 0;
+	float typicalMs = 0.0f;
+	unsigned long long totalFrames = 0;
+	unsigned long long totalHitches = 0;
+	std::vector<float> sorted;
+};
@@ -1,10 +0,0 @@
-struct PS_INPUT
-{
-    float4 inPosition : SV_POSITION;
-    float3 inColor : COLOR;
-};
-
-float4 main(PS_INPUT input) : SV_TARGET
-{
-    return float4(input.inColor, 1.0f);
-}
\ No newline at end of file
@@ -1,24 +0,0 @@
-cbuffer cbPerVertex : register(b0)
-{
-    float4x4 wvp;
-}
-
-struct VS_INPUT
-{
-    float3 inPos : POSITION;
-    float3 inColor : COLOR;
-};
-
-struct VS_OUTPUT
-{
-    float4 outPosition : SV_POSITION;
-    float3 outColor : COLOR;
-};
-
-VS_OUTPUT main(VS_INPUT input)
-{
-    VS_OUTPUT output;
-    output.outPosition = mul(float4(input.inPos, 1.0f), wvp);
-    output.outColor = input.inColor;
-    return output;
-}
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "Test.h"
+#include "Graphics/Camera.h"
+#include "Math/ScalarMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+// The lazily rebuilt camera matrices against the ones the camera built on
+// every change before, and the portable math against ScalarMath. Also
+// built with ENGINE_MATH_SCALAR as CameraTestsScalar.
+
+namespace
+{
+	ScalarMath::Vector ToScalar(FXMVECTOR v)
+	{
+		XMFLOAT4 f;
+		XMStoreFloat4(&f, v);
+		return ScalarMath::VectorSet(f.x, f.y, f.z, f.w);
+	}
+
+	ScalarMath::Matrix ToScalar(FXMMATRIX m)
+	{
+		return ScalarMath::MatrixSet(ToScalar(m.r[0]), ToScalar(m.r[1]), ToScalar(m.r[2]), ToScalar(m.r[3]));
+	}
+
+	float Difference(const ScalarMath::Vector& a, const ScalarMath::Vector& b, int components = 4)
+	{
+		float largest = 0.0f;
+		for (int i = 0; i < components; ++i)
+			largest = (std::max)(largest, std::fabs(a.v[i] - b.v[i]) / (std::max)(1.0f, std::fabs(b.v[i])));
+		return largest;
+	}
+
+	float Difference(const ScalarMath::Matrix& a, const ScalarMath::Matrix& b)
+	{
+		float largest = 0.0f;
+		for (int i = 0; i < 4; ++i)
+			largest = (std::max)(largest, Difference(a.r[i], b.r[i]));
+		return largest;
+	}
+
+	bool Same(FXMMATRIX a, FXMMATRIX b)
+	{
+		XMFLOAT4X4 fa, fb;
+		XMStoreFloat4x4(&fa, a);
+		XMStoreFloat4x4(&fb, b);
+		return std::memcmp(&fa, &fb, sizeof(fa)) == 0;
+	}
+
+	// What Camera::UpdateViewMatrix computed on every change before it went
+	// lazy, in ScalarMath.
+	struct EagerCamera
+	{
+		ScalarMath::Matrix view;
+		ScalarMath::Vector forward, right, backward, left;
+
+		EagerCamera(const ScalarMath::Vector& pos, const XMFLOAT3& rot)
+		{
+			const ScalarMath::Matrix rotation = ScalarMath::MatrixRotationRollPitchYaw(rot.x, rot.y, rot.z);
+			ScalarMath::Vector target = ScalarMath::Vector3Normalize(
+				ScalarMath::Vector3TransformCoord(ScalarMath::VectorSet(0, 0, 1, 0), rotation));
+			target = ScalarMath::VectorAdd(target, pos);
+			const ScalarMath::Vector up = ScalarMath::Vector3TransformCoord(ScalarMath::VectorSet(0, 1, 0, 0), rotation);
+			this->view = ScalarMath::MatrixLookAtLH(pos, target, up);
+
+			const ScalarMath::Matrix yaw = ScalarMath::MatrixRotationRollPitchYaw(0, rot.y, rot.z);
+			this->forward = Flat(ScalarMath::Vector3TransformCoord(ScalarMath::VectorSet(0, 0, 1, 0), yaw));
+			this->backward = Flat(ScalarMath::Vector3TransformCoord(ScalarMath::VectorSet(0, 0, -1, 0), yaw));
+			this->left = Flat(ScalarMath::Vector3TransformCoord(ScalarMath::VectorSet(-1, 0, 0, 0), yaw));
+			this->right = Flat(ScalarMath::Vector3TransformCoord(ScalarMath::VectorSet(1, 0, 0, 0), yaw));
+		}
+
+		static ScalarMath::Vector Flat(ScalarMath::Vector v)
+		{
+			v.v[1] = 0.0f;
+			return v;
+		}
+	};
+
+	const float tolerance = 1e-5f;
+}
+
+TEST(CameraMatchesTheEagerMatrices)
+{
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	Camera camera;
+	float fov = 90.0f, width = 800.0f, height = 600.0f, nearZ = 0.1f, farZ = 1000.0f;
+	camera.SetProjectionValues(fov, width, height, nearZ, farZ);
+	for (int step = 0; step < 2000; ++step)
+	{
+		switch (random() % 5)
+		{
+		case 0:
+			camera.SetPosition(100.0f * unit(random), 100.0f * unit(random), 100.0f * unit(random));
+			break;
+		case 1:
+			camera.AdjustPosition(XMVectorSet(unit(random), unit(random), unit(random), 0.0f));
+			break;
+		case 2:
+			camera.SetRotation(90.0f * unit(random), 180.0f + 180.0f * unit(random), 0.0f);
+			break;
+		case 3:
+			// Mouse look: many small moves, pushed past the pitch limits now
+			// and then.
+			for (int i = 0; i < 1 + static_cast<int>(random() % 40); ++i)
+				camera.AdjustRotation(0.1f * unit(random), 0.1f * unit(random), 0.0f);
+			break;
+		default:
+			fov = 60.0f + 30.0f * unit(random);
+			width = 640.0f + 320.0f * unit(random);
+			nearZ = 0.1f + 0.05f * unit(random);
+			farZ = 1000.0f + 500.0f * unit(random);
+			camera.SetProjectionValues(fov, width, height, nearZ, farZ);
+			break;
+		}
+
+		const XMFLOAT3 rot = camera.GetRotation();
+		CHECK(rot.x >= -XM_PIDIV2 && rot.x <= XM_PIDIV2);
+		const EagerCamera eager(ToScalar(camera.GetPosition()), rot);
+		const ScalarMath::Matrix projection = ScalarMath::MatrixPerspectiveFovLH(XMConvertToRadians(fov), width / height, nearZ, farZ);
+		CHECK(Difference(ToScalar(camera.GetViewMatrix()), eager.view) <= tolerance);
+		CHECK(Difference(ToScalar(camera.GetProjectionMatrix()), projection) <= tolerance);
+		CHECK(Difference(ToScalar(camera.GetViewProjectionMatrix()), ScalarMath::MatrixMultiply(eager.view, projection)) <= tolerance * 100.0f);
+		CHECK(Difference(ToScalar(camera.GetForwardVector()), eager.forward, 3) <= tolerance);
+		CHECK(Difference(ToScalar(camera.GetRightVector()), eager.right, 3) <= tolerance);
+		CHECK(Difference(ToScalar(camera.GetBackwardVector()), eager.backward, 3) <= tolerance);
+		CHECK(Difference(ToScalar(camera.GetLeftVector()), eager.left, 3) <= tolerance);
+	}
+}
+
+// A burst of changes read once gives the same matrices, to the bit, as
+// reading after every change.
+TEST(CameraReadsTheSameWhenRebuiltLazily)
+{
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	Camera eager, lazy;
+	eager.SetProjectionValues(75.0f, 1280.0f, 720.0f, 0.1f, 500.0f);
+	lazy.SetProjectionValues(75.0f, 1280.0f, 720.0f, 0.1f, 500.0f);
+	for (int frame = 0; frame < 200; ++frame)
+	{
+		for (int i = 0; i < 30; ++i)
+		{
+			const XMVECTOR move = XMVectorSet(unit(random), unit(random), unit(random), 0.0f);
+			const float pitch = 0.05f * unit(random), yaw = 0.05f * unit(random);
+			eager.AdjustPosition(move);
+			eager.AdjustRotation(pitch, yaw, 0.0f);
+			eager.GetViewProjectionMatrix();
+			lazy.AdjustPosition(move);
+			lazy.AdjustRotation(pitch, yaw, 0.0f);
+		}
+		CHECK(Same(lazy.GetViewMatrix(), eager.GetViewMatrix()));
+		CHECK(Same(lazy.GetViewProjectionMatrix(), eager.GetViewProjectionMatrix()));
+		CHECK(XMVector3Equal(lazy.GetForwardVector(), eager.GetForwardVector()));
+	}
+}
+
+TEST(CameraViewProjectionFollowsEitherChange)
+{
+	Camera camera;
+	camera.SetProjectionValues(90.0f, 800.0f, 600.0f, 0.1f, 100.0f);
+	camera.SetPosition(1.0f, 2.0f, -5.0f);
+	const XMMATRIX first = camera.GetViewProjectionMatrix();
+	CHECK(Same(camera.GetViewProjectionMatrix(), first));
+
+	camera.SetProjectionValues(60.0f, 800.0f, 600.0f, 0.1f, 100.0f);
+	const XMMATRIX projected = camera.GetViewProjectionMatrix();
+	CHECK(!Same(projected, first));
+	CHECK(Same(projected, XMMatrixMultiply(camera.GetViewMatrix(), camera.GetProjectionMatrix())));
+
+	// The view alone changes too, read through the movement vectors first.
+	camera.AdjustRotation(0.0f, 0.5f, 0.0f);
+	camera.GetForwardVector();
+	const XMMATRIX turned = camera.GetViewProjectionMatrix();
+	CHECK(!Same(turned, projected));
+	CHECK(Same(turned, XMMatrixMultiply(camera.GetViewMatrix(), camera.GetProjectionMatrix())));
+}
+
+TEST(CameraClampsPitchAndWrapsYaw)
+{
+	Camera camera;
+	camera.AdjustRotation(10.0f, 0.0f, 0.0f);
+	CHECK(camera.GetRotation().x == XM_PIDIV2);
+	camera.AdjustRotation(-20.0f, 0.0f, 0.0f);
+	CHECK(camera.GetRotation().x == -XM_PIDIV2);
+	camera.AdjustRotation(0.0f, -0.5f, 0.0f);
+	CHECK_NEAR(camera.GetRotation().y, XM_2PI - 0.5f, 1e-6);
+	camera.AdjustRotation(0.0f, 1.0f, 0.0f);
+	CHECK_NEAR(camera.GetRotation().y, 0.5f, 1e-6);
+	// Looking straight down still gives a usable view.
+	const XMMATRIX view = camera.GetViewMatrix();
+	for (int i = 0; i < 4; ++i)
+	{
+		const ScalarMath::Vector row = ToScalar(view.r[i]);
+		for (int j = 0; j < 4; ++j)
+			CHECK(std::isfinite(row.v[j]));
+	}
+}
+
+// The SIMD paths of PortableMath give ScalarMath's results.
+TEST(PortableMathMatchesScalarMath)
+{
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> unit(-10.0f, 10.0f);
+	auto randomVector = [&]() { return XMVectorSet(unit(random), unit(random), unit(random), unit(random)); };
+	for (int i = 0; i < 1000; ++i)
+	{
+		const XMVECTOR a = randomVector(), b = randomVector(), c = randomVector();
+		const ScalarMath::Vector sa = ToScalar(a), sb = ToScalar(b), sc = ToScalar(c);
+		const XMMATRIX m(randomVector(), randomVector(), randomVector(), XMVectorSet(unit(random), unit(random), unit(random), 1.0f));
+		const XMMATRIX n(randomVector(), randomVector(), randomVector(), randomVector());
+		const ScalarMath::Matrix sm = ToScalar(m), sn = ToScalar(n);
+
+		CHECK(Difference(ToScalar(XMVector3Dot(a, b)), ScalarMath::VectorReplicate(ScalarMath::Vector3Dot(sa, sb))) <= tolerance);
+		CHECK(Difference(ToScalar(XMVector3Cross(a, b)), ScalarMath::Vector3Cross(sa, sb)) <= tolerance);
+		CHECK(Difference(ToScalar(XMVector3Normalize(a)), ScalarMath::Vector3Normalize(sa)) <= tolerance);
+		CHECK(Difference(ToScalar(XMVector4Transform(a, m)), ScalarMath::Vector4Transform(sa, sm)) <= tolerance);
+		CHECK(Difference(ToScalar(XMVector3TransformCoord(XMVectorSetW(a, 0.0f), m)),
+			ScalarMath::Vector3TransformCoord(sa, sm)) <= tolerance * 10.0f);
+		CHECK(Difference(ToScalar(XMMatrixMultiply(m, n)), ScalarMath::MatrixMultiply(sm, sn)) <= tolerance);
+		CHECK(Difference(ToScalar(XMMatrixTranspose(m)), ScalarMath::MatrixTranspose(sm)) == 0.0f);
+		CHECK(Difference(ToScalar(XMMatrixLookToLH(a, b, c)), ScalarMath::MatrixLookToLH(sa, sb, sc)) <= tolerance);
+		CHECK(Difference(ToScalar(XMVectorLerp(a, b, 0.25f)), ScalarMath::VectorLerp(sa, sb, 0.25f)) <= tolerance);
+
+		const float value = unit(random);
+		CHECK(XMVectorGetY(XMVectorSetY(a, value)) == value);
+		CHECK(XMVectorGetZ(XMVectorSetZ(a, value)) == value);
+		CHECK(XMVectorGetW(XMVectorSetW(a, value)) == value);
+		const XMVECTOR set = XMVectorSetZ(a, value);
+		CHECK(XMVectorGetX(set) == sa.v[0] && XMVectorGetY(set) == sa.v[1] && XMVectorGetW(set) == sa.v[3]);
+	}
+	CHECK(Difference(ToScalar(XMVector3Normalize(XMVectorZero())), ScalarMath::VectorZero()) == 0.0f);
+}
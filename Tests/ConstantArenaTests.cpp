@@ -0,0 +1,124 @@
+#include "Test.h"
+#include "Graphics/ConstantArena.h"
+#include "Graphics/NullRenderDevice.h"
+#include <cstring>
+
+TEST(LinearAllocatorAlignsAndFillsFrontToBack)
+{
+	LinearAllocator allocator;
+	allocator.Reset(1024);
+	CHECK(allocator.Allocate(10, 1) == 0);
+	CHECK(allocator.Allocate(16, 256) == 256);
+	CHECK(allocator.Used() == 272);
+	CHECK(allocator.Allocate(1, 16) == 272);
+	// Exactly what is left still fits, one byte more doesn't.
+	CHECK(allocator.Allocate(1024 - 512, 256) == 512);
+	CHECK(allocator.Used() == 1024);
+	CHECK(allocator.Allocate(1, 1) == LinearAllocator::invalidOffset);
+	CHECK(allocator.Used() == 1024);
+}
+
+TEST(LinearAllocatorRefusesWithoutAllocating)
+{
+	LinearAllocator allocator;
+	allocator.Reset(512);
+	CHECK(allocator.Allocate(600, 16) == LinearAllocator::invalidOffset);
+	CHECK(allocator.Allocate(100, 1) == 0);
+	// Aligning the offset past the end must not wrap around.
+	CHECK(allocator.Allocate(1, 0x80000000u) == LinearAllocator::invalidOffset);
+	CHECK(allocator.Allocate(0xFFFFFFF0u, 16) == LinearAllocator::invalidOffset);
+	CHECK(allocator.Used() == 100);
+}
+
+TEST(LinearAllocatorResetFreesEverything)
+{
+	LinearAllocator allocator;
+	allocator.Reset(256);
+	CHECK(allocator.Allocate(256, 256) == 0);
+	allocator.Reset();
+	CHECK(allocator.Used() == 0);
+	CHECK(allocator.Capacity() == 256);
+	CHECK(allocator.Allocate(256, 256) == 0);
+	allocator.Reset(0);
+	CHECK(allocator.Allocate(1, 1) == LinearAllocator::invalidOffset);
+}
+
+TEST(ConstantArenaMapsOncePerFrameForAnyNumberOfDraws)
+{
+	NullRenderDevice device;
+	ConstantArena arena;
+	CHECK(SUCCEEDED(arena.Initialize(&device, 64 * ConstantArena::blockAlignment)));
+
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		device.BeginFrame();
+		arena.BeginFrame();
+		ConstantRange ranges[64];
+		for (int draw = 0; draw < 64; ++draw)
+		{
+			float constants[20];
+			for (int i = 0; i < 20; ++i)
+				constants[i] = static_cast<float>(frame * 1000 + draw * 20 + i);
+			CHECK(arena.Write(constants, sizeof(constants), ranges[draw]));
+			CHECK(ranges[draw].firstConstant == static_cast<UINT>(draw) * ConstantArena::blockAlignment / 16);
+			CHECK(ranges[draw].numConstants == ConstantArena::blockAlignment / 16);
+		}
+		arena.Close();
+		CHECK(device.CurrentFrameStats().maps == 1);
+
+		// Every draw's constants landed at its own offset.
+		const std::vector<std::uint8_t>& contents = device.BufferContents(ranges[0].buffer);
+		for (int draw = 0; draw < 64; ++draw)
+		{
+			float first;
+			std::memcpy(&first, contents.data() + ranges[draw].firstConstant * 16, sizeof(first));
+			CHECK(first == static_cast<float>(frame * 1000 + draw * 20));
+		}
+	}
+	arena.BeginFrame();
+	CHECK(arena.LastFrameBytes() == 64 * ConstantArena::blockAlignment);
+}
+
+TEST(ConstantArenaGrowsAfterAFrameThatDidNotFit)
+{
+	NullRenderDevice device;
+	ConstantArena arena;
+	CHECK(SUCCEEDED(arena.Initialize(&device, 100)));
+	CHECK(arena.CapacityBytes() == ConstantArena::blockAlignment);
+
+	arena.BeginFrame();
+	const char data[300] = {};
+	ConstantRange range;
+	CHECK(arena.Write(data, 100, range));
+	// 300 bytes take two blocks, which no longer fit this frame.
+	CHECK(!arena.Write(data, 300, range));
+	arena.Close();
+
+	arena.BeginFrame();
+	CHECK(arena.CapacityBytes() >= 3 * ConstantArena::blockAlignment);
+	CHECK(arena.Write(data, 100, range));
+	CHECK(arena.Write(data, 300, range));
+	CHECK(range.numConstants == 2 * ConstantArena::blockAlignment / 16);
+	arena.Close();
+	CHECK(device.LiveBuffers() == 1);
+}
+
+TEST(ConstantArenaFailsWithoutConstantBufferOffsets)
+{
+	// A device like D3D11.0 without ID3D11DeviceContext1: callers fall
+	// back to a constant buffer per draw.
+	class OldDevice : public NullRenderDevice
+	{
+	public:
+		OldDevice() { constantBufferOffsets = false; }
+	};
+	OldDevice device;
+	ConstantArena arena;
+	CHECK(SUCCEEDED(arena.Initialize(&device, 1024)));
+	arena.BeginFrame();
+	ConstantRange range;
+	const float data[16] = {};
+	CHECK(!arena.Write(data, sizeof(data), range));
+	arena.Close();
+	CHECK(device.CurrentFrameStats().maps == 0);
+}
@@ -0,0 +1,200 @@
+#include "Test.h"
+#include "Graphics/CurveGraph.h"
+#include "Jobs/JobSystem.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// ComputeGraph, and curve graphs evaluated from the job system the way
+// curve regenerations evaluate them. Also built with -fsanitize=thread as
+// CurveGraphTestsTsan.
+
+namespace
+{
+	CurveInputs Inputs(int graph, int round)
+	{
+		CurveInputs inputs;
+		inputs.params.type = static_cast<CurveType>(graph % 3);
+		inputs.params.a = 1.0f + 0.25f * graph;
+		inputs.params.t_max = 30.0f + round % 3;
+		inputs.params.t_num = 150000 + 10000 * (round % 2);
+		if (round % 4 == 3)
+		{
+			inputs.sampling.sampling = CurveSampling::ARC_LENGTH;
+			inputs.sampling.vertices = 5000;
+		}
+		inputs.simplifyTolerance = round % 2 ? 0.01f : 0.0f;
+		return inputs;
+	}
+
+	bool Same(const std::vector<DirectX::XMFLOAT3>& a, const std::vector<DirectX::XMFLOAT3>& b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(DirectX::XMFLOAT3)) == 0;
+	}
+
+	bool Same(const CurveProducts& a, const CurveProducts& b)
+	{
+		return Same(*a.points, *b.points) && Same(*a.simplified, *b.simplified) && a.arcLength == b.arcLength &&
+			a.chunks->size() == b.chunks->size();
+	}
+
+	const NodeReport* Find(const std::vector<NodeReport>& nodes, const char* name)
+	{
+		for (const NodeReport& node : nodes)
+		{
+			if (node.name == name)
+				return &node;
+		}
+		return nullptr;
+	}
+
+	NodeStatus Status(const ComputeGraph& graph, const char* name)
+	{
+		std::vector<NodeReport> nodes;
+		graph.Report(nodes);
+		return Find(nodes, name)->status;
+	}
+}
+
+TEST(ComputeGraphRecomputesOnlyWhatChanged)
+{
+	ComputeGraph graph;
+	int parities = 0, labels = 0;
+	GraphNode<int> a = graph.AddInput("a", 2);
+	GraphNode<int> b = graph.AddInput("b", 10);
+	GraphNode<int> sum = graph.AddNode<int>("sum", [](const int& x, const int& y) { return x + y; }, a, b);
+	GraphNode<int> parity = graph.AddNode<int>("parity", [&parities](const int& x) { ++parities; return x % 2; }, sum);
+	GraphNode<int> label = graph.AddNode<int>("label", [&labels](const int& p) { ++labels; return p ? 1 : 0; }, parity);
+	CHECK(*graph.Get(label) == 0);
+	CHECK(parities == 1 && labels == 1);
+
+	// The same value again isn't a change, so nothing is even checked.
+	graph.BeginPass();
+	graph.Set(a, 2);
+	CHECK(*graph.Get(label) == 0);
+	CHECK(Status(graph, "a") == NodeStatus::REUSED);
+	CHECK(Status(graph, "sum") == NodeStatus::IDLE);
+	CHECK(parities == 1);
+
+	// A new sum with the same parity stops there.
+	graph.BeginPass();
+	graph.Set(a, 4);
+	CHECK(*graph.Get(label) == 0);
+	CHECK(Status(graph, "sum") == NodeStatus::COMPUTED);
+	CHECK(Status(graph, "parity") == NodeStatus::COMPUTED);
+	CHECK(Status(graph, "label") == NodeStatus::REUSED);
+	CHECK(parities == 2 && labels == 1);
+
+	// Going back to earlier inputs is a lookup.
+	graph.BeginPass();
+	graph.Set(a, 2);
+	CHECK(*graph.Get(sum) == 12);
+	CHECK(Status(graph, "sum") == NodeStatus::MEMO_HIT);
+	CHECK(Status(graph, "label") == NodeStatus::IDLE);
+}
+
+TEST(ComputeGraphSharedNodesPassInputsOn)
+{
+	ComputeGraph graph;
+	int computes = 0;
+	GraphNode<std::vector<int>> values = graph.AddInput("values", std::vector<int>(1000, 7));
+	GraphNode<bool> negate = graph.AddInput("negate", false);
+	GraphNode<std::vector<int>> maybeNegated = graph.AddSharedNode<std::vector<int>>("maybe negated",
+		[&computes](const std::shared_ptr<const std::vector<int>>& in, const std::shared_ptr<const bool>& negate)
+	{
+		++computes;
+		if (!*negate)
+			return in;
+		std::shared_ptr<std::vector<int>> out = std::make_shared<std::vector<int>>(*in);
+		for (int& value : *out)
+			value = -value;
+		return std::shared_ptr<const std::vector<int>>(out);
+	}, values, negate);
+
+	CHECK(graph.Get(maybeNegated) == graph.Get(values));
+	std::vector<NodeReport> nodes;
+	graph.Report(nodes);
+	CHECK(Find(nodes, "maybe negated")->hash == Find(nodes, "values")->hash);
+
+	graph.BeginPass();
+	graph.Set(negate, true);
+	const std::shared_ptr<const std::vector<int>> negated = graph.Get(maybeNegated);
+	CHECK(negated != graph.Get(values));
+	CHECK(negated->front() == -7);
+	graph.Report(nodes);
+	CHECK(Find(nodes, "maybe negated")->hash == HashContent(*negated));
+	CHECK(computes == 2);
+}
+
+TEST(CurveGraphSharesPointsInsteadOfCopying)
+{
+	CurveGraph graph;
+	CurveInputs inputs = Inputs(0, 0);
+	CurveProducts uniform;
+	graph.Evaluate(inputs, uniform);
+	// Uniform-phi points are the dense ones, and with no tolerance the
+	// simplified polyline is the same vector again.
+	CHECK(uniform.simplified == uniform.points);
+	const NodeReport* dense = Find(uniform.nodes, "dense points");
+	const NodeReport* sampled = Find(uniform.nodes, "sampled points");
+	CHECK(dense && sampled && dense->hash == sampled->hash);
+
+	inputs.sampling.sampling = CurveSampling::ARC_LENGTH;
+	inputs.sampling.vertices = 1000;
+	inputs.simplifyTolerance = 0.01f;
+	CurveProducts resampled;
+	graph.Evaluate(inputs, resampled);
+	CHECK(resampled.points != uniform.points);
+	CHECK(resampled.points->size() == 1000);
+	CHECK(resampled.simplified != resampled.points);
+	CHECK(Find(resampled.nodes, "dense points")->status == NodeStatus::REUSED);
+
+	// Back to uniform sampling: the same vector once more, from the memo.
+	inputs.sampling.sampling = CurveSampling::UNIFORM_PHI;
+	inputs.simplifyTolerance = 0.0f;
+	CurveProducts again;
+	graph.Evaluate(inputs, again);
+	CHECK(again.points == uniform.points);
+	CHECK(again.simplified == uniform.points);
+}
+
+// Evaluations wait for their own jobs, and the waiting threads run the
+// evaluations of other graphs in the meantime; each graph is only ever
+// evaluated by one of them at a time, and nothing is locked across the
+// waits.
+TEST(CurveGraphsEvaluateSideBySideOnJobs)
+{
+	JobSystem& jobs = Jobs();
+	const int graphs = 4, rounds = 4;
+	std::vector<std::unique_ptr<CurveGraph>> owned;
+	for (int g = 0; g < graphs; ++g)
+		owned.push_back(std::make_unique<CurveGraph>());
+	std::vector<CurveProducts> results(graphs);
+	std::vector<CurveGraph*> pointers;
+	for (const std::unique_ptr<CurveGraph>& graph : owned)
+		pointers.push_back(graph.get());
+	CurveGraph** graphPointers = pointers.data();
+	CurveProducts* out = results.data();
+
+	for (int round = 0; round < rounds; ++round)
+	{
+		const JobHandle root = jobs.Create([]() {});
+		for (int g = 0; g < graphs; ++g)
+		{
+			jobs.Run([graphPointers, out, g, round]()
+			{
+				graphPointers[g]->Evaluate(Inputs(g, round), out[g]);
+			}, root);
+		}
+		jobs.Submit(root);
+		jobs.Wait(root);
+
+		for (int g = 0; g < graphs; ++g)
+		{
+			CurveGraph reference;
+			CurveProducts expected;
+			reference.Evaluate(Inputs(g, round), expected);
+			CHECK(Same(results[g], expected));
+		}
+	}
+}
@@ -0,0 +1,239 @@
+#include "Test.h"
+#include "Jobs/SpscQueue.h"
+#include "Jobs/TripleBuffer.h"
+#include "Timing/FrameClock.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// The handoff between the update thread and the render thread. Also built
+// with -fsanitize=thread as FramePacketTestsTsan.
+
+namespace
+{
+	// A packet large enough that a torn copy would show: every value is
+	// derived from the sequence number.
+	struct Packet
+	{
+		unsigned int sequence = 0;
+		unsigned int values[64] = {};
+
+		void Fill(unsigned int s)
+		{
+			sequence = s;
+			for (unsigned int i = 0; i < 64; ++i)
+				values[i] = s * 31 + i;
+		}
+
+		bool Intact() const
+		{
+			for (unsigned int i = 0; i < 64; ++i)
+			{
+				if (values[i] != sequence * 31 + i)
+					return false;
+			}
+			return true;
+		}
+	};
+}
+
+TEST(TripleBufferHandsOverTheNewestValue)
+{
+	TripleBuffer<int> buffer;
+	CHECK(!buffer.Acquire());
+	buffer.WriteBuffer() = 1;
+	buffer.Publish();
+	buffer.WriteBuffer() = 2;
+	buffer.Publish();
+	CHECK(buffer.Acquire());
+	CHECK(buffer.ReadBuffer() == 2);
+	// Nothing new: the consumer keeps the packet it has.
+	CHECK(!buffer.Acquire());
+	CHECK(buffer.ReadBuffer() == 2);
+	buffer.WriteBuffer() = 3;
+	buffer.Publish();
+	CHECK(buffer.Acquire());
+	CHECK(buffer.ReadBuffer() == 3);
+}
+
+TEST(TripleBufferNeverTearsOrGoesBackUnderContention)
+{
+	const unsigned int packets = 200000;
+	TripleBuffer<Packet> buffer;
+	std::atomic<bool> done(false);
+	std::thread producer([&]()
+	{
+		for (unsigned int s = 1; s <= packets; ++s)
+		{
+			buffer.WriteBuffer().Fill(s);
+			buffer.Publish();
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	unsigned int last = 0, acquired = 0;
+	bool intact = true, increasing = true;
+	for (;;)
+	{
+		// Read done first: a publish before it is seen by the Acquire after.
+		const bool finished = done.load(std::memory_order_acquire);
+		if (buffer.Acquire())
+		{
+			const Packet& packet = buffer.ReadBuffer();
+			intact = intact && packet.Intact();
+			increasing = increasing && packet.sequence > last;
+			last = packet.sequence;
+			++acquired;
+		}
+		if (finished)
+			break;
+	}
+	producer.join();
+	CHECK(intact);
+	CHECK(increasing);
+	CHECK(last == packets);
+	CHECK(acquired > 0);
+}
+
+TEST(SpscQueueKeepsOrder)
+{
+	SpscQueue<int> queue;
+	int value = 0;
+	CHECK(!queue.TryPop(value));
+	for (int i = 0; i < 10; ++i)
+		queue.Push(i);
+	for (int i = 0; i < 10; ++i)
+	{
+		CHECK(queue.TryPop(value));
+		CHECK(value == i);
+	}
+	CHECK(!queue.TryPop(value));
+}
+
+TEST(SpscQueueReleasesWhatItHolds)
+{
+	std::shared_ptr<int> shared = std::make_shared<int>(7);
+	{
+		SpscQueue<std::shared_ptr<int>> queue;
+		for (int i = 0; i < 5; ++i)
+			queue.Push(shared);
+		std::shared_ptr<int> popped;
+		CHECK(queue.TryPop(popped));
+		popped.reset();
+		// The popped node stays as the queue's head without a copy.
+		CHECK(shared.use_count() == 5);
+	}
+	CHECK(shared.use_count() == 1);
+}
+
+TEST(SpscQueueDeliversEverythingInOrderAcrossThreads)
+{
+	const unsigned int count = 200000;
+	SpscQueue<std::unique_ptr<unsigned int>> queue;
+	std::thread producer([&]()
+	{
+		for (unsigned int i = 0; i < count; ++i)
+			queue.Push(std::make_unique<unsigned int>(i));
+	});
+
+	unsigned int received = 0;
+	bool ordered = true;
+	std::unique_ptr<unsigned int> value;
+	while (received < count)
+	{
+		if (!queue.TryPop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		ordered = ordered && value && *value == received;
+		++received;
+	}
+	producer.join();
+	CHECK(ordered);
+	CHECK(!queue.TryPop(value));
+}
+
+// The render side paces itself and draws whatever packet is newest; an
+// update that takes several frames must not hold it back.
+TEST(SlowUpdatesDontHoldBackTheRenderThread)
+{
+	typedef std::chrono::steady_clock Clock;
+	const std::chrono::milliseconds frame(4);
+	const int frames = 50;
+	TripleBuffer<Packet> packets;
+	std::atomic<bool> stop(false);
+	std::thread update([&]()
+	{
+		unsigned int s = 0;
+		while (!stop.load(std::memory_order_acquire))
+		{
+			// Curve generation or UI work worth five frames.
+			std::this_thread::sleep_for(frame * 5);
+			packets.WriteBuffer().Fill(++s);
+			packets.Publish();
+		}
+	});
+
+	int drawn = 0, repeated = 0;
+	bool intact = true;
+	const Clock::time_point start = Clock::now();
+	Clock::time_point next = start;
+	for (int i = 0; i < frames; ++i)
+	{
+		if (packets.Acquire())
+			intact = intact && packets.ReadBuffer().Intact();
+		else
+			++repeated;
+		++drawn;
+		next += frame;
+		std::this_thread::sleep_until(next);
+	}
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	stop.store(true, std::memory_order_release);
+	update.join();
+
+	CHECK(intact);
+	CHECK(drawn == frames);
+	// Most frames repeat the last packet instead of waiting for a new one,
+	// and the frames took about as long as their pacing asks, not as long
+	// as the updates.
+	CHECK(repeated > frames / 2);
+	CHECK(seconds < frames * 5 * 0.004 / 2);
+}
+
+TEST(FixedStepSplitsFramesIntoSteps)
+{
+	FixedStep step(0.01);
+	CHECK(step.Advance(0.025) == 2);
+	CHECK_NEAR(step.Alpha(), 0.5, 1e-4);
+	// The remainder carries over.
+	CHECK(step.Advance(0.006) == 1);
+	CHECK_NEAR(step.Alpha(), 0.1, 1e-4);
+	CHECK(step.Advance(0.0) == 0);
+	CHECK_NEAR(step.Step(), 0.01, 1e-12);
+}
+
+TEST(FixedStepDropsTimeBeyondMaxSteps)
+{
+	FixedStep step(0.01);
+	step.maxSteps = 4;
+	// A hitch of a second runs four steps, not a hundred, and leaves no
+	// backlog for the frames after it.
+	CHECK(step.Advance(1.0) == 4);
+	CHECK(step.Alpha() == 0.0f);
+	CHECK(step.Advance(0.01) == 1);
+}
+
+TEST(FrameClockMeasuresTheTimeBetweenTicks)
+{
+	FrameClock clock;
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	const double first = clock.Tick();
+	CHECK(first >= 0.005);
+	const double second = clock.Tick();
+	CHECK(second >= 0.0);
+	CHECK(second < first);
+}
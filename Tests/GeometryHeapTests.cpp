@@ -0,0 +1,318 @@
+#include "Test.h"
+#include "Graphics/GeometryHeap.h"
+#include "Graphics/NullRenderDevice.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// No two live allocations share a unit, all lie within the capacity,
+	// and their sizes add up to UsedSize.
+	bool Consistent(const FreeListAllocator& allocator, const std::vector<HeapHandle>& handles)
+	{
+		std::vector<std::pair<UINT, UINT>> ranges;
+		UINT used = 0;
+		for (HeapHandle handle : handles)
+		{
+			if (!allocator.IsLive(handle))
+				return false;
+			ranges.emplace_back(allocator.Offset(handle), allocator.Size(handle));
+			used += allocator.Size(handle);
+		}
+		std::sort(ranges.begin(), ranges.end());
+		for (size_t i = 0; i < ranges.size(); ++i)
+		{
+			if (ranges[i].first + ranges[i].second > allocator.Capacity())
+				return false;
+			if (i > 0 && ranges[i - 1].first + ranges[i - 1].second > ranges[i].first)
+				return false;
+		}
+		return used == allocator.UsedSize();
+	}
+
+	std::vector<VertexCommon> CurveVertices(UINT count, float tag)
+	{
+		std::vector<VertexCommon> vertices(count);
+		for (UINT i = 0; i < count; ++i)
+			vertices[i] = VertexCommon(static_cast<float>(i), tag);
+		return vertices;
+	}
+
+	// The vertices of `handle` as the heap's buffer holds them now.
+	bool HoldsCurve(const NullRenderDevice& device, const GeometryHeap& heap, const GeometryHandle& handle, UINT count, float tag)
+	{
+		const std::vector<std::uint8_t>& contents = device.BufferContents(heap.VertexBuffer());
+		const std::vector<VertexCommon> expected = CurveVertices(count, tag);
+		const size_t offset = sizeof(VertexCommon) * heap.BaseVertex(handle);
+		return offset + sizeof(VertexCommon) * count <= contents.size() &&
+			std::memcmp(contents.data() + offset, expected.data(), sizeof(VertexCommon) * count) == 0;
+	}
+}
+
+TEST(FreeListAllocatorPicksTheBestFit)
+{
+	FreeListAllocator allocator;
+	allocator.Reset(100);
+	HeapHandle a = allocator.Allocate(10);
+	HeapHandle b = allocator.Allocate(30);
+	HeapHandle c = allocator.Allocate(10);
+	HeapHandle d = allocator.Allocate(20);
+	HeapHandle e = allocator.Allocate(10);
+	CHECK(allocator.Offset(e) == 70);
+	allocator.Free(b);
+	allocator.Free(d);
+	// Gaps of 30 at 10, 20 at 50 and 20 at 80: 15 goes into a 20.
+	HeapHandle f = allocator.Allocate(15);
+	CHECK(allocator.Offset(f) == 50 || allocator.Offset(f) == 80);
+	CHECK(allocator.Allocate(25).IsValid());
+	CHECK(!allocator.Allocate(21).IsValid());
+	CHECK(allocator.IsLive(a) && allocator.IsLive(c) && allocator.IsLive(e));
+}
+
+TEST(FreeListAllocatorCoalescesNeighbours)
+{
+	FreeListAllocator allocator;
+	allocator.Reset(30);
+	HeapHandle a = allocator.Allocate(10);
+	HeapHandle b = allocator.Allocate(10);
+	HeapHandle c = allocator.Allocate(10);
+	CHECK(allocator.FreeBlockCount() == 0);
+	CHECK(allocator.Fragmentation() == 0.0f);
+	allocator.Free(a);
+	allocator.Free(c);
+	CHECK(allocator.FreeBlockCount() == 2);
+	CHECK(allocator.Fragmentation() == 0.5f);
+	allocator.Free(b);
+	CHECK(allocator.FreeBlockCount() == 1);
+	CHECK(allocator.LargestFreeBlock() == 30);
+	CHECK(allocator.Allocate(30).IsValid());
+}
+
+TEST(FreeListAllocatorStaleHandlesStayDead)
+{
+	FreeListAllocator allocator;
+	allocator.Reset(16);
+	HeapHandle first = allocator.Allocate(8);
+	allocator.Free(first);
+	HeapHandle second = allocator.Allocate(8);
+	// The entry is reused under a new generation.
+	CHECK(second.index == first.index);
+	CHECK(!allocator.IsLive(first));
+	CHECK(allocator.IsLive(second));
+	allocator.Free(first);
+	CHECK(allocator.IsLive(second));
+	CHECK(allocator.UsedSize() == 8);
+	CHECK(allocator.Size(first) == 0);
+	CHECK(!allocator.IsLive(HeapHandle()));
+}
+
+TEST(FreeListAllocatorGrowMergesWithTheLastGap)
+{
+	FreeListAllocator allocator;
+	allocator.Reset(20);
+	HeapHandle a = allocator.Allocate(10);
+	CHECK(!allocator.Allocate(20).IsValid());
+	allocator.Grow(30);
+	HeapHandle b = allocator.Allocate(20);
+	CHECK(allocator.Offset(b) == 10);
+	CHECK(allocator.Offset(a) == 0);
+	allocator.Grow(10);
+	CHECK(allocator.Capacity() == 30);
+}
+
+TEST(FreeListAllocatorCompactionKeepsHandles)
+{
+	FreeListAllocator allocator;
+	allocator.Reset(1000);
+	std::vector<HeapHandle> handles;
+	for (UINT i = 0; i < 20; ++i)
+		handles.push_back(allocator.Allocate(10 + i));
+	for (size_t i = 0; i < handles.size(); i += 2)
+		allocator.Free(handles[i]);
+	std::vector<HeapHandle> live;
+	for (size_t i = 1; i < handles.size(); i += 2)
+		live.push_back(handles[i]);
+	CHECK(allocator.Fragmentation() > 0.0f);
+
+	FreeListAllocator::Move move;
+	UINT steps = 0;
+	while (allocator.CompactStep(move))
+	{
+		CHECK(move.to < move.from);
+		CHECK(allocator.Offset(move.handle) == move.to);
+		CHECK(allocator.Size(move.handle) == move.size);
+		CHECK(Consistent(allocator, live));
+		++steps;
+	}
+	CHECK(steps == live.size());
+	CHECK(allocator.Fragmentation() == 0.0f);
+	CHECK(allocator.FreeBlockCount() == 1);
+	CHECK(allocator.LargestFreeBlock() == allocator.Capacity() - allocator.UsedSize());
+}
+
+TEST(FreeListAllocatorStaysConsistentUnderChurn)
+{
+	std::mt19937 random(7);
+	FreeListAllocator allocator;
+	allocator.Reset(1 << 20);
+	std::vector<HeapHandle> live;
+	unsigned int failures = 0;
+	for (int step = 0; step < 20000; ++step)
+	{
+		if (!live.empty() && (random() % 2 == 0 || live.size() > 64))
+		{
+			const size_t victim = random() % live.size();
+			allocator.Free(live[victim]);
+			live[victim] = live.back();
+			live.pop_back();
+		}
+		else
+		{
+			const HeapHandle handle = allocator.Allocate(1 + random() % 8192);
+			if (handle.IsValid())
+				live.push_back(handle);
+			else
+				++failures;
+		}
+		if (step % 64 == 0)
+		{
+			FreeListAllocator::Move move;
+			allocator.CompactStep(move);
+		}
+		if (step % 500 == 0)
+			CHECK(Consistent(allocator, live));
+	}
+	CHECK(Consistent(allocator, live));
+	CHECK(failures == 0);
+}
+
+// Curves come and go in one pair of buffers: no buffer is created unless
+// the heap has to grow, and every curve still reads back intact after
+// defragmenting a little each frame.
+TEST(GeometryHeapAddsRemovesAndDefragments)
+{
+	NullRenderDevice device;
+	UploadRing uploads;
+	CHECK(SUCCEEDED(uploads.Initialize(&device, 1 << 20)));
+	GeometryHeap heap;
+	CHECK(SUCCEEDED(heap.Initialize(&device, &uploads, 1 << 16, 1 << 16)));
+	const UINT buffers = device.LiveBuffers();
+
+	struct Curve
+	{
+		GeometryHandle handle;
+		UINT count;
+		float tag;
+	};
+	std::vector<Curve> curves;
+	std::mt19937 random(3);
+	for (int i = 0; i < 64; ++i)
+	{
+		Curve curve;
+		curve.count = 16 + random() % 900;
+		curve.tag = static_cast<float>(i);
+		const std::vector<VertexCommon> vertices = CurveVertices(curve.count, curve.tag);
+		std::vector<DWORD> indices(curve.count);
+		for (UINT j = 0; j < curve.count; ++j)
+			indices[j] = j;
+		CHECK(SUCCEEDED(heap.Add(vertices.data(), curve.count, indices.data(), curve.count, curve.handle)));
+		curves.push_back(curve);
+	}
+	CHECK(device.LiveBuffers() == buffers);
+
+	for (size_t i = 0; i < curves.size(); i += 3)
+		heap.Remove(curves[i].handle);
+	curves.erase(std::remove_if(curves.begin(), curves.end(), [](const Curve& curve) { return !curve.handle.vertices.IsValid(); }), curves.end());
+	CHECK(heap.Vertices().Fragmentation() > 0.0f);
+
+	int frames = 0;
+	do
+	{
+		device.BeginFrame();
+		uploads.BeginFrame();
+		heap.Defragment(16 * 1024);
+		CHECK(heap.MovedBytesLastFrame() <= 16 * 1024 + 1000 * sizeof(VertexCommon));
+		for (const Curve& curve : curves)
+		{
+			CHECK(HoldsCurve(device, heap, curve.handle, curve.count, curve.tag));
+			CHECK(heap.IndexCount(curve.handle) == curve.count);
+		}
+		++frames;
+	} while (heap.MovedBytesLastFrame() > 0 && frames < 1000);
+	CHECK(heap.Vertices().Fragmentation() == 0.0f);
+	CHECK(heap.Indices().Fragmentation() == 0.0f);
+	CHECK(frames > 1);
+	CHECK(device.LiveBuffers() == buffers);
+}
+
+// D3D11 drops copies whose source and destination are the same buffer,
+// and so does the null device.
+TEST(NullRenderDeviceDropsCopiesWithinOneBuffer)
+{
+	NullRenderDevice device;
+	const std::vector<VertexCommon> vertices = CurveVertices(8, 1.0f);
+	BufferDesc desc;
+	desc.byteWidth = sizeof(VertexCommon) * 8;
+	DeviceBuffer* buffer = nullptr;
+	CHECK(SUCCEEDED(device.CreateBuffer(desc, vertices.data(), &buffer)));
+	device.CopyBuffer(buffer, 0, buffer, sizeof(VertexCommon) * 4, sizeof(VertexCommon) * 4);
+	CHECK(std::memcmp(device.BufferContents(buffer).data(), vertices.data(), sizeof(VertexCommon) * 8) == 0);
+	device.ReleaseBuffer(buffer);
+}
+
+// A curve much longer than the scratch buffer, moving by less than its
+// own length.
+TEST(GeometryHeapMovesLongCurvesAShortWay)
+{
+	NullRenderDevice device;
+	UploadRing uploads;
+	CHECK(SUCCEEDED(uploads.Initialize(&device, 1 << 22)));
+	GeometryHeap heap;
+	CHECK(SUCCEEDED(heap.Initialize(&device, &uploads, 1 << 17, 1 << 17)));
+
+	GeometryHandle small, large;
+	const std::vector<VertexCommon> few = CurveVertices(100, 1.0f);
+	const std::vector<DWORD> fewIndices(100, 0);
+	CHECK(SUCCEEDED(heap.Add(few.data(), 100, fewIndices.data(), 100, small)));
+	const std::vector<VertexCommon> many = CurveVertices(100000, 2.0f);
+	const std::vector<DWORD> manyIndices(100000, 0);
+	CHECK(SUCCEEDED(heap.Add(many.data(), 100000, manyIndices.data(), 100000, large)));
+	CHECK(heap.BaseVertex(large) == 100);
+
+	heap.Remove(small);
+	device.BeginFrame();
+	uploads.BeginFrame();
+	heap.Defragment(1);
+	CHECK(heap.BaseVertex(large) == 0);
+	CHECK(HoldsCurve(device, heap, large, 100000, 2.0f));
+}
+
+TEST(GeometryHeapGrowsForCurvesOfAnyLength)
+{
+	NullRenderDevice device;
+	UploadRing uploads;
+	CHECK(SUCCEEDED(uploads.Initialize(&device, 1 << 16)));
+	GeometryHeap heap;
+	CHECK(SUCCEEDED(heap.Initialize(&device, &uploads, 1024, 1024)));
+
+	GeometryHandle small;
+	const std::vector<VertexCommon> few = CurveVertices(100, 1.0f);
+	const std::vector<DWORD> fewIndices(100, 0);
+	CHECK(SUCCEEDED(heap.Add(few.data(), 100, fewIndices.data(), 100, small)));
+
+	GeometryHandle large;
+	const std::vector<VertexCommon> many = CurveVertices(50000, 2.0f);
+	const std::vector<DWORD> manyIndices(50000, 0);
+	CHECK(SUCCEEDED(heap.Add(many.data(), 50000, manyIndices.data(), 50000, large)));
+	CHECK(heap.Vertices().Capacity() >= 50100);
+	CHECK(HoldsCurve(device, heap, small, 100, 1.0f));
+	CHECK(HoldsCurve(device, heap, large, 50000, 2.0f));
+
+	GeometryHandle empty;
+	CHECK(heap.Add(few.data(), 0, fewIndices.data(), 0, empty) == E_INVALIDARG);
+	heap.Remove(large);
+	CHECK(!large.vertices.IsValid());
+	CHECK(heap.Vertices().UsedSize() == 100);
+}
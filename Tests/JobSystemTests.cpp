@@ -0,0 +1,314 @@
+#include "Test.h"
+#include "Jobs/JobDeque.h"
+#include "Jobs/JobSystem.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Run with ENGINE_JOB_WORKERS set so there are workers to steal, and built
+// with -fsanitize=thread as JobSystemTestsTsan.
+
+TEST(DequeOwnerPopsNewestThievesStealOldest)
+{
+	int items[3] = { 0, 1, 2 };
+	JobDeque<int> deque;
+	CHECK(deque.Pop() == nullptr);
+	CHECK(deque.Steal() == nullptr);
+	for (int& item : items)
+		CHECK(deque.Push(&item));
+	CHECK(deque.Pop() == &items[2]);
+	CHECK(deque.Steal() == &items[0]);
+	CHECK(deque.Pop() == &items[1]);
+	CHECK(deque.Pop() == nullptr);
+	CHECK(deque.Steal() == nullptr);
+}
+
+TEST(DequeRefusesPushWhenFull)
+{
+	std::vector<int> items(JobDeque<int>::capacity + 1);
+	std::unique_ptr<JobDeque<int>> deque(new JobDeque<int>());
+	for (int64_t i = 0; i < JobDeque<int>::capacity; ++i)
+		CHECK(deque->Push(&items[i]));
+	CHECK(!deque->Push(&items.back()));
+	// A steal makes room again, and the indices wrap around the buffer.
+	CHECK(deque->Steal() == &items[0]);
+	CHECK(deque->Push(&items.back()));
+	CHECK(deque->Pop() == &items.back());
+}
+
+TEST(DequeHandsOutEveryItemOnceUnderContention)
+{
+	const int count = 200000;
+	const int thieves = 3;
+	std::vector<int> items(count);
+	std::vector<std::atomic<int>> taken(count);
+	for (std::atomic<int>& t : taken)
+		t.store(0);
+	std::unique_ptr<JobDeque<int>> deque(new JobDeque<int>());
+	std::atomic<bool> done(false);
+	std::atomic<int> stolen(0);
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < thieves; ++i)
+	{
+		threads.emplace_back([&]()
+		{
+			while (!done.load(std::memory_order_acquire))
+			{
+				if (int* item = deque->Steal())
+				{
+					taken[item - items.data()].fetch_add(1, std::memory_order_relaxed);
+					stolen.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+	}
+
+	// The owner pushes in bursts and pops some of each back, so pops race
+	// the thieves for the last item as well as for the others.
+	int next = 0;
+	while (next < count)
+	{
+		for (int burst = 0; burst < 64 && next < count; ++burst)
+		{
+			while (!deque->Push(&items[next]))
+			{
+				if (int* item = deque->Pop())
+					taken[item - items.data()].fetch_add(1, std::memory_order_relaxed);
+			}
+			++next;
+		}
+		for (int pops = 0; pops < 48; ++pops)
+		{
+			if (int* item = deque->Pop())
+				taken[item - items.data()].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	while (int* item = deque->Pop())
+		taken[item - items.data()].fetch_add(1, std::memory_order_relaxed);
+	done.store(true, std::memory_order_release);
+	for (std::thread& thread : threads)
+		thread.join();
+
+	int wrong = 0;
+	for (const std::atomic<int>& t : taken)
+		wrong += t.load() != 1;
+	CHECK(wrong == 0);
+}
+
+TEST(EveryJobRunsOnce)
+{
+	JobSystem& jobs = Jobs();
+	const int count = 20000;
+	std::vector<std::atomic<int>> runs(count);
+	for (std::atomic<int>& r : runs)
+		r.store(0);
+	std::atomic<int>* counters = runs.data();
+
+	// More jobs than a slot's deque holds; the rest run where they are made.
+	const JobHandle root = jobs.Create([]() {});
+	for (int i = 0; i < count; ++i)
+		jobs.Run([counters, i]() { counters[i].fetch_add(1, std::memory_order_relaxed); }, root);
+	jobs.Submit(root);
+	jobs.Wait(root);
+	CHECK(jobs.Done(root));
+
+	int wrong = 0;
+	for (const std::atomic<int>& r : runs)
+		wrong += r.load() != 1;
+	CHECK(wrong == 0);
+}
+
+TEST(ParentIsDoneOnlyAfterItsChildren)
+{
+	JobSystem& jobs = Jobs();
+	std::atomic<int> finished(0);
+	std::atomic<int>* counter = &finished;
+	const JobHandle parent = jobs.Create([]() {});
+	for (int i = 0; i < 64; ++i)
+	{
+		jobs.Run([counter]()
+		{
+			std::this_thread::yield();
+			counter->fetch_add(1, std::memory_order_relaxed);
+		}, parent);
+	}
+	jobs.Submit(parent);
+	jobs.Wait(parent);
+	CHECK(finished.load() == 64);
+}
+
+TEST(DependenciesRunFirst)
+{
+	JobSystem& jobs = Jobs();
+	for (int round = 0; round < 200; ++round)
+	{
+		// A diamond: first, then two in the middle, then last.
+		std::atomic<int> clock(0);
+		int stamps[4] = { -1, -1, -1, -1 };
+		std::atomic<int>* c = &clock;
+		int* s = stamps;
+		JobHandle first = jobs.Create([c, s]() { s[0] = c->fetch_add(1); });
+		JobHandle left = jobs.Create([c, s]() { s[1] = c->fetch_add(1); });
+		JobHandle right = jobs.Create([c, s]() { s[2] = c->fetch_add(1); });
+		JobHandle last = jobs.Create([c, s]() { s[3] = c->fetch_add(1); });
+		jobs.DependsOn(left, first);
+		jobs.DependsOn(right, first);
+		jobs.DependsOn(last, left);
+		jobs.DependsOn(last, right);
+		// Submitted backwards, so nothing runs in order by accident.
+		jobs.Submit(last);
+		jobs.Submit(right);
+		jobs.Submit(left);
+		jobs.Submit(first);
+		jobs.Wait(last);
+
+		CHECK(stamps[0] == 0);
+		CHECK(stamps[1] > stamps[0] && stamps[2] > stamps[0]);
+		CHECK(stamps[3] == 3);
+	}
+}
+
+TEST(ManyDependentsAreAllReleased)
+{
+	// Past maxDependents, dependents are chained through relay jobs.
+	JobSystem& jobs = Jobs();
+	const int count = JobSystem::maxDependents * 4 + 3;
+	std::atomic<int> gate(0), late(0);
+	std::atomic<int>* g = &gate;
+	std::atomic<int>* l = &late;
+	const JobHandle first = jobs.Create([g]() { g->store(1, std::memory_order_release); });
+	std::vector<JobHandle> dependents;
+	for (int i = 0; i < count; ++i)
+	{
+		dependents.push_back(jobs.Create([g, l]()
+		{
+			if (g->load(std::memory_order_acquire) != 1)
+				l->fetch_add(1);
+		}));
+		jobs.DependsOn(dependents.back(), first);
+	}
+	for (JobHandle job : dependents)
+		jobs.Submit(job);
+	jobs.Submit(first);
+	for (JobHandle job : dependents)
+		jobs.Wait(job);
+	CHECK(late.load() == 0);
+}
+
+TEST(WaitOnAFinishedJobReturns)
+{
+	JobSystem& jobs = Jobs();
+	const JobHandle job = jobs.Run([]() {});
+	jobs.Wait(job);
+	// The task may be recycled by now; the handle still reads as done.
+	jobs.Wait(job);
+	CHECK(jobs.Done(job));
+	CHECK(jobs.Done(JobHandle()));
+}
+
+TEST(ParallelForCoversTheRangeOnce)
+{
+	JobSystem& jobs = Jobs();
+	const size_t counts[] = { 0, 1, 7, 4096, 4097, 100003 };
+	const size_t grains[] = { 0, 1, 13, 4096 };
+	for (size_t count : counts)
+	{
+		for (size_t grain : grains)
+		{
+			if (grain == 1 && count > 5000)
+				continue;
+			std::vector<std::atomic<int>> visits(count);
+			for (std::atomic<int>& v : visits)
+				v.store(0);
+			std::atomic<bool> badRange(false);
+			jobs.ParallelFor(count, grain, [&](size_t begin, size_t end)
+			{
+				if (begin >= end || end > count || (grain > 1 && begin % grain != 0))
+					badRange.store(true);
+				for (size_t i = begin; i < end; ++i)
+					visits[i].fetch_add(1, std::memory_order_relaxed);
+			});
+			int wrong = 0;
+			for (const std::atomic<int>& v : visits)
+				wrong += v.load() != 1;
+			CHECK(wrong == 0);
+			CHECK(!badRange.load());
+		}
+	}
+}
+
+TEST(ParallelForNestsInsideJobs)
+{
+	JobSystem& jobs = Jobs();
+	const size_t outer = 16, inner = 10000;
+	std::vector<std::atomic<size_t>> sums(outer);
+	for (std::atomic<size_t>& s : sums)
+		s.store(0);
+	jobs.ParallelFor(outer, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t o = begin; o < end; ++o)
+		{
+			jobs.ParallelFor(inner, 256, [&, o](size_t b, size_t e)
+			{
+				size_t sum = 0;
+				for (size_t i = b; i < e; ++i)
+					sum += i;
+				sums[o].fetch_add(sum, std::memory_order_relaxed);
+			});
+		}
+	});
+	int wrong = 0;
+	for (const std::atomic<size_t>& s : sums)
+		wrong += s.load() != inner * (inner - 1) / 2;
+	CHECK(wrong == 0);
+}
+
+TEST(JobsSubmittedFromManyThreads)
+{
+	// Every thread that submits gets a slot of its own.
+	JobSystem& jobs = Jobs();
+	const int threads = 4, perThread = 2000;
+	std::atomic<int> ran(0);
+	std::atomic<int>* counter = &ran;
+	std::vector<std::thread> submitters;
+	for (int t = 0; t < threads; ++t)
+	{
+		submitters.emplace_back([&jobs, counter]()
+		{
+			const JobHandle root = jobs.Create([]() {});
+			for (int i = 0; i < perThread; ++i)
+				jobs.Run([counter]() { counter->fetch_add(1, std::memory_order_relaxed); }, root);
+			jobs.Submit(root);
+			jobs.Wait(root);
+		});
+	}
+	for (std::thread& thread : submitters)
+		thread.join();
+	CHECK(ran.load() == threads * perThread);
+}
+
+TEST(WorkFinishesWithWorkersParked)
+{
+	JobSystem& jobs = Jobs();
+	const unsigned int previous = jobs.ActiveWorkers();
+	const unsigned int settings[] = { 0, 1, jobs.WorkerCount() };
+	for (unsigned int active : settings)
+	{
+		jobs.SetActiveWorkers(active);
+		CHECK(jobs.ActiveWorkers() == (std::min)(active, jobs.WorkerCount()));
+		std::atomic<size_t> sum(0);
+		jobs.ParallelFor(50000, 512, [&](size_t begin, size_t end)
+		{
+			sum.fetch_add(end - begin, std::memory_order_relaxed);
+		});
+		CHECK(sum.load() == 50000);
+		std::atomic<int> ran(0);
+		std::atomic<int>* counter = &ran;
+		const JobHandle job = jobs.Run([counter]() { counter->store(1); });
+		jobs.Wait(job);
+		CHECK(ran.load() == 1);
+	}
+	jobs.SetActiveWorkers(previous);
+}
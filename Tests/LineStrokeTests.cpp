@@ -0,0 +1,271 @@
+#include "Test.h"
+#include "Graphics/LineStroke.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	const float width = 200.0f;
+	const float height = 100.0f;
+	const std::uint32_t white = 0xffffffffu;
+
+	// Points are given in normalized device coordinates.
+	StrokeView IdentityView()
+	{
+		StrokeView view;
+		for (int i = 0; i < 4; ++i)
+			view.viewProjection[i][i] = 1.0f;
+		view.width = width;
+		view.height = height;
+		return view;
+	}
+
+	// Vertex positions back in pixels from the center of the screen.
+	float PixelX(const StrokeVertex& v) { return v.pos.x * width * 0.5f; }
+	float PixelY(const StrokeVertex& v) { return v.pos.y * height * 0.5f; }
+
+	// Whole triangles, and every index names a vertex.
+	bool WellFormed(const StrokeMesh& mesh)
+	{
+		if (mesh.indices.size() % 3 != 0)
+			return false;
+		for (size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				if (mesh.indices[i + j] >= mesh.vertices.size())
+					return false;
+			}
+		}
+		return true;
+	}
+
+	std::vector<XMFLOAT3> Spiral(size_t count)
+	{
+		std::vector<XMFLOAT3> points(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float t = 30.0f * i / count;
+			points[i] = XMFLOAT3(0.03f * t * std::cos(t), 0.03f * t * std::sin(t), 0.5f);
+		}
+		return points;
+	}
+
+	float MaxPixelX(const StrokeMesh& mesh)
+	{
+		float x = -1e30f;
+		for (const StrokeVertex& v : mesh.vertices)
+			x = (std::max)(x, PixelX(v));
+		return x;
+	}
+}
+
+TEST(StrokeHasTheWidthAndFringeAskedFor)
+{
+	const XMFLOAT3 points[3] = { { -0.5f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.0f, 0.0f } };
+	StrokeStyle style;
+	style.width = 4.0f;
+	style.fringe = 1.0f;
+	LineStroker stroker;
+	StrokeMesh mesh;
+	stroker.Stroke(points, 3, sizeof(XMFLOAT3), IdentityView(), style, white, mesh);
+	CHECK(!mesh.vertices.empty());
+	CHECK(WellFormed(mesh));
+
+	// Opaque out to half the width, transparent at the fringe's edge.
+	bool opaqueEdge = false, clearEdge = false;
+	for (const StrokeVertex& v : mesh.vertices)
+	{
+		const float y = std::fabs(PixelY(v));
+		CHECK(y <= 3.0f + 1e-3f);
+		CHECK(std::fabs(PixelX(v)) <= 50.0f + 1.0f + 1e-3f);
+		if ((v.color >> 24) == 255)
+		{
+			CHECK(y <= 2.0f + 1e-3f);
+			opaqueEdge = opaqueEdge || std::fabs(y - 2.0f) < 1e-3f;
+		}
+		else
+		{
+			CHECK((v.color >> 24) == 0);
+			CHECK((v.color & 0x00ffffffu) == 0x00ffffffu);
+			clearEdge = clearEdge || std::fabs(y - 3.0f) < 1e-3f;
+		}
+	}
+	CHECK(opaqueEdge);
+	CHECK(clearEdge);
+	// The straight middle point shares one row between its segments.
+	CHECK(stroker.KeptPoints() == 3);
+}
+
+TEST(SquareCapsExtendByHalfTheWidth)
+{
+	const XMFLOAT3 points[2] = { { -0.5f, 0.0f, 0.0f }, { 0.5f, 0.0f, 0.0f } };
+	StrokeStyle style;
+	style.width = 6.0f;
+	style.fringe = 1.0f;
+	LineStroker stroker;
+	StrokeMesh butt, square, round;
+	stroker.Stroke(points, 2, sizeof(XMFLOAT3), IdentityView(), style, white, butt);
+	style.cap = LineCap::SQUARE;
+	stroker.Stroke(points, 2, sizeof(XMFLOAT3), IdentityView(), style, white, square);
+	style.cap = LineCap::ROUND;
+	stroker.Stroke(points, 2, sizeof(XMFLOAT3), IdentityView(), style, white, round);
+	CHECK(WellFormed(butt) && WellFormed(square) && WellFormed(round));
+	CHECK_NEAR(MaxPixelX(butt), 50.0f + 1.0f, 1e-3);
+	CHECK_NEAR(MaxPixelX(square), 50.0f + 3.0f + 1.0f, 1e-3);
+	// The arc is a polygon within the round tolerance of the true one.
+	CHECK(MaxPixelX(round) <= 50.0f + 4.0f + 1e-3f);
+	CHECK(MaxPixelX(round) >= 50.0f + 4.0f - style.roundTolerance);
+	CHECK(round.vertices.size() > butt.vertices.size());
+}
+
+TEST(JoinsFollowTheStyle)
+{
+	// A right angle: its miter is sqrt(2) half widths long.
+	const XMFLOAT3 points[3] = { { -0.5f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.5f, 0.0f } };
+	StrokeStyle style;
+	style.width = 8.0f;
+	LineStroker stroker;
+	StrokeMesh miter, beveled, bevel, round;
+	stroker.Stroke(points, 3, sizeof(XMFLOAT3), IdentityView(), style, white, miter);
+	style.miterLimit = 1.2f;
+	stroker.Stroke(points, 3, sizeof(XMFLOAT3), IdentityView(), style, white, beveled);
+	style.join = LineJoin::BEVEL;
+	stroker.Stroke(points, 3, sizeof(XMFLOAT3), IdentityView(), style, white, bevel);
+	style.join = LineJoin::ROUND;
+	stroker.Stroke(points, 3, sizeof(XMFLOAT3), IdentityView(), style, white, round);
+	CHECK(WellFormed(miter) && WellFormed(beveled) && WellFormed(bevel) && WellFormed(round));
+
+	// The miter's outer corner lies at (h, -h) from the turn, the others
+	// cut it off; a miter past its limit is a bevel.
+	auto reachesCorner = [](const StrokeMesh& mesh)
+	{
+		for (const StrokeVertex& v : mesh.vertices)
+		{
+			if (std::fabs(PixelX(v) - 4.0f) < 1e-2f && std::fabs(PixelY(v) + 4.0f) < 1e-2f)
+				return true;
+		}
+		return false;
+	};
+	CHECK(reachesCorner(miter));
+	CHECK(!reachesCorner(bevel));
+	CHECK(!reachesCorner(round));
+	CHECK(beveled.vertices.size() == bevel.vertices.size());
+	CHECK(miter.vertices.size() < bevel.vertices.size());
+	CHECK(round.vertices.size() > bevel.vertices.size());
+}
+
+TEST(StrokeThinsToAboutOnePointPerPixel)
+{
+	// 100000 points over 100 pixels.
+	std::vector<XMFLOAT3> points(100000);
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i] = XMFLOAT3(-0.5f + static_cast<float>(i) / (points.size() - 1), 0.0f, 0.0f);
+	StrokeStyle style;
+	style.minSegment = 1.0f;
+	LineStroker stroker;
+	stroker.chunkSize = 4096;
+	StrokeMesh mesh;
+	stroker.Stroke(points.data(), points.size(), sizeof(XMFLOAT3), IdentityView(), style, white, mesh);
+	CHECK(stroker.KeptPoints() >= 100);
+	// Plus the first point of every chunk.
+	CHECK(stroker.KeptPoints() <= 101 + points.size() / 4096 + 1);
+	// The stroke still ends where the curve does.
+	CHECK_NEAR(MaxPixelX(mesh), 50.0f + style.fringe, 1e-2);
+}
+
+TEST(ChunkedStrokeMatchesOneChunk)
+{
+	// Without thinning every point is kept either way, so chunking must
+	// not change a single vertex.
+	const std::vector<XMFLOAT3> points = Spiral(20000);
+	StrokeStyle style;
+	style.width = 3.0f;
+	style.join = LineJoin::ROUND;
+	style.cap = LineCap::ROUND;
+	style.minSegment = 0.0f;
+	LineStroker whole, chunked;
+	whole.chunkSize = points.size();
+	chunked.chunkSize = 777;
+	StrokeMesh a, b;
+	whole.Stroke(points.data(), points.size(), sizeof(XMFLOAT3), IdentityView(), style, white, a);
+	chunked.Stroke(points.data(), points.size(), sizeof(XMFLOAT3), IdentityView(), style, white, b);
+	CHECK(WellFormed(a) && WellFormed(b));
+	CHECK(a.vertices.size() == b.vertices.size());
+	CHECK(a.indices == b.indices);
+	bool same = a.vertices.size() == b.vertices.size();
+	for (size_t i = 0; same && i < a.vertices.size(); ++i)
+	{
+		same = a.vertices[i].pos.x == b.vertices[i].pos.x && a.vertices[i].pos.y == b.vertices[i].pos.y &&
+			a.vertices[i].pos.z == b.vertices[i].pos.z && a.vertices[i].color == b.vertices[i].color;
+	}
+	CHECK(same);
+}
+
+TEST(StrokeLeavesOutWhatCantBeSeen)
+{
+	LineStroker stroker;
+	StrokeMesh mesh;
+	StrokeStyle style;
+
+	// Entirely right of the screen.
+	const XMFLOAT3 offscreen[2] = { { 2.0f, 0.0f, 0.0f }, { 3.0f, 0.5f, 0.0f } };
+	stroker.Stroke(offscreen, 2, sizeof(XMFLOAT3), IdentityView(), style, white, mesh);
+	CHECK(mesh.vertices.empty() && mesh.indices.empty());
+
+	// With w = z, points at negative z are behind the camera: the segments
+	// touching the middle point go, and both remaining pieces get caps.
+	StrokeView view = IdentityView();
+	view.viewProjection[2][3] = 1.0f;
+	view.viewProjection[3][3] = 0.0f;
+	const XMFLOAT3 behind[5] = { { -0.4f, 0.0f, 1.0f }, { -0.2f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 0.2f, 0.0f, 1.0f }, { 0.4f, 0.0f, 1.0f } };
+	stroker.Stroke(behind, 5, sizeof(XMFLOAT3), view, style, white, mesh);
+	CHECK(WellFormed(mesh));
+	LineStroker single;
+	StrokeMesh piece;
+	single.Stroke(behind, 2, sizeof(XMFLOAT3), view, style, white, piece);
+	CHECK(mesh.vertices.size() == 2 * piece.vertices.size());
+	for (const StrokeVertex& v : mesh.vertices)
+		CHECK(std::fabs(PixelX(v)) >= 20.0f - style.fringe - 1e-3f);
+
+	// Degenerate input strokes nothing.
+	stroker.Stroke(behind, 1, sizeof(XMFLOAT3), IdentityView(), style, white, mesh);
+	CHECK(mesh.vertices.empty());
+	style.width = 0.0f;
+	stroker.Stroke(behind, 5, sizeof(XMFLOAT3), IdentityView(), style, white, mesh);
+	CHECK(mesh.vertices.empty());
+}
+
+TEST(StrokeReadsPositionsOutOfVertices)
+{
+	// Positions straight out of a vertex array, as the curve models pass
+	// them, give the same stroke as a packed array.
+	const std::vector<XMFLOAT3> points = Spiral(5000);
+	std::vector<VertexCommon> vertices(points.size());
+	for (size_t i = 0; i < points.size(); ++i)
+		vertices[i].pos = points[i];
+	LineStroker stroker;
+	StrokeMesh packed, strided;
+	stroker.Stroke(points.data(), points.size(), sizeof(XMFLOAT3), IdentityView(), StrokeStyle(), white, packed);
+	stroker.Stroke(&vertices[0].pos, vertices.size(), sizeof(VertexCommon), IdentityView(), StrokeStyle(), white, strided);
+	CHECK(packed.vertices.size() == strided.vertices.size());
+	CHECK(packed.indices == strided.indices);
+}
+
+TEST(StrokeAMillionPoints)
+{
+	// The case the stroker is built for: a dense curve re-stroked on every
+	// zoom. The time shows in the test's report.
+	const std::vector<XMFLOAT3> points = Spiral(1000000);
+	StrokeStyle style;
+	style.join = LineJoin::ROUND;
+	LineStroker stroker;
+	StrokeMesh mesh;
+	stroker.Stroke(points.data(), points.size(), sizeof(XMFLOAT3), IdentityView(), style, white, mesh);
+	CHECK(WellFormed(mesh));
+	CHECK(stroker.KeptPoints() < points.size() / 10);
+	CHECK(!mesh.indices.empty());
+}
@@ -0,0 +1,148 @@
+#include "Test.h"
+#include "Math/MathKernels.h"
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Every tier the CPU runs gives the scalar tier's results bit for bit, so
+// a tier forced with --simd or ENGINE_SIMD_TIER reproduces the detected one.
+
+namespace
+{
+	const size_t count = 1 << 16;
+
+	// Half from the ranges the curves use, half arbitrary bit patterns,
+	// infinities and NaNs included.
+	std::vector<float> Inputs(unsigned int seed, float low, float high)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> range(low, high);
+		std::vector<float> values(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (i % 2 == 0)
+			{
+				values[i] = range(random);
+			}
+			else
+			{
+				const std::uint32_t bits = random();
+				std::memcpy(&values[i], &bits, sizeof(bits));
+			}
+		}
+		return values;
+	}
+
+	bool Same(const std::vector<float>& a, const std::vector<float>& b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+	}
+
+	std::vector<const MathKernels*> SupportedTiers()
+	{
+		std::vector<const MathKernels*> tiers;
+		for (int tier = 0; tier < static_cast<int>(SimdTier::COUNT); ++tier)
+		{
+			if (KernelsSupported(static_cast<SimdTier>(tier)))
+				tiers.push_back(KernelsForTier(static_cast<SimdTier>(tier)));
+		}
+		return tiers;
+	}
+}
+
+TEST(EveryTierIncludesScalarAndTheDetectedOne)
+{
+	const std::vector<const MathKernels*> tiers = SupportedTiers();
+	CHECK(!tiers.empty() && tiers.front() == ScalarKernels());
+	bool detected = false;
+	for (const MathKernels* kernels : tiers)
+		detected = detected || kernels->tier == SelectKernels(nullptr).best;
+	CHECK(detected);
+}
+
+TEST(TranscendentalsAreTheSameOnEveryTier)
+{
+	const std::vector<float> angles = Inputs(1, -200.0f, 200.0f);
+	const std::vector<float> bases = Inputs(2, 0.0f, 20.0f);
+	const std::vector<float> exponents = Inputs(3, -8.0f, 8.0f);
+	const MathKernels* scalar = ScalarKernels();
+	for (int a = 0; a < static_cast<int>(MathAccuracy::COUNT); ++a)
+	{
+		const MathAccuracy accuracy = static_cast<MathAccuracy>(a);
+		std::vector<float> sin(count), cos(count), sinCosS(count), sinCosC(count), sqrt(count), pow(count);
+		scalar->sin(angles.data(), sin.data(), count, accuracy);
+		scalar->cos(angles.data(), cos.data(), count, accuracy);
+		scalar->sinCos(angles.data(), sinCosS.data(), sinCosC.data(), count, accuracy);
+		scalar->sqrt(bases.data(), sqrt.data(), count, accuracy);
+		scalar->pow(bases.data(), exponents.data(), pow.data(), count, accuracy);
+
+		for (const MathKernels* kernels : SupportedTiers())
+		{
+			std::vector<float> out(count), second(count);
+			kernels->sin(angles.data(), out.data(), count, accuracy);
+			CHECK(Same(out, sin));
+			kernels->cos(angles.data(), out.data(), count, accuracy);
+			CHECK(Same(out, cos));
+			kernels->sinCos(angles.data(), out.data(), second.data(), count, accuracy);
+			CHECK(Same(out, sinCosS) && Same(second, sinCosC));
+			kernels->sqrt(bases.data(), out.data(), count, accuracy);
+			CHECK(Same(out, sqrt));
+			kernels->pow(bases.data(), exponents.data(), out.data(), count, accuracy);
+			CHECK(Same(out, pow));
+		}
+	}
+}
+
+TEST(TransformsAreTheSameOnEveryTier)
+{
+	std::mt19937 random(4);
+	std::uniform_real_distribution<float> range(-50.0f, 50.0f);
+	std::vector<float> x(count), y(count), z(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		x[i] = range(random);
+		y[i] = range(random);
+		z[i] = range(random);
+	}
+	SoaPoints3 in;
+	in.x = x.data();
+	in.y = y.data();
+	in.z = z.data();
+	float m[16];
+	for (float& value : m)
+		value = range(random) * 0.1f;
+	const float color[3] = { 0.25f, 0.5f, 1.0f };
+
+	const TransformOutput outputs[] = { TransformOutput::CLIP, TransformOutput::NDC, TransformOutput::SCREEN };
+	for (TransformOutput output : outputs)
+	{
+		TransformStreamDesc desc;
+		desc.output = output;
+		desc.viewportWidth = 1920.0f;
+		desc.viewportHeight = 1080.0f;
+		std::vector<float> expected[4], actual[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			expected[c].resize(count);
+			actual[c].resize(count);
+		}
+		SoaPoints4 expectedOut{ expected[0].data(), expected[1].data(), expected[2].data(), expected[3].data() };
+		SoaPoints4 actualOut{ actual[0].data(), actual[1].data(), actual[2].data(), actual[3].data() };
+		ScalarKernels()->transformPoints(in, 0, count, m, desc, expectedOut);
+		for (const MathKernels* kernels : SupportedTiers())
+		{
+			kernels->transformPoints(in, 0, count, m, desc, actualOut);
+			for (int c = 0; c < 4; ++c)
+				CHECK(Same(actual[c], expected[c]));
+		}
+	}
+
+	std::vector<float> packed(9 * count), expectedPacked(9 * count);
+	ScalarKernels()->packVertices(in, count, color, expectedPacked.data());
+	for (const MathKernels* kernels : SupportedTiers())
+	{
+		kernels->packVertices(in, count, color, packed.data());
+		CHECK(Same(packed, expectedPacked));
+	}
+}
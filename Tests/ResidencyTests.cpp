@@ -0,0 +1,309 @@
+#include "Test.h"
+#include "Graphics/ResidencyManager.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+	typedef ResidencyManager::ResourceId ResourceId;
+
+	// The per-category and total figures agree with the resources listed.
+	bool Accounted(const ResidencyManager& residency)
+	{
+		const int categories = static_cast<int>(ResidencyCategory::COUNT);
+		unsigned long long resident[categories] = {}, evicted[categories] = {};
+		unsigned int counts[categories] = {};
+		unsigned long long total = 0;
+		std::vector<ResidencyManager::ResourceInfo> resources;
+		residency.Resources(resources);
+		for (const ResidencyManager::ResourceInfo& info : resources)
+		{
+			const int c = static_cast<int>(info.category);
+			++counts[c];
+			(info.resident ? resident[c] : evicted[c]) += info.bytes;
+			if (info.resident)
+				total += info.bytes;
+		}
+		for (int c = 0; c < categories; ++c)
+		{
+			const ResidencyManager::CategoryUsage& usage = residency.Usage(static_cast<ResidencyCategory>(c));
+			if (usage.residentBytes != resident[c] || usage.evictedBytes != evicted[c] || usage.resources != counts[c])
+				return false;
+		}
+		return total == residency.TotalBytes();
+	}
+}
+
+TEST(ResidencyAccountsBytesPerCategory)
+{
+	ResidencyManager residency;
+	const ResourceId curve = residency.Register(ResidencyCategory::CURVES, "curve");
+	const ResourceId grid = residency.Register(ResidencyCategory::GRID, "grid");
+	const ResourceId staging = residency.Register(ResidencyCategory::STAGING, "ring");
+	CHECK(curve != 0 && grid != 0 && staging != 0);
+	CHECK(residency.TotalBytes() == 0);
+
+	residency.SetBytes(curve, 1000);
+	residency.SetBytes(grid, 300);
+	residency.SetBytes(staging, 4096);
+	CHECK(residency.TotalBytes() == 5396);
+	CHECK(residency.Usage(ResidencyCategory::CURVES).residentBytes == 1000);
+	CHECK(residency.Usage(ResidencyCategory::GRID).resources == 1);
+
+	// Buffers grow and shrink.
+	residency.SetBytes(grid, 100);
+	residency.SetBytes(staging, 8192);
+	CHECK(residency.TotalBytes() == 9292);
+	CHECK(Accounted(residency));
+
+	residency.Unregister(staging);
+	CHECK(residency.TotalBytes() == 1100);
+	CHECK(residency.Usage(ResidencyCategory::STAGING).resources == 0);
+	CHECK(residency.Usage(ResidencyCategory::STAGING).residentBytes == 0);
+	// Unknown ids are ignored.
+	residency.SetBytes(staging, 5);
+	residency.Unregister(0);
+	CHECK(!residency.Touch(staging));
+	CHECK(residency.TotalBytes() == 1100);
+
+	// The slot is reused.
+	const ResourceId stroke = residency.Register(ResidencyCategory::STROKE, "stroke");
+	CHECK(stroke == staging);
+	CHECK(Accounted(residency));
+}
+
+TEST(ResidencyEvictsLeastRecentlyUsedFirst)
+{
+	ResidencyManager residency;
+	residency.budgetBytes = 250;
+	residency.minIdleFrames = 2;
+	std::vector<int> evicted;
+	ResourceId ids[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		ids[i] = residency.Register(ResidencyCategory::CURVES, "curve", [&evicted, i]() { evicted.push_back(i); });
+		residency.SetBytes(ids[i], 100);
+	}
+	const ResourceId grid = residency.Register(ResidencyCategory::GRID, "grid");
+	residency.SetBytes(grid, 100);
+
+	// Curve 0 was used three frames ago, curve 1 two frames ago, curves 2
+	// and 3 and the grid just now.
+	residency.BeginFrame();
+	residency.Touch(ids[1]);
+	residency.BeginFrame();
+	for (ResourceId id : { ids[2], ids[3], grid })
+		residency.Touch(id);
+	residency.BeginFrame();
+	for (ResourceId id : { ids[2], ids[3], grid })
+		residency.Touch(id);
+
+	// 500 bytes over a budget of 250, but only curves 0 and 1 have been
+	// idle long enough; the grid has no evict function.
+	CHECK(residency.Enforce() == 2);
+	CHECK(evicted.size() == 2 && evicted[0] == 0 && evicted[1] == 1);
+	CHECK(residency.TotalBytes() == 300);
+	CHECK(residency.Usage(ResidencyCategory::CURVES).evictedBytes == 200);
+	CHECK(residency.Usage(ResidencyCategory::CURVES).evictions == 2);
+	CHECK(residency.TotalEvictions() == 2);
+	CHECK(!residency.IsResident(ids[0]));
+	CHECK(Accounted(residency));
+
+	// Evicted resources report it when they are used next, and are
+	// counted again once rebuilt.
+	CHECK(!residency.Touch(ids[0]));
+	residency.MarkResident(ids[0]);
+	CHECK(residency.Touch(ids[0]));
+	CHECK(residency.TotalBytes() == 400);
+	CHECK(residency.Usage(ResidencyCategory::CURVES).evictedBytes == 100);
+	CHECK(Accounted(residency));
+
+	// Under budget nothing goes, however idle.
+	residency.budgetBytes = 1000;
+	for (int frame = 0; frame < 10; ++frame)
+		residency.BeginFrame();
+	CHECK(residency.Enforce() == 0);
+	CHECK(evicted.size() == 2);
+}
+
+TEST(ResidencyEvictsTheLargestOfEquallyIdleResources)
+{
+	ResidencyManager residency;
+	residency.budgetBytes = 600;
+	residency.minIdleFrames = 0;
+	std::vector<int> evicted;
+	const unsigned long long sizes[3] = { 100, 500, 200 };
+	for (int i = 0; i < 3; ++i)
+	{
+		const ResourceId id = residency.Register(ResidencyCategory::FAMILY, "batch", [&evicted, i]() { evicted.push_back(i); });
+		residency.SetBytes(id, sizes[i]);
+	}
+	// One 500-byte eviction brings 800 under 600, where the others would
+	// take two.
+	CHECK(residency.Enforce() == 1);
+	CHECK(evicted.size() == 1 && evicted[0] == 1);
+	CHECK(residency.TotalBytes() == 300);
+}
+
+TEST(ResidencyTracksSizeChangesWhileEvicted)
+{
+	ResidencyManager residency;
+	residency.budgetBytes = 0;
+	residency.minIdleFrames = 0;
+	const ResourceId id = residency.Register(ResidencyCategory::ANIMATION, "curve", []() {});
+	residency.SetBytes(id, 64);
+	CHECK(residency.Enforce() == 1);
+	// The curve grew while it was away; it comes back at its new size.
+	residency.SetBytes(id, 128);
+	CHECK(residency.Usage(ResidencyCategory::ANIMATION).evictedBytes == 128);
+	CHECK(residency.TotalBytes() == 0);
+	residency.MarkResident(id);
+	CHECK(residency.TotalBytes() == 128);
+	CHECK(residency.Usage(ResidencyCategory::ANIMATION).evictedBytes == 0);
+	// Marking it twice changes nothing.
+	residency.MarkResident(id);
+	CHECK(residency.TotalBytes() == 128);
+	residency.Unregister(id);
+	CHECK(residency.TotalBytes() == 0);
+	CHECK(Accounted(residency));
+}
+
+TEST(ResidencyListsMostRecentlyUsedFirst)
+{
+	ResidencyManager residency;
+	const ResourceId old = residency.Register(ResidencyCategory::CURVES, "old");
+	residency.BeginFrame();
+	const ResourceId middle = residency.Register(ResidencyCategory::CURVES, "middle");
+	residency.BeginFrame();
+	residency.BeginFrame();
+	const ResourceId recent = residency.Register(ResidencyCategory::GRID, "recent");
+	std::vector<ResidencyManager::ResourceInfo> resources;
+	residency.Resources(resources);
+	CHECK(resources.size() == 3);
+	CHECK(resources[0].id == recent && resources[0].idleFrames == 0 && resources[0].name == "recent");
+	CHECK(resources[1].id == middle && resources[1].idleFrames == 2);
+	CHECK(resources[2].id == old && resources[2].idleFrames == 3);
+	CHECK(!resources[0].evictable);
+
+	residency.Touch(old);
+	residency.Resources(resources);
+	CHECK(resources[0].id == old || resources[1].id == old);
+	CHECK(resources[2].id == middle);
+}
+
+// The way Graphics uses it: of many curves only the visible ones are drawn
+// each frame. Hidden curves go once the budget runs out, and a curve shown
+// again is rebuilt before its draw.
+TEST(ResidencyEvictsHiddenCurvesAndRestoresShownOnes)
+{
+	const int curves = 16;
+	const unsigned long long curveBytes = 1 << 20;
+	ResidencyManager residency;
+	// Room for the curves on screen and those that just left it.
+	residency.budgetBytes = 8 * curveBytes;
+	residency.minIdleFrames = 2;
+	std::vector<bool> built(curves, true);
+	std::vector<ResourceId> ids;
+	for (int i = 0; i < curves; ++i)
+	{
+		ids.push_back(residency.Register(ResidencyCategory::CURVES, "curve", [&built, i]() { built[i] = false; }));
+		residency.SetBytes(ids.back(), curveBytes);
+	}
+
+	unsigned int rebuilds = 0;
+	bool drewUnbuilt = false;
+	for (int frame = 0; frame < 300; ++frame)
+	{
+		residency.BeginFrame();
+		// Four curves on screen, moving along every 20 frames.
+		const int first = (frame / 20) * 3 % curves;
+		for (int k = 0; k < 4; ++k)
+		{
+			const int i = (first + k) % curves;
+			if (!residency.Touch(ids[i]))
+			{
+				built[i] = true;
+				residency.MarkResident(ids[i]);
+				++rebuilds;
+			}
+			drewUnbuilt = drewUnbuilt || !built[i];
+		}
+		residency.Enforce();
+		// All curves were used when they were registered.
+		if (frame >= 2)
+			CHECK(residency.TotalBytes() <= residency.budgetBytes);
+		for (int k = 0; k < 4; ++k)
+			CHECK(residency.IsResident(ids[(first + k) % curves]));
+	}
+	CHECK(!drewUnbuilt);
+	CHECK(rebuilds > 0);
+	CHECK(residency.TotalEvictions() >= rebuilds);
+	CHECK(residency.Usage(ResidencyCategory::CURVES).resources == curves);
+	CHECK(Accounted(residency));
+}
+
+// Random registrations, size changes, uses, rebuilds and budgets: the
+// figures always add up, and Enforce gets under the budget whenever
+// enough idle evictable bytes exist.
+TEST(ResidencyStaysConsistentUnderChurn)
+{
+	std::mt19937 random(42);
+	ResidencyManager residency;
+	residency.minIdleFrames = 1;
+	std::vector<ResourceId> ids;
+	const int categories = static_cast<int>(ResidencyCategory::COUNT);
+	for (int step = 0; step < 20000; ++step)
+	{
+		switch (random() % 6)
+		{
+		case 0:
+		{
+			const ResidencyCategory category = static_cast<ResidencyCategory>(random() % categories);
+			const bool evictable = random() % 4 != 0;
+			ids.push_back(residency.Register(category, "resource", evictable ? ResidencyManager::Evictor([]() {}) : ResidencyManager::Evictor()));
+			break;
+		}
+		case 1:
+			if (!ids.empty() && random() % 4 == 0)
+			{
+				const size_t i = random() % ids.size();
+				residency.Unregister(ids[i]);
+				ids[i] = ids.back();
+				ids.pop_back();
+			}
+			break;
+		case 2:
+			if (!ids.empty())
+				residency.SetBytes(ids[random() % ids.size()], random() % 100000);
+			break;
+		case 3:
+			if (!ids.empty())
+			{
+				const ResourceId id = ids[random() % ids.size()];
+				if (!residency.Touch(id))
+					residency.MarkResident(id);
+			}
+			break;
+		case 4:
+			residency.BeginFrame();
+			break;
+		default:
+		{
+			residency.budgetBytes = random() % 2000000;
+			residency.Enforce();
+			// Whatever is left over the budget can't be evicted yet.
+			if (residency.TotalBytes() > residency.budgetBytes)
+			{
+				std::vector<ResidencyManager::ResourceInfo> resources;
+				residency.Resources(resources);
+				for (const ResidencyManager::ResourceInfo& info : resources)
+					CHECK(!(info.resident && info.evictable && info.bytes > 0 && info.idleFrames >= residency.minIdleFrames));
+			}
+			break;
+		}
+		}
+		if (step % 100 == 0)
+			CHECK(Accounted(residency));
+	}
+	CHECK(Accounted(residency));
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Tests of the parts of the engine that build without the Windows SDK.
+// A test is a function declared with TEST; CHECK reports a condition that
+// doesn't hold and lets the test go on. TestMain.cpp runs every test of
+// the executable it is linked into, or those whose names contain the
+// first argument, and fails if any check did.
+struct TestCase
+{
+	const char* name;
+	void (*run)();
+};
+
+std::vector<TestCase>& TestCases();
+void TestFailed(const char* file, int line, const std::string& what);
+
+struct TestRegistration
+{
+	TestRegistration(const char* name, void (*run)())
+	{
+		TestCases().push_back({ name, run });
+	}
+};
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistration name##Registration(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) TestFailed(__FILE__, __LINE__, #condition); } while (false)
+
+// Checks |a - b| <= tolerance and reports both values if not.
+#define CHECK_NEAR(a, b, tolerance) \
+	do { \
+		const double checkA = static_cast<double>(a), checkB = static_cast<double>(b); \
+		if (!(checkA - checkB <= (tolerance) && checkB - checkA <= (tolerance))) \
+			TestFailed(__FILE__, __LINE__, #a " == " #b ": " + std::to_string(checkA) + " vs " + std::to_string(checkB)); \
+	} while (false)
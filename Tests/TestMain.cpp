@@ -0,0 +1,42 @@
+#include "Test.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	unsigned int failures = 0;
+}
+
+std::vector<TestCase>& TestCases()
+{
+	static std::vector<TestCase> cases;
+	return cases;
+}
+
+void TestFailed(const char* file, int line, const std::string& what)
+{
+	std::printf("%s(%d): check failed: %s\n", file, line, what.c_str());
+	++failures;
+}
+
+int main(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : "";
+	unsigned int ran = 0, failed = 0;
+	for (const TestCase& test : TestCases())
+	{
+		if (!std::strstr(test.name, filter))
+			continue;
+		const unsigned int before = failures;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		test.run();
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%-6s %s (%.1f ms)\n", failures == before ? "ok" : "FAILED", test.name, ms);
+		++ran;
+		if (failures != before)
+			++failed;
+	}
+	std::printf("%u of %u tests passed\n", ran - failed, ran);
+	return failed == 0 && ran > 0 ? 0 : 1;
+}
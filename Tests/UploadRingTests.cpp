@@ -0,0 +1,216 @@
+#include "Test.h"
+#include "Graphics/NullRenderDevice.h"
+#include "Graphics/UploadRing.h"
+#include "Graphics/VertexBuffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct LiveRange
+	{
+		std::uint64_t frame;
+		UINT offset;
+		UINT size;
+	};
+
+	bool Overlaps(const LiveRange& range, UINT offset, UINT size)
+	{
+		return offset < range.offset + range.size && range.offset < offset + size;
+	}
+}
+
+TEST(RingAllocatorWrapsWithoutStraddlingTheEnd)
+{
+	RingAllocator ring;
+	ring.Reset(100);
+	bool wrapped = false;
+	CHECK(ring.Allocate(60, 1, wrapped) == 0 && !wrapped);
+	ring.EndFrame(0);
+	CHECK(ring.Allocate(30, 1, wrapped) == 60 && !wrapped);
+	ring.EndFrame(1);
+	// Frame 0 still holds [0, 60), so 20 bytes don't fit before the end
+	// and can't wrap either.
+	CHECK(ring.Allocate(20, 1, wrapped) == RingAllocator::invalidOffset);
+	ring.Retire(0);
+	CHECK(ring.Allocate(20, 1, wrapped) == 0 && wrapped);
+	// The 10 bytes skipped at the end count until frame 1 retires.
+	CHECK(ring.Used() == 30 + 10 + 20);
+	CHECK(ring.Allocate(40, 1, wrapped) == 20 && !wrapped);
+	CHECK(ring.Allocate(1, 1, wrapped) == RingAllocator::invalidOffset);
+	ring.EndFrame(2);
+	ring.Retire(2);
+	CHECK(ring.Used() == 0);
+}
+
+TEST(RingAllocatorRefusesWhatCanNeverFit)
+{
+	RingAllocator ring;
+	ring.Reset(64);
+	bool wrapped = false;
+	CHECK(ring.Allocate(0, 1, wrapped) == RingAllocator::invalidOffset);
+	CHECK(ring.Allocate(65, 1, wrapped) == RingAllocator::invalidOffset);
+	CHECK(ring.Allocate(64, 16, wrapped) == 0);
+	CHECK(ring.Used() == 64);
+	CHECK(ring.Allocate(1, 1, wrapped) == RingAllocator::invalidOffset);
+}
+
+// Many frames of random allocations, with the GPU finishing frames at an
+// uneven pace: no range may overlap one of a frame that hasn't finished,
+// and once every frame has finished the whole ring is free again.
+TEST(RingAllocatorStressNeverHandsOutLiveRanges)
+{
+	const UINT capacity = 1 << 16;
+	const UINT alignments[4] = { 1, 4, 16, 256 };
+	std::mt19937 random(1234);
+	RingAllocator ring;
+	ring.Reset(capacity);
+
+	std::vector<LiveRange> live;
+	std::uint64_t completed = 0;
+	unsigned int allocations = 0, refusals = 0, wraps = 0;
+	for (std::uint64_t frame = 1; frame <= 20000; ++frame)
+	{
+		const unsigned int count = random() % 8;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const UINT size = 1 + random() % (random() % 4 == 0 ? capacity / 3 : 2048);
+			const UINT alignment = alignments[random() % 4];
+			bool wrapped = false;
+			const UINT offset = ring.Allocate(size, alignment, wrapped);
+			if (offset == RingAllocator::invalidOffset)
+			{
+				++refusals;
+				continue;
+			}
+			++allocations;
+			if (wrapped)
+				++wraps;
+			CHECK(offset % alignment == 0);
+			CHECK(offset + size <= capacity);
+			const bool overlapsLiveRange = std::any_of(live.begin(), live.end(), [&](const LiveRange& range) { return Overlaps(range, offset, size); });
+			CHECK(!overlapsLiveRange);
+			live.push_back({ frame, offset, size });
+		}
+		ring.EndFrame(frame);
+
+		// The GPU is zero to three frames behind.
+		completed = (std::max)(completed, frame - random() % 4);
+		ring.Retire(completed);
+		live.erase(std::remove_if(live.begin(), live.end(), [&](const LiveRange& range) { return range.frame <= completed; }), live.end());
+
+		UINT liveBytes = 0;
+		for (const LiveRange& range : live)
+			liveBytes += range.size;
+		CHECK(liveBytes <= ring.Used());
+		CHECK(ring.Used() <= capacity);
+
+		if (frame % 1000 == 0)
+		{
+			ring.Retire(frame);
+			completed = frame;
+			live.clear();
+			CHECK(ring.Used() == 0);
+			bool wrapped = false;
+			const UINT whole = ring.Allocate(capacity, 1, wrapped);
+			CHECK(whole == 0);
+			ring.EndFrame(frame);
+			ring.Retire(frame);
+		}
+	}
+	CHECK(allocations > 50000);
+	CHECK(wraps > 100);
+	CHECK(refusals > 0);
+}
+
+// Streams random uploads into static buffers for many frames: what the
+// buffers end up holding matches a copy kept in system memory, maps only
+// discard when the ring starts over, and the ring grows until nothing
+// goes around it.
+TEST(UploadRingStressUploadsArriveIntact)
+{
+	NullRenderDevice device;
+	device.recordCalls = true;
+	UploadRing uploads;
+	CHECK(SUCCEEDED(uploads.Initialize(&device, 16 * 1024)));
+
+	const UINT destinationSize = 256 * 1024;
+	DeviceBuffer* destinations[2] = {};
+	std::vector<std::uint8_t> expected[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		BufferDesc desc;
+		desc.type = BufferType::VERTEX;
+		desc.byteWidth = destinationSize;
+		desc.dynamic = false;
+		CHECK(SUCCEEDED(device.CreateBuffer(desc, nullptr, &destinations[i])));
+		expected[i].assign(destinationSize, 0);
+	}
+
+	std::mt19937 random(99);
+	std::vector<std::uint8_t> data;
+	unsigned int discards = 0, appends = 0, lateFallbacks = 0;
+	for (int frame = 0; frame < 2000; ++frame)
+	{
+		device.BeginFrame();
+		uploads.BeginFrame();
+		const UINT fallbacksBefore = uploads.FallbackUploads();
+		const unsigned int count = 1 + random() % 16;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const int target = random() % 2;
+			const UINT size = 1 + random() % 4096;
+			const UINT offset = random() % (destinationSize - size);
+			data.resize(size);
+			for (std::uint8_t& byte : data)
+				byte = static_cast<std::uint8_t>(random());
+			CHECK(SUCCEEDED(uploads.Upload(destinations[target], offset, data.data(), size)));
+			std::copy(data.begin(), data.end(), expected[target].begin() + offset);
+		}
+		if (frame >= 1000)
+			lateFallbacks += uploads.FallbackUploads() - fallbacksBefore;
+
+		for (const RecordedCall& call : device.Calls())
+		{
+			if (call.call != RenderCall::MAP)
+				continue;
+			if (static_cast<MapMode>(call.args[0]) == MapMode::WRITE_DISCARD)
+				++discards;
+			else
+				++appends;
+		}
+		CHECK(uploads.UsedBytes() <= uploads.CapacityBytes());
+	}
+	for (int i = 0; i < 2; ++i)
+		CHECK(device.BufferContents(destinations[i]) == expected[i]);
+	CHECK(appends > 10 * discards);
+	CHECK(lateFallbacks == 0);
+	CHECK(uploads.CapacityBytes() <= UploadRing::maxByteWidth);
+
+	for (DeviceBuffer* destination : destinations)
+		device.ReleaseBuffer(destination);
+}
+
+TEST(VertexBufferUpdatesAreBoundsChecked)
+{
+	NullRenderDevice device;
+	VertexBuffer<float> buffer;
+	CHECK(SUCCEEDED(buffer.Initialize(&device, nullptr, 8)));
+	const float data[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	CHECK(buffer.Update(data, 9) == E_INVALIDARG);
+	CHECK(SUCCEEDED(buffer.Update(data, 8)));
+	CHECK(buffer.UpdateRange(data, 6, 3, MapMode::WRITE_NO_OVERWRITE) == E_INVALIDARG);
+	CHECK(buffer.UpdateRange(data, 9, 0, MapMode::WRITE_NO_OVERWRITE) == E_INVALIDARG);
+	CHECK(buffer.UpdateRange(data, 0xFFFFFFFFu, 2, MapMode::WRITE_NO_OVERWRITE) == E_INVALIDARG);
+	CHECK(SUCCEEDED(buffer.UpdateRange(data, 6, 2, MapMode::WRITE_NO_OVERWRITE)));
+	CHECK(device.CurrentFrameStats().maps == 2);
+
+	UploadRing uploads;
+	CHECK(SUCCEEDED(uploads.Initialize(&device, 1024)));
+	VertexBuffer<float> gpuOnly;
+	CHECK(SUCCEEDED(gpuOnly.Initialize(&device, nullptr, 8, false)));
+	CHECK(gpuOnly.UploadRange(uploads, data, 4, 5) == E_INVALIDARG);
+	CHECK(SUCCEEDED(gpuOnly.UploadRange(uploads, data, 4, 4)));
+}
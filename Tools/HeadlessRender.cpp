@@ -0,0 +1,237 @@
+// Renders a plot to a PNG or PPM file with the software rasterizer, with
+// no window or GPU: the grid, a curve and optionally a family of curves,
+// seen through the same camera the engine starts with.
+//     HeadlessRender [options] --out plot.png
+//     --curve arhimedes|fermat|bernoulli  --a A  --t-min T  --t-max T
+//     --phi-scale S  --vertices N         (the curve; N samples)
+//     --family A_MIN:A_MAX:A_STEP         (sweep a instead of one curve)
+//     --palette rainbow|heat|grayscale    (of the family)
+//     --size WxH  --camera X,Y,Z  --fov DEGREES
+//     --grid xy|xz|both|none  --aa
+#include "Graphics/AdaptiveGrid.h"
+#include "Graphics/Camera.h"
+#include "Graphics/CurveFamily.h"
+#include "Graphics/Curves.h"
+#include "Graphics/ImageWriter.h"
+#include "Graphics/SoftwareRasterizer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	struct Options
+	{
+		CurveParams curve;
+		bool family = false;
+		CurveFamilyDesc familyDesc;
+		int width = 1280;
+		int height = 720;
+		XMFLOAT3 eye = { 0.0f, 0.0f, -20.0f };
+		float fov = 60.0f;
+		bool gridXY = true;
+		bool gridXZ = false;
+		bool antialias = false;
+		std::string out;
+	};
+
+	double MsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	bool EndsWith(const std::string& s, const char* suffix)
+	{
+		const size_t n = std::strlen(suffix);
+		return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+	}
+
+	// Returns false, after saying why, on anything it doesn't understand.
+	bool Parse(int argc, char** argv, Options& options)
+	{
+		// The engine's default curve: the Archimedean spiral it starts with.
+		options.curve.type = CurveType::ARHIMEDES;
+		options.curve.a = 0.33f;
+		options.curve.t_max = 3.14f * 10.0f;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+			if (arg == "--aa")
+			{
+				options.antialias = true;
+				continue;
+			}
+			if (!value)
+			{
+				std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+				return false;
+			}
+			++i;
+			if (arg == "--out")
+				options.out = value;
+			else if (arg == "--curve")
+			{
+				const std::string type = value;
+				if (type == "arhimedes") options.curve.type = CurveType::ARHIMEDES;
+				else if (type == "fermat") options.curve.type = CurveType::FERMAT;
+				else if (type == "bernoulli") options.curve.type = CurveType::BERNOULLI;
+				else
+				{
+					std::fprintf(stderr, "unknown curve %s\n", value);
+					return false;
+				}
+			}
+			else if (arg == "--a") options.curve.a = std::strtof(value, nullptr);
+			else if (arg == "--t-min") options.curve.t_min = std::strtof(value, nullptr);
+			else if (arg == "--t-max") options.curve.t_max = std::strtof(value, nullptr);
+			else if (arg == "--phi-scale") options.curve.phi_scale = std::strtof(value, nullptr);
+			else if (arg == "--vertices") options.curve.t_num = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+			else if (arg == "--family")
+			{
+				options.family = std::sscanf(value, "%f:%f:%f", &options.familyDesc.aMin, &options.familyDesc.aMax, &options.familyDesc.aStep) == 3 &&
+					options.familyDesc.aStep > 0.0f;
+				if (!options.family)
+				{
+					std::fprintf(stderr, "--family wants A_MIN:A_MAX:A_STEP\n");
+					return false;
+				}
+			}
+			else if (arg == "--palette")
+			{
+				const std::string palette = value;
+				if (palette == "rainbow") options.familyDesc.palette = Palette::RAINBOW;
+				else if (palette == "heat") options.familyDesc.palette = Palette::HEAT;
+				else if (palette == "grayscale") options.familyDesc.palette = Palette::GRAYSCALE;
+				else
+				{
+					std::fprintf(stderr, "unknown palette %s\n", value);
+					return false;
+				}
+			}
+			else if (arg == "--size")
+			{
+				if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0)
+				{
+					std::fprintf(stderr, "--size wants WxH\n");
+					return false;
+				}
+			}
+			else if (arg == "--camera")
+			{
+				if (std::sscanf(value, "%f,%f,%f", &options.eye.x, &options.eye.y, &options.eye.z) != 3)
+				{
+					std::fprintf(stderr, "--camera wants X,Y,Z\n");
+					return false;
+				}
+			}
+			else if (arg == "--fov") options.fov = std::strtof(value, nullptr);
+			else if (arg == "--grid")
+			{
+				const std::string grid = value;
+				options.gridXY = grid == "xy" || grid == "both";
+				options.gridXZ = grid == "xz" || grid == "both";
+				if (!options.gridXY && !options.gridXZ && grid != "none")
+				{
+					std::fprintf(stderr, "--grid wants xy, xz, both or none\n");
+					return false;
+				}
+			}
+			else
+			{
+				std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+				return false;
+			}
+		}
+		if (options.out.empty())
+		{
+			std::fprintf(stderr, "usage: %s [options] --out FILE.png|FILE.ppm\n", argv[0]);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!Parse(argc, argv, options))
+		return 2;
+
+	const Clock::time_point start = Clock::now();
+	Camera camera;
+	camera.SetProjectionValues(options.fov, static_cast<float>(options.width), static_cast<float>(options.height), 1.0f, 1000.0f);
+	camera.SetPosition(options.eye.x, options.eye.y, options.eye.z);
+	const XMMATRIX viewProjection = camera.GetViewProjectionMatrix();
+
+	SoftwareRasterizer rasterizer(options.width, options.height);
+	const XMFLOAT4 background(0.1f, 0.1f, 0.1f, 1.0f);
+	rasterizer.Clear(background);
+
+	// As Graphics::UpdateGrid and ExportImage do it: the grid follows the
+	// camera, and its colors are mixed with the background up front since
+	// the rasterizer doesn't blend.
+	if (options.gridXY || options.gridXZ)
+	{
+		XMFLOAT4X4 view;
+		XMFLOAT4X4 projection;
+		XMStoreFloat4x4(&view, camera.GetViewMatrix());
+		XMStoreFloat4x4(&projection, camera.GetProjectionMatrix());
+		GridView gridView;
+		XMStoreFloat3(&gridView.eye, camera.GetPosition());
+		gridView.forward = XMFLOAT3(view._13, view._23, view._33);
+		gridView.tanHalfFov = 1.0f / projection._22;
+		gridView.viewportHeight = static_cast<float>(options.height);
+		AdaptiveGrid grid;
+		grid.Update(gridView, GridStyle(), options.gridXY, options.gridXZ);
+		std::vector<VertexCommon> vertices = grid.Vertices();
+		for (VertexCommon& vertex : vertices)
+		{
+			XMFLOAT4& c = vertex.color;
+			c = XMFLOAT4(background.x + (c.x - background.x) * c.w, background.y + (c.y - background.y) * c.w,
+				background.z + (c.z - background.z) * c.w, 1.0f);
+		}
+		if (!vertices.empty())
+			rasterizer.DrawLineList(vertices.data(), vertices.size(), viewProjection);
+	}
+
+	if (options.family)
+	{
+		options.familyDesc.base = options.curve;
+		GenerateCurveFamily(options.familyDesc, [&](const CurveFamilyBatch& batch)
+		{
+			for (unsigned int member = 0; member < batch.memberCount; ++member)
+				rasterizer.DrawLineStrip(batch.vertices.data() + static_cast<size_t>(member) * batch.verticesPerMember, batch.verticesPerMember, viewProjection);
+		});
+	}
+	else
+	{
+		std::vector<VertexCommon> vertices(CurveVertexCount(options.curve));
+		GenerateCurve(options.curve, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), std::span<VertexCommon>(vertices.data(), vertices.size()));
+		rasterizer.DrawLineStrip(vertices.data(), vertices.size(), viewProjection);
+	}
+	const double generateMs = MsSince(start);
+
+	const Clock::time_point renderStart = Clock::now();
+	rasterizer.Render(options.antialias);
+	const double renderMs = MsSince(renderStart);
+
+	const Clock::time_point writeStart = Clock::now();
+	const bool written = EndsWith(options.out, ".ppm") ? WritePPM(rasterizer.Image(), options.out) : WritePNG(rasterizer.Image(), options.out);
+	if (!written)
+	{
+		std::fprintf(stderr, "Failed to write %s\n", options.out.c_str());
+		return 1;
+	}
+	std::printf("%s: %dx%d, %zu segments; generated and queued in %.1f ms, rasterized in %.1f ms, written in %.1f ms\n",
+		options.out.c_str(), options.width, options.height, rasterizer.SegmentCount(), generateMs, renderMs, MsSince(writeStart));
+	return 0;
+}
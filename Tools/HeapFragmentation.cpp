@@ -0,0 +1,178 @@
+// Churns curves of random lengths through a FreeListAllocator the size of
+// the geometry heap and prints how fragmented it gets, with and without
+// the heap's per-frame compaction, and what the compaction costs.
+//     HeapFragmentation [--capacity VERTICES] [--frames N] [--budget VERTICES] [--seed N]
+// Each frame removes and adds a few curves, between 16 and 64k vertices
+// long, spread evenly on a log scale like the lengths users pick; the heap
+// stays a little over half full.
+#include "Graphics/FreeListAllocator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	struct Options
+	{
+		UINT capacity = 1 << 22;
+		unsigned int frames = 20000;
+		// Vertices Defragment may move per frame; 0 turns compaction off.
+		UINT budget = 0;
+		unsigned int seed = 1;
+	};
+
+	struct Result
+	{
+		unsigned long long allocations = 0;
+		unsigned long long failures = 0;
+		double nsPerAllocate = 0.0;
+		double nsPerFree = 0.0;
+		double meanFragmentation = 0.0;
+		float maxFragmentation = 0.0f;
+		double meanFreeBlocks = 0.0;
+		double meanUsed = 0.0;
+		// Vertices moved by compaction, per frame.
+		double movedPerFrame = 0.0;
+		// Frames of compaction after the run until no gap was left.
+		unsigned int framesToCompact = 0;
+	};
+
+	UINT CurveLength(std::mt19937& random)
+	{
+		std::uniform_real_distribution<double> exponent(4.0, 16.0);
+		return static_cast<UINT>(std::exp2(exponent(random)));
+	}
+
+	// As GeometryHeap::Defragment does it, counting vertices instead of bytes.
+	UINT Compact(FreeListAllocator& allocator, UINT budget)
+	{
+		UINT moved = 0;
+		FreeListAllocator::Move move;
+		while (moved < budget && allocator.Fragmentation() > 0.0f && allocator.CompactStep(move))
+			moved += move.size;
+		return moved;
+	}
+
+	Result Run(const Options& options)
+	{
+		Result result;
+		std::mt19937 random(options.seed);
+		FreeListAllocator allocator;
+		allocator.Reset(options.capacity);
+		std::vector<HeapHandle> live;
+		double allocateNs = 0.0, freeNs = 0.0;
+		unsigned long long frees = 0, moved = 0;
+		for (unsigned int frame = 0; frame < options.frames; ++frame)
+		{
+			// Fill to about half, then keep removing and adding.
+			const bool grow = allocator.UsedSize() < options.capacity / 2;
+			const unsigned int changes = 1 + random() % 4;
+			for (unsigned int i = 0; i < changes; ++i)
+			{
+				if (!grow && !live.empty())
+				{
+					const size_t victim = random() % live.size();
+					const Clock::time_point start = Clock::now();
+					allocator.Free(live[victim]);
+					freeNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+					++frees;
+					live[victim] = live.back();
+					live.pop_back();
+				}
+				const UINT length = CurveLength(random);
+				const Clock::time_point start = Clock::now();
+				const HeapHandle handle = allocator.Allocate(length);
+				allocateNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+				++result.allocations;
+				if (handle.IsValid())
+					live.push_back(handle);
+				else
+					++result.failures;
+			}
+			moved += Compact(allocator, options.budget);
+
+			const float fragmentation = allocator.Fragmentation();
+			result.meanFragmentation += fragmentation;
+			result.maxFragmentation = (std::max)(result.maxFragmentation, fragmentation);
+			result.meanFreeBlocks += allocator.FreeBlockCount();
+			result.meanUsed += static_cast<double>(allocator.UsedSize()) / options.capacity;
+		}
+		result.meanFragmentation /= options.frames;
+		result.meanFreeBlocks /= options.frames;
+		result.meanUsed /= options.frames;
+		result.nsPerAllocate = result.allocations ? allocateNs / result.allocations : 0.0;
+		result.nsPerFree = frees ? freeNs / frees : 0.0;
+		result.movedPerFrame = static_cast<double>(moved) / options.frames;
+
+		const UINT budget = options.budget > 0 ? options.budget : options.capacity / 64;
+		while (result.framesToCompact < 100000 && Compact(allocator, budget) > 0)
+			++result.framesToCompact;
+		return result;
+	}
+
+	void Print(const char* name, const Result& result)
+	{
+		std::printf("%-22s %9.1f %9.1f %7.3f %7.3f %9.1f %6.1f%% %8llu %11.0f %8u\n", name,
+			result.nsPerAllocate, result.nsPerFree, result.meanFragmentation, result.maxFragmentation,
+			result.meanFreeBlocks, 100.0 * result.meanUsed, result.failures, result.movedPerFrame, result.framesToCompact);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--capacity") && i + 1 < argc)
+			options.capacity = static_cast<UINT>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+			options.frames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--budget") && i + 1 < argc)
+			options.budget = static_cast<UINT>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc)
+			options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--capacity VERTICES] [--frames N] [--budget VERTICES] [--seed N]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (options.capacity < (1 << 17) || options.frames == 0)
+	{
+		std::fprintf(stderr, "--capacity must hold at least 131072 vertices and --frames be positive\n");
+		return 2;
+	}
+
+	std::printf("%u frames of churn in a heap of %u vertices\n\n", options.frames, options.capacity);
+	std::printf("%-22s %9s %9s %7s %7s %9s %7s %8s %11s %8s\n", "compaction per frame", "alloc ns", "free ns",
+		"frag", "max", "gaps", "used", "failed", "moved/frame", "settle");
+
+	// Without compaction, then a small budget and the heap's default of
+	// 1 MB, about 29k vertices, or only the budget asked for.
+	std::vector<UINT> budgets = { 0 };
+	if (options.budget > 0)
+		budgets.push_back(options.budget);
+	else
+		budgets.insert(budgets.end(), { 1024, 29127 });
+	for (UINT budget : budgets)
+	{
+		Options run = options;
+		run.budget = budget;
+		char name[32];
+		if (budget == 0)
+			std::snprintf(name, sizeof(name), "none");
+		else
+			std::snprintf(name, sizeof(name), "%u vertices", budget);
+		Print(name, Run(run));
+	}
+	std::printf("\nfrag: 1 - largest gap / free space, averaged over frames; settle: frames of\n"
+		"compaction at the same budget (capacity / 64 for none) until no gap is left.\n");
+	return 0;
+}
@@ -0,0 +1,48 @@
+// Prints how the job system scales with the number of threads.
+//     JobScaling [--runs N] [--workers N]
+// --workers sets ENGINE_JOB_WORKERS before the job system starts; by
+// default it gets a worker per hardware thread but one.
+#include "Jobs/JobBenchmark.h"
+#include "Jobs/JobSystem.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+int main(int argc, char** argv)
+{
+	unsigned int runs = 5;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+			runs = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--workers") && i + 1 < argc)
+		{
+#ifdef _WIN32
+			_putenv_s("ENGINE_JOB_WORKERS", argv[++i]);
+#else
+			setenv("ENGINE_JOB_WORKERS", argv[++i], 1);
+#endif
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--runs N] [--workers N]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	std::printf("%u workers, best of %u runs\n", Jobs().WorkerCount(), runs);
+	std::vector<JobBenchmarkResult> results;
+	RunJobBenchmark(runs, results);
+	std::string workload;
+	for (const JobBenchmarkResult& result : results)
+	{
+		if (workload != result.name)
+		{
+			workload = result.name;
+			std::printf("\n%s\n  threads        ms   speedup\n", result.name);
+		}
+		std::printf("  %7u %9.3f %8.2fx\n", result.threads, result.msPerRun, result.speedup);
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+// Prints the math benchmarks of the Math panel without the UI: vector and
+// matrix operations against ScalarMath, clip-space transforms of arrays of
+// points, and sin, cos, sincos, sqrt and pow at each accuracy tier against
+// the C library.
+//     MathBench [--iterations N] [--points N] [--count N] [--runs N] [--only math|transform|transcendental]
+#include "Math/MathBenchmark.h"
+#include "Math/TransformStream.h"
+#include "Math/VectorMath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	unsigned int iterations = 1 << 20;
+	size_t points = 1 << 20;
+	size_t count = 1 << 16;
+	unsigned int runs = 20;
+	const char* only = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--iterations") && i + 1 < argc)
+			iterations = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--points") && i + 1 < argc)
+			points = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--count") && i + 1 < argc)
+			count = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+			runs = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--only") && i + 1 < argc &&
+			(!std::strcmp(argv[i + 1], "math") || !std::strcmp(argv[i + 1], "transform") || !std::strcmp(argv[i + 1], "transcendental")))
+			only = argv[++i];
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--iterations N] [--points N] [--count N] [--runs N] [--only math|transform|transcendental]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (iterations == 0 || points == 0 || count == 0 || runs == 0)
+	{
+		std::fprintf(stderr, "--iterations, --points, --count and --runs must be positive\n");
+		return 2;
+	}
+
+	if (!only || !std::strcmp(only, "math"))
+	{
+		std::printf("Math backend %s, %u iterations\n  %-24s %9s %9s %8s\n", ENGINE_MATH_BACKEND, iterations,
+			"operation", "ns", "scalar ns", "speedup");
+		std::vector<MathBenchmarkResult> results;
+		RunMathBenchmark(iterations, results);
+		for (const MathBenchmarkResult& result : results)
+		{
+			std::printf("  %-24s %9.2f %9.2f %7.2fx\n", result.name, result.nsPerOp, result.scalarNsPerOp,
+				result.nsPerOp > 0.0 ? result.scalarNsPerOp / result.nsPerOp : 0.0);
+		}
+		std::printf("\n");
+	}
+
+	if (!only || !std::strcmp(only, "transform"))
+	{
+		std::printf("Transform streams %s, %zu points, best of %u runs\n  %-32s %-12s %9s %9s\n", TransformStreamBackend(),
+			points, runs, "loop", "tier", "GB/s", "ms");
+		std::vector<TransformBenchmarkResult> results;
+		RunTransformBenchmark(points, runs, results);
+		for (const TransformBenchmarkResult& result : results)
+			std::printf("  %-32s %-12s %9.2f %9.3f\n", result.name, result.tier, result.gigabytesPerSecond, result.msPerRun);
+		std::printf("\n");
+	}
+
+	if (!only || !std::strcmp(only, "transcendental"))
+	{
+		std::printf("sin, cos, sqrt, pow %s, %zu values, best of %u runs\n  %-8s %-17s %-10s %10s %10s\n", TranscendentalBackend(),
+			count, runs, "function", "accuracy", "tier", "M/s", "libm M/s");
+		std::vector<TranscendentalBenchmarkResult> results;
+		RunTranscendentalBenchmark(count, runs, results);
+		for (const TranscendentalBenchmarkResult& result : results)
+		{
+			std::printf("  %-8s %-17s %-10s %10.0f %10.0f\n", result.function, MathAccuracyName(result.accuracy), result.tier,
+				result.millionsPerSecond, result.libmMillionsPerSecond);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,241 @@
+// Runs frames of a scene like the engine's through the render device
+// interface on the null backend and reports what they cost the CPU: the
+// grid following an orbiting camera, the three curve models with their
+// chunks culled, and optionally one curve regenerated every frame.
+//     NullFrames [--frames N] [--vertices N] [--animate] [--record]
+// --record keeps the null device's call log on, which costs time of its
+// own; the counts below don't need it.
+#include "Graphics/AdaptiveGrid.h"
+#include "Graphics/Camera.h"
+#include "Graphics/DrawCommandBuffer.h"
+#include "Graphics/Model.h"
+#include "Graphics/NullRenderDevice.h"
+#include "Timing/FrameTimeHistogram.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const int width = 1280;
+	const int height = 720;
+	const unsigned int chunkSize = 4096;
+
+	double MsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// Generates straight into the model's buffer, as the engine's curve
+	// uploads do.
+	bool Generate(Model& model, const CurveParams& params)
+	{
+		std::span<VertexCommon> target;
+		if (FAILED(model.vertices.Map(MapMode::WRITE_DISCARD, target)))
+			return false;
+		const UINT written = GenerateCurve(params, model.curveColor, target, &model.chunks, chunkSize);
+		model.vertices.Unmap(written);
+		model.curveVertices = written;
+		return written > 0;
+	}
+
+	bool InitCurve(RenderDevice& device, Model& model, const CurveParams& params, const XMFLOAT4& color)
+	{
+		const UINT count = CurveVertexCount(params);
+		model.topology = PrimitiveTopology::LINE_STRIP;
+		model.curve = params;
+		model.curveColor = color;
+		model.curveCapacity = count;
+		std::vector<DWORD> indices(count);
+		std::iota(indices.begin(), indices.end(), 0);
+		return SUCCEEDED(model.vertices.Initialize(&device, nullptr, count)) &&
+			SUCCEEDED(model.indices.Initialize(&device, indices.data(), count)) &&
+			SUCCEEDED(model.cb.Initialize(&device)) &&
+			Generate(model, params);
+	}
+
+	CurveParams Params(CurveType type, float a, float tMax, unsigned int vertices, float phiScale = 2.0f)
+	{
+		CurveParams params;
+		params.type = type;
+		params.a = a;
+		params.t_max = tMax;
+		params.phi_scale = phiScale;
+		params.t_num = vertices;
+		return params;
+	}
+
+	struct PhaseTimes
+	{
+		double update = 0.0;
+		double generate = 0.0;
+		double record = 0.0;
+		double submit = 0.0;
+	};
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int frames = 600;
+	unsigned int vertices = 100000;
+	bool animate = false;
+	bool record = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--vertices") && i + 1 < argc)
+			vertices = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--animate"))
+			animate = true;
+		else if (!std::strcmp(argv[i], "--record"))
+			record = true;
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--frames N] [--vertices N] [--animate] [--record]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (frames == 0 || vertices < 2)
+		return 2;
+
+	NullRenderDevice device;
+	device.recordCalls = record;
+	ConstantArena arena;
+	if (FAILED(arena.Initialize(&device, 256 * ConstantArena::blockAlignment)))
+		return 1;
+	DrawCommandBuffer commands;
+	commands.SetConstantArena(&arena);
+
+	// The engine's three function models, as it first creates them.
+	Model curves[3];
+	const CurveParams params[3] =
+	{
+		Params(CurveType::ARHIMEDES, 0.33f, 3.14f * 10.0f, vertices),
+		Params(CurveType::FERMAT, 2.5f, 3.14f * 10.0f, vertices),
+		Params(CurveType::BERNOULLI, 5.0f, 1000.0f, vertices),
+	};
+	const XMFLOAT4 colors[3] = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 0.6f, 0.2f, 1.0f }, { 0.3f, 0.8f, 1.0f, 1.0f } };
+	for (int i = 0; i < 3; ++i)
+	{
+		if (!InitCurve(device, curves[i], params[i], colors[i]))
+		{
+			std::fprintf(stderr, "Failed to create the curve buffers.\n");
+			return 1;
+		}
+	}
+
+	Camera camera;
+	camera.SetProjectionValues(60.0f, static_cast<float>(width), static_cast<float>(height), 1.0f, 1000.0f);
+	AdaptiveGrid grid;
+	VertexBuffer<VertexCommon> gridVertices;
+	UINT gridVertexCount = 0;
+	ConstantBuffer<CB_VS_vertexshader> gridConstants;
+	gridConstants.Initialize(&device);
+
+	FrameTimeHistogram frameTimes(frames);
+	PhaseTimes total;
+	RenderStats stats;
+	unsigned long long uploadedBytes = 0;
+	UINT visibleChunks = 0, totalChunks = 0;
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		const Clock::time_point frameStart = Clock::now();
+		device.BeginFrame();
+
+		// The camera circles the origin and moves in and out, so the grid
+		// changes level and chunks leave and enter the view.
+		const Clock::time_point updateStart = Clock::now();
+		const float angle = frame * 0.01f;
+		const float distance = 20.0f + 15.0f * std::sin(frame * 0.013f);
+		camera.SetPosition(distance * std::sin(angle), 4.0f, -distance * std::cos(angle));
+		camera.SetRotation(0.2f, -angle, 0.0f);
+		XMFLOAT4X4 view;
+		XMFLOAT4X4 projection;
+		XMStoreFloat4x4(&view, camera.GetViewMatrix());
+		XMStoreFloat4x4(&projection, camera.GetProjectionMatrix());
+		GridView gridView;
+		XMStoreFloat3(&gridView.eye, camera.GetPosition());
+		gridView.forward = XMFLOAT3(view._13, view._23, view._33);
+		gridView.tanHalfFov = 1.0f / projection._22;
+		gridView.viewportHeight = static_cast<float>(height);
+		if (grid.Update(gridView, GridStyle(), true, true))
+		{
+			const std::vector<VertexCommon>& lines = grid.Vertices();
+			gridVertexCount = static_cast<UINT>(lines.size());
+			if (gridVertexCount > gridVertices.BufferSize())
+				gridVertices.Initialize(&device, nullptr, gridVertexCount * 2);
+			if (gridVertexCount > 0)
+				gridVertices.Update(lines.data(), gridVertexCount);
+		}
+		const XMMATRIX viewProjection = camera.GetViewProjectionMatrix();
+		total.update += MsSince(updateStart);
+
+		const Clock::time_point generateStart = Clock::now();
+		if (animate)
+		{
+			CurveParams animated = params[frame % 3];
+			animated.a *= 1.0f + 0.25f * std::sin(frame * 0.05f);
+			Generate(curves[frame % 3], animated);
+		}
+		total.generate += MsSince(generateStart);
+
+		// What Graphics::RenderPacket records: the grid on layer 0, the
+		// curves over it on layer 1.
+		const Clock::time_point recordStart = Clock::now();
+		commands.Clear();
+		if (gridVertexCount > 0)
+		{
+			gridConstants.data.wvp = XMMatrixTranspose(viewProjection);
+			gridConstants.data.enableSpherical = 0;
+			DrawCommand lines;
+			lines.topology = PrimitiveTopology::LINE_LIST;
+			lines.blend = BlendMode::ALPHA;
+			lines.vertexBuffer = gridVertices.Get();
+			lines.vertexStride = gridVertices.Stride();
+			lines.count = gridVertexCount;
+			if (commands.BindConstants(lines, gridConstants))
+				commands.Add(lines);
+		}
+		visibleChunks = 0;
+		totalChunks = 0;
+		for (Model& model : curves)
+		{
+			model.draw(commands, viewProjection, 1);
+			visibleChunks += model.visibleChunks;
+			totalChunks += static_cast<UINT>(model.chunks.size());
+		}
+		total.record += MsSince(recordStart);
+
+		const Clock::time_point submitStart = Clock::now();
+		commands.Submit(device);
+		total.submit += MsSince(submitStart);
+
+		frameTimes.Add(static_cast<float>(MsSince(frameStart)));
+		stats = device.CurrentFrameStats();
+		uploadedBytes += stats.uploadedBytes;
+	}
+
+	const FrameTimeHistogram::Summary summary = frameTimes.Summarize();
+	std::printf("%u frames, 3 curves of %u vertices%s, null render device\n\n", frames, vertices, animate ? ", one regenerated per frame" : "");
+	std::printf("CPU ms per frame: mean %.3f, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n",
+		summary.mean, summary.p50, summary.p95, summary.p99, summary.max);
+	std::printf("  update %.3f, generate %.3f, record %.3f, submit %.3f\n\n",
+		total.update / frames, total.generate / frames, total.record / frames, total.submit / frames);
+	std::printf("Last frame: %u draws of %llu elements, %u state changes (%u skipped), %u maps, %llu bytes uploaded\n",
+		stats.draws, stats.drawnElements, stats.stateChanges, commands.SkippedBindings(), stats.maps, stats.uploadedBytes);
+	std::printf("            %u of %u curve chunks visible, %u constant arena bytes\n", visibleChunks, totalChunks, arena.LastFrameBytes());
+	std::printf("Uploaded %.2f MB per frame on average\n", uploadedBytes / 1e6 / frames);
+	if (record)
+		std::printf("%zu calls recorded in the last frame\n", device.Calls().size());
+	return 0;
+}
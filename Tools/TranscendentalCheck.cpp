@@ -0,0 +1,154 @@
+// Checks sin, cos, sqrt and pow at every accuracy tier against the C
+// library in double precision, over every float or every step-th bit
+// pattern, and fails when a tier misses what Transcendental.h promises.
+//     TranscendentalCheck [--step N] [--function sin|cos|sqrt|pow] [--accuracy precise|standard|fast]
+// The default step of 1 checks all 2^32 floats per function and tier and
+// takes minutes; the tests run it with a large prime step.
+#include "Math/TranscendentalCheck.h"
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	struct Limit
+	{
+		// Largest error in ulp, or 0 where the tier is held to maxRelError
+		// or maxAbsError instead.
+		double maxUlp = 0.0;
+		double maxAbsError = 0.0;
+		double maxRelError = 0.0;
+		// Inputs beyond this magnitude aren't checked.
+		float maxInput = FLT_MAX;
+		bool specialsMatch = true;
+	};
+
+	Limit LimitFor(MathFunction function, MathAccuracy accuracy)
+	{
+		Limit limit;
+		// The square root instruction is correctly rounded at every tier.
+		if (function == MathFunction::SQRT)
+		{
+			limit.maxUlp = 0.5;
+			return limit;
+		}
+		switch (accuracy)
+		{
+		case MathAccuracy::PRECISE:
+			limit.maxUlp = 1.0;
+			break;
+		case MathAccuracy::STANDARD:
+			limit.maxUlp = 4.0;
+			break;
+		default:
+			if (function == MathFunction::POW)
+			{
+				limit.maxRelError = 1e-5;
+				// It may overflow a little before FLT_MAX.
+				limit.specialsMatch = false;
+			}
+			else
+			{
+				// "About 1e-5" in Transcendental.h.
+				limit.maxAbsError = 2e-5;
+				limit.maxInput = 1e5f;
+			}
+			break;
+		}
+		return limit;
+	}
+
+	bool Within(const AccuracyReport& report, const Limit& limit)
+	{
+		if (limit.maxUlp > 0.0 && report.maxUlp > limit.maxUlp)
+			return false;
+		if (limit.maxAbsError > 0.0 && report.maxAbsError > limit.maxAbsError)
+			return false;
+		if (limit.maxRelError > 0.0 && report.maxRelError > limit.maxRelError)
+			return false;
+		return !limit.specialsMatch || report.specialMismatches == 0;
+	}
+
+	const char* const accuracyArguments[] = { "precise", "standard", "fast" };
+
+	bool ParseFunction(const char* text, MathFunction& out)
+	{
+		for (int i = 0; i < static_cast<int>(MathFunction::COUNT); ++i)
+		{
+			if (!std::strcmp(text, MathFunctionName(static_cast<MathFunction>(i))))
+			{
+				out = static_cast<MathFunction>(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ParseAccuracy(const char* text, MathAccuracy& out)
+	{
+		for (int i = 0; i < static_cast<int>(MathAccuracy::COUNT); ++i)
+		{
+			if (!std::strcmp(text, accuracyArguments[i]))
+			{
+				out = static_cast<MathAccuracy>(i);
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int step = 1;
+	bool oneFunction = false, oneAccuracy = false;
+	MathFunction onlyFunction = MathFunction::SIN;
+	MathAccuracy onlyAccuracy = MathAccuracy::PRECISE;
+	bool usage = false;
+	for (int i = 1; i < argc && !usage; ++i)
+	{
+		if (!std::strcmp(argv[i], "--step") && i + 1 < argc)
+			step = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--function") && i + 1 < argc)
+			usage = !(oneFunction = ParseFunction(argv[++i], onlyFunction));
+		else if (!std::strcmp(argv[i], "--accuracy") && i + 1 < argc)
+			usage = !(oneAccuracy = ParseAccuracy(argv[++i], onlyAccuracy));
+		else
+			usage = true;
+	}
+	if (usage || step == 0)
+	{
+		std::fprintf(stderr, "usage: %s [--step N] [--function sin|cos|sqrt|pow] [--accuracy precise|standard|fast]\n", argv[0]);
+		return 2;
+	}
+
+	if (step == 1)
+		std::printf("%s, every float\n", TranscendentalBackend());
+	else
+		std::printf("%s, one float in %u\n", TranscendentalBackend(), step);
+	std::printf("  %-5s %-17s %12s %12s %10s %10s %9s\n", "", "", "checked", "max ulp", "abs", "rel", "specials");
+	bool passed = true;
+	for (int f = 0; f < static_cast<int>(MathFunction::COUNT); ++f)
+	{
+		const MathFunction function = static_cast<MathFunction>(f);
+		if (oneFunction && function != onlyFunction)
+			continue;
+		for (int a = 0; a < static_cast<int>(MathAccuracy::COUNT); ++a)
+		{
+			const MathAccuracy accuracy = static_cast<MathAccuracy>(a);
+			if (oneAccuracy && accuracy != onlyAccuracy)
+				continue;
+			const Limit limit = LimitFor(function, accuracy);
+			const AccuracyReport report = CheckAccuracy(function, accuracy, step, limit.maxInput);
+			const bool within = Within(report, limit);
+			passed = passed && within;
+			std::printf("  %-5s %-17s %12llu %12.3f %10.2e %10.2e %9llu%s\n", MathFunctionName(function), MathAccuracyName(accuracy),
+				report.checked, report.maxUlp, report.maxAbsError, report.maxRelError, report.specialMismatches,
+				within ? "" : "  FAILED");
+			if (!within)
+				std::printf("        worst input %.9g\n", report.worstInput);
+		}
+	}
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+// Prints what generating curves, or packing their points, straight into
+// mapped vertex buffer memory saves over staging them in system memory
+// first.
+//     UploadBandwidth [--vertices N] [--runs N]
+// Runs on the null render device, whose buffers are plain system memory;
+// write-combined memory behind a real D3D11 map favours the direct path
+// more, since reading it back is never needed.
+#include "Graphics/NullRenderDevice.h"
+#include "Graphics/UploadBenchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	unsigned int vertices = 1000000;
+	unsigned int runs = 10;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--vertices") && i + 1 < argc)
+			vertices = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+			runs = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--vertices N] [--runs N]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	NullRenderDevice device;
+	device.recordCalls = false;
+	std::vector<UploadBenchmarkResult> results;
+	RunUploadBenchmark(device, vertices, runs, results);
+	if (results.empty())
+		return 1;
+
+	std::printf("%u vertices, best of %u runs\n\n", vertices, runs);
+	std::printf("%-24s %-8s %10s %8s %12s\n", "", "path", "ms", "GB/s", "MB moved");
+	for (const UploadBenchmarkResult& result : results)
+	{
+		std::printf("%-24s %-8s %10.3f %8.2f %12.1f\n", result.name, result.staged ? "staged" : "mapped",
+			result.msPerRun, result.gigabytesPerSecond, result.bytesMoved / 1e6);
+	}
+	return 0;
+}